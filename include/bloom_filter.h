@@ -0,0 +1,363 @@
+#ifndef MYTINYSTL_BLOOM_FILTER_H_
+#define MYTINYSTL_BLOOM_FILTER_H_
+
+// 分块布隆过滤器（split block Bloom filter）：位数组按 256 位分块，
+// 块按 64 字节对齐，一个键只落在一个块内，查询只访问一条缓存行。
+// 块内 8 个 32 位字各置 1 位，位号由哈希值低 32 位分别乘以 8 个奇数常数
+// 后取高 5 位得到；有 AVX2 时一次计算整块的掩码并用 vptest 判断。
+// 只支持插入与查询，不支持删除（需要删除时用 cuckoo_filter）。
+// 键的哈希须足够均匀：未声明 is_avalanching 的哈希结果会先混合一次。
+// 序列化格式为 8 字节标识、8 字节块数，之后是各块的原始字节，
+// 按本机字节序存放，只应在同一平台和同一哈希函数之间交换。
+
+#include "allocator.h"
+#include "exceptdef.h"
+#include "hash.h"
+#include "iterator.h"
+#include "util.h"
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace tinystl {
+struct alignas(32) bloom_filter_block {
+  std::uint32_t word[8];
+};
+
+inline const std::uint32_t *bloom_filter_salt() {
+  alignas(32) static const std::uint32_t salt[8] = {
+      0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+      0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U};
+  return salt;
+}
+
+// 被移走的过滤器指向这个全零块，查询照常进行，写入前才换上自己的块
+inline bloom_filter_block *bloom_filter_empty_block() {
+  alignas(64) static bloom_filter_block empty = {};
+  return &empty;
+}
+
+// 每块平均有 keys_per_block 个键时的误判率：块内键数服从泊松分布，
+// 块内有 j 个键时一个字的某一位已置 1 的概率是 1 - (31/32)^j
+inline double bloom_filter_fpp(double keys_per_block) {
+  double p = std::exp(-keys_per_block);
+  double fpp = 0;
+  const double last = keys_per_block + 10 * std::sqrt(keys_per_block) + 10;
+  for (int j = 1; j <= last; ++j) {
+    p *= keys_per_block / j;
+    fpp += p * std::pow(1 - std::pow(31.0 / 32.0, j), 8);
+  }
+  return fpp;
+}
+
+template <typename Key, typename Hash = tinystl::hash<Key>>
+class bloom_filter {
+public:
+  typedef Key key_type;
+  typedef Hash hasher;
+  typedef std::size_t size_type;
+
+private:
+  typedef tinystl::allocator<unsigned char> byte_allocator;
+  static constexpr size_type block_align = 64;
+  // 批量操作先算出一批哈希并预取对应块
+  static constexpr size_type bulk_batch = 16;
+  static constexpr char magic[8] = {'T', 'S', 'T', 'L', 'B', 'L', 'M', '1'};
+
+  bloom_filter_block *blocks_;
+  size_type block_count_;
+  hasher hash_;
+
+public:
+  // 按预计元素数与目标误判率确定大小
+  explicit bloom_filter(size_type expected_count, double fpp = 0.01,
+                        const hasher &hash = hasher());
+  bloom_filter(const bloom_filter &f);
+  bloom_filter(bloom_filter &&f) noexcept
+      : blocks_(f.blocks_), block_count_(f.block_count_), hash_(f.hash_) {
+    f.blocks_ = bloom_filter_empty_block();
+    f.block_count_ = 1;
+  }
+  ~bloom_filter() { deallocate_blocks(blocks_); }
+
+  bloom_filter &operator=(const bloom_filter &f) {
+    if (this != &f) {
+      bloom_filter tmp(f);
+      swap(tmp);
+    }
+    return *this;
+  }
+  bloom_filter &operator=(bloom_filter &&f) noexcept {
+    bloom_filter tmp(std::move(f));
+    swap(tmp);
+    return *this;
+  }
+
+  void insert(const key_type &k) {
+    own_blocks();
+    insert_hash(hash_of(k));
+  }
+  template <typename InputIterator,
+            typename std::enable_if<
+                tinystl::has_input_iterator_cat<InputIterator>::value,
+                int>::type = 0>
+  void insert(InputIterator first, InputIterator last);
+
+  // 返回 false 时键一定不在集合中
+  bool contains(const key_type &k) const { return contains_hash(hash_of(k)); }
+  // 依次把每个键的查询结果写入 out，返回写完后的 out
+  template <typename InputIterator, typename OutputIterator>
+  OutputIterator contains(InputIterator first, InputIterator last,
+                          OutputIterator out) const;
+
+  // 并入另一个大小与哈希相同的过滤器
+  void merge(const bloom_filter &f);
+  void clear() {
+    if (blocks_ != bloom_filter_empty_block()) {
+      std::memset(static_cast<void *>(blocks_), 0,
+                  block_count_ * sizeof(bloom_filter_block));
+    }
+  }
+
+  size_type block_count() const noexcept { return block_count_; }
+  size_type bit_count() const noexcept { return block_count_ * 256; }
+  hasher hash_function() const { return hash_; }
+
+  size_type serialized_size() const noexcept {
+    return 16 + block_count_ * sizeof(bloom_filter_block);
+  }
+  // out 须至少有 serialized_size() 字节
+  void serialize(void *out) const;
+  static bloom_filter deserialize(const void *data, size_type len,
+                                  const hasher &hash = hasher());
+
+  void swap(bloom_filter &f) noexcept {
+    std::swap(blocks_, f.blocks_);
+    std::swap(block_count_, f.block_count_);
+    std::swap(hash_, f.hash_);
+  }
+
+private:
+  bloom_filter(size_type block_count, const hasher &hash, int)
+      : blocks_(allocate_blocks(block_count)), block_count_(block_count),
+        hash_(hash) {}
+
+  std::uint64_t hash_of(const key_type &k) const {
+    return mix(hash_(k), hash_is_avalanching<hasher>());
+  }
+  static std::uint64_t mix(std::uint64_t h, std::true_type) { return h; }
+  static std::uint64_t mix(std::uint64_t h, std::false_type) {
+    return hash_mix(h);
+  }
+
+  // 高 32 位选块（乘法取高位代替取模），低 32 位选块内的位
+  bloom_filter_block *block_of(std::uint64_t h) const {
+    return blocks_ + (((h >> 32) * block_count_) >> 32);
+  }
+  void own_blocks() {
+    if (blocks_ == bloom_filter_empty_block()) {
+      blocks_ = allocate_blocks(1);
+    }
+  }
+  void insert_hash(std::uint64_t h);
+  bool contains_hash(std::uint64_t h) const;
+
+  static bloom_filter_block *allocate_blocks(size_type n);
+  static void deallocate_blocks(bloom_filter_block *p);
+};
+
+template <typename Key, typename Hash>
+constexpr char bloom_filter<Key, Hash>::magic[8];
+
+template <typename Key, typename Hash>
+bloom_filter<Key, Hash>::bloom_filter(size_type expected_count, double fpp,
+                                      const hasher &hash)
+    : blocks_(nullptr), block_count_(0), hash_(hash) {
+  MY_DEBUG(fpp > 0 && fpp < 1);
+  // 二分求出满足误判率的每块最多键数
+  double lo = 0, hi = 256;
+  for (int i = 0; i < 40; ++i) {
+    double mid = (lo + hi) / 2;
+    if (bloom_filter_fpp(mid) <= fpp) {
+      lo = mid;
+    } else {
+      hi = mid;
+    }
+  }
+  double blocks = lo > 0 ? std::ceil(expected_count / lo) : expected_count;
+  // 块号由 32 位乘法得到，块数不超过 2^32
+  block_count_ = static_cast<size_type>(
+      blocks < 1 ? 1 : (blocks > 4294967296.0 ? 4294967296.0 : blocks));
+  blocks_ = allocate_blocks(block_count_);
+}
+
+template <typename Key, typename Hash>
+bloom_filter<Key, Hash>::bloom_filter(const bloom_filter &f)
+    : blocks_(allocate_blocks(f.block_count_)), block_count_(f.block_count_),
+      hash_(f.hash_) {
+  std::memcpy(static_cast<void *>(blocks_), f.blocks_,
+              block_count_ * sizeof(bloom_filter_block));
+}
+
+template <typename Key, typename Hash>
+template <typename InputIterator,
+          typename std::enable_if<
+              tinystl::has_input_iterator_cat<InputIterator>::value, int>::type>
+void bloom_filter<Key, Hash>::insert(InputIterator first,
+                                     InputIterator last) {
+  std::uint64_t h[bulk_batch];
+  own_blocks();
+  while (first != last) {
+    size_type n = 0;
+    for (; n < bulk_batch && first != last; ++n, ++first) {
+      h[n] = hash_of(*first);
+#if defined(__GNUC__)
+      __builtin_prefetch(block_of(h[n]), 1);
+#endif
+    }
+    for (size_type i = 0; i < n; ++i) {
+      insert_hash(h[i]);
+    }
+  }
+}
+
+template <typename Key, typename Hash>
+template <typename InputIterator, typename OutputIterator>
+OutputIterator bloom_filter<Key, Hash>::contains(InputIterator first,
+                                                 InputIterator last,
+                                                 OutputIterator out) const {
+  std::uint64_t h[bulk_batch];
+  while (first != last) {
+    size_type n = 0;
+    for (; n < bulk_batch && first != last; ++n, ++first) {
+      h[n] = hash_of(*first);
+#if defined(__GNUC__)
+      __builtin_prefetch(block_of(h[n]));
+#endif
+    }
+    for (size_type i = 0; i < n; ++i, ++out) {
+      *out = contains_hash(h[i]);
+    }
+  }
+  return out;
+}
+
+template <typename Key, typename Hash>
+void bloom_filter<Key, Hash>::insert_hash(std::uint64_t h) {
+  bloom_filter_block *b = block_of(h);
+  const std::uint32_t key = static_cast<std::uint32_t>(h);
+#if defined(__AVX2__)
+  const __m256i salt = _mm256_load_si256(
+      reinterpret_cast<const __m256i *>(bloom_filter_salt()));
+  __m256i bit = _mm256_srli_epi32(
+      _mm256_mullo_epi32(_mm256_set1_epi32(static_cast<int>(key)), salt), 27);
+  __m256i mask = _mm256_sllv_epi32(_mm256_set1_epi32(1), bit);
+  __m256i *p = reinterpret_cast<__m256i *>(b);
+  _mm256_store_si256(p, _mm256_or_si256(_mm256_load_si256(p), mask));
+#else
+  const std::uint32_t *salt = bloom_filter_salt();
+  for (int i = 0; i < 8; ++i) {
+    b->word[i] |= std::uint32_t(1) << ((key * salt[i]) >> 27);
+  }
+#endif
+}
+
+template <typename Key, typename Hash>
+bool bloom_filter<Key, Hash>::contains_hash(std::uint64_t h) const {
+  const bloom_filter_block *b = block_of(h);
+  const std::uint32_t key = static_cast<std::uint32_t>(h);
+#if defined(__AVX2__)
+  const __m256i salt = _mm256_load_si256(
+      reinterpret_cast<const __m256i *>(bloom_filter_salt()));
+  __m256i bit = _mm256_srli_epi32(
+      _mm256_mullo_epi32(_mm256_set1_epi32(static_cast<int>(key)), salt), 27);
+  __m256i mask = _mm256_sllv_epi32(_mm256_set1_epi32(1), bit);
+  // 掩码中的位全部为 1 时 testc 返回 1
+  return _mm256_testc_si256(
+      _mm256_load_si256(reinterpret_cast<const __m256i *>(b)), mask);
+#else
+  const std::uint32_t *salt = bloom_filter_salt();
+  std::uint32_t miss = 0;
+  for (int i = 0; i < 8; ++i) {
+    std::uint32_t mask = std::uint32_t(1) << ((key * salt[i]) >> 27);
+    miss |= mask & ~b->word[i];
+  }
+  return miss == 0;
+#endif
+}
+
+template <typename Key, typename Hash>
+void bloom_filter<Key, Hash>::merge(const bloom_filter &f) {
+  MY_DEBUG(block_count_ == f.block_count_);
+  own_blocks();
+  for (size_type i = 0; i < block_count_; ++i) {
+    for (int j = 0; j < 8; ++j) {
+      blocks_[i].word[j] |= f.blocks_[i].word[j];
+    }
+  }
+}
+
+template <typename Key, typename Hash>
+void bloom_filter<Key, Hash>::serialize(void *out) const {
+  unsigned char *p = static_cast<unsigned char *>(out);
+  const std::uint64_t n = block_count_;
+  std::memcpy(p, magic, 8);
+  std::memcpy(p + 8, &n, 8);
+  std::memcpy(p + 16, blocks_, block_count_ * sizeof(bloom_filter_block));
+}
+
+template <typename Key, typename Hash>
+bloom_filter<Key, Hash>
+bloom_filter<Key, Hash>::deserialize(const void *data, size_type len,
+                                     const hasher &hash) {
+  const unsigned char *p = static_cast<const unsigned char *>(data);
+  THROW_INVALID_ARGUMENT_IF(len < 16 || std::memcmp(p, magic, 8) != 0,
+                            "bloom_filter: bad serialized data");
+  std::uint64_t n;
+  std::memcpy(&n, p + 8, 8);
+  THROW_INVALID_ARGUMENT_IF(n == 0 || n > 4294967296ull ||
+                                (len - 16) / sizeof(bloom_filter_block) != n ||
+                                (len - 16) % sizeof(bloom_filter_block) != 0,
+                            "bloom_filter: bad serialized data");
+  bloom_filter f(static_cast<size_type>(n), hash, 0);
+  std::memcpy(static_cast<void *>(f.blocks_), p + 16,
+              f.block_count_ * sizeof(bloom_filter_block));
+  return f;
+}
+
+// 按 block_align 对齐，对齐前的偏移存在紧挨着的前一个字节中，
+// 块数组清零
+template <typename Key, typename Hash>
+bloom_filter_block *bloom_filter<Key, Hash>::allocate_blocks(size_type n) {
+  unsigned char *raw =
+      byte_allocator::allocate(n * sizeof(bloom_filter_block) + block_align);
+  const std::uintptr_t addr =
+      (reinterpret_cast<std::uintptr_t>(raw) + block_align) &
+      ~(block_align - 1);
+  unsigned char *p = reinterpret_cast<unsigned char *>(addr);
+  p[-1] = static_cast<unsigned char>(p - raw);
+  std::memset(p, 0, n * sizeof(bloom_filter_block));
+  return reinterpret_cast<bloom_filter_block *>(p);
+}
+
+template <typename Key, typename Hash>
+void bloom_filter<Key, Hash>::deallocate_blocks(bloom_filter_block *p) {
+  if (p != nullptr && p != bloom_filter_empty_block()) {
+    unsigned char *aligned = reinterpret_cast<unsigned char *>(p);
+    byte_allocator::deallocate(aligned - aligned[-1]);
+  }
+}
+
+template <typename Key, typename Hash>
+void swap(bloom_filter<Key, Hash> &lhs, bloom_filter<Key, Hash> &rhs) noexcept {
+  lhs.swap(rhs);
+}
+} // namespace tinystl
+
+#endif
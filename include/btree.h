@@ -0,0 +1,1214 @@
+#ifndef MYTINYSTL_BTREE_H_
+#define MYTINYSTL_BTREE_H_
+
+// B 树：一个节点连续存放多个元素，节点按缓存行大小取整，
+// 一次查找只访问 O(log_B n) 个节点，缓存缺失远少于每元素一个节点的 rb_tree，
+// 每个元素的额外内存也只有指针摊销后的几个字节。
+// 与 rb_tree 不同，任何插入、删除都会在节点间移动元素，使所有迭代器失效；
+// 元素类型的移动构造不应抛出异常。
+
+#include "allocator.h"
+#include "construct.h"
+#include "exceptdef.h"
+#include "functional.h"
+#include "iterator.h"
+#include "rb_tree.h"
+#include "type_traits.h"
+#include "util.h"
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace tinystl {
+// 叶子节点的目标大小（4 个 64 字节缓存行）
+static constexpr std::size_t btree_target_node_size = 256;
+
+template <typename T> struct btree_internal_node;
+
+template <typename T> struct btree_node {
+  typedef btree_node<T> *node_ptr;
+  typedef std::size_t size_type;
+  typedef typename std::aligned_storage<sizeof(T), alignof(T)>::type
+      storage_type;
+
+  // parent、position、count、leaf 共占两个指针宽度
+  static constexpr size_type header_size = 2 * sizeof(void *);
+  static constexpr size_type max_count =
+      (btree_target_node_size - header_size) / sizeof(T) < 3
+          ? 3
+          : (btree_target_node_size - header_size) / sizeof(T);
+  static constexpr size_type min_count = max_count / 2;
+  static_assert(max_count < 65535, "btree node position overflow");
+
+  node_ptr parent; // 根节点为 nullptr
+  unsigned short position; // 在父节点中的子节点下标
+  unsigned short count;
+  bool leaf;
+  storage_type slots[max_count];
+
+  template <typename S> S *slot(size_type i) {
+    return reinterpret_cast<S *>(&slots[i]);
+  }
+  T *value(size_type i) { return reinterpret_cast<T *>(&slots[i]); }
+  node_ptr &child(size_type i);
+};
+
+// 内部节点在叶子之后追加 max_count + 1 个子节点指针
+template <typename T> struct btree_internal_node : public btree_node<T> {
+  btree_node<T> *children[btree_node<T>::max_count + 1];
+};
+
+template <typename T>
+typename btree_node<T>::node_ptr &btree_node<T>::child(size_type i) {
+  MY_DEBUG(!leaf);
+  return static_cast<btree_internal_node<T> *>(this)->children[i];
+}
+
+template <typename T> struct btree_iterator;
+template <typename T> struct btree_const_iterator;
+
+// 迭代器以 (节点, 下标) 表示，end() 为 (最右叶子, count)
+template <typename T>
+struct btree_iterator_base : tinystl::iterator<bidirectional_iterator_tag, T> {
+  typedef btree_node<T> *node_ptr;
+  typedef std::size_t size_type;
+
+  node_ptr node;
+  size_type position;
+
+  btree_iterator_base() : node(nullptr), position(0) {}
+  void inc() {
+    if (!node->leaf) {
+      node = node->child(position + 1);
+      while (!node->leaf) {
+        node = node->child(0);
+      }
+      position = 0;
+      return;
+    }
+    if (++position < node->count) {
+      return;
+    }
+    // 叶子走完：回溯到第一个右侧还有分隔元素的祖先
+    node_ptr save = node;
+    while (position == node->count && node->parent != nullptr) {
+      position = node->position;
+      node = node->parent;
+    }
+    if (position == node->count) {
+      node = save; // 已是最后一个元素，停在 end()
+      position = save->count;
+    }
+  }
+  void dec() {
+    if (!node->leaf) {
+      node = node->child(position);
+      while (!node->leaf) {
+        node = node->child(node->count);
+      }
+      position = node->count - 1;
+      return;
+    }
+    if (position > 0) {
+      --position;
+      return;
+    }
+    while (position == 0 && node->parent != nullptr) {
+      position = node->position;
+      node = node->parent;
+    }
+    MY_DEBUG(position > 0); // begin() 不可再递减
+    --position;
+  }
+
+  bool operator==(const btree_iterator_base<T> &t) const {
+    return node == t.node && position == t.position;
+  }
+  bool operator!=(const btree_iterator_base<T> &t) const {
+    return !(*this == t);
+  }
+};
+
+template <typename T> struct btree_iterator : public btree_iterator_base<T> {
+  typedef btree_node<T> *node_ptr;
+  typedef std::size_t size_type;
+  typedef btree_iterator<T> self;
+  typedef T value_type;
+  typedef T &reference;
+  typedef T *pointer;
+
+  using btree_iterator_base<T>::node;
+  using btree_iterator_base<T>::position;
+
+  btree_iterator() {}
+  btree_iterator(node_ptr x, size_type i) {
+    node = x;
+    position = i;
+  }
+  btree_iterator(const btree_iterator &t) {
+    node = t.node;
+    position = t.position;
+  }
+  btree_iterator(const btree_const_iterator<T> &t) {
+    node = t.node;
+    position = t.position;
+  }
+
+  self &operator=(const btree_iterator &t) {
+    node = t.node;
+    position = t.position;
+    return *this;
+  }
+  self &operator++() {
+    this->inc();
+    return *this;
+  }
+  self operator++(int) {
+    self tmp = *this;
+    this->inc();
+    return tmp;
+  }
+  self &operator--() {
+    this->dec();
+    return *this;
+  }
+  self operator--(int) {
+    self tmp = *this;
+    this->dec();
+    return tmp;
+  }
+  reference operator*() const { return *node->value(position); }
+  pointer operator->() const { return &*(*this); }
+};
+
+template <typename T>
+struct btree_const_iterator : public btree_iterator_base<T> {
+  typedef btree_node<T> *node_ptr;
+  typedef std::size_t size_type;
+  typedef btree_const_iterator<T> self;
+  typedef T value_type;
+  typedef const T &reference;
+  typedef const T *pointer;
+  typedef const T &const_reference;
+  typedef const T *const_pointer;
+
+  using btree_iterator_base<T>::node;
+  using btree_iterator_base<T>::position;
+
+  btree_const_iterator() {}
+  btree_const_iterator(node_ptr x, size_type i) {
+    node = x;
+    position = i;
+  }
+  btree_const_iterator(const btree_iterator<T> &t) {
+    node = t.node;
+    position = t.position;
+  }
+  btree_const_iterator(const btree_const_iterator &t) {
+    node = t.node;
+    position = t.position;
+  }
+
+  self &operator=(const btree_const_iterator &t) {
+    node = t.node;
+    position = t.position;
+    return *this;
+  }
+  self &operator++() {
+    this->inc();
+    return *this;
+  }
+  self operator++(int) {
+    self tmp = *this;
+    this->inc();
+    return tmp;
+  }
+  self &operator--() {
+    this->dec();
+    return *this;
+  }
+  self operator--(int) {
+    self tmp = *this;
+    this->dec();
+    return tmp;
+  }
+  const_reference operator*() const { return *node->value(position); }
+  const_pointer operator->() const { return &*(*this); }
+};
+
+// 节点内查找：统计有序数组 keys[0, n) 中小于 k（或不大于 k）的元素个数，
+// 即 lower_bound（upper_bound）的下标。用于算术类型的键配合 tinystl::less：
+// 一个节点只有几十个键，无分支的顺序扫描比二分查找的分支预测失败更便宜
+template <typename Key>
+std::size_t btree_count_less(const Key *keys, std::size_t n, const Key &k) {
+  std::size_t c = 0;
+  for (std::size_t i = 0; i < n; ++i) {
+    c += keys[i] < k;
+  }
+  return c;
+}
+template <typename Key>
+std::size_t btree_count_less_equal(const Key *keys, std::size_t n,
+                                   const Key &k) {
+  std::size_t c = 0;
+  for (std::size_t i = 0; i < n; ++i) {
+    c += !(k < keys[i]);
+  }
+  return c;
+}
+
+#if defined(__SSE2__)
+// 32 位整数每次比较 4 个；无符号数先翻转符号位再按有符号比较。
+// 满足条件的元素是一段前缀，遇到第一组不全满足的即可停止
+template <bool Inclusive>
+std::size_t btree_simd_count(const void *keys, std::size_t n, int k,
+                             int bias) {
+  const __m128i b = _mm_set1_epi32(bias);
+  const __m128i kv = _mm_xor_si128(_mm_set1_epi32(k), b);
+  const __m128i *p = static_cast<const __m128i *>(keys);
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4, ++p) {
+    __m128i v = _mm_xor_si128(_mm_loadu_si128(p), b);
+    __m128i m = Inclusive ? _mm_cmpgt_epi32(v, kv) : _mm_cmplt_epi32(v, kv);
+    int bits = _mm_movemask_epi8(m);
+    if (Inclusive) {
+      bits = ~bits & 0xFFFF;
+    }
+    if (bits != 0xFFFF) {
+      return i + (bits & 1) + (bits >> 4 & 1) + (bits >> 8 & 1) +
+             (bits >> 12 & 1);
+    }
+  }
+  const int *q = static_cast<const int *>(keys);
+  for (; i < n; ++i) {
+    int x = q[i] ^ bias;
+    if (Inclusive ? x > (k ^ bias) : !(x < (k ^ bias))) {
+      break;
+    }
+  }
+  return i;
+}
+inline std::size_t btree_count_less(const int *keys, std::size_t n,
+                                    const int &k) {
+  return btree_simd_count<false>(keys, n, k, 0);
+}
+inline std::size_t btree_count_less_equal(const int *keys, std::size_t n,
+                                          const int &k) {
+  return btree_simd_count<true>(keys, n, k, 0);
+}
+inline std::size_t btree_count_less(const unsigned *keys, std::size_t n,
+                                    const unsigned &k) {
+  return btree_simd_count<false>(keys, n, static_cast<int>(k),
+                                 static_cast<int>(0x80000000u));
+}
+inline std::size_t btree_count_less_equal(const unsigned *keys,
+                                          std::size_t n,
+                                          const unsigned &k) {
+  return btree_simd_count<true>(keys, n, static_cast<int>(k),
+                                static_cast<int>(0x80000000u));
+}
+#endif
+
+template <typename T, typename Compare,
+          bool IsMap = tinystl::is_pair<T>::value>
+class btree {
+public:
+  typedef rb_tree_value_traits<T, IsMap> value_traits;
+  typedef btree_node<T> tree_node;
+  typedef btree_internal_node<T> internal_node;
+  typedef tree_node *node_ptr;
+
+  typedef tinystl::allocator<tree_node> leaf_allocator;
+  typedef tinystl::allocator<internal_node> internal_allocator;
+
+  typedef typename value_traits::key_type key_type;
+  typedef typename value_traits::mapped_type mapped_type;
+  typedef typename value_traits::value_type value_type;
+  typedef value_type *pointer;
+  typedef const value_type *const_pointer;
+  typedef value_type &reference;
+  typedef const value_type &const_reference;
+  typedef std::size_t size_type;
+  typedef std::ptrdiff_t difference_type;
+
+  typedef btree_iterator<T> iterator;
+  typedef btree_const_iterator<T> const_iterator;
+  typedef tinystl::reverse_iterator<iterator> reverse_iterator;
+  typedef tinystl::reverse_iterator<const_iterator> const_reverse_iterator;
+
+  typedef Compare key_compare;
+
+  static constexpr size_type max_count = tree_node::max_count;
+  static constexpr size_type min_count = tree_node::min_count;
+
+private:
+  // 节点内实际构造的类型：map 的键不带 const，在节点内移动元素时可以移动
+  // 而不是拷贝键；对外仍以 value_type（pair<const Key, T>）访问
+  typedef typename std::conditional<
+      IsMap, tinystl::pair<key_type, mapped_type>, value_type>::type
+      slot_type;
+  static_assert(sizeof(slot_type) == sizeof(value_type) &&
+                    alignof(slot_type) == alignof(value_type),
+                "btree slot layout mismatch");
+
+  // 算术类型的键配合 tinystl::less 时用顺序扫描，
+  // 元素即键（set）时键在节点内连续，可用 SIMD
+  typedef std::integral_constant<
+      bool, std::is_arithmetic<key_type>::value &&
+                std::is_same<Compare, tinystl::less<key_type>>::value>
+      linear_search;
+  typedef std::integral_constant<bool, linear_search::value && !IsMap>
+      contiguous_keys;
+
+  node_ptr root_;
+  node_ptr leftmost_;
+  node_ptr rightmost_;
+  size_type size_;
+  key_compare key_comp_;
+
+protected:
+  template <typename P>
+  static const key_type &key_of_value(const P &v, std::true_type) {
+    return v.first;
+  }
+  static const key_type &key_of_value(const slot_type &v, std::false_type) {
+    return v;
+  }
+  template <typename V> static const key_type &key_of_value(const V &v) {
+    return key_of_value(v, std::integral_constant<bool, IsMap>());
+  }
+  static const key_type &key_of(node_ptr x, size_type i) {
+    return value_traits::get_key(*x->value(i));
+  }
+
+  static node_ptr new_node(bool leaf, node_ptr parent);
+  static void delete_node(node_ptr x);
+  static void set_child(node_ptr x, size_type i, node_ptr c) {
+    x->child(i) = c;
+    c->parent = x;
+    c->position = static_cast<unsigned short>(i);
+  }
+  static void move_slot(node_ptr src, size_type i, node_ptr dst,
+                        size_type j) {
+    tinystl::construct(dst->template slot<slot_type>(j),
+                       std::move(*src->template slot<slot_type>(i)));
+    tinystl::destory(src->template slot<slot_type>(i));
+  }
+  static void shift_right(node_ptr x, size_type i, size_type n);
+  static void shift_left(node_ptr x, size_type i, size_type n);
+  void destroy_subtree(node_ptr x);
+  node_ptr clone_subtree(node_ptr x, node_ptr parent);
+  void reset_extremes();
+
+  size_type node_lower_bound(node_ptr x, const key_type &k) const {
+    return node_search<false>(x, k, linear_search(), contiguous_keys());
+  }
+  size_type node_upper_bound(node_ptr x, const key_type &k) const {
+    return node_search<true>(x, k, linear_search(), contiguous_keys());
+  }
+  template <bool Upper, typename Contiguous>
+  size_type node_search(node_ptr x, const key_type &k, std::false_type,
+                        Contiguous) const;
+  template <bool Upper>
+  size_type node_search(node_ptr x, const key_type &k, std::true_type,
+                        std::false_type) const;
+  template <bool Upper>
+  size_type node_search(node_ptr x, const key_type &k, std::true_type,
+                        std::true_type) const;
+
+  void split_node(node_ptr &x, size_type &pos);
+  template <typename V> void node_emplace(node_ptr x, size_type i, V &&v);
+  template <typename V> iterator insert_leaf(node_ptr x, size_type i, V &&v);
+  template <typename V> iterator insert_before(const_iterator pos, V &&v);
+  template <typename V>
+  tinystl::pair<iterator, bool> insert_value_unique(V &&v);
+  template <typename V>
+  iterator insert_hint_value_unique(const_iterator hint, V &&v);
+
+  void borrow_from_left(node_ptr x, size_type n);
+  void borrow_from_right(node_ptr x, size_type n);
+  void merge_nodes(node_ptr left, node_ptr right);
+  void rebalance_after_erase(node_ptr &x, size_type &pos);
+
+  template <typename InputIterator>
+  void build_sorted(InputIterator first, InputIterator last);
+
+public:
+  btree()
+      : root_(nullptr), leftmost_(nullptr), rightmost_(nullptr), size_(0),
+        key_comp_() {}
+  explicit btree(const key_compare &comp)
+      : root_(nullptr), leftmost_(nullptr), rightmost_(nullptr), size_(0),
+        key_comp_(comp) {}
+  // [first, last) 须已按键有序：逐个追加到最右叶子，不做比较查找，
+  // 叶子按偏向一侧的方式分裂，除最右一条路径外节点都是满的
+  template <typename InputIterator,
+            typename std::enable_if<
+                tinystl::has_input_iterator_cat<InputIterator>::value,
+                int>::type = 0>
+  btree(sorted_unique_t, InputIterator first, InputIterator last,
+        const key_compare &comp = key_compare())
+      : root_(nullptr), leftmost_(nullptr), rightmost_(nullptr), size_(0),
+        key_comp_(comp) {
+    try {
+      build_sorted(first, last);
+    } catch (...) {
+      clear();
+      throw;
+    }
+  }
+  btree(const btree &t);
+  btree(btree &&t) noexcept
+      : root_(t.root_), leftmost_(t.leftmost_), rightmost_(t.rightmost_),
+        size_(t.size_), key_comp_(t.key_comp_) {
+    t.root_ = t.leftmost_ = t.rightmost_ = nullptr;
+    t.size_ = 0;
+  }
+
+  btree &operator=(const btree &t);
+  btree &operator=(btree &&t) noexcept {
+    clear();
+    swap(t);
+    return *this;
+  }
+
+  ~btree() { clear(); }
+
+  template <typename InputIterator,
+            typename std::enable_if<
+                tinystl::has_input_iterator_cat<InputIterator>::value,
+                int>::type = 0>
+  void assign(sorted_unique_t, InputIterator first, InputIterator last) {
+    clear();
+    build_sorted(first, last);
+  }
+
+  iterator begin() noexcept { return iterator(leftmost_, 0); }
+  const_iterator begin() const noexcept { return const_iterator(leftmost_, 0); }
+  iterator end() noexcept {
+    return iterator(rightmost_, rightmost_ ? rightmost_->count : 0);
+  }
+  const_iterator end() const noexcept {
+    return const_iterator(rightmost_, rightmost_ ? rightmost_->count : 0);
+  }
+  reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+  const_reverse_iterator rbegin() const noexcept {
+    return const_reverse_iterator(end());
+  }
+  reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+  const_reverse_iterator rend() const noexcept {
+    return const_reverse_iterator(begin());
+  }
+  const_iterator cbegin() const noexcept { return begin(); }
+  const_iterator cend() const noexcept { return end(); }
+
+  bool empty() const noexcept { return size_ == 0; }
+  size_type size() const noexcept { return size_; }
+  size_type max_size() const noexcept {
+    return static_cast<size_type>(-1) / sizeof(value_type);
+  }
+  key_compare key_comp() const { return key_comp_; }
+
+  // 先构造出元素才能取得键；键已存在时该临时元素被丢弃
+  template <typename... Args>
+  tinystl::pair<iterator, bool> emplace_unique(Args &&...args) {
+    return insert_value_unique(slot_type(std::forward<Args>(args)...));
+  }
+  template <typename... Args>
+  iterator emplace_hint_unique(const_iterator hint, Args &&...args) {
+    return insert_hint_value_unique(hint,
+                                    slot_type(std::forward<Args>(args)...));
+  }
+
+  tinystl::pair<iterator, bool> insert_unique(const value_type &value) {
+    return insert_value_unique(value);
+  }
+  tinystl::pair<iterator, bool> insert_unique(value_type &&value) {
+    return insert_value_unique(std::move(value));
+  }
+  // hint 正确（紧邻插入位置之后）时不做查找
+  iterator insert_unique(const_iterator hint, const value_type &value) {
+    return insert_hint_value_unique(hint, value);
+  }
+  iterator insert_unique(const_iterator hint, value_type &&value) {
+    return insert_hint_value_unique(hint, std::move(value));
+  }
+  template <typename InputIterator,
+            typename std::enable_if<
+                tinystl::has_input_iterator_cat<InputIterator>::value,
+                int>::type = 0>
+  void insert_unique(InputIterator first, InputIterator last) {
+    for (; first != last; ++first) {
+      insert_unique(end(), *first);
+    }
+  }
+
+  // 返回被删元素的后继
+  iterator erase(const_iterator pos);
+  iterator erase(const_iterator first, const_iterator last);
+  size_type erase_unique(const key_type &k);
+  void clear();
+
+  iterator find(const key_type &k);
+  const_iterator find(const key_type &k) const;
+  size_type count_unique(const key_type &k) const {
+    return find(k) != end() ? 1 : 0;
+  }
+  iterator lower_bound(const key_type &k);
+  const_iterator lower_bound(const key_type &k) const;
+  iterator upper_bound(const key_type &k);
+  const_iterator upper_bound(const key_type &k) const;
+  tinystl::pair<iterator, iterator> equal_range_unique(const key_type &k) {
+    iterator it = lower_bound(k);
+    iterator next = it;
+    if (it != end() && !key_comp_(k, key_of(it.node, it.position))) {
+      ++next;
+    }
+    return tinystl::pair<iterator, iterator>(it, next);
+  }
+  tinystl::pair<const_iterator, const_iterator>
+  equal_range_unique(const key_type &k) const {
+    const_iterator it = lower_bound(k);
+    const_iterator next = it;
+    if (it != end() && !key_comp_(k, key_of(it.node, it.position))) {
+      ++next;
+    }
+    return tinystl::pair<const_iterator, const_iterator>(it, next);
+  }
+
+  void swap(btree &t) noexcept {
+    std::swap(root_, t.root_);
+    std::swap(leftmost_, t.leftmost_);
+    std::swap(rightmost_, t.rightmost_);
+    std::swap(size_, t.size_);
+    std::swap(key_comp_, t.key_comp_);
+  }
+};
+
+template <typename T, typename Compare, bool IsMap>
+typename btree<T, Compare, IsMap>::node_ptr
+btree<T, Compare, IsMap>::new_node(bool leaf, node_ptr parent) {
+  node_ptr x = leaf ? leaf_allocator::allocate(1)
+                    : static_cast<node_ptr>(internal_allocator::allocate(1));
+  x->parent = parent;
+  x->position = 0;
+  x->count = 0;
+  x->leaf = leaf;
+  return x;
+}
+template <typename T, typename Compare, bool IsMap>
+void btree<T, Compare, IsMap>::delete_node(node_ptr x) {
+  if (x->leaf) {
+    leaf_allocator::deallocate(x);
+  } else {
+    internal_allocator::deallocate(static_cast<internal_node *>(x));
+  }
+}
+
+// 将 x 中 [i, count) 右移 n 格，不修改 count
+template <typename T, typename Compare, bool IsMap>
+void btree<T, Compare, IsMap>::shift_right(node_ptr x, size_type i,
+                                           size_type n) {
+  for (size_type j = x->count; j > i; --j) {
+    move_slot(x, j - 1, x, j - 1 + n);
+  }
+  if (!x->leaf) {
+    for (size_type j = x->count + 1; j > i; --j) {
+      set_child(x, j - 1 + n, x->child(j - 1));
+    }
+  }
+}
+// 将 x 中 [i, count) 左移 n 格（子节点为 [i, count]），不修改 count
+template <typename T, typename Compare, bool IsMap>
+void btree<T, Compare, IsMap>::shift_left(node_ptr x, size_type i,
+                                          size_type n) {
+  for (size_type j = i; j < x->count; ++j) {
+    move_slot(x, j, x, j - n);
+  }
+  if (!x->leaf) {
+    for (size_type j = i; j <= x->count; ++j) {
+      set_child(x, j - n, x->child(j));
+    }
+  }
+}
+
+template <typename T, typename Compare, bool IsMap>
+void btree<T, Compare, IsMap>::destroy_subtree(node_ptr x) {
+  if (!x->leaf) {
+    for (size_type i = 0; i <= x->count; ++i) {
+      destroy_subtree(x->child(i));
+    }
+  }
+  for (size_type i = 0; i < x->count; ++i) {
+    tinystl::destory(x->template slot<slot_type>(i));
+  }
+  delete_node(x);
+}
+
+template <typename T, typename Compare, bool IsMap>
+typename btree<T, Compare, IsMap>::node_ptr
+btree<T, Compare, IsMap>::clone_subtree(node_ptr x, node_ptr parent) {
+  node_ptr y = new_node(x->leaf, parent);
+  if (!x->leaf) {
+    for (size_type i = 0; i <= x->count; ++i) {
+      y->child(i) = nullptr;
+    }
+  }
+  try {
+    for (; y->count < x->count; ++y->count) {
+      tinystl::construct(y->template slot<slot_type>(y->count),
+                         *x->template slot<slot_type>(y->count));
+    }
+    if (!x->leaf) {
+      for (size_type i = 0; i <= x->count; ++i) {
+        set_child(y, i, clone_subtree(x->child(i), y));
+      }
+    }
+  } catch (...) {
+    if (!y->leaf) {
+      for (size_type i = 0; i <= x->count && y->child(i) != nullptr; ++i) {
+        destroy_subtree(y->child(i));
+      }
+    }
+    for (size_type i = 0; i < y->count; ++i) {
+      tinystl::destory(y->template slot<slot_type>(i));
+    }
+    delete_node(y);
+    throw;
+  }
+  return y;
+}
+
+template <typename T, typename Compare, bool IsMap>
+void btree<T, Compare, IsMap>::reset_extremes() {
+  leftmost_ = rightmost_ = root_;
+  if (root_ == nullptr) {
+    return;
+  }
+  while (!leftmost_->leaf) {
+    leftmost_ = leftmost_->child(0);
+  }
+  while (!rightmost_->leaf) {
+    rightmost_ = rightmost_->child(rightmost_->count);
+  }
+}
+
+// 通用比较器：二分查找
+template <typename T, typename Compare, bool IsMap>
+template <bool Upper, typename Contiguous>
+typename btree<T, Compare, IsMap>::size_type
+btree<T, Compare, IsMap>::node_search(node_ptr x, const key_type &k,
+                                      std::false_type, Contiguous) const {
+  size_type lo = 0;
+  size_type hi = x->count;
+  while (lo < hi) {
+    size_type mid = (lo + hi) / 2;
+    bool go_right = Upper ? !key_comp_(k, key_of(x, mid))
+                          : key_comp_(key_of(x, mid), k);
+    if (go_right) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+// 算术键、键不连续（map）：无分支顺序计数
+template <typename T, typename Compare, bool IsMap>
+template <bool Upper>
+typename btree<T, Compare, IsMap>::size_type
+btree<T, Compare, IsMap>::node_search(node_ptr x, const key_type &k,
+                                      std::true_type, std::false_type) const {
+  size_type c = 0;
+  for (size_type i = 0; i < x->count; ++i) {
+    c += Upper ? !(k < key_of(x, i)) : key_of(x, i) < k;
+  }
+  return c;
+}
+// 算术键、键连续（set）：交给 btree_count_less，int/unsigned 走 SIMD
+template <typename T, typename Compare, bool IsMap>
+template <bool Upper>
+typename btree<T, Compare, IsMap>::size_type
+btree<T, Compare, IsMap>::node_search(node_ptr x, const key_type &k,
+                                      std::true_type, std::true_type) const {
+  const key_type *keys = x->value(0);
+  return Upper ? btree_count_less_equal(keys, x->count, k)
+               : btree_count_less(keys, x->count, k);
+}
+
+// x 已满、将在 pos 处插入：把 x 一分为二，中间元素上移到父节点
+// （父节点满则先递归分裂），完成后 x、pos 指向新的插入位置。
+// 在末尾或开头插入时偏向一侧分裂，使顺序插入留下的节点几乎是满的
+template <typename T, typename Compare, bool IsMap>
+void btree<T, Compare, IsMap>::split_node(node_ptr &x, size_type &pos) {
+  node_ptr parent = x->parent;
+  if (parent == nullptr) {
+    parent = new_node(false, nullptr);
+    set_child(parent, 0, x);
+    root_ = parent;
+  } else if (parent->count == max_count) {
+    size_type ppos = x->position;
+    split_node(parent, ppos);
+    parent = x->parent;
+  }
+  size_type keep = pos == max_count ? max_count - 1
+                   : pos == 0       ? 1
+                                    : max_count / 2;
+  node_ptr y = new_node(x->leaf, parent);
+  for (size_type i = keep + 1; i < max_count; ++i) {
+    move_slot(x, i, y, i - keep - 1);
+  }
+  if (!x->leaf) {
+    for (size_type i = keep + 1; i <= max_count; ++i) {
+      set_child(y, i - keep - 1, x->child(i));
+    }
+  }
+  y->count = static_cast<unsigned short>(max_count - keep - 1);
+  // 中间元素与 y 插入父节点的 x->position 处
+  size_type p = x->position;
+  shift_right(parent, p + 1, 1);
+  if (p < parent->count) {
+    move_slot(parent, p, parent, p + 1);
+  }
+  move_slot(x, keep, parent, p);
+  set_child(parent, p + 1, y);
+  ++parent->count;
+  x->count = static_cast<unsigned short>(keep);
+  if (rightmost_ == x) {
+    rightmost_ = y;
+  }
+  if (pos > keep) {
+    x = y;
+    pos -= keep + 1;
+  }
+}
+
+// 在 x 的 i 处构造元素，x 须有空位；构造失败时把移开的元素移回
+template <typename T, typename Compare, bool IsMap>
+template <typename V>
+void btree<T, Compare, IsMap>::node_emplace(node_ptr x, size_type i, V &&v) {
+  for (size_type j = x->count; j > i; --j) {
+    move_slot(x, j - 1, x, j);
+  }
+  try {
+    tinystl::construct(x->template slot<slot_type>(i), std::forward<V>(v));
+  } catch (...) {
+    for (size_type j = i; j < x->count; ++j) {
+      move_slot(x, j + 1, x, j);
+    }
+    throw;
+  }
+  ++x->count;
+}
+
+template <typename T, typename Compare, bool IsMap>
+template <typename V>
+typename btree<T, Compare, IsMap>::iterator
+btree<T, Compare, IsMap>::insert_leaf(node_ptr x, size_type i, V &&v) {
+  MY_DEBUG(x->leaf);
+  if (x->count == max_count) {
+    // 先构造出元素再分裂，构造失败时树保持不变
+    slot_type tmp(std::forward<V>(v));
+    split_node(x, i);
+    node_emplace(x, i, std::move(tmp));
+  } else {
+    node_emplace(x, i, std::forward<V>(v));
+  }
+  ++size_;
+  return iterator(x, i);
+}
+
+// 插在 pos 之前；pos 在内部节点时改为插在前驱所在叶子的末尾
+template <typename T, typename Compare, bool IsMap>
+template <typename V>
+typename btree<T, Compare, IsMap>::iterator
+btree<T, Compare, IsMap>::insert_before(const_iterator pos, V &&v) {
+  if (root_ == nullptr) {
+    root_ = leftmost_ = rightmost_ = new_node(true, nullptr);
+    return insert_leaf(root_, 0, std::forward<V>(v));
+  }
+  if (!pos.node->leaf) {
+    --pos;
+    ++pos.position;
+  }
+  return insert_leaf(pos.node, pos.position, std::forward<V>(v));
+}
+
+template <typename T, typename Compare, bool IsMap>
+template <typename V>
+tinystl::pair<typename btree<T, Compare, IsMap>::iterator, bool>
+btree<T, Compare, IsMap>::insert_value_unique(V &&v) {
+  const key_type &k = key_of_value(v);
+  if (root_ == nullptr) {
+    return tinystl::pair<iterator, bool>(
+        insert_before(end(), std::forward<V>(v)), true);
+  }
+  node_ptr x = root_;
+  while (true) {
+    size_type i = node_lower_bound(x, k);
+    if (i < x->count && !key_comp_(k, key_of(x, i))) {
+      return tinystl::pair<iterator, bool>(iterator(x, i), false);
+    }
+    if (x->leaf) {
+      return tinystl::pair<iterator, bool>(
+          insert_leaf(x, i, std::forward<V>(v)), true);
+    }
+    x = x->child(i);
+  }
+}
+
+template <typename T, typename Compare, bool IsMap>
+template <typename V>
+typename btree<T, Compare, IsMap>::iterator
+btree<T, Compare, IsMap>::insert_hint_value_unique(const_iterator hint,
+                                                   V &&v) {
+  const key_type &k = key_of_value(v);
+  if (hint == end()) {
+    if (size_ == 0 ||
+        key_comp_(key_of(rightmost_, rightmost_->count - 1), k)) {
+      return insert_before(hint, std::forward<V>(v));
+    }
+  } else if (key_comp_(k, key_of(hint.node, hint.position))) {
+    if (hint == begin()) {
+      return insert_before(hint, std::forward<V>(v));
+    }
+    const_iterator prev = hint;
+    --prev;
+    if (key_comp_(key_of(prev.node, prev.position), k)) {
+      return insert_before(hint, std::forward<V>(v));
+    }
+  } else if (!key_comp_(key_of(hint.node, hint.position), k)) {
+    return hint; // 等值元素已存在
+  }
+  return insert_value_unique(std::forward<V>(v)).first;
+}
+
+// 从左兄弟借 n 个元素：分隔元素下移到 x 开头，左兄弟的末尾元素上移
+template <typename T, typename Compare, bool IsMap>
+void btree<T, Compare, IsMap>::borrow_from_left(node_ptr x, size_type n) {
+  node_ptr parent = x->parent;
+  size_type p = x->position - 1;
+  node_ptr left = parent->child(p);
+  shift_right(x, 0, n);
+  move_slot(parent, p, x, n - 1);
+  for (size_type i = 1; i < n; ++i) {
+    move_slot(left, left->count - n + i, x, i - 1);
+  }
+  move_slot(left, left->count - n, parent, p);
+  if (!x->leaf) {
+    for (size_type i = 0; i < n; ++i) {
+      set_child(x, i, left->child(left->count - n + 1 + i));
+    }
+  }
+  left->count = static_cast<unsigned short>(left->count - n);
+  x->count = static_cast<unsigned short>(x->count + n);
+}
+// 从右兄弟借 n 个元素：分隔元素下移到 x 末尾，右兄弟的开头元素上移
+template <typename T, typename Compare, bool IsMap>
+void btree<T, Compare, IsMap>::borrow_from_right(node_ptr x, size_type n) {
+  node_ptr parent = x->parent;
+  size_type p = x->position;
+  node_ptr right = parent->child(p + 1);
+  move_slot(parent, p, x, x->count);
+  for (size_type i = 0; i + 1 < n; ++i) {
+    move_slot(right, i, x, x->count + 1 + i);
+  }
+  move_slot(right, n - 1, parent, p);
+  if (!x->leaf) {
+    for (size_type i = 0; i < n; ++i) {
+      set_child(x, x->count + 1 + i, right->child(i));
+    }
+  }
+  shift_left(right, n, n);
+  right->count = static_cast<unsigned short>(right->count - n);
+  x->count = static_cast<unsigned short>(x->count + n);
+}
+// 分隔元素与 right 全部并入 left，释放 right
+template <typename T, typename Compare, bool IsMap>
+void btree<T, Compare, IsMap>::merge_nodes(node_ptr left, node_ptr right) {
+  node_ptr parent = left->parent;
+  size_type p = left->position;
+  move_slot(parent, p, left, left->count);
+  for (size_type i = 0; i < right->count; ++i) {
+    move_slot(right, i, left, left->count + 1 + i);
+  }
+  if (!left->leaf) {
+    for (size_type i = 0; i <= right->count; ++i) {
+      set_child(left, left->count + 1 + i, right->child(i));
+    }
+  }
+  left->count = static_cast<unsigned short>(left->count + right->count + 1);
+  for (size_type j = p + 1; j < parent->count; ++j) {
+    move_slot(parent, j, parent, j - 1);
+  }
+  for (size_type j = p + 2; j <= parent->count; ++j) {
+    set_child(parent, j - 1, parent->child(j));
+  }
+  --parent->count;
+  if (rightmost_ == right) {
+    rightmost_ = left;
+  }
+  delete_node(right);
+}
+
+// 叶子 x 删除元素后不足半满时，优先向兄弟借元素，否则与兄弟合并，
+// 合并使父节点减少一个元素，可能逐层向上传递。
+// (x, pos) 为被删元素之后的位置，随元素移动一起更新
+template <typename T, typename Compare, bool IsMap>
+void btree<T, Compare, IsMap>::rebalance_after_erase(node_ptr &x,
+                                                     size_type &pos) {
+  node_ptr node = x;
+  while (node != root_ && node->count < min_count) {
+    node_ptr parent = node->parent;
+    size_type p = node->position;
+    node_ptr left = p > 0 ? parent->child(p - 1) : nullptr;
+    node_ptr right = p < parent->count ? parent->child(p + 1) : nullptr;
+    if (left != nullptr && left->count > min_count) {
+      size_type n = (left->count - node->count + 1) / 2;
+      borrow_from_left(node, n);
+      if (node == x) {
+        pos += n;
+      }
+      break;
+    }
+    if (right != nullptr && right->count > min_count) {
+      borrow_from_right(node, (right->count - node->count + 1) / 2);
+      break;
+    }
+    if (left != nullptr) {
+      if (node == x) {
+        x = left;
+        pos += left->count + 1;
+      }
+      merge_nodes(left, node);
+    } else {
+      merge_nodes(node, right);
+    }
+    node = parent;
+  }
+  if (root_->count == 0) {
+    node_ptr old = root_;
+    if (old->leaf) {
+      root_ = nullptr;
+      x = nullptr;
+      pos = 0;
+    } else {
+      root_ = old->child(0);
+      root_->parent = nullptr;
+      root_->position = 0;
+    }
+    delete_node(old);
+    reset_extremes();
+  }
+}
+
+template <typename T, typename Compare, bool IsMap>
+template <typename InputIterator>
+void btree<T, Compare, IsMap>::build_sorted(InputIterator first,
+                                            InputIterator last) {
+  for (; first != last; ++first) {
+    const value_type &v = *first;
+    if (size_ != 0 &&
+        !key_comp_(key_of(rightmost_, rightmost_->count - 1),
+                   key_of_value(v))) {
+      MY_DEBUG(!key_comp_(key_of_value(v),
+                          key_of(rightmost_, rightmost_->count - 1)));
+      continue;
+    }
+    insert_before(end(), v);
+  }
+}
+
+template <typename T, typename Compare, bool IsMap>
+btree<T, Compare, IsMap>::btree(const btree &t)
+    : root_(nullptr), leftmost_(nullptr), rightmost_(nullptr), size_(0),
+      key_comp_(t.key_comp_) {
+  if (t.root_ != nullptr) {
+    root_ = clone_subtree(t.root_, nullptr);
+    size_ = t.size_;
+    reset_extremes();
+  }
+}
+
+template <typename T, typename Compare, bool IsMap>
+btree<T, Compare, IsMap> &btree<T, Compare, IsMap>::operator=(const btree &t) {
+  if (this != &t) {
+    btree tmp(t);
+    swap(tmp);
+  }
+  return *this;
+}
+
+template <typename T, typename Compare, bool IsMap>
+typename btree<T, Compare, IsMap>::iterator
+btree<T, Compare, IsMap>::erase(const_iterator pos) {
+  MY_DEBUG(pos != end());
+  node_ptr x = pos.node;
+  size_type i = pos.position;
+  bool internal = !x->leaf;
+  if (internal) {
+    // 用前驱（左子树最大元素）顶替，转为删除叶子上的元素
+    node_ptr leaf = x->child(i);
+    while (!leaf->leaf) {
+      leaf = leaf->child(leaf->count);
+    }
+    tinystl::destory(x->template slot<slot_type>(i));
+    move_slot(leaf, leaf->count - 1, x, i);
+    --leaf->count;
+    x = leaf;
+    i = leaf->count;
+  } else {
+    tinystl::destory(x->template slot<slot_type>(i));
+    shift_left(x, i + 1, 1);
+    --x->count;
+  }
+  --size_;
+  rebalance_after_erase(x, i);
+  if (x == nullptr) {
+    return end();
+  }
+  // (x, i) 为被删元素之后的位置；原位于内部节点时，该位置是顶替上去的前驱
+  iterator res(x, i);
+  if (i == x->count) {
+    --res.position;
+    ++res;
+  }
+  if (internal) {
+    ++res;
+  }
+  return res;
+}
+
+template <typename T, typename Compare, bool IsMap>
+typename btree<T, Compare, IsMap>::iterator
+btree<T, Compare, IsMap>::erase(const_iterator first, const_iterator last) {
+  if (first == begin() && last == end()) {
+    clear();
+    return end();
+  }
+  size_type n = static_cast<size_type>(tinystl::distance(first, last));
+  iterator it = first;
+  for (; n > 0; --n) {
+    it = erase(it);
+  }
+  return it;
+}
+
+template <typename T, typename Compare, bool IsMap>
+typename btree<T, Compare, IsMap>::size_type
+btree<T, Compare, IsMap>::erase_unique(const key_type &k) {
+  iterator it = find(k);
+  if (it == end()) {
+    return 0;
+  }
+  erase(it);
+  return 1;
+}
+
+template <typename T, typename Compare, bool IsMap>
+void btree<T, Compare, IsMap>::clear() {
+  if (root_ != nullptr) {
+    destroy_subtree(root_);
+    root_ = leftmost_ = rightmost_ = nullptr;
+    size_ = 0;
+  }
+}
+
+template <typename T, typename Compare, bool IsMap>
+typename btree<T, Compare, IsMap>::iterator
+btree<T, Compare, IsMap>::find(const key_type &k) {
+  return static_cast<const btree &>(*this).find(k);
+}
+template <typename T, typename Compare, bool IsMap>
+typename btree<T, Compare, IsMap>::const_iterator
+btree<T, Compare, IsMap>::find(const key_type &k) const {
+  node_ptr x = root_;
+  while (x != nullptr) {
+    size_type i = node_lower_bound(x, k);
+    if (i < x->count && !key_comp_(k, key_of(x, i))) {
+      return const_iterator(x, i);
+    }
+    x = x->leaf ? nullptr : x->child(i);
+  }
+  return end();
+}
+
+// 沿途记录最后一个命中的位置：越深的候选越小
+template <typename T, typename Compare, bool IsMap>
+typename btree<T, Compare, IsMap>::iterator
+btree<T, Compare, IsMap>::lower_bound(const key_type &k) {
+  return static_cast<const btree &>(*this).lower_bound(k);
+}
+template <typename T, typename Compare, bool IsMap>
+typename btree<T, Compare, IsMap>::const_iterator
+btree<T, Compare, IsMap>::lower_bound(const key_type &k) const {
+  const_iterator res = end();
+  node_ptr x = root_;
+  while (x != nullptr) {
+    size_type i = node_lower_bound(x, k);
+    if (i < x->count) {
+      res = const_iterator(x, i);
+    }
+    x = x->leaf ? nullptr : x->child(i);
+  }
+  return res;
+}
+template <typename T, typename Compare, bool IsMap>
+typename btree<T, Compare, IsMap>::iterator
+btree<T, Compare, IsMap>::upper_bound(const key_type &k) {
+  return static_cast<const btree &>(*this).upper_bound(k);
+}
+template <typename T, typename Compare, bool IsMap>
+typename btree<T, Compare, IsMap>::const_iterator
+btree<T, Compare, IsMap>::upper_bound(const key_type &k) const {
+  const_iterator res = end();
+  node_ptr x = root_;
+  while (x != nullptr) {
+    size_type i = node_upper_bound(x, k);
+    if (i < x->count) {
+      res = const_iterator(x, i);
+    }
+    x = x->leaf ? nullptr : x->child(i);
+  }
+  return res;
+}
+
+template <typename T, typename Compare, bool IsMap>
+bool operator==(const btree<T, Compare, IsMap> &lhs,
+                const btree<T, Compare, IsMap> &rhs) {
+  if (lhs.size() != rhs.size()) {
+    return false;
+  }
+  for (auto i = lhs.begin(), j = rhs.begin(); i != lhs.end(); ++i, ++j) {
+    if (!(*i == *j)) {
+      return false;
+    }
+  }
+  return true;
+}
+template <typename T, typename Compare, bool IsMap>
+bool operator!=(const btree<T, Compare, IsMap> &lhs,
+                const btree<T, Compare, IsMap> &rhs) {
+  return !(lhs == rhs);
+}
+template <typename T, typename Compare, bool IsMap>
+bool operator<(const btree<T, Compare, IsMap> &lhs,
+               const btree<T, Compare, IsMap> &rhs) {
+  auto i = lhs.begin();
+  auto j = rhs.begin();
+  for (; i != lhs.end() && j != rhs.end(); ++i, ++j) {
+    if (*i < *j) {
+      return true;
+    }
+    if (*j < *i) {
+      return false;
+    }
+  }
+  return i == lhs.end() && j != rhs.end();
+}
+} // namespace tinystl
+
+#endif
@@ -0,0 +1,215 @@
+#ifndef MYTINYSTL_BTREE_MAP_H_
+#define MYTINYSTL_BTREE_MAP_H_
+
+// 接口与 map 相同，底层为 btree；插入、删除使所有迭代器失效，
+// 节点内连续存放元素，因此不提供节点句柄（extract、merge）
+
+#include "btree.h"
+#include "exceptdef.h"
+#include "functional.h"
+#include "util.h"
+#include <initializer_list>
+#include <type_traits>
+#include <utility>
+
+namespace tinystl {
+template <typename Key, typename T, typename Compare = tinystl::less<Key>>
+class btree_map {
+public:
+  typedef Key key_type;
+  typedef T mapped_type;
+  typedef tinystl::pair<const Key, T> value_type;
+  typedef Compare key_compare;
+
+  class value_compare : public binary_function<value_type, value_type, bool> {
+    friend class btree_map<Key, T, Compare>;
+
+  private:
+    Compare comp;
+    value_compare(Compare c) : comp(c) {}
+
+  public:
+    bool operator()(const value_type &lhs, const value_type &rhs) const {
+      return comp(lhs.first, rhs.first);
+    }
+  };
+
+private:
+  typedef tinystl::btree<value_type, key_compare, true> base_type;
+  base_type tree_;
+
+public:
+  typedef typename base_type::pointer pointer;
+  typedef typename base_type::const_pointer const_pointer;
+  typedef typename base_type::reference reference;
+  typedef typename base_type::const_reference const_reference;
+  typedef typename base_type::iterator iterator;
+  typedef typename base_type::const_iterator const_iterator;
+  typedef typename base_type::reverse_iterator reverse_iterator;
+  typedef typename base_type::const_reverse_iterator const_reverse_iterator;
+  typedef typename base_type::size_type size_type;
+  typedef typename base_type::difference_type difference_type;
+
+  btree_map() = default;
+  explicit btree_map(const key_compare &comp) : tree_(comp) {}
+  template <typename InputIterator,
+            typename std::enable_if<
+                tinystl::has_input_iterator_cat<InputIterator>::value,
+                int>::type = 0>
+  btree_map(InputIterator first, InputIterator last) {
+    tree_.insert_unique(first, last);
+  }
+  btree_map(std::initializer_list<value_type> l) {
+    tree_.insert_unique(l.begin(), l.end());
+  }
+  // [first, last) 须已按键有序，O(n) 建树
+  template <typename InputIterator,
+            typename std::enable_if<
+                tinystl::has_input_iterator_cat<InputIterator>::value,
+                int>::type = 0>
+  btree_map(sorted_unique_t, InputIterator first, InputIterator last,
+            const key_compare &comp = key_compare())
+      : tree_(sorted_unique, first, last, comp) {}
+  btree_map(const btree_map &m) : tree_(m.tree_) {}
+  btree_map(btree_map &&m) noexcept : tree_(std::move(m.tree_)) {}
+
+  btree_map &operator=(const btree_map &m) {
+    tree_ = m.tree_;
+    return *this;
+  }
+  btree_map &operator=(btree_map &&m) noexcept {
+    tree_ = std::move(m.tree_);
+    return *this;
+  }
+  btree_map &operator=(std::initializer_list<value_type> l) {
+    tree_.clear();
+    tree_.insert_unique(l.begin(), l.end());
+    return *this;
+  }
+
+  key_compare key_comp() const { return tree_.key_comp(); }
+  value_compare value_comp() const { return value_compare(tree_.key_comp()); }
+
+  iterator begin() noexcept { return tree_.begin(); }
+  const_iterator begin() const noexcept { return tree_.begin(); }
+  iterator end() noexcept { return tree_.end(); }
+  const_iterator end() const noexcept { return tree_.end(); }
+  reverse_iterator rbegin() noexcept { return tree_.rbegin(); }
+  const_reverse_iterator rbegin() const noexcept { return tree_.rbegin(); }
+  reverse_iterator rend() noexcept { return tree_.rend(); }
+  const_reverse_iterator rend() const noexcept { return tree_.rend(); }
+  const_iterator cbegin() const noexcept { return begin(); }
+  const_iterator cend() const noexcept { return end(); }
+
+  bool empty() const noexcept { return tree_.empty(); }
+  size_type size() const noexcept { return tree_.size(); }
+  size_type max_size() const noexcept { return tree_.max_size(); }
+
+  mapped_type &at(const key_type &key) {
+    iterator it = find(key);
+    THROW_OUT_OF_RANGE_IF(it == end(),
+                          "btree_map<Key, T> no such element exists");
+    return it->second;
+  }
+  const mapped_type &at(const key_type &key) const {
+    const_iterator it = find(key);
+    THROW_OUT_OF_RANGE_IF(it == end(),
+                          "btree_map<Key, T> no such element exists");
+    return it->second;
+  }
+  mapped_type &operator[](const key_type &key) {
+    iterator it = lower_bound(key);
+    if (it == end() || key_comp()(key, it->first)) {
+      it = tree_.emplace_hint_unique(it, key, T{});
+    }
+    return it->second;
+  }
+  mapped_type &operator[](key_type &&key) {
+    iterator it = lower_bound(key);
+    if (it == end() || key_comp()(key, it->first)) {
+      it = tree_.emplace_hint_unique(it, std::move(key), T{});
+    }
+    return it->second;
+  }
+
+  template <typename... Args>
+  tinystl::pair<iterator, bool> emplace(Args &&...args) {
+    return tree_.emplace_unique(std::forward<Args>(args)...);
+  }
+  template <typename... Args>
+  iterator emplace_hint(const_iterator hint, Args &&...args) {
+    return tree_.emplace_hint_unique(hint, std::forward<Args>(args)...);
+  }
+
+  tinystl::pair<iterator, bool> insert(const value_type &value) {
+    return tree_.insert_unique(value);
+  }
+  tinystl::pair<iterator, bool> insert(value_type &&value) {
+    return tree_.insert_unique(std::move(value));
+  }
+  iterator insert(const_iterator hint, const value_type &value) {
+    return tree_.insert_unique(hint, value);
+  }
+  iterator insert(const_iterator hint, value_type &&value) {
+    return tree_.insert_unique(hint, std::move(value));
+  }
+  template <typename InputIterator,
+            typename std::enable_if<
+                tinystl::has_input_iterator_cat<InputIterator>::value,
+                int>::type = 0>
+  void insert(InputIterator first, InputIterator last) {
+    tree_.insert_unique(first, last);
+  }
+  void insert(std::initializer_list<value_type> l) {
+    tree_.insert_unique(l.begin(), l.end());
+  }
+
+  iterator erase(const_iterator pos) { return tree_.erase(pos); }
+  iterator erase(const_iterator first, const_iterator last) {
+    return tree_.erase(first, last);
+  }
+  size_type erase(const key_type &key) { return tree_.erase_unique(key); }
+  void clear() { tree_.clear(); }
+
+  iterator find(const key_type &key) { return tree_.find(key); }
+  const_iterator find(const key_type &key) const { return tree_.find(key); }
+  size_type count(const key_type &key) const { return tree_.count_unique(key); }
+  iterator lower_bound(const key_type &key) { return tree_.lower_bound(key); }
+  const_iterator lower_bound(const key_type &key) const {
+    return tree_.lower_bound(key);
+  }
+  iterator upper_bound(const key_type &key) { return tree_.upper_bound(key); }
+  const_iterator upper_bound(const key_type &key) const {
+    return tree_.upper_bound(key);
+  }
+  tinystl::pair<iterator, iterator> equal_range(const key_type &key) {
+    return tree_.equal_range_unique(key);
+  }
+  tinystl::pair<const_iterator, const_iterator>
+  equal_range(const key_type &key) const {
+    return tree_.equal_range_unique(key);
+  }
+
+  void swap(btree_map &m) noexcept { tree_.swap(m.tree_); }
+
+  friend bool operator==(const btree_map &lhs, const btree_map &rhs) {
+    return lhs.tree_ == rhs.tree_;
+  }
+  friend bool operator<(const btree_map &lhs, const btree_map &rhs) {
+    return lhs.tree_ < rhs.tree_;
+  }
+};
+
+template <typename Key, typename T, typename Compare>
+bool operator!=(const btree_map<Key, T, Compare> &lhs,
+                const btree_map<Key, T, Compare> &rhs) {
+  return !(lhs == rhs);
+}
+template <typename Key, typename T, typename Compare>
+void swap(btree_map<Key, T, Compare> &lhs,
+          btree_map<Key, T, Compare> &rhs) noexcept {
+  lhs.swap(rhs);
+}
+} // namespace tinystl
+
+#endif
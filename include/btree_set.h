@@ -0,0 +1,166 @@
+#ifndef MYTINYSTL_BTREE_SET_H_
+#define MYTINYSTL_BTREE_SET_H_
+
+// 接口与 set 相同，底层为 btree；插入、删除使所有迭代器失效。
+// int、unsigned 键配合默认比较器时，节点内查找使用 SIMD
+
+#include "btree.h"
+#include "functional.h"
+#include "util.h"
+#include <initializer_list>
+#include <type_traits>
+#include <utility>
+
+namespace tinystl {
+template <typename Key, typename Compare = tinystl::less<Key>>
+class btree_set {
+public:
+  typedef Key key_type;
+  typedef Key value_type;
+  typedef Compare key_compare;
+  typedef Compare value_compare;
+
+private:
+  typedef tinystl::btree<value_type, key_compare, false> base_type;
+  base_type tree_;
+
+public:
+  typedef typename base_type::const_pointer pointer;
+  typedef typename base_type::const_pointer const_pointer;
+  typedef typename base_type::const_reference reference;
+  typedef typename base_type::const_reference const_reference;
+  typedef typename base_type::const_iterator iterator;
+  typedef typename base_type::const_iterator const_iterator;
+  typedef typename base_type::const_reverse_iterator reverse_iterator;
+  typedef typename base_type::const_reverse_iterator const_reverse_iterator;
+  typedef typename base_type::size_type size_type;
+  typedef typename base_type::difference_type difference_type;
+
+  btree_set() = default;
+  explicit btree_set(const key_compare &comp) : tree_(comp) {}
+  template <typename InputIterator,
+            typename std::enable_if<
+                tinystl::has_input_iterator_cat<InputIterator>::value,
+                int>::type = 0>
+  btree_set(InputIterator first, InputIterator last) {
+    tree_.insert_unique(first, last);
+  }
+  btree_set(std::initializer_list<value_type> l) {
+    tree_.insert_unique(l.begin(), l.end());
+  }
+  // [first, last) 须已按键有序，O(n) 建树
+  template <typename InputIterator,
+            typename std::enable_if<
+                tinystl::has_input_iterator_cat<InputIterator>::value,
+                int>::type = 0>
+  btree_set(sorted_unique_t, InputIterator first, InputIterator last,
+            const key_compare &comp = key_compare())
+      : tree_(sorted_unique, first, last, comp) {}
+  btree_set(const btree_set &s) : tree_(s.tree_) {}
+  btree_set(btree_set &&s) noexcept : tree_(std::move(s.tree_)) {}
+
+  btree_set &operator=(const btree_set &s) {
+    tree_ = s.tree_;
+    return *this;
+  }
+  btree_set &operator=(btree_set &&s) noexcept {
+    tree_ = std::move(s.tree_);
+    return *this;
+  }
+  btree_set &operator=(std::initializer_list<value_type> l) {
+    tree_.clear();
+    tree_.insert_unique(l.begin(), l.end());
+    return *this;
+  }
+
+  key_compare key_comp() const { return tree_.key_comp(); }
+  value_compare value_comp() const { return tree_.key_comp(); }
+
+  iterator begin() const noexcept { return tree_.begin(); }
+  iterator end() const noexcept { return tree_.end(); }
+  reverse_iterator rbegin() const noexcept { return tree_.rbegin(); }
+  reverse_iterator rend() const noexcept { return tree_.rend(); }
+  const_iterator cbegin() const noexcept { return begin(); }
+  const_iterator cend() const noexcept { return end(); }
+
+  bool empty() const noexcept { return tree_.empty(); }
+  size_type size() const noexcept { return tree_.size(); }
+  size_type max_size() const noexcept { return tree_.max_size(); }
+
+  template <typename... Args>
+  tinystl::pair<iterator, bool> emplace(Args &&...args) {
+    auto p = tree_.emplace_unique(std::forward<Args>(args)...);
+    return tinystl::pair<iterator, bool>(p.first, p.second);
+  }
+  template <typename... Args>
+  iterator emplace_hint(const_iterator hint, Args &&...args) {
+    return tree_.emplace_hint_unique(hint, std::forward<Args>(args)...);
+  }
+
+  tinystl::pair<iterator, bool> insert(const value_type &value) {
+    auto p = tree_.insert_unique(value);
+    return tinystl::pair<iterator, bool>(p.first, p.second);
+  }
+  tinystl::pair<iterator, bool> insert(value_type &&value) {
+    auto p = tree_.insert_unique(std::move(value));
+    return tinystl::pair<iterator, bool>(p.first, p.second);
+  }
+  iterator insert(const_iterator hint, const value_type &value) {
+    return tree_.insert_unique(hint, value);
+  }
+  iterator insert(const_iterator hint, value_type &&value) {
+    return tree_.insert_unique(hint, std::move(value));
+  }
+  template <typename InputIterator,
+            typename std::enable_if<
+                tinystl::has_input_iterator_cat<InputIterator>::value,
+                int>::type = 0>
+  void insert(InputIterator first, InputIterator last) {
+    tree_.insert_unique(first, last);
+  }
+  void insert(std::initializer_list<value_type> l) {
+    tree_.insert_unique(l.begin(), l.end());
+  }
+
+  iterator erase(const_iterator pos) { return tree_.erase(pos); }
+  iterator erase(const_iterator first, const_iterator last) {
+    return tree_.erase(first, last);
+  }
+  size_type erase(const key_type &key) { return tree_.erase_unique(key); }
+  void clear() { tree_.clear(); }
+
+  iterator find(const key_type &key) const { return tree_.find(key); }
+  size_type count(const key_type &key) const { return tree_.count_unique(key); }
+  iterator lower_bound(const key_type &key) const {
+    return tree_.lower_bound(key);
+  }
+  iterator upper_bound(const key_type &key) const {
+    return tree_.upper_bound(key);
+  }
+  tinystl::pair<iterator, iterator> equal_range(const key_type &key) const {
+    return tree_.equal_range_unique(key);
+  }
+
+  void swap(btree_set &s) noexcept { tree_.swap(s.tree_); }
+
+  friend bool operator==(const btree_set &lhs, const btree_set &rhs) {
+    return lhs.tree_ == rhs.tree_;
+  }
+  friend bool operator<(const btree_set &lhs, const btree_set &rhs) {
+    return lhs.tree_ < rhs.tree_;
+  }
+};
+
+template <typename Key, typename Compare>
+bool operator!=(const btree_set<Key, Compare> &lhs,
+                const btree_set<Key, Compare> &rhs) {
+  return !(lhs == rhs);
+}
+template <typename Key, typename Compare>
+void swap(btree_set<Key, Compare> &lhs,
+          btree_set<Key, Compare> &rhs) noexcept {
+  lhs.swap(rhs);
+}
+} // namespace tinystl
+
+#endif
@@ -0,0 +1,570 @@
+#ifndef MYTINYSTL_CONCURRENT_HASH_MAP_H_
+#define MYTINYSTL_CONCURRENT_HASH_MAP_H_
+
+// 分片的并发哈希表：键按哈希值的高位分到各分片，每个分片一把互斥锁、
+// 一张拉链法的桶表。写操作持有本分片的锁，读操作不加锁：
+// 节点发布后不再修改（update 复制出新节点再替换），被替换或删除的节点
+// 交给 epoch_domain 延迟释放，读者在 epoch_guard 内沿链表读取总是安全的。
+// 扩容按分片渐进进行：分片元素数超过桶数的一半时挂上一张两倍大的新表，
+// 之后本分片的每次写操作迁移若干个桶（先迁移自己要写的桶），
+// 迁移时把整条链复制到新表，再把旧桶置为 moved 标记；读者遇到该标记
+// 就转到新表查找。旧表迁移完毕后整体退休。
+// 读操作是线性一致的；size() 只作提示。
+// 元素通过拷贝迁移和更新，mapped_type 须可拷贝构造。
+
+#include "allocator.h"
+#include "construct.h"
+#include "epoch.h"
+#include "exceptdef.h"
+#include "functional.h"
+#include "hash.h"
+#include "util.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+namespace tinystl {
+template <typename Key, typename T, typename Hash = tinystl::hash<Key>,
+          typename KeyEqual = tinystl::equal_to<Key>>
+class concurrent_hash_map {
+public:
+  typedef Key key_type;
+  typedef T mapped_type;
+  typedef tinystl::pair<const Key, T> value_type;
+  typedef Hash hasher;
+  typedef KeyEqual key_equal;
+  typedef std::size_t size_type;
+
+private:
+  struct node {
+    std::atomic<node *> next;
+    std::uint64_t hash; // 混合后的哈希值，高位选分片，低位选桶
+    typename std::aligned_storage<sizeof(value_type),
+                                  alignof(value_type)>::type storage;
+
+    value_type *value() { return reinterpret_cast<value_type *>(&storage); }
+    const key_type &key() { return value()->first; }
+  };
+  struct table {
+    size_type mask; // 桶数减一
+    std::atomic<table *> next; // 迁移中的目标表
+    // 其后紧跟 mask + 1 个桶
+
+    std::atomic<node *> *buckets() {
+      return reinterpret_cast<std::atomic<node *> *>(this + 1);
+    }
+  };
+  // 各分片独占缓存行，避免不同分片的锁互相干扰
+  struct alignas(64) shard {
+    std::mutex lock;
+    std::atomic<table *> tab; // 最旧的一张表，读者从这里开始
+    std::atomic<size_type> size;
+    size_type cursor; // 下一个待迁移的旧桶
+  };
+  typedef tinystl::allocator<node> node_allocator;
+  typedef tinystl::allocator<char> byte_allocator;
+
+  static constexpr size_type min_buckets = 8;
+  // 每次写操作额外迁移的桶数
+  static constexpr size_type migrate_batch = 8;
+
+  static node moved_; // 已迁移桶的标记，只比较地址
+
+  shard *shards_;
+  size_type shard_count_;
+  unsigned shard_shift_; // 63 - log2(shard_count_)
+  hasher hash_;
+  key_equal equal_;
+
+public:
+  // shard_count 取不小于它的 2 的幂，为 0 时取硬件线程数的 4 倍
+  explicit concurrent_hash_map(size_type shard_count = 0,
+                               const hasher &hash = hasher(),
+                               const key_equal &equal = key_equal());
+  concurrent_hash_map(const concurrent_hash_map &) = delete;
+  concurrent_hash_map &operator=(const concurrent_hash_map &) = delete;
+  // 析构与其他操作不能并发
+  ~concurrent_hash_map();
+
+  // 仅作提示，并发修改时结果可能立即过期
+  size_type size() const noexcept;
+  bool empty() const noexcept { return size() == 0; }
+  size_type shard_count() const noexcept { return shard_count_; }
+  hasher hash_function() const { return hash_; }
+  key_equal key_eq() const { return equal_; }
+
+  // 以下读操作不加锁
+  bool contains(const key_type &k) const {
+    epoch_guard guard;
+    return lookup(k, hash_of(k)) != nullptr;
+  }
+  // 找到时把值拷贝到 out
+  bool find(const key_type &k, mapped_type &out) const {
+    epoch_guard guard;
+    node *p = lookup(k, hash_of(k));
+    if (p == nullptr) {
+      return false;
+    }
+    out = p->value()->second;
+    return true;
+  }
+  // 找到时在读临界区内调用 f(const value_type &)，适合只读取部分字段
+  template <typename F> bool visit(const key_type &k, F &&f) const {
+    epoch_guard guard;
+    node *p = lookup(k, hash_of(k));
+    if (p == nullptr) {
+      return false;
+    }
+    f(static_cast<const value_type &>(*p->value()));
+    return true;
+  }
+
+  // 以下写操作持有所在分片的锁
+  // 键已存在时不插入，返回 false
+  template <typename... Args> bool emplace(Args &&...args);
+  bool insert(const value_type &value) { return emplace(value); }
+  bool insert(value_type &&value) { return emplace(std::move(value)); }
+  // 键不存在时以 args 构造映射值插入；无论是否插入，都在锁内对该元素调用
+  // f(const value_type &)，返回是否插入
+  template <typename F, typename... Args>
+  bool find_or_emplace(const key_type &k, F &&f, Args &&...args);
+  // 键存在时在锁内对映射值的副本调用 f(mapped_type &)，再以副本替换原元素；
+  // f 抛出异常时原元素不变
+  template <typename F> bool update(const key_type &k, F &&f);
+  // 返回是否插入了新元素
+  template <typename M> bool insert_or_assign(const key_type &k, M &&obj);
+  bool erase(const key_type &k);
+  // 逐个分片清空，可与其他操作并发
+  void clear();
+
+private:
+  std::uint64_t hash_of(const key_type &k) const {
+    return static_cast<std::uint64_t>(hash_(k)) * 0x9E3779B97F4A7C15ull;
+  }
+  shard &shard_of(std::uint64_t h) const {
+    return shards_[h >> shard_shift_ >> 1];
+  }
+  static size_type bucket_of(std::uint64_t h, const table *t) {
+    return static_cast<size_type>(h ^ (h >> 32)) & t->mask;
+  }
+
+  template <typename... Args> static node *create_node(Args &&...args);
+  static void destory_node(node *p) {
+    tinystl::destory(p->value());
+    node_allocator::deallocate(p);
+  }
+  static void reclaim_node(void *p) { destory_node(static_cast<node *>(p)); }
+  static table *create_table(size_type buckets);
+  static void reclaim_table(void *p) {
+    byte_allocator::deallocate(static_cast<char *>(p));
+  }
+  static void retire(node *p) {
+    epoch_domain::instance().retire(p, &reclaim_node);
+  }
+
+  node *lookup(const key_type &k, std::uint64_t h) const;
+  // 以下须持有分片锁并处于读临界区内
+  std::atomic<node *> &write_bucket(shard &s, std::uint64_t h);
+  // 在链 head 中找 k，同时给出指向它的那个链接
+  node *find_in(std::atomic<node *> &head, const key_type &k,
+                std::uint64_t h, std::atomic<node *> *&link) const;
+  void link_new(shard &s, std::atomic<node *> &head, node *p);
+  void replace(std::atomic<node *> &link, node *old, node *p) {
+    p->next.store(old->next.load(std::memory_order_relaxed),
+                  std::memory_order_relaxed);
+    link.store(p, std::memory_order_release);
+    retire(old);
+  }
+  static void migrate_bucket(table *t, table *n, size_type i);
+  static void retire_chains(table *t);
+  static void destroy_chains(table *t);
+};
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+typename concurrent_hash_map<Key, T, Hash, KeyEqual>::node
+    concurrent_hash_map<Key, T, Hash, KeyEqual>::moved_;
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+concurrent_hash_map<Key, T, Hash, KeyEqual>::concurrent_hash_map(
+    size_type shard_count, const hasher &hash, const key_equal &equal)
+    : shards_(nullptr), shard_count_(1), shard_shift_(63), hash_(hash),
+      equal_(equal) {
+  if (shard_count == 0) {
+    shard_count =
+        4 * static_cast<size_type>(std::thread::hardware_concurrency());
+  }
+  while (shard_count_ < shard_count) {
+    shard_count_ *= 2;
+    --shard_shift_;
+  }
+  shards_ = new shard[shard_count_];
+  size_type i = 0;
+  try {
+    for (; i < shard_count_; ++i) {
+      shards_[i].tab.store(create_table(min_buckets),
+                           std::memory_order_relaxed);
+      shards_[i].size.store(0, std::memory_order_relaxed);
+      shards_[i].cursor = 0;
+    }
+  } catch (...) {
+    while (i-- != 0) {
+      reclaim_table(shards_[i].tab.load(std::memory_order_relaxed));
+    }
+    delete[] shards_;
+    throw;
+  }
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+concurrent_hash_map<Key, T, Hash, KeyEqual>::~concurrent_hash_map() {
+  for (size_type i = 0; i < shard_count_; ++i) {
+    table *t = shards_[i].tab.load(std::memory_order_acquire);
+    while (t != nullptr) {
+      table *next = t->next.load(std::memory_order_relaxed);
+      destroy_chains(t);
+      reclaim_table(t);
+      t = next;
+    }
+  }
+  delete[] shards_;
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+typename concurrent_hash_map<Key, T, Hash, KeyEqual>::size_type
+concurrent_hash_map<Key, T, Hash, KeyEqual>::size() const noexcept {
+  size_type n = 0;
+  for (size_type i = 0; i < shard_count_; ++i) {
+    n += shards_[i].size.load(std::memory_order_relaxed);
+  }
+  return n;
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+template <typename... Args>
+typename concurrent_hash_map<Key, T, Hash, KeyEqual>::node *
+concurrent_hash_map<Key, T, Hash, KeyEqual>::create_node(Args &&...args) {
+  node *p = node_allocator::allocate(1);
+  try {
+    tinystl::construct(p->value(), std::forward<Args>(args)...);
+  } catch (...) {
+    node_allocator::deallocate(p);
+    throw;
+  }
+  ::new (static_cast<void *>(&p->next)) std::atomic<node *>(nullptr);
+  return p;
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+typename concurrent_hash_map<Key, T, Hash, KeyEqual>::table *
+concurrent_hash_map<Key, T, Hash, KeyEqual>::create_table(size_type buckets) {
+  char *mem = byte_allocator::allocate(sizeof(table) +
+                                       buckets * sizeof(std::atomic<node *>));
+  table *t = reinterpret_cast<table *>(mem);
+  t->mask = buckets - 1;
+  ::new (static_cast<void *>(&t->next)) std::atomic<table *>(nullptr);
+  for (size_type i = 0; i < buckets; ++i) {
+    ::new (static_cast<void *>(t->buckets() + i)) std::atomic<node *>(nullptr);
+  }
+  return t;
+}
+
+// 桶被迁移后沿 next 转到新表；新表中的该桶在迁移完成前不会被写入，
+// 因此转过去时看到的是完整的链
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+typename concurrent_hash_map<Key, T, Hash, KeyEqual>::node *
+concurrent_hash_map<Key, T, Hash, KeyEqual>::lookup(const key_type &k,
+                                                    std::uint64_t h) const {
+  table *t = shard_of(h).tab.load(std::memory_order_acquire);
+  for (;;) {
+    node *p = t->buckets()[bucket_of(h, t)].load(std::memory_order_acquire);
+    if (p == &moved_) {
+      t = t->next.load(std::memory_order_acquire);
+      continue;
+    }
+    for (; p != nullptr; p = p->next.load(std::memory_order_acquire)) {
+      if (p->hash == h && equal_(p->key(), k)) {
+        return p;
+      }
+    }
+    return nullptr;
+  }
+}
+
+// 先把整条链复制成一条尚未发布的新链，复制中途抛出异常时旧桶不受影响；
+// 再把新链接到新表，最后标记旧桶并退休旧节点
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+void concurrent_hash_map<Key, T, Hash, KeyEqual>::migrate_bucket(table *t,
+                                                                 table *n,
+                                                                 size_type i) {
+  std::atomic<node *> &old_head = t->buckets()[i];
+  node *p = old_head.load(std::memory_order_relaxed);
+  if (p == &moved_) {
+    return;
+  }
+  // 桶数翻倍，旧桶 i 中的节点只会落到新表的 i 与 i + 旧桶数两个桶中
+  node *heads[2] = {nullptr, nullptr};
+  try {
+    for (node *q = p; q != nullptr;
+         q = q->next.load(std::memory_order_relaxed)) {
+      node *c = create_node(*q->value());
+      c->hash = q->hash;
+      int half = bucket_of(q->hash, n) == i ? 0 : 1;
+      c->next.store(heads[half], std::memory_order_relaxed);
+      heads[half] = c;
+    }
+  } catch (...) {
+    for (node *c : heads) {
+      while (c != nullptr) {
+        node *next = c->next.load(std::memory_order_relaxed);
+        destory_node(c);
+        c = next;
+      }
+    }
+    throw;
+  }
+  n->buckets()[i].store(heads[0], std::memory_order_release);
+  n->buckets()[i + t->mask + 1].store(heads[1], std::memory_order_release);
+  old_head.store(&moved_, std::memory_order_release);
+  while (p != nullptr) {
+    node *next = p->next.load(std::memory_order_relaxed);
+    retire(p);
+    p = next;
+  }
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+std::atomic<typename concurrent_hash_map<Key, T, Hash, KeyEqual>::node *> &
+concurrent_hash_map<Key, T, Hash, KeyEqual>::write_bucket(shard &s,
+                                                          std::uint64_t h) {
+  table *t = s.tab.load(std::memory_order_relaxed);
+  table *n = t->next.load(std::memory_order_relaxed);
+  if (n == nullptr) {
+    return t->buckets()[bucket_of(h, t)];
+  }
+  migrate_bucket(t, n, bucket_of(h, t));
+  // 迁移成功后才前移游标：migrate_bucket 抛出时该桶留待下次重试
+  for (size_type i = 0; i < migrate_batch && s.cursor <= t->mask; ++i) {
+    migrate_bucket(t, n, s.cursor);
+    ++s.cursor;
+  }
+  if (s.cursor > t->mask) {
+    s.tab.store(n, std::memory_order_release);
+    s.cursor = 0;
+    epoch_domain::instance().retire(t, &reclaim_table);
+  }
+  return n->buckets()[bucket_of(h, n)];
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+typename concurrent_hash_map<Key, T, Hash, KeyEqual>::node *
+concurrent_hash_map<Key, T, Hash, KeyEqual>::find_in(
+    std::atomic<node *> &head, const key_type &k, std::uint64_t h,
+    std::atomic<node *> *&link) const {
+  link = &head;
+  for (node *p = head.load(std::memory_order_relaxed); p != nullptr;
+       p = p->next.load(std::memory_order_relaxed)) {
+    if (p->hash == h && equal_(p->key(), k)) {
+      return p;
+    }
+    link = &p->next;
+  }
+  return nullptr;
+}
+
+// 插到链首后，若分片没有在迁移且负载因子超过 1/2，挂上两倍大的新表；
+// 读者每多走一个节点就多一次缓存缺失，因此负载因子取得较低；
+// 新表分配失败只是推迟扩容
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+void concurrent_hash_map<Key, T, Hash, KeyEqual>::link_new(
+    shard &s, std::atomic<node *> &head, node *p) {
+  p->next.store(head.load(std::memory_order_relaxed),
+                std::memory_order_relaxed);
+  head.store(p, std::memory_order_release);
+  size_type n = s.size.load(std::memory_order_relaxed) + 1;
+  s.size.store(n, std::memory_order_relaxed);
+  table *t = s.tab.load(std::memory_order_relaxed);
+  if (n > (t->mask + 1) / 2 &&
+      t->next.load(std::memory_order_relaxed) == nullptr) {
+    try {
+      t->next.store(create_table(2 * (t->mask + 1)), std::memory_order_release);
+    } catch (...) {
+    }
+  }
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+template <typename... Args>
+bool concurrent_hash_map<Key, T, Hash, KeyEqual>::emplace(Args &&...args) {
+  node *p = create_node(std::forward<Args>(args)...);
+  std::uint64_t h;
+  try {
+    h = hash_of(p->key());
+  } catch (...) {
+    destory_node(p);
+    throw;
+  }
+  p->hash = h;
+  shard &s = shard_of(h);
+  std::lock_guard<std::mutex> lock(s.lock);
+  epoch_guard guard;
+  std::atomic<node *> *head;
+  std::atomic<node *> *link;
+  try {
+    head = &write_bucket(s, h);
+  } catch (...) {
+    destory_node(p);
+    throw;
+  }
+  if (find_in(*head, p->key(), h, link) != nullptr) {
+    destory_node(p); // 尚未发布，直接释放
+    return false;
+  }
+  link_new(s, *head, p);
+  return true;
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+template <typename F, typename... Args>
+bool concurrent_hash_map<Key, T, Hash, KeyEqual>::find_or_emplace(
+    const key_type &k, F &&f, Args &&...args) {
+  std::uint64_t h = hash_of(k);
+  shard &s = shard_of(h);
+  std::lock_guard<std::mutex> lock(s.lock);
+  epoch_guard guard;
+  std::atomic<node *> &head = write_bucket(s, h);
+  std::atomic<node *> *link;
+  node *p = find_in(head, k, h, link);
+  if (p != nullptr) {
+    f(static_cast<const value_type &>(*p->value()));
+    return false;
+  }
+  p = create_node(k, mapped_type(std::forward<Args>(args)...));
+  p->hash = h;
+  link_new(s, head, p);
+  f(static_cast<const value_type &>(*p->value()));
+  return true;
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+template <typename F>
+bool concurrent_hash_map<Key, T, Hash, KeyEqual>::update(const key_type &k,
+                                                         F &&f) {
+  std::uint64_t h = hash_of(k);
+  shard &s = shard_of(h);
+  std::lock_guard<std::mutex> lock(s.lock);
+  epoch_guard guard;
+  std::atomic<node *> *link;
+  node *old = find_in(write_bucket(s, h), k, h, link);
+  if (old == nullptr) {
+    return false;
+  }
+  node *p = create_node(*old->value());
+  try {
+    f(p->value()->second);
+  } catch (...) {
+    destory_node(p);
+    throw;
+  }
+  p->hash = h;
+  replace(*link, old, p);
+  return true;
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+template <typename M>
+bool concurrent_hash_map<Key, T, Hash, KeyEqual>::insert_or_assign(
+    const key_type &k, M &&obj) {
+  std::uint64_t h = hash_of(k);
+  shard &s = shard_of(h);
+  std::lock_guard<std::mutex> lock(s.lock);
+  epoch_guard guard;
+  std::atomic<node *> &head = write_bucket(s, h);
+  std::atomic<node *> *link;
+  node *old = find_in(head, k, h, link);
+  node *p = create_node(k, std::forward<M>(obj));
+  p->hash = h;
+  if (old != nullptr) {
+    replace(*link, old, p);
+    return false;
+  }
+  link_new(s, head, p);
+  return true;
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+bool concurrent_hash_map<Key, T, Hash, KeyEqual>::erase(const key_type &k) {
+  std::uint64_t h = hash_of(k);
+  shard &s = shard_of(h);
+  std::lock_guard<std::mutex> lock(s.lock);
+  epoch_guard guard;
+  std::atomic<node *> *link;
+  node *p = find_in(write_bucket(s, h), k, h, link);
+  if (p == nullptr) {
+    return false;
+  }
+  link->store(p->next.load(std::memory_order_relaxed),
+              std::memory_order_release);
+  s.size.store(s.size.load(std::memory_order_relaxed) - 1,
+               std::memory_order_relaxed);
+  retire(p);
+  return true;
+}
+
+// 换上一张空表，旧表及其中尚未迁移的节点、迁移目标表一并退休
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+void concurrent_hash_map<Key, T, Hash, KeyEqual>::clear() {
+  for (size_type i = 0; i < shard_count_; ++i) {
+    shard &s = shards_[i];
+    table *fresh = create_table(min_buckets);
+    std::lock_guard<std::mutex> lock(s.lock);
+    epoch_guard guard;
+    table *t = s.tab.load(std::memory_order_relaxed);
+    s.tab.store(fresh, std::memory_order_release);
+    s.size.store(0, std::memory_order_relaxed);
+    s.cursor = 0;
+    while (t != nullptr) {
+      table *next = t->next.load(std::memory_order_relaxed);
+      retire_chains(t);
+      epoch_domain::instance().retire(t, &reclaim_table);
+      t = next;
+    }
+  }
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+void concurrent_hash_map<Key, T, Hash, KeyEqual>::retire_chains(table *t) {
+  for (size_type i = 0; i <= t->mask; ++i) {
+    node *p = t->buckets()[i].load(std::memory_order_relaxed);
+    if (p == &moved_) {
+      continue;
+    }
+    while (p != nullptr) {
+      node *next = p->next.load(std::memory_order_relaxed);
+      retire(p);
+      p = next;
+    }
+  }
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+void concurrent_hash_map<Key, T, Hash, KeyEqual>::destroy_chains(table *t) {
+  for (size_type i = 0; i <= t->mask; ++i) {
+    node *p = t->buckets()[i].load(std::memory_order_relaxed);
+    if (p == &moved_) {
+      continue;
+    }
+    while (p != nullptr) {
+      node *next = p->next.load(std::memory_order_relaxed);
+      destory_node(p);
+      p = next;
+    }
+  }
+}
+} // namespace tinystl
+
+#endif
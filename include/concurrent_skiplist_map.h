@@ -0,0 +1,454 @@
+#ifndef MYTINYSTL_CONCURRENT_SKIPLIST_MAP_H_
+#define MYTINYSTL_CONCURRENT_SKIPLIST_MAP_H_
+
+// 无锁有序映射（Fraser / Herlihy-Shavit 式跳表），可供多线程同时读写。
+// 每层后继指针的最低位是删除标记：erase 自顶向下标记各层，
+// 标记第 0 层成功的线程即为删除者，之后由查找路径上的任意线程
+// 用 CAS 把节点从各层摘除。insert 先链入第 0 层（线性化点），再逐层向上链接。
+// 摘除后的节点交给 epoch_domain 延迟释放，因此持有 epoch_guard 的读者
+// （包括迭代器）始终可以安全地访问节点，即使节点已被并发删除。
+// 迭代为弱一致的：保证看到迭代开始前就存在、且迭代期间未被删除的元素，
+// 并发插入的元素可能看到也可能看不到。
+// 元素插入后不可修改；迭代器只能在创建它的线程上使用，
+// 长时间持有会推迟所有线程的内存回收。
+
+#include "allocator.h"
+#include "construct.h"
+#include "epoch.h"
+#include "functional.h"
+#include "iterator.h"
+#include "util.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+namespace tinystl {
+template <typename Key, typename T, typename Compare = tinystl::less<Key>>
+class concurrent_skiplist_map {
+public:
+  typedef Key key_type;
+  typedef T mapped_type;
+  typedef tinystl::pair<const Key, T> value_type;
+  typedef Compare key_compare;
+  typedef std::size_t size_type;
+  typedef const value_type &const_reference;
+  typedef const value_type *const_pointer;
+
+  // 每层晋升概率 1/2，24 层足以支撑上千万个元素
+  static constexpr int max_level = 24;
+
+private:
+  typedef std::atomic<std::uintptr_t> link_type;
+
+  struct alignas(link_type) node {
+    typename std::aligned_storage<sizeof(value_type),
+                                  alignof(value_type)>::type storage;
+    // 插入方完成逐层链接、删除方完成摘除后各加一，后到者负责退休节点
+    std::atomic<int> handoff;
+    int level;
+    // 其后紧跟 level 个 link_type
+
+    value_type *value() { return reinterpret_cast<value_type *>(&storage); }
+    const key_type &key() { return value()->first; }
+    link_type *links() { return reinterpret_cast<link_type *>(this + 1); }
+  };
+  typedef tinystl::allocator<char> byte_allocator;
+
+  node *head_;
+  std::atomic<size_type> size_;
+  key_compare key_comp_;
+
+  static node *ptr_of(std::uintptr_t w) {
+    return reinterpret_cast<node *>(w & ~std::uintptr_t(1));
+  }
+  static bool is_marked(std::uintptr_t w) { return (w & 1) != 0; }
+  static std::uintptr_t word_of(node *p) {
+    return reinterpret_cast<std::uintptr_t>(p);
+  }
+
+  static node *allocate_node(int level);
+  static void deallocate_node(node *p);
+  template <typename... Args> static node *create_node(Args &&...args);
+  static void destory_node(node *p);
+  static void reclaim_node(void *p) { destory_node(static_cast<node *>(p)); }
+  static int random_level();
+
+  // 查找 k 在每层的前驱与后继，并摘除途经的已标记节点；
+  // CAS 失败时返回 false，调用者应重试
+  bool search(const key_type &k, node **preds, node **succs,
+              bool &found) const;
+  void search_for_update(const key_type &k, node **preds,
+                         node **succs) const {
+    bool found;
+    while (!search(k, preds, succs, found)) {
+    }
+  }
+  // 只读查找，跳过已标记节点而不摘除，返回第 0 层首个不小于 k 的节点
+  node *locate(const key_type &k) const;
+  static node *next_live(node *p);
+  void finish(node *p) {
+    if (p->handoff.fetch_add(1, std::memory_order_acq_rel) == 1) {
+      epoch_domain::instance().retire(p, &reclaim_node);
+    }
+  }
+  bool insert_node(node *n);
+
+public:
+  class const_iterator
+      : public tinystl::iterator<forward_iterator_tag, value_type> {
+    friend class concurrent_skiplist_map;
+
+    node *node_;
+    epoch_guard guard_; // 迭代器存活期间其指向的节点不会被释放
+
+    explicit const_iterator(node *p) : node_(p) {}
+
+  public:
+    typedef const value_type &reference;
+    typedef const value_type *pointer;
+
+    const_iterator() : node_(nullptr) {}
+
+    reference operator*() const { return *node_->value(); }
+    pointer operator->() const { return node_->value(); }
+    const_iterator &operator++() {
+      node_ = next_live(node_);
+      return *this;
+    }
+    const_iterator operator++(int) {
+      const_iterator tmp = *this;
+      ++*this;
+      return tmp;
+    }
+    bool operator==(const const_iterator &it) const {
+      return node_ == it.node_;
+    }
+    bool operator!=(const const_iterator &it) const {
+      return node_ != it.node_;
+    }
+  };
+  typedef const_iterator iterator;
+
+  concurrent_skiplist_map() : concurrent_skiplist_map(key_compare()) {}
+  explicit concurrent_skiplist_map(const key_compare &comp);
+  concurrent_skiplist_map(const concurrent_skiplist_map &) = delete;
+  concurrent_skiplist_map &
+  operator=(const concurrent_skiplist_map &) = delete;
+  // 析构与其他操作不能并发
+  ~concurrent_skiplist_map();
+
+  key_compare key_comp() const { return key_comp_; }
+
+  // 仅作提示，并发修改时结果可能立即过期
+  size_type size() const noexcept {
+    return size_.load(std::memory_order_relaxed);
+  }
+  bool empty() const noexcept { return size() == 0; }
+
+  const_iterator begin() const {
+    epoch_guard guard;
+    return const_iterator(next_live(head_));
+  }
+  const_iterator end() const { return const_iterator(nullptr); }
+
+  // 键已存在时不插入，返回 false
+  template <typename... Args> bool emplace(Args &&...args) {
+    return insert_node(create_node(std::forward<Args>(args)...));
+  }
+  bool insert(const value_type &value) { return emplace(value); }
+  bool insert(value_type &&value) { return emplace(std::move(value)); }
+
+  // 键不存在或被其他线程抢先删除时返回 false
+  bool erase(const key_type &k);
+  // 逐个删除当前元素，可与其他操作并发
+  void clear();
+
+  const_iterator find(const key_type &k) const;
+  const_iterator lower_bound(const key_type &k) const {
+    epoch_guard guard;
+    return const_iterator(locate(k));
+  }
+  bool contains(const key_type &k) const {
+    epoch_guard guard;
+    node *p = locate(k);
+    return p != nullptr && !key_comp_(k, p->key());
+  }
+  // 找到时把值拷贝到 out
+  bool find(const key_type &k, mapped_type &out) const;
+};
+
+template <typename Key, typename T, typename Compare>
+typename concurrent_skiplist_map<Key, T, Compare>::node *
+concurrent_skiplist_map<Key, T, Compare>::allocate_node(int level) {
+  char *mem =
+      byte_allocator::allocate(sizeof(node) + level * sizeof(link_type));
+  node *p = reinterpret_cast<node *>(mem);
+  ::new (static_cast<void *>(&p->handoff)) std::atomic<int>(0);
+  p->level = level;
+  for (int i = 0; i < level; ++i) {
+    ::new (static_cast<void *>(p->links() + i)) link_type(0);
+  }
+  return p;
+}
+
+template <typename Key, typename T, typename Compare>
+void concurrent_skiplist_map<Key, T, Compare>::deallocate_node(node *p) {
+  byte_allocator::deallocate(reinterpret_cast<char *>(p));
+}
+
+template <typename Key, typename T, typename Compare>
+template <typename... Args>
+typename concurrent_skiplist_map<Key, T, Compare>::node *
+concurrent_skiplist_map<Key, T, Compare>::create_node(Args &&...args) {
+  node *p = allocate_node(random_level());
+  try {
+    tinystl::construct(p->value(), std::forward<Args>(args)...);
+  } catch (...) {
+    deallocate_node(p);
+    throw;
+  }
+  return p;
+}
+
+template <typename Key, typename T, typename Compare>
+void concurrent_skiplist_map<Key, T, Compare>::destory_node(node *p) {
+  tinystl::destory(p->value());
+  deallocate_node(p);
+}
+
+template <typename Key, typename T, typename Compare>
+int concurrent_skiplist_map<Key, T, Compare>::random_level() {
+  // 每线程一个 xorshift 生成器，种子取自线程局部变量的地址
+  static thread_local std::uint32_t state = 0;
+  if (state == 0) {
+    state = static_cast<std::uint32_t>(
+                reinterpret_cast<std::uintptr_t>(&state) >> 4) |
+            1;
+  }
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+  int level = 1;
+  for (std::uint32_t r = state; (r & 1) != 0 && level < max_level; r >>= 1) {
+    ++level;
+  }
+  return level;
+}
+
+template <typename Key, typename T, typename Compare>
+concurrent_skiplist_map<Key, T, Compare>::concurrent_skiplist_map(
+    const key_compare &comp)
+    : head_(allocate_node(max_level)), size_(0), key_comp_(comp) {}
+
+template <typename Key, typename T, typename Compare>
+concurrent_skiplist_map<Key, T, Compare>::~concurrent_skiplist_map() {
+  node *p = ptr_of(head_->links()[0].load(std::memory_order_acquire));
+  while (p != nullptr) {
+    node *next = ptr_of(p->links()[0].load(std::memory_order_relaxed));
+    destory_node(p);
+    p = next;
+  }
+  deallocate_node(head_);
+}
+
+template <typename Key, typename T, typename Compare>
+bool concurrent_skiplist_map<Key, T, Compare>::search(const key_type &k,
+                                                      node **preds,
+                                                      node **succs,
+                                                      bool &found) const {
+  node *pred = head_;
+  node *curr = nullptr;
+  for (int i = max_level - 1; i >= 0; --i) {
+    curr = ptr_of(pred->links()[i].load(std::memory_order_acquire));
+    while (curr != nullptr) {
+      std::uintptr_t succ = curr->links()[i].load(std::memory_order_acquire);
+      if (is_marked(succ)) {
+        // curr 已被逻辑删除，把它从第 i 层摘除；pred 同时被删除时 CAS 失败
+        std::uintptr_t expected = word_of(curr);
+        if (!pred->links()[i].compare_exchange_strong(
+                expected, succ & ~std::uintptr_t(1),
+                std::memory_order_acq_rel, std::memory_order_acquire)) {
+          return false;
+        }
+        curr = ptr_of(succ);
+      } else if (key_comp_(curr->key(), k)) {
+        pred = curr;
+        curr = ptr_of(succ);
+      } else {
+        break;
+      }
+    }
+    preds[i] = pred;
+    succs[i] = curr;
+  }
+  found = curr != nullptr && !key_comp_(k, curr->key());
+  return true;
+}
+
+template <typename Key, typename T, typename Compare>
+typename concurrent_skiplist_map<Key, T, Compare>::node *
+concurrent_skiplist_map<Key, T, Compare>::locate(const key_type &k) const {
+  node *pred = head_;
+  node *curr = nullptr;
+  for (int i = max_level - 1; i >= 0; --i) {
+    curr = ptr_of(pred->links()[i].load(std::memory_order_acquire));
+    while (curr != nullptr) {
+      std::uintptr_t succ = curr->links()[i].load(std::memory_order_acquire);
+      if (!is_marked(succ) && key_comp_(curr->key(), k)) {
+        pred = curr;
+      } else if (!is_marked(succ)) {
+        break;
+      }
+      curr = ptr_of(succ);
+    }
+  }
+  return curr;
+}
+
+template <typename Key, typename T, typename Compare>
+typename concurrent_skiplist_map<Key, T, Compare>::node *
+concurrent_skiplist_map<Key, T, Compare>::next_live(node *p) {
+  node *curr = ptr_of(p->links()[0].load(std::memory_order_acquire));
+  while (curr != nullptr) {
+    std::uintptr_t succ = curr->links()[0].load(std::memory_order_acquire);
+    if (!is_marked(succ)) {
+      break;
+    }
+    curr = ptr_of(succ);
+  }
+  return curr;
+}
+
+template <typename Key, typename T, typename Compare>
+bool concurrent_skiplist_map<Key, T, Compare>::insert_node(node *n) {
+  node *preds[max_level];
+  node *succs[max_level];
+  epoch_guard guard;
+  const key_type &k = n->key();
+  for (;;) {
+    bool found;
+    while (!search(k, preds, succs, found)) {
+    }
+    if (found) {
+      destory_node(n); // 尚未发布，直接释放
+      return false;
+    }
+    for (int i = 0; i < n->level; ++i) {
+      n->links()[i].store(word_of(succs[i]), std::memory_order_relaxed);
+    }
+    std::uintptr_t expected = word_of(succs[0]);
+    if (preds[0]->links()[0].compare_exchange_strong(
+            expected, word_of(n), std::memory_order_release,
+            std::memory_order_relaxed)) {
+      break;
+    }
+  }
+  size_.fetch_add(1, std::memory_order_relaxed);
+  // 逐层向上链接；节点一旦被标记删除就不再继续
+  bool deleted = false;
+  for (int i = 1; i < n->level && !deleted; ++i) {
+    for (;;) {
+      std::uintptr_t w = n->links()[i].load(std::memory_order_acquire);
+      if (is_marked(w) ||
+          (ptr_of(w) != succs[i] &&
+           !n->links()[i].compare_exchange_strong(
+               w, word_of(succs[i]), std::memory_order_acq_rel,
+               std::memory_order_acquire))) {
+        deleted = true;
+        break;
+      }
+      std::uintptr_t expected = word_of(succs[i]);
+      if (preds[i]->links()[i].compare_exchange_strong(
+              expected, word_of(n), std::memory_order_release,
+              std::memory_order_relaxed)) {
+        break;
+      }
+      bool found;
+      while (!search(k, preds, succs, found)) {
+      }
+      if (succs[0] != n) {
+        deleted = true; // 已被删除并从第 0 层摘除
+        break;
+      }
+    }
+  }
+  // 删除可能发生在链接某层之前，此时再走一遍查找把该层也摘除
+  if (is_marked(n->links()[0].load(std::memory_order_acquire))) {
+    search_for_update(k, preds, succs);
+  }
+  finish(n);
+  return true;
+}
+
+template <typename Key, typename T, typename Compare>
+bool concurrent_skiplist_map<Key, T, Compare>::erase(const key_type &k) {
+  node *preds[max_level];
+  node *succs[max_level];
+  epoch_guard guard;
+  bool found;
+  while (!search(k, preds, succs, found)) {
+  }
+  if (!found) {
+    return false;
+  }
+  node *n = succs[0];
+  for (int i = n->level - 1; i >= 1; --i) {
+    std::uintptr_t w = n->links()[i].load(std::memory_order_relaxed);
+    while (!is_marked(w) &&
+           !n->links()[i].compare_exchange_weak(w, w | 1,
+                                                std::memory_order_acq_rel,
+                                                std::memory_order_relaxed)) {
+    }
+  }
+  std::uintptr_t w = n->links()[0].load(std::memory_order_relaxed);
+  for (;;) {
+    if (is_marked(w)) {
+      return false; // 其他线程先完成了删除
+    }
+    if (n->links()[0].compare_exchange_weak(w, w | 1,
+                                            std::memory_order_acq_rel,
+                                            std::memory_order_relaxed)) {
+      break;
+    }
+  }
+  size_.fetch_sub(1, std::memory_order_relaxed);
+  search_for_update(n->key(), preds, succs);
+  finish(n);
+  return true;
+}
+
+template <typename Key, typename T, typename Compare>
+void concurrent_skiplist_map<Key, T, Compare>::clear() {
+  epoch_guard guard;
+  for (node *p = next_live(head_); p != nullptr; p = next_live(p)) {
+    erase(p->key());
+  }
+}
+
+template <typename Key, typename T, typename Compare>
+typename concurrent_skiplist_map<Key, T, Compare>::const_iterator
+concurrent_skiplist_map<Key, T, Compare>::find(const key_type &k) const {
+  epoch_guard guard;
+  node *p = locate(k);
+  if (p == nullptr || key_comp_(k, p->key())) {
+    p = nullptr;
+  }
+  return const_iterator(p);
+}
+
+template <typename Key, typename T, typename Compare>
+bool concurrent_skiplist_map<Key, T, Compare>::find(const key_type &k,
+                                                    mapped_type &out) const {
+  epoch_guard guard;
+  node *p = locate(k);
+  if (p == nullptr || key_comp_(k, p->key())) {
+    return false;
+  }
+  out = p->value()->second;
+  return true;
+}
+} // namespace tinystl
+
+#endif
@@ -27,7 +27,7 @@ void destory_cat(ForwardIter first, ForwardIter last, std::true_type) {}
 template <typename ForwardIter>
 void destory_cat(ForwardIter first, ForwardIter last, std::false_type) {
   for (; first != last; ++first) {
-    destory_one(&(*first));
+    destory_one(&(*first), std::false_type{});
   }
 }
 
@@ -0,0 +1,424 @@
+#ifndef MYTINYSTL_CUCKOO_FILTER_H_
+#define MYTINYSTL_CUCKOO_FILTER_H_
+
+// 布谷鸟过滤器：只保存键的 16 位指纹，支持删除。
+// 每个桶 4 个槽，正好装进一个 64 位字，查找时按字同时比较 4 个指纹；
+// 桶数为 2 的幂。键的两个候选桶为 i1 与 i1 ^ g(指纹)，
+// 由任一候选桶和指纹即可算出另一个，搬动指纹时不需要原键。
+// 插入时两个桶都满则随机踢出一个指纹放到它的另一个桶，最多踢
+// max_kicks 次；仍失败时把最后被踢出的指纹放进唯一的 victim 槽，
+// 之后的插入都返回 false，直到有删除腾出位置。随机键下首次插入失败时
+// 装填率约为 96%～97%（1K 至 1M 个预计元素，最低约 95.7%）。
+// 误判率约为 2 * 4 / 2^16，约 0.012%。只应删除确实插入过的键，
+// 否则可能删掉另一个键的指纹；同一个键最多插入 8 次（两个桶的槽数）。
+// 序列化格式为 8 字节标识，桶数、元素数、victim 的桶号与指纹各 8 字节，
+// 之后是各桶的原始字节，按本机字节序存放。
+
+#include "allocator.h"
+#include "exceptdef.h"
+#include "hash.h"
+#include "iterator.h"
+#include "util.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+namespace tinystl {
+// 被移走的过滤器指向这个全零桶，查询与删除照常进行，插入前才换上自己的桶
+inline std::uint64_t *cuckoo_filter_empty_bucket() {
+  static std::uint64_t empty = 0;
+  return &empty;
+}
+
+template <typename Key, typename Hash = tinystl::hash<Key>>
+class cuckoo_filter {
+public:
+  typedef Key key_type;
+  typedef Hash hasher;
+  typedef std::size_t size_type;
+
+private:
+  typedef tinystl::allocator<std::uint64_t> bucket_allocator;
+  static constexpr size_type slots = 4;
+  static constexpr size_type max_kicks = 500;
+  static constexpr size_type bulk_batch = 16;
+  static constexpr std::uint64_t lanes = 0x0001000100010001ull;
+  static constexpr std::uint64_t high_bits = 0x8000800080008000ull;
+  static constexpr char magic[8] = {'T', 'S', 'T', 'L', 'C', 'K', 'F', '1'};
+
+  std::uint64_t *buckets_; // 每个桶 4 个 16 位指纹，0 表示空槽
+  size_type mask_;         // 桶数减一
+  size_type size_;
+  size_type victim_index_;
+  std::uint16_t victim_; // 0 表示 victim 槽为空
+  std::uint64_t rng_;    // 选择被踢出的槽
+  hasher hash_;
+
+public:
+  // 按预计元素数确定大小，装填率约 95% 以内插入基本不会失败
+  explicit cuckoo_filter(size_type expected_count,
+                         const hasher &hash = hasher())
+      : cuckoo_filter(bucket_count_for(expected_count), hash, 0) {}
+  cuckoo_filter(const cuckoo_filter &f);
+  cuckoo_filter(cuckoo_filter &&f) noexcept
+      : buckets_(f.buckets_), mask_(f.mask_), size_(f.size_),
+        victim_index_(f.victim_index_), victim_(f.victim_), rng_(f.rng_),
+        hash_(f.hash_) {
+    f.buckets_ = cuckoo_filter_empty_bucket();
+    f.mask_ = 0;
+    f.size_ = 0;
+    f.victim_ = 0;
+  }
+  ~cuckoo_filter() {
+    if (buckets_ != cuckoo_filter_empty_bucket()) {
+      bucket_allocator::deallocate(buckets_);
+    }
+  }
+
+  cuckoo_filter &operator=(const cuckoo_filter &f) {
+    if (this != &f) {
+      cuckoo_filter tmp(f);
+      swap(tmp);
+    }
+    return *this;
+  }
+  cuckoo_filter &operator=(cuckoo_filter &&f) noexcept {
+    cuckoo_filter tmp(std::move(f));
+    swap(tmp);
+    return *this;
+  }
+
+  // 过滤器已满时返回 false，此时过滤器不变
+  bool insert(const key_type &k) {
+    own_buckets();
+    return insert_hash(hash_of(k));
+  }
+  // 返回成功插入的个数，遇到第一次失败即停止
+  template <typename InputIterator,
+            typename std::enable_if<
+                tinystl::has_input_iterator_cat<InputIterator>::value,
+                int>::type = 0>
+  size_type insert(InputIterator first, InputIterator last);
+
+  // 返回 false 时键一定不在集合中
+  bool contains(const key_type &k) const { return contains_hash(hash_of(k)); }
+  // 依次把每个键的查询结果写入 out，返回写完后的 out
+  template <typename InputIterator, typename OutputIterator>
+  OutputIterator contains(InputIterator first, InputIterator last,
+                          OutputIterator out) const;
+
+  // 删除键的一个指纹，找不到时返回 false
+  bool erase(const key_type &k);
+  void clear() noexcept {
+    if (buckets_ != cuckoo_filter_empty_bucket()) {
+      std::memset(buckets_, 0, bucket_count() * sizeof(std::uint64_t));
+    }
+    size_ = 0;
+    victim_ = 0;
+  }
+
+  size_type size() const noexcept { return size_; }
+  bool empty() const noexcept { return size_ == 0; }
+  size_type bucket_count() const noexcept { return mask_ + 1; }
+  size_type capacity() const noexcept { return bucket_count() * slots; }
+  double load_factor() const noexcept {
+    return static_cast<double>(size_) / capacity();
+  }
+  hasher hash_function() const { return hash_; }
+
+  size_type serialized_size() const noexcept {
+    return 40 + bucket_count() * sizeof(std::uint64_t);
+  }
+  // out 须至少有 serialized_size() 字节
+  void serialize(void *out) const;
+  static cuckoo_filter deserialize(const void *data, size_type len,
+                                   const hasher &hash = hasher());
+
+  void swap(cuckoo_filter &f) noexcept {
+    std::swap(buckets_, f.buckets_);
+    std::swap(mask_, f.mask_);
+    std::swap(size_, f.size_);
+    std::swap(victim_index_, f.victim_index_);
+    std::swap(victim_, f.victim_);
+    std::swap(rng_, f.rng_);
+    std::swap(hash_, f.hash_);
+  }
+
+private:
+  cuckoo_filter(size_type bucket_count, const hasher &hash, int)
+      : buckets_(allocate_buckets(bucket_count)), mask_(bucket_count - 1),
+        size_(0), victim_index_(0), victim_(0), rng_(hash_secret()[0]),
+        hash_(hash) {}
+
+  static size_type bucket_count_for(size_type expected_count) {
+    size_type n = 1;
+    while (n * slots * 95 / 100 < expected_count) {
+      n <<= 1;
+    }
+    return n;
+  }
+
+  std::uint64_t hash_of(const key_type &k) const {
+    return mix(hash_(k), hash_is_avalanching<hasher>());
+  }
+  static std::uint64_t mix(std::uint64_t h, std::true_type) { return h; }
+  static std::uint64_t mix(std::uint64_t h, std::false_type) {
+    return hash_mix(h);
+  }
+
+  // 低 16 位为指纹，其上的位选桶
+  static std::uint16_t fingerprint(std::uint64_t h) {
+    std::uint16_t fp = static_cast<std::uint16_t>(h);
+    return fp == 0 ? 1 : fp;
+  }
+  size_type index_of(std::uint64_t h) const {
+    return static_cast<size_type>(h >> 16) & mask_;
+  }
+  size_type alt_index(size_type i, std::uint16_t fp) const {
+    return (i ^ static_cast<size_type>(hash_mix(fp))) & mask_;
+  }
+
+  // 桶中与 fp 相等的槽，每个槽对应结果中的最高位
+  static std::uint64_t match(std::uint64_t bucket, std::uint16_t fp) {
+    std::uint64_t x = bucket ^ (lanes * fp);
+    return (x - lanes) & ~x & high_bits;
+  }
+  // m 非零，只有各槽的最高位可能为 1
+  static int lowest_slot(std::uint64_t m) {
+#if defined(__GNUC__)
+    return __builtin_ctzll(m) >> 4;
+#else
+    int i = 0;
+    for (; (m & 0x8000) == 0; m >>= 16) {
+      ++i;
+    }
+    return i;
+#endif
+  }
+  bool bucket_has(size_type i, std::uint16_t fp) const {
+    return match(buckets_[i], fp) != 0;
+  }
+  bool try_put(size_type i, std::uint16_t fp);
+  bool try_remove(size_type i, std::uint16_t fp);
+  void insert_fingerprint(size_type i, std::uint16_t fp);
+  std::uint64_t next_random() {
+    rng_ ^= rng_ << 13;
+    rng_ ^= rng_ >> 7;
+    rng_ ^= rng_ << 17;
+    return rng_;
+  }
+
+  void own_buckets() {
+    if (buckets_ == cuckoo_filter_empty_bucket()) {
+      buckets_ = allocate_buckets(1);
+    }
+  }
+  bool insert_hash(std::uint64_t h);
+  bool contains_hash(std::uint64_t h) const;
+
+  static std::uint64_t *allocate_buckets(size_type n) {
+    std::uint64_t *p = bucket_allocator::allocate(n);
+    std::memset(p, 0, n * sizeof(std::uint64_t));
+    return p;
+  }
+};
+
+template <typename Key, typename Hash>
+constexpr char cuckoo_filter<Key, Hash>::magic[8];
+
+template <typename Key, typename Hash>
+cuckoo_filter<Key, Hash>::cuckoo_filter(const cuckoo_filter &f)
+    : cuckoo_filter(f.bucket_count(), f.hash_, 0) {
+  std::memcpy(buckets_, f.buckets_, bucket_count() * sizeof(std::uint64_t));
+  size_ = f.size_;
+  victim_index_ = f.victim_index_;
+  victim_ = f.victim_;
+  rng_ = f.rng_;
+}
+
+template <typename Key, typename Hash>
+template <typename InputIterator,
+          typename std::enable_if<
+              tinystl::has_input_iterator_cat<InputIterator>::value, int>::type>
+typename cuckoo_filter<Key, Hash>::size_type
+cuckoo_filter<Key, Hash>::insert(InputIterator first, InputIterator last) {
+  std::uint64_t h[bulk_batch];
+  size_type inserted = 0;
+  own_buckets();
+  while (first != last) {
+    size_type n = 0;
+    for (; n < bulk_batch && first != last; ++n, ++first) {
+      h[n] = hash_of(*first);
+#if defined(__GNUC__)
+      __builtin_prefetch(buckets_ + index_of(h[n]), 1);
+#endif
+    }
+    for (size_type i = 0; i < n; ++i, ++inserted) {
+      if (!insert_hash(h[i])) {
+        return inserted;
+      }
+    }
+  }
+  return inserted;
+}
+
+template <typename Key, typename Hash>
+template <typename InputIterator, typename OutputIterator>
+OutputIterator cuckoo_filter<Key, Hash>::contains(InputIterator first,
+                                                  InputIterator last,
+                                                  OutputIterator out) const {
+  std::uint64_t h[bulk_batch];
+  while (first != last) {
+    size_type n = 0;
+    for (; n < bulk_batch && first != last; ++n, ++first) {
+      h[n] = hash_of(*first);
+#if defined(__GNUC__)
+      const size_type i = index_of(h[n]);
+      __builtin_prefetch(buckets_ + i);
+      __builtin_prefetch(buckets_ + alt_index(i, fingerprint(h[n])));
+#endif
+    }
+    for (size_type i = 0; i < n; ++i, ++out) {
+      *out = contains_hash(h[i]);
+    }
+  }
+  return out;
+}
+
+template <typename Key, typename Hash>
+bool cuckoo_filter<Key, Hash>::erase(const key_type &k) {
+  const std::uint64_t h = hash_of(k);
+  const std::uint16_t fp = fingerprint(h);
+  const size_type i1 = index_of(h);
+  const size_type i2 = alt_index(i1, fp);
+  if (try_remove(i1, fp) || try_remove(i2, fp)) {
+    --size_;
+    // 腾出了位置，把 victim 放回表中
+    if (victim_ != 0) {
+      std::uint16_t v = victim_;
+      victim_ = 0;
+      --size_;
+      insert_fingerprint(victim_index_, v);
+    }
+    return true;
+  }
+  if (victim_ != 0 && victim_ == fp &&
+      (victim_index_ == i1 || victim_index_ == i2)) {
+    victim_ = 0;
+    --size_;
+    return true;
+  }
+  return false;
+}
+
+template <typename Key, typename Hash>
+bool cuckoo_filter<Key, Hash>::try_put(size_type i, std::uint16_t fp) {
+  const std::uint64_t empty = match(buckets_[i], 0);
+  if (empty == 0) {
+    return false;
+  }
+  buckets_[i] |= static_cast<std::uint64_t>(fp) << (lowest_slot(empty) * 16);
+  return true;
+}
+
+template <typename Key, typename Hash>
+bool cuckoo_filter<Key, Hash>::try_remove(size_type i, std::uint16_t fp) {
+  const std::uint64_t m = match(buckets_[i], fp);
+  if (m == 0) {
+    return false;
+  }
+  buckets_[i] &= ~(std::uint64_t(0xFFFF) << (lowest_slot(m) * 16));
+  return true;
+}
+
+template <typename Key, typename Hash>
+bool cuckoo_filter<Key, Hash>::insert_hash(std::uint64_t h) {
+  if (victim_ != 0) {
+    return false;
+  }
+  const std::uint16_t fp = fingerprint(h);
+  insert_fingerprint(index_of(h), fp);
+  return true;
+}
+
+// 先试两个候选桶，都满时随机踢出指纹；踢满 max_kicks 次后
+// 手上的指纹进入 victim 槽
+template <typename Key, typename Hash>
+void cuckoo_filter<Key, Hash>::insert_fingerprint(size_type i,
+                                                  std::uint16_t fp) {
+  ++size_;
+  if (try_put(i, fp)) {
+    return;
+  }
+  i = alt_index(i, fp);
+  if (try_put(i, fp)) {
+    return;
+  }
+  for (size_type kick = 0; kick < max_kicks; ++kick) {
+    const int shift = static_cast<int>(next_random() & (slots - 1)) * 16;
+    const std::uint16_t out =
+        static_cast<std::uint16_t>(buckets_[i] >> shift);
+    buckets_[i] ^= static_cast<std::uint64_t>(out ^ fp) << shift;
+    fp = out;
+    i = alt_index(i, fp);
+    if (try_put(i, fp)) {
+      return;
+    }
+  }
+  victim_index_ = i;
+  victim_ = fp;
+}
+
+template <typename Key, typename Hash>
+bool cuckoo_filter<Key, Hash>::contains_hash(std::uint64_t h) const {
+  const std::uint16_t fp = fingerprint(h);
+  const size_type i1 = index_of(h);
+  const size_type i2 = alt_index(i1, fp);
+  return bucket_has(i1, fp) || bucket_has(i2, fp) ||
+         (victim_ == fp && (victim_index_ == i1 || victim_index_ == i2));
+}
+
+template <typename Key, typename Hash>
+void cuckoo_filter<Key, Hash>::serialize(void *out) const {
+  unsigned char *p = static_cast<unsigned char *>(out);
+  const std::uint64_t header[4] = {bucket_count(), size_, victim_index_,
+                                   victim_};
+  std::memcpy(p, magic, 8);
+  std::memcpy(p + 8, header, sizeof(header));
+  std::memcpy(p + 40, buckets_, bucket_count() * sizeof(std::uint64_t));
+}
+
+template <typename Key, typename Hash>
+cuckoo_filter<Key, Hash>
+cuckoo_filter<Key, Hash>::deserialize(const void *data, size_type len,
+                                      const hasher &hash) {
+  const unsigned char *p = static_cast<const unsigned char *>(data);
+  THROW_INVALID_ARGUMENT_IF(len < 40 || std::memcmp(p, magic, 8) != 0,
+                            "cuckoo_filter: bad serialized data");
+  std::uint64_t header[4];
+  std::memcpy(header, p + 8, sizeof(header));
+  const std::uint64_t n = header[0];
+  THROW_INVALID_ARGUMENT_IF(n == 0 || (n & (n - 1)) != 0 ||
+                                (len - 40) / sizeof(std::uint64_t) != n ||
+                                (len - 40) % sizeof(std::uint64_t) != 0 ||
+                                header[2] >= n || header[3] > 0xFFFF ||
+                                header[1] > n * slots + (header[3] != 0),
+                            "cuckoo_filter: bad serialized data");
+  cuckoo_filter f(static_cast<size_type>(n), hash, 0);
+  std::memcpy(f.buckets_, p + 40, n * sizeof(std::uint64_t));
+  f.size_ = static_cast<size_type>(header[1]);
+  f.victim_index_ = static_cast<size_type>(header[2]);
+  f.victim_ = static_cast<std::uint16_t>(header[3]);
+  return f;
+}
+
+template <typename Key, typename Hash>
+void swap(cuckoo_filter<Key, Hash> &lhs,
+          cuckoo_filter<Key, Hash> &rhs) noexcept {
+  lhs.swap(rhs);
+}
+} // namespace tinystl
+
+#endif
@@ -2,7 +2,9 @@
 #define MYTINYSTL_DEQUE_H_
 
 #include "allocator.h"
+#include "exceptdef.h"
 #include "iterator.h"
+#include <algorithm>
 #include <memory>
 #include <iostream>
 
@@ -222,6 +224,7 @@ namespace tinystl
     void require_buffer(size_type, bool);
     void reallocate_map_at_front(size_type);
     void reallocate_map_at_end(size_type);
+    void shift_map_nodes(map_pointer);
     void clear();
     iterator fill_insert(iterator &, size_type, const value_type &);
     template <typename InputIterator>
@@ -334,6 +337,27 @@ namespace tinystl
     iterator erase(iterator);
     iterator erase(iterator, iterator);
 
+    reference front()
+    {
+      MY_DEBUG(!empty());
+      return *begin_;
+    }
+    const_reference front() const
+    {
+      MY_DEBUG(!empty());
+      return *begin_.cur;
+    }
+    reference back()
+    {
+      MY_DEBUG(!empty());
+      return *(end_ - 1);
+    }
+    const_reference back() const
+    {
+      MY_DEBUG(!empty());
+      return *(end_ - 1).cur;
+    }
+
     //查询
     bool empty() const noexcept { return begin_ == end_; }
     size_type size() const noexcept { return static_cast<size_type>(end_ - begin_); }
@@ -493,22 +517,53 @@ namespace tinystl
     }
   }
   template <typename T>
+  void deque<T>::shift_map_nodes(map_pointer new_start)
+  {
+    // 在原 map 内平移已使用的节点指针，并将腾出的槽位置空；缓冲区本身不移动
+    const size_type old_node = end_.node - begin_.node + 1;
+    map_pointer old_start = begin_.node;
+    map_pointer old_finish = end_.node + 1;
+    if (new_start < old_start)
+    {
+      std::copy(old_start, old_finish, new_start);
+      std::fill(std::max(new_start + old_node, old_start), old_finish, nullptr);
+    }
+    else if (new_start > old_start)
+    {
+      std::copy_backward(old_start, old_finish, new_start + old_node);
+      std::fill(old_start, std::min(new_start, old_finish), nullptr);
+    }
+    begin_.set_node(new_start);
+    end_.set_node(new_start + old_node - 1);
+  }
+  template <typename T>
   void deque<T>::reallocate_map_at_front(size_type need_node)
   {
-    const size_type new_map_size = std::max(map_size * 2, map_size + need_node + DEQUE_INIT_MAP_SIZE_);
     const size_type old_node = end_.node - begin_.node + 1;
     const size_type new_node = need_node + old_node;
+    if (map_size > 2 * new_node)
+    {
+      // map 另一端空闲足够（如 push_front/pop_back 滑动窗口），居中平移即可
+      map_pointer new_begin = map_ + (map_size - new_node) / 2;
+      shift_map_nodes(new_begin + need_node);
+      create_buffer(new_begin, begin_.node - 1);
+      return;
+    }
+    const size_type new_map_size = std::max(map_size * 2, map_size + need_node + DEQUE_INIT_MAP_SIZE_);
     map_pointer new_map = create_map(new_map_size);
     map_pointer new_begin = new_map + (new_map_size - new_node) / 2;
     map_pointer mid = new_begin + need_node;
     map_pointer new_end = mid + old_node;
-    create_buffer(new_begin, mid - 1);
-    for (auto begin1 = begin_.node, begin2 = mid; begin1 <= end_.node; ++begin1, ++begin2)
+    try
     {
-      *begin2 = *begin1;
+      create_buffer(new_begin, mid - 1);
     }
-    begin_.cur = *mid + (begin_.cur - begin_.first);
-    end_.cur = *(new_end - 1) + (end_.cur - end_.first);
+    catch (...)
+    {
+      map_allocator::deallocate(new_map);
+      throw;
+    }
+    std::copy(begin_.node, end_.node + 1, mid);
     map_allocator::deallocate(map_);
     begin_.set_node(mid);
     end_.set_node(new_end - 1);
@@ -518,21 +573,33 @@ namespace tinystl
   template <typename T>
   void deque<T>::reallocate_map_at_end(size_type need_node)
   {
-    const size_type new_map_size = std::max(map_size * 2, map_size + need_node + DEQUE_INIT_MAP_SIZE_);
     const size_type old_node = end_.node - begin_.node + 1;
     const size_type new_node = need_node + old_node;
+    if (map_size > 2 * new_node)
+    {
+      // map 另一端空闲足够（如 push_back/pop_front 滑动窗口），居中平移即可
+      shift_map_nodes(map_ + (map_size - new_node) / 2);
+      create_buffer(end_.node + 1, end_.node + need_node);
+      return;
+    }
+    const size_type new_map_size = std::max(map_size * 2, map_size + need_node + DEQUE_INIT_MAP_SIZE_);
     map_pointer new_map = create_map(new_map_size);
     map_pointer new_begin = new_map + (new_map_size - new_node) / 2;
     map_pointer mid = new_begin + old_node;
     map_pointer new_end = mid + need_node;
-    for (auto begin1 = map_, begin2 = new_begin; begin1 <= end_.node; ++begin1, ++begin2)
+    try
     {
-      *begin2 = *begin1;
+      create_buffer(mid, new_end - 1);
+    }
+    catch (...)
+    {
+      map_allocator::deallocate(new_map);
+      throw;
     }
-    create_buffer(mid, new_end - 1);
-    begin_ = iterator(*new_begin + (begin_.cur - begin_.first), new_begin);
-    end_ = iterator(*(mid - 1) + (end_.cur - end_.first), mid - 1);
+    std::copy(begin_.node, end_.node + 1, new_begin);
     map_allocator::deallocate(map_);
+    begin_.set_node(new_begin);
+    end_.set_node(mid - 1);
     map_ = new_map;
     map_size = new_map_size;
   }
@@ -0,0 +1,208 @@
+#ifndef MYTINYSTL_EPOCH_H_
+#define MYTINYSTL_EPOCH_H_
+
+// 基于纪元的内存回收（epoch-based reclamation），供无锁容器延迟释放
+// 已摘除的节点。
+// 访问共享节点前用 epoch_guard 进入临界区，并公布当时的全局纪元；
+// 被摘除的节点交给 retire()，记入当前纪元的待回收表。
+// 只有当所有处于临界区的线程都已看到当前纪元时，全局纪元才能前进，
+// 因此某纪元退休的对象在全局纪元再前进两次后不会再被任何线程引用，
+// 此时即可安全释放。
+// 整个进程共用一个 epoch_domain，每个线程首次使用时领取一条记录，
+// 线程退出时归还，记录中尚未释放的对象由下一个领取者接手。
+
+#include "allocator.h"
+#include "construct.h"
+#include "exceptdef.h"
+#include "vector.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace tinystl {
+class epoch_domain {
+public:
+  typedef void (*deleter_type)(void *);
+
+  static epoch_domain &instance() {
+    static epoch_domain domain;
+    return domain;
+  }
+
+  epoch_domain(const epoch_domain &) = delete;
+  epoch_domain &operator=(const epoch_domain &) = delete;
+  ~epoch_domain();
+
+  // 可嵌套，只有最外层的 enter / exit 才会公布状态
+  void enter();
+  void exit();
+  // 须在临界区内调用；p 在至少两次纪元前进后由 del(p) 释放
+  void retire(void *p, deleter_type del);
+
+private:
+  struct retired {
+    void *ptr;
+    deleter_type del;
+  };
+  struct record {
+    std::atomic<std::uint64_t> state; // (纪元 << 1) | 是否在临界区内
+    std::atomic<bool> in_use;
+    record *next;
+    // 以下只由持有记录的线程访问
+    unsigned nest;
+    std::uint64_t local_epoch;
+    std::size_t retire_count;
+    std::uint64_t limbo_epoch[3];
+    tinystl::vector<retired> limbo[3]; // 按纪元 % 3 分组的待回收对象
+  };
+  struct thread_handle {
+    record *rec = nullptr;
+    ~thread_handle() {
+      if (rec != nullptr) {
+        epoch_domain::instance().release_record(rec);
+      }
+    }
+  };
+
+  // 每退休这么多个对象尝试推进一次全局纪元
+  static constexpr std::size_t advance_interval = 64;
+
+  std::atomic<std::uint64_t> epoch_;
+  std::atomic<record *> records_;
+
+  epoch_domain() : epoch_(0), records_(nullptr) {}
+
+  record *local_record() {
+    static thread_local thread_handle handle;
+    if (handle.rec == nullptr) {
+      handle.rec = acquire_record();
+    }
+    return handle.rec;
+  }
+  record *acquire_record();
+  void release_record(record *rec);
+  bool try_advance();
+  static void free_bucket(record *rec, int i);
+  static void reclaim(record *rec, std::uint64_t epoch);
+};
+
+inline epoch_domain::~epoch_domain() {
+  record *rec = records_.load(std::memory_order_acquire);
+  while (rec != nullptr) {
+    record *next = rec->next;
+    for (int i = 0; i < 3; ++i) {
+      free_bucket(rec, i);
+    }
+    tinystl::destory(rec);
+    tinystl::allocator<record>::deallocate(rec);
+    rec = next;
+  }
+}
+
+inline epoch_domain::record *epoch_domain::acquire_record() {
+  for (record *rec = records_.load(std::memory_order_acquire); rec != nullptr;
+       rec = rec->next) {
+    bool expected = false;
+    if (!rec->in_use.load(std::memory_order_relaxed) &&
+        rec->in_use.compare_exchange_strong(expected, true,
+                                            std::memory_order_acquire)) {
+      return rec;
+    }
+  }
+  record *rec = tinystl::allocator<record>::allocate(1);
+  tinystl::construct(rec); // 值初始化，各计数与纪元均为 0
+  rec->in_use.store(true, std::memory_order_relaxed);
+  record *head = records_.load(std::memory_order_relaxed);
+  do {
+    rec->next = head;
+  } while (!records_.compare_exchange_weak(head, rec,
+                                           std::memory_order_release,
+                                           std::memory_order_relaxed));
+  return rec;
+}
+
+inline void epoch_domain::release_record(record *rec) {
+  rec->nest = 0;
+  rec->state.store(0, std::memory_order_release);
+  try_advance();
+  reclaim(rec, epoch_.load(std::memory_order_acquire));
+  rec->in_use.store(false, std::memory_order_release);
+}
+
+inline void epoch_domain::enter() {
+  record *rec = local_record();
+  if (rec->nest++ != 0) {
+    return;
+  }
+  std::uint64_t e = epoch_.load(std::memory_order_acquire);
+  // seq_cst 保证公布在后续读取共享指针之前对 try_advance 可见
+  rec->state.store(e << 1 | 1, std::memory_order_seq_cst);
+  if (e != rec->local_epoch) {
+    rec->local_epoch = e;
+    reclaim(rec, e);
+  }
+}
+
+inline void epoch_domain::exit() {
+  record *rec = local_record();
+  if (--rec->nest == 0) {
+    rec->state.store(0, std::memory_order_release);
+  }
+}
+
+inline void epoch_domain::retire(void *p, deleter_type del) {
+  record *rec = local_record();
+  MY_DEBUG(rec->nest != 0);
+  // 按退休时的全局纪元而非本线程进入时的纪元归档：
+  // 此时仍可能持有 p 的读者，公布的纪元都不小于 e - 1
+  std::uint64_t e = epoch_.load(std::memory_order_seq_cst);
+  int i = static_cast<int>(e % 3);
+  if (rec->limbo_epoch[i] != e) {
+    // 同一桶中的旧对象至少早三个纪元，已可释放
+    free_bucket(rec, i);
+    rec->limbo_epoch[i] = e;
+  }
+  rec->limbo[i].push_back(retired{p, del});
+  if (++rec->retire_count % advance_interval == 0) {
+    try_advance();
+  }
+}
+
+inline bool epoch_domain::try_advance() {
+  std::uint64_t e = epoch_.load(std::memory_order_seq_cst);
+  for (record *rec = records_.load(std::memory_order_acquire); rec != nullptr;
+       rec = rec->next) {
+    std::uint64_t s = rec->state.load(std::memory_order_seq_cst);
+    if ((s & 1) != 0 && (s >> 1) != e) {
+      return false;
+    }
+  }
+  return epoch_.compare_exchange_strong(e, e + 1, std::memory_order_acq_rel);
+}
+
+inline void epoch_domain::free_bucket(record *rec, int i) {
+  for (auto &r : rec->limbo[i]) {
+    r.del(r.ptr);
+  }
+  rec->limbo[i].clear();
+}
+
+inline void epoch_domain::reclaim(record *rec, std::uint64_t epoch) {
+  for (int i = 0; i < 3; ++i) {
+    if (!rec->limbo[i].empty() && rec->limbo_epoch[i] + 2 <= epoch) {
+      free_bucket(rec, i);
+    }
+  }
+}
+
+// RAII 临界区，可拷贝（拷贝即再嵌套一层），只能在创建它的线程上使用
+class epoch_guard {
+public:
+  epoch_guard() { epoch_domain::instance().enter(); }
+  epoch_guard(const epoch_guard &) { epoch_domain::instance().enter(); }
+  epoch_guard &operator=(const epoch_guard &) { return *this; }
+  ~epoch_guard() { epoch_domain::instance().exit(); }
+};
+} // namespace tinystl
+
+#endif
@@ -7,6 +7,8 @@ namespace tinystl {
 #define MY_DEBUG(EXPR) assert(EXPR)
 
 #define THROW_OUT_OF_RANGE_IF(expr,what) if(expr) throw std::out_of_range(what)
+
+#define THROW_INVALID_ARGUMENT_IF(expr,what) if(expr) throw std::invalid_argument(what)
 } // namespace tinystl
 
 #endif
\ No newline at end of file
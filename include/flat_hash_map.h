@@ -0,0 +1,231 @@
+#ifndef MYTINYSTL_FLAT_HASH_MAP_H_
+#define MYTINYSTL_FLAT_HASH_MAP_H_
+
+// 接口与 unordered_map 相近，底层为开放寻址的 flat_hash_table：
+// 元素直接存放在表中，插入可能使所有迭代器和引用失效，
+// 因此没有桶接口和节点句柄；删除不影响其他元素的迭代器
+
+#include "exceptdef.h"
+#include "flat_hash_table.h"
+#include "functional.h"
+#include "hash.h"
+#include "util.h"
+#include <functional>
+#include <initializer_list>
+#include <type_traits>
+#include <utility>
+
+namespace tinystl {
+template <typename Key, typename T, typename Hash = tinystl::hash<Key>,
+          typename KeyEqual = tinystl::equal_to<Key>>
+class flat_hash_map {
+public:
+  typedef Key key_type;
+  typedef T mapped_type;
+  typedef tinystl::pair<const Key, T> value_type;
+  typedef Hash hasher;
+  typedef KeyEqual key_equal;
+
+private:
+  typedef tinystl::flat_hash_table<value_type, Hash, KeyEqual, true>
+      base_type;
+  base_type table_;
+
+public:
+  typedef typename base_type::pointer pointer;
+  typedef typename base_type::const_pointer const_pointer;
+  typedef typename base_type::reference reference;
+  typedef typename base_type::const_reference const_reference;
+  typedef typename base_type::iterator iterator;
+  typedef typename base_type::const_iterator const_iterator;
+  typedef typename base_type::size_type size_type;
+  typedef typename base_type::difference_type difference_type;
+
+  flat_hash_map() = default;
+  explicit flat_hash_map(size_type bucket_count, const hasher &hash = hasher(),
+                         const key_equal &equal = key_equal())
+      : table_(bucket_count, hash, equal) {}
+  template <typename InputIterator,
+            typename std::enable_if<
+                tinystl::has_input_iterator_cat<InputIterator>::value,
+                int>::type = 0>
+  flat_hash_map(InputIterator first, InputIterator last) {
+    insert(first, last);
+  }
+  flat_hash_map(std::initializer_list<value_type> l) {
+    table_.reserve(l.size());
+    insert(l.begin(), l.end());
+  }
+  flat_hash_map(const flat_hash_map &m) : table_(m.table_) {}
+  flat_hash_map(flat_hash_map &&m) noexcept : table_(std::move(m.table_)) {}
+
+  flat_hash_map &operator=(const flat_hash_map &m) {
+    table_ = m.table_;
+    return *this;
+  }
+  flat_hash_map &operator=(flat_hash_map &&m) noexcept {
+    table_ = std::move(m.table_);
+    return *this;
+  }
+  flat_hash_map &operator=(std::initializer_list<value_type> l) {
+    table_.clear();
+    insert(l.begin(), l.end());
+    return *this;
+  }
+
+  iterator begin() noexcept { return table_.begin(); }
+  const_iterator begin() const noexcept { return table_.begin(); }
+  iterator end() noexcept { return table_.end(); }
+  const_iterator end() const noexcept { return table_.end(); }
+  const_iterator cbegin() const noexcept { return begin(); }
+  const_iterator cend() const noexcept { return end(); }
+
+  bool empty() const noexcept { return table_.empty(); }
+  size_type size() const noexcept { return table_.size(); }
+  size_type max_size() const noexcept { return table_.max_size(); }
+
+  mapped_type &at(const key_type &key) {
+    iterator it = find(key);
+    THROW_OUT_OF_RANGE_IF(it == end(),
+                          "flat_hash_map<Key, T> no such element exists");
+    return it->second;
+  }
+  const mapped_type &at(const key_type &key) const {
+    const_iterator it = find(key);
+    THROW_OUT_OF_RANGE_IF(it == end(),
+                          "flat_hash_map<Key, T> no such element exists");
+    return it->second;
+  }
+  mapped_type &operator[](const key_type &key) {
+    return try_emplace(key).first->second;
+  }
+  mapped_type &operator[](key_type &&key) {
+    return try_emplace(std::move(key)).first->second;
+  }
+
+  template <typename... Args>
+  tinystl::pair<iterator, bool> emplace(Args &&...args) {
+    return table_.emplace_unique(std::forward<Args>(args)...);
+  }
+  // 键已存在时不构造元素，args 不会被移动
+  template <typename... Args>
+  tinystl::pair<iterator, bool> try_emplace(const key_type &key,
+                                            Args &&...args) {
+    return table_.try_emplace(key, std::forward<Args>(args)...);
+  }
+  template <typename... Args>
+  tinystl::pair<iterator, bool> try_emplace(key_type &&key, Args &&...args) {
+    return table_.try_emplace(std::move(key), std::forward<Args>(args)...);
+  }
+  template <typename M>
+  tinystl::pair<iterator, bool> insert_or_assign(const key_type &key,
+                                                 M &&obj) {
+    auto r = table_.emplace_key(key, key, std::forward<M>(obj));
+    if (!r.second) {
+      r.first->second = std::forward<M>(obj);
+    }
+    return r;
+  }
+
+  tinystl::pair<iterator, bool> insert(const value_type &value) {
+    return table_.emplace_key(value.first, value);
+  }
+  tinystl::pair<iterator, bool> insert(value_type &&value) {
+    return table_.emplace_key(value.first, std::move(value));
+  }
+  template <typename InputIterator,
+            typename std::enable_if<
+                tinystl::has_input_iterator_cat<InputIterator>::value,
+                int>::type = 0>
+  void insert(InputIterator first, InputIterator last) {
+    for (; first != last; ++first) {
+      insert(*first);
+    }
+  }
+  void insert(std::initializer_list<value_type> l) {
+    insert(l.begin(), l.end());
+  }
+
+  iterator erase(const_iterator pos) { return table_.erase(pos); }
+  iterator erase(const_iterator first, const_iterator last) {
+    return table_.erase(first, last);
+  }
+  size_type erase(const key_type &key) { return table_.erase_key(key); }
+  void clear() { table_.clear(); }
+
+  iterator find(const key_type &key) { return table_.find(key); }
+  const_iterator find(const key_type &key) const { return table_.find(key); }
+  size_type count(const key_type &key) const {
+    return table_.contains(key) ? 1 : 0;
+  }
+  bool contains(const key_type &key) const { return table_.contains(key); }
+  tinystl::pair<iterator, iterator> equal_range(const key_type &key) {
+    iterator it = find(key);
+    iterator next = it;
+    return tinystl::pair<iterator, iterator>(it, it == end() ? it : ++next);
+  }
+  tinystl::pair<const_iterator, const_iterator>
+  equal_range(const key_type &key) const {
+    const_iterator it = find(key);
+    const_iterator next = it;
+    return tinystl::pair<const_iterator, const_iterator>(
+        it, it == end() ? it : ++next);
+  }
+
+  // 哈希与相等比较都透明时的异构查找，不构造临时键
+  template <typename K, typename H = Hash, typename E = KeyEqual,
+            typename = typename H::is_transparent,
+            typename = typename E::is_transparent>
+  iterator find(const K &key) {
+    return table_.find(key);
+  }
+  template <typename K, typename H = Hash, typename E = KeyEqual,
+            typename = typename H::is_transparent,
+            typename = typename E::is_transparent>
+  const_iterator find(const K &key) const {
+    return table_.find(key);
+  }
+  template <typename K, typename H = Hash, typename E = KeyEqual,
+            typename = typename H::is_transparent,
+            typename = typename E::is_transparent>
+  size_type count(const K &key) const {
+    return table_.contains(key) ? 1 : 0;
+  }
+  template <typename K, typename H = Hash, typename E = KeyEqual,
+            typename = typename H::is_transparent,
+            typename = typename E::is_transparent>
+  bool contains(const K &key) const {
+    return table_.contains(key);
+  }
+
+  size_type bucket_count() const noexcept { return table_.capacity(); }
+  float load_factor() const noexcept { return table_.load_factor(); }
+  // 负载因子上限固定为 7/8
+  float max_load_factor() const noexcept { return table_.max_load_factor(); }
+  void max_load_factor(float) noexcept {}
+  void rehash(size_type n) { table_.rehash(n); }
+  void reserve(size_type n) { table_.reserve(n); }
+
+  hasher hash_function() const { return table_.hash_function(); }
+  key_equal key_eq() const { return table_.key_eq(); }
+
+  void swap(flat_hash_map &m) noexcept { table_.swap(m.table_); }
+
+  friend bool operator==(const flat_hash_map &lhs, const flat_hash_map &rhs) {
+    return lhs.table_ == rhs.table_;
+  }
+};
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+bool operator!=(const flat_hash_map<Key, T, Hash, KeyEqual> &lhs,
+                const flat_hash_map<Key, T, Hash, KeyEqual> &rhs) {
+  return !(lhs == rhs);
+}
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+void swap(flat_hash_map<Key, T, Hash, KeyEqual> &lhs,
+          flat_hash_map<Key, T, Hash, KeyEqual> &rhs) noexcept {
+  lhs.swap(rhs);
+}
+} // namespace tinystl
+
+#endif
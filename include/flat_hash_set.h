@@ -0,0 +1,176 @@
+#ifndef MYTINYSTL_FLAT_HASH_SET_H_
+#define MYTINYSTL_FLAT_HASH_SET_H_
+
+// 接口与 unordered_set 相近，底层为开放寻址的 flat_hash_table：
+// 元素不可修改，iterator 与 const_iterator 相同；
+// 插入可能使所有迭代器和引用失效，删除不影响其他元素的迭代器
+
+#include "flat_hash_table.h"
+#include "functional.h"
+#include "hash.h"
+#include "util.h"
+#include <functional>
+#include <initializer_list>
+#include <type_traits>
+#include <utility>
+
+namespace tinystl {
+template <typename Key, typename Hash = tinystl::hash<Key>,
+          typename KeyEqual = tinystl::equal_to<Key>>
+class flat_hash_set {
+public:
+  typedef Key key_type;
+  typedef Key value_type;
+  typedef Hash hasher;
+  typedef KeyEqual key_equal;
+
+private:
+  typedef tinystl::flat_hash_table<Key, Hash, KeyEqual, false> base_type;
+  base_type table_;
+
+public:
+  typedef typename base_type::const_pointer pointer;
+  typedef typename base_type::const_pointer const_pointer;
+  typedef typename base_type::const_reference reference;
+  typedef typename base_type::const_reference const_reference;
+  typedef typename base_type::const_iterator iterator;
+  typedef typename base_type::const_iterator const_iterator;
+  typedef typename base_type::size_type size_type;
+  typedef typename base_type::difference_type difference_type;
+
+  flat_hash_set() = default;
+  explicit flat_hash_set(size_type bucket_count, const hasher &hash = hasher(),
+                         const key_equal &equal = key_equal())
+      : table_(bucket_count, hash, equal) {}
+  template <typename InputIterator,
+            typename std::enable_if<
+                tinystl::has_input_iterator_cat<InputIterator>::value,
+                int>::type = 0>
+  flat_hash_set(InputIterator first, InputIterator last) {
+    insert(first, last);
+  }
+  flat_hash_set(std::initializer_list<value_type> l) {
+    table_.reserve(l.size());
+    insert(l.begin(), l.end());
+  }
+  flat_hash_set(const flat_hash_set &s) : table_(s.table_) {}
+  flat_hash_set(flat_hash_set &&s) noexcept : table_(std::move(s.table_)) {}
+
+  flat_hash_set &operator=(const flat_hash_set &s) {
+    table_ = s.table_;
+    return *this;
+  }
+  flat_hash_set &operator=(flat_hash_set &&s) noexcept {
+    table_ = std::move(s.table_);
+    return *this;
+  }
+  flat_hash_set &operator=(std::initializer_list<value_type> l) {
+    table_.clear();
+    insert(l.begin(), l.end());
+    return *this;
+  }
+
+  iterator begin() const noexcept { return table_.begin(); }
+  iterator end() const noexcept { return table_.end(); }
+  const_iterator cbegin() const noexcept { return begin(); }
+  const_iterator cend() const noexcept { return end(); }
+
+  bool empty() const noexcept { return table_.empty(); }
+  size_type size() const noexcept { return table_.size(); }
+  size_type max_size() const noexcept { return table_.max_size(); }
+
+  template <typename... Args>
+  tinystl::pair<iterator, bool> emplace(Args &&...args) {
+    auto r = table_.emplace_unique(std::forward<Args>(args)...);
+    return tinystl::pair<iterator, bool>(r.first, r.second);
+  }
+  tinystl::pair<iterator, bool> insert(const value_type &value) {
+    auto r = table_.emplace_key(value, value);
+    return tinystl::pair<iterator, bool>(r.first, r.second);
+  }
+  tinystl::pair<iterator, bool> insert(value_type &&value) {
+    auto r = table_.emplace_key(value, std::move(value));
+    return tinystl::pair<iterator, bool>(r.first, r.second);
+  }
+  template <typename InputIterator,
+            typename std::enable_if<
+                tinystl::has_input_iterator_cat<InputIterator>::value,
+                int>::type = 0>
+  void insert(InputIterator first, InputIterator last) {
+    for (; first != last; ++first) {
+      insert(*first);
+    }
+  }
+  void insert(std::initializer_list<value_type> l) {
+    insert(l.begin(), l.end());
+  }
+
+  iterator erase(const_iterator pos) { return table_.erase(pos); }
+  iterator erase(const_iterator first, const_iterator last) {
+    return table_.erase(first, last);
+  }
+  size_type erase(const key_type &key) { return table_.erase_key(key); }
+  void clear() { table_.clear(); }
+
+  iterator find(const key_type &key) const { return table_.find(key); }
+  size_type count(const key_type &key) const {
+    return table_.contains(key) ? 1 : 0;
+  }
+  bool contains(const key_type &key) const { return table_.contains(key); }
+  tinystl::pair<iterator, iterator> equal_range(const key_type &key) const {
+    iterator it = find(key);
+    iterator next = it;
+    return tinystl::pair<iterator, iterator>(it, it == end() ? it : ++next);
+  }
+
+  // 哈希与相等比较都透明时的异构查找，不构造临时键
+  template <typename K, typename H = Hash, typename E = KeyEqual,
+            typename = typename H::is_transparent,
+            typename = typename E::is_transparent>
+  iterator find(const K &key) const {
+    return table_.find(key);
+  }
+  template <typename K, typename H = Hash, typename E = KeyEqual,
+            typename = typename H::is_transparent,
+            typename = typename E::is_transparent>
+  size_type count(const K &key) const {
+    return table_.contains(key) ? 1 : 0;
+  }
+  template <typename K, typename H = Hash, typename E = KeyEqual,
+            typename = typename H::is_transparent,
+            typename = typename E::is_transparent>
+  bool contains(const K &key) const {
+    return table_.contains(key);
+  }
+
+  size_type bucket_count() const noexcept { return table_.capacity(); }
+  float load_factor() const noexcept { return table_.load_factor(); }
+  // 负载因子上限固定为 7/8
+  float max_load_factor() const noexcept { return table_.max_load_factor(); }
+  void max_load_factor(float) noexcept {}
+  void rehash(size_type n) { table_.rehash(n); }
+  void reserve(size_type n) { table_.reserve(n); }
+
+  hasher hash_function() const { return table_.hash_function(); }
+  key_equal key_eq() const { return table_.key_eq(); }
+
+  void swap(flat_hash_set &s) noexcept { table_.swap(s.table_); }
+
+  friend bool operator==(const flat_hash_set &lhs, const flat_hash_set &rhs) {
+    return lhs.table_ == rhs.table_;
+  }
+};
+
+template <typename Key, typename Hash, typename KeyEqual>
+bool operator!=(const flat_hash_set<Key, Hash, KeyEqual> &lhs,
+                const flat_hash_set<Key, Hash, KeyEqual> &rhs) {
+  return !(lhs == rhs);
+}
+template <typename Key, typename Hash, typename KeyEqual>
+void swap(flat_hash_set<Key, Hash, KeyEqual> &lhs,
+          flat_hash_set<Key, Hash, KeyEqual> &rhs) noexcept {
+  lhs.swap(rhs);
+}
+} // namespace tinystl
+
+#endif
@@ -0,0 +1,683 @@
+#ifndef MYTINYSTL_FLAT_HASH_TABLE_H_
+#define MYTINYSTL_FLAT_HASH_TABLE_H_
+
+// 开放寻址哈希表（Swiss table）：元素直接存放在槽数组中，每个槽另有一个
+// 控制字节，记录空、墓碑或元素哈希值的低 7 位（H2）。
+// 查找时以 16 个控制字节为一组，用 SSE2 一次比较整组的 H2，只有 H2 相同
+// 的槽才需要比较键；组内出现空槽即可确定键不存在。
+// 容量为 2^k - 1，负载因子上限 7/8；删除时若所在位置可能位于某条探测
+// 序列中间则留下墓碑，墓碑过多时原容量重建。
+// 插入可能移动所有元素，使所有迭代器和引用失效；删除不移动其他元素。
+// 重建时会重新计算哈希，哈希函数与相等比较不应抛出异常。
+
+#include "allocator.h"
+#include "construct.h"
+#include "exceptdef.h"
+#include "functional.h"
+#include "hash.h"
+#include "iterator.h"
+#include "rb_tree.h"
+#include "type_traits.h"
+#include "util.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace tinystl {
+typedef signed char flat_hash_ctrl;
+
+// 非负的控制字节为 H2，表示槽中有元素；三种特殊值都小于 0，
+// 且空与墓碑都小于哨兵，便于一次比较挑出“空或墓碑”
+static constexpr flat_hash_ctrl flat_hash_empty = -128;
+static constexpr flat_hash_ctrl flat_hash_deleted = -2;
+static constexpr flat_hash_ctrl flat_hash_sentinel = -1;
+
+// m 非零
+inline unsigned flat_hash_ctz(std::uint32_t m) {
+#if defined(__GNUC__)
+  return static_cast<unsigned>(__builtin_ctz(m));
+#else
+  unsigned n = 0;
+  for (; (m & 1) == 0; m >>= 1) {
+    ++n;
+  }
+  return n;
+#endif
+}
+// 16 位掩码的前导零个数，m 可以为零
+inline unsigned flat_hash_clz16(std::uint32_t m) {
+  unsigned n = 16;
+  for (; m != 0; m >>= 1) {
+    --n;
+  }
+  return n;
+}
+
+// 一组 16 个控制字节，各 match 返回每字节一位的掩码
+struct flat_hash_group {
+  static constexpr std::size_t width = 16;
+
+#if defined(__SSE2__)
+  __m128i ctrl;
+
+  explicit flat_hash_group(const flat_hash_ctrl *p)
+      : ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p))) {}
+
+  std::uint32_t match(flat_hash_ctrl h2) const {
+    return static_cast<std::uint32_t>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl)));
+  }
+  std::uint32_t match_empty_or_deleted() const {
+    return static_cast<std::uint32_t>(_mm_movemask_epi8(
+        _mm_cmpgt_epi8(_mm_set1_epi8(flat_hash_sentinel), ctrl)));
+  }
+#else
+  flat_hash_ctrl ctrl[width];
+
+  explicit flat_hash_group(const flat_hash_ctrl *p) {
+    std::memcpy(ctrl, p, width);
+  }
+
+  std::uint32_t match(flat_hash_ctrl h2) const {
+    std::uint32_t m = 0;
+    for (std::size_t i = 0; i < width; ++i) {
+      m |= static_cast<std::uint32_t>(ctrl[i] == h2) << i;
+    }
+    return m;
+  }
+  std::uint32_t match_empty_or_deleted() const {
+    std::uint32_t m = 0;
+    for (std::size_t i = 0; i < width; ++i) {
+      m |= static_cast<std::uint32_t>(ctrl[i] < flat_hash_sentinel) << i;
+    }
+    return m;
+  }
+#endif
+  std::uint32_t match_empty() const { return match(flat_hash_empty); }
+  // 从组首开始连续的空槽或墓碑个数，遍历时据此整段跳过
+  std::size_t count_leading_empty_or_deleted() const {
+    return flat_hash_ctz(~match_empty_or_deleted());
+  }
+};
+
+// 容量为 0 的表共用的控制字节：哨兵后接一组空槽，
+// 使查找和遍历无需分配内存也无需特判
+inline flat_hash_ctrl *flat_hash_empty_group() {
+  alignas(16) static const flat_hash_ctrl group[flat_hash_group::width] = {
+      flat_hash_sentinel, flat_hash_empty, flat_hash_empty, flat_hash_empty,
+      flat_hash_empty,    flat_hash_empty, flat_hash_empty, flat_hash_empty,
+      flat_hash_empty,    flat_hash_empty, flat_hash_empty, flat_hash_empty,
+      flat_hash_empty,    flat_hash_empty, flat_hash_empty, flat_hash_empty};
+  return const_cast<flat_hash_ctrl *>(group);
+}
+
+// std::hash 对整数通常是恒等映射，而探测位置取高位、H2 取低 7 位，
+// 故对未声明 is_avalanching 的哈希先乘以 2^64 / 黄金比例，
+// 再把高半部分折到低半部分
+inline std::size_t flat_hash_mix(std::size_t h) {
+  std::uint64_t m = static_cast<std::uint64_t>(h) * 0x9E3779B97F4A7C15ull;
+  return static_cast<std::size_t>(m ^ (m >> 32));
+}
+
+template <typename T> struct flat_hash_iterator;
+template <typename T> struct flat_hash_const_iterator;
+
+template <typename T>
+struct flat_hash_iterator : public tinystl::iterator<forward_iterator_tag, T> {
+  typedef T value_type;
+  typedef T &reference;
+  typedef T *pointer;
+  typedef flat_hash_iterator<T> self;
+
+  const flat_hash_ctrl *ctrl;
+  T *slot;
+
+  flat_hash_iterator() : ctrl(nullptr), slot(nullptr) {}
+  flat_hash_iterator(const flat_hash_ctrl *c, T *s) : ctrl(c), slot(s) {}
+
+  reference operator*() const { return *slot; }
+  pointer operator->() const { return slot; }
+
+  // 哨兵不小于 flat_hash_sentinel，遍历在表尾自然停下
+  void skip_empty_or_deleted() {
+    while (*ctrl < flat_hash_sentinel) {
+      std::size_t n = flat_hash_group(ctrl).count_leading_empty_or_deleted();
+      ctrl += n;
+      slot += n;
+    }
+  }
+  self &operator++() {
+    ++ctrl;
+    ++slot;
+    skip_empty_or_deleted();
+    return *this;
+  }
+  self operator++(int) {
+    self tmp = *this;
+    ++*this;
+    return tmp;
+  }
+
+  bool operator==(const self &rhs) const { return ctrl == rhs.ctrl; }
+  bool operator!=(const self &rhs) const { return ctrl != rhs.ctrl; }
+};
+
+template <typename T>
+struct flat_hash_const_iterator
+    : public tinystl::iterator<forward_iterator_tag, T> {
+  typedef T value_type;
+  typedef const T &reference;
+  typedef const T *pointer;
+  typedef flat_hash_const_iterator<T> self;
+
+  flat_hash_iterator<T> it;
+
+  flat_hash_const_iterator() {}
+  flat_hash_const_iterator(const flat_hash_iterator<T> &i) : it(i) {}
+
+  reference operator*() const { return *it; }
+  pointer operator->() const { return it.slot; }
+
+  self &operator++() {
+    ++it;
+    return *this;
+  }
+  self operator++(int) {
+    self tmp = *this;
+    ++it;
+    return tmp;
+  }
+
+  bool operator==(const self &rhs) const { return it == rhs.it; }
+  bool operator!=(const self &rhs) const { return it != rhs.it; }
+};
+
+template <typename T, typename Hash, typename KeyEqual,
+          bool IsMap = tinystl::is_pair<T>::value>
+class flat_hash_table {
+public:
+  typedef rb_tree_value_traits<T, IsMap> value_traits;
+  typedef typename value_traits::key_type key_type;
+  typedef typename value_traits::mapped_type mapped_type;
+  typedef typename value_traits::value_type value_type;
+  typedef value_type *pointer;
+  typedef const value_type *const_pointer;
+  typedef value_type &reference;
+  typedef const value_type &const_reference;
+  typedef std::size_t size_type;
+  typedef std::ptrdiff_t difference_type;
+  typedef Hash hasher;
+  typedef KeyEqual key_equal;
+
+  typedef flat_hash_iterator<value_type> iterator;
+  typedef flat_hash_const_iterator<value_type> const_iterator;
+
+  static_assert(alignof(value_type) <= alignof(std::max_align_t),
+                "over-aligned element types are not supported");
+
+private:
+  typedef tinystl::allocator<flat_hash_ctrl> data_allocator;
+  static constexpr size_type width = flat_hash_group::width;
+
+  flat_hash_ctrl *ctrl_; // capacity_ + width 字节，之后是槽数组
+  value_type *slots_;
+  size_type capacity_;
+  size_type size_;
+  size_type growth_left_; // 还能插入多少个元素而不必重建
+  hasher hash_;
+  key_equal equal_;
+
+public:
+  flat_hash_table() : flat_hash_table(0) {}
+  explicit flat_hash_table(size_type bucket_count,
+                           const hasher &hash = hasher(),
+                           const key_equal &equal = key_equal())
+      : ctrl_(flat_hash_empty_group()), slots_(nullptr), capacity_(0),
+        size_(0), growth_left_(0), hash_(hash), equal_(equal) {
+    if (bucket_count != 0) {
+      resize(normalize_capacity(bucket_count));
+    }
+  }
+  flat_hash_table(const flat_hash_table &t);
+  flat_hash_table(flat_hash_table &&t) noexcept
+      : ctrl_(t.ctrl_), slots_(t.slots_), capacity_(t.capacity_),
+        size_(t.size_), growth_left_(t.growth_left_), hash_(t.hash_),
+        equal_(t.equal_) {
+    t.reset_empty();
+  }
+
+  flat_hash_table &operator=(const flat_hash_table &t) {
+    if (this != &t) {
+      flat_hash_table tmp(t);
+      swap(tmp);
+    }
+    return *this;
+  }
+  flat_hash_table &operator=(flat_hash_table &&t) noexcept {
+    if (this != &t) {
+      destroy_all();
+      release();
+      ctrl_ = t.ctrl_;
+      slots_ = t.slots_;
+      capacity_ = t.capacity_;
+      size_ = t.size_;
+      growth_left_ = t.growth_left_;
+      hash_ = t.hash_;
+      equal_ = t.equal_;
+      t.reset_empty();
+    }
+    return *this;
+  }
+
+  ~flat_hash_table() {
+    destroy_all();
+    release();
+  }
+
+  iterator begin() noexcept {
+    iterator it(ctrl_, slots_);
+    it.skip_empty_or_deleted();
+    return it;
+  }
+  const_iterator begin() const noexcept {
+    return const_cast<flat_hash_table *>(this)->begin();
+  }
+  iterator end() noexcept {
+    return iterator(ctrl_ + capacity_, slots_ + capacity_);
+  }
+  const_iterator end() const noexcept {
+    return const_cast<flat_hash_table *>(this)->end();
+  }
+
+  bool empty() const noexcept { return size_ == 0; }
+  size_type size() const noexcept { return size_; }
+  size_type max_size() const noexcept {
+    return static_cast<size_type>(-1) / (sizeof(value_type) + 1);
+  }
+  size_type capacity() const noexcept { return capacity_; }
+  float load_factor() const noexcept {
+    return capacity_ == 0 ? 0.0f
+                          : static_cast<float>(size_) /
+                                static_cast<float>(capacity_);
+  }
+  float max_load_factor() const noexcept { return 0.875f; }
+  hasher hash_function() const { return hash_; }
+  key_equal key_eq() const { return equal_; }
+
+  // 键 k 不存在时以 args 在槽中原位构造元素；k 仅用于查找
+  template <typename K, typename... Args>
+  tinystl::pair<iterator, bool> emplace_key(const K &k, Args &&...args);
+  template <typename... Args>
+  tinystl::pair<iterator, bool> emplace_unique(Args &&...args);
+  // 仅用于映射：键不存在时才以 args 构造映射值，否则 args 不被移动
+  template <typename KArg, typename... Args>
+  tinystl::pair<iterator, bool> try_emplace(KArg &&key, Args &&...args) {
+    return insert_key(key, [&](value_type *p) {
+      tinystl::construct(p, std::forward<KArg>(key),
+                         mapped_type(std::forward<Args>(args)...));
+    });
+  }
+
+  iterator erase(const_iterator pos) {
+    iterator it = pos.it;
+    erase_at(static_cast<size_type>(it.ctrl - ctrl_));
+    ++it;
+    return it;
+  }
+  iterator erase(const_iterator first, const_iterator last) {
+    while (first != last) {
+      first = erase(first);
+    }
+    return last.it;
+  }
+  template <typename K> size_type erase_key(const K &k) {
+    size_type i = find_index(k, hash_of(k));
+    if (i == capacity_) {
+      return 0;
+    }
+    erase_at(i);
+    return 1;
+  }
+  void clear();
+
+  template <typename K> iterator find(const K &k) {
+    size_type i = find_index(k, hash_of(k));
+    return i == capacity_ ? end() : iterator(ctrl_ + i, slots_ + i);
+  }
+  template <typename K> const_iterator find(const K &k) const {
+    return const_cast<flat_hash_table *>(this)->find(k);
+  }
+  template <typename K> bool contains(const K &k) const {
+    return find_index(k, hash_of(k)) != capacity_;
+  }
+
+  // 容量至少为 n，且足以容纳现有元素；n 为 0 且表空时释放内存
+  void rehash(size_type n);
+  // 之后插入到共 n 个元素前都不会重建
+  void reserve(size_type n) {
+    if (n > size_ + growth_left_) {
+      resize(capacity_for(n));
+    }
+  }
+
+  void swap(flat_hash_table &t) noexcept {
+    std::swap(ctrl_, t.ctrl_);
+    std::swap(slots_, t.slots_);
+    std::swap(capacity_, t.capacity_);
+    std::swap(size_, t.size_);
+    std::swap(growth_left_, t.growth_left_);
+    std::swap(hash_, t.hash_);
+    std::swap(equal_, t.equal_);
+  }
+
+  friend bool operator==(const flat_hash_table &lhs,
+                         const flat_hash_table &rhs) {
+    if (lhs.size_ != rhs.size_) {
+      return false;
+    }
+    for (const_iterator it = lhs.begin(); it != lhs.end(); ++it) {
+      const_iterator j = rhs.find(value_traits::get_key(*it));
+      if (j == rhs.end() || !(*j == *it)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+private:
+  static const key_type &key_of(const value_type &v) {
+    return value_traits::get_key(v);
+  }
+  // tinystl::hash 等声明了 is_avalanching 的哈希结果已充分混合
+  template <typename K> size_type hash_of(const K &k) const {
+    return mix(hash_(k), hash_is_avalanching<hasher>());
+  }
+  static size_type mix(size_type h, std::true_type) { return h; }
+  static size_type mix(size_type h, std::false_type) {
+    return flat_hash_mix(h);
+  }
+  static flat_hash_ctrl h2(size_type hash) {
+    return static_cast<flat_hash_ctrl>(hash & 0x7F);
+  }
+  static size_type growth_of(size_type cap) { return cap - cap / 8; }
+  static size_type normalize_capacity(size_type n) {
+    size_type cap = 1;
+    while (cap < n) {
+      cap = cap * 2 + 1;
+    }
+    return cap;
+  }
+  static size_type capacity_for(size_type n) {
+    size_type cap = 1;
+    while (growth_of(cap) < n) {
+      cap = cap * 2 + 1;
+    }
+    return cap;
+  }
+  static size_type ctrl_bytes(size_type cap) {
+    // 控制字节之后按元素对齐放槽数组
+    size_type n = cap + width;
+    return (n + alignof(value_type) - 1) / alignof(value_type) *
+           alignof(value_type);
+  }
+
+  // 表尾之后复制了前 width - 1 个控制字节，从任意位置读一整组都不越界；
+  // 写控制字节时同时更新其副本
+  void set_ctrl(size_type i, flat_hash_ctrl c) {
+    ctrl_[i] = c;
+    ctrl_[((i - (width - 1)) & capacity_) + ((width - 1) & capacity_)] = c;
+  }
+
+  template <typename K> size_type find_index(const K &k, size_type hash) const;
+  // 键 k 不存在时调用 build 在空出的槽中构造元素
+  template <typename K, typename Build>
+  tinystl::pair<iterator, bool> insert_key(const K &k, Build build);
+  size_type find_first_non_full(size_type hash) const;
+  size_type prepare_insert(size_type hash);
+  void finish_insert(size_type i, size_type hash) {
+    ++size_;
+    growth_left_ -= ctrl_[i] == flat_hash_empty ? 1 : 0;
+    set_ctrl(i, h2(hash));
+  }
+  void erase_at(size_type i);
+  void resize(size_type new_capacity);
+  void destroy_all();
+  void release() {
+    if (capacity_ != 0) {
+      data_allocator::deallocate(ctrl_);
+    }
+  }
+  void reset_empty() {
+    ctrl_ = flat_hash_empty_group();
+    slots_ = nullptr;
+    capacity_ = 0;
+    size_ = 0;
+    growth_left_ = 0;
+  }
+};
+
+// 按组做三角数探测：依次跳过 1, 2, 3... 组，容量为 2 的幂减一时
+// 能不重复地走遍所有组
+template <typename T, typename Hash, typename KeyEqual, bool IsMap>
+template <typename K>
+typename flat_hash_table<T, Hash, KeyEqual, IsMap>::size_type
+flat_hash_table<T, Hash, KeyEqual, IsMap>::find_index(const K &k,
+                                                      size_type hash) const {
+  const flat_hash_ctrl tag = h2(hash);
+  size_type offset = (hash >> 7) & capacity_;
+  for (size_type step = width;; step += width) {
+    flat_hash_group g(ctrl_ + offset);
+    for (std::uint32_t m = g.match(tag); m != 0; m &= m - 1) {
+      size_type i = (offset + flat_hash_ctz(m)) & capacity_;
+      if (equal_(key_of(slots_[i]), k)) {
+        return i;
+      }
+    }
+    if (g.match_empty() != 0) {
+      return capacity_;
+    }
+    offset = (offset + step) & capacity_;
+  }
+}
+template <typename T, typename Hash, typename KeyEqual, bool IsMap>
+typename flat_hash_table<T, Hash, KeyEqual, IsMap>::size_type
+flat_hash_table<T, Hash, KeyEqual, IsMap>::find_first_non_full(
+    size_type hash) const {
+  size_type offset = (hash >> 7) & capacity_;
+  for (size_type step = width;; step += width) {
+    std::uint32_t m = flat_hash_group(ctrl_ + offset).match_empty_or_deleted();
+    if (m != 0) {
+      return (offset + flat_hash_ctz(m)) & capacity_;
+    }
+    offset = (offset + step) & capacity_;
+  }
+}
+// 复用墓碑不消耗增长余量；没有余量时先重建再重新找位置
+template <typename T, typename Hash, typename KeyEqual, bool IsMap>
+typename flat_hash_table<T, Hash, KeyEqual, IsMap>::size_type
+flat_hash_table<T, Hash, KeyEqual, IsMap>::prepare_insert(size_type hash) {
+  size_type i = find_first_non_full(hash);
+  if (growth_left_ == 0 && ctrl_[i] != flat_hash_deleted) {
+    // 墓碑占去的空间超过约 1/5 时原容量重建即可，否则扩容一倍
+    resize(capacity_ != 0 && size_ * 32 <= capacity_ * 25 ? capacity_
+                                                           : capacity_ * 2 + 1);
+    i = find_first_non_full(hash);
+  }
+  return i;
+}
+
+template <typename T, typename Hash, typename KeyEqual, bool IsMap>
+template <typename K, typename Build>
+tinystl::pair<typename flat_hash_table<T, Hash, KeyEqual, IsMap>::iterator,
+              bool>
+flat_hash_table<T, Hash, KeyEqual, IsMap>::insert_key(const K &k,
+                                                      Build build) {
+  size_type hash = hash_of(k);
+  size_type i = find_index(k, hash);
+  if (i != capacity_) {
+    return tinystl::pair<iterator, bool>(iterator(ctrl_ + i, slots_ + i),
+                                         false);
+  }
+  i = prepare_insert(hash);
+  build(slots_ + i);
+  finish_insert(i, hash);
+  return tinystl::pair<iterator, bool>(iterator(ctrl_ + i, slots_ + i), true);
+}
+template <typename T, typename Hash, typename KeyEqual, bool IsMap>
+template <typename K, typename... Args>
+tinystl::pair<typename flat_hash_table<T, Hash, KeyEqual, IsMap>::iterator,
+              bool>
+flat_hash_table<T, Hash, KeyEqual, IsMap>::emplace_key(const K &k,
+                                                       Args &&...args) {
+  return insert_key(k, [&](value_type *p) {
+    tinystl::construct(p, std::forward<Args>(args)...);
+  });
+}
+// 无法从参数直接得到键，先在栈上构造元素，键不存在时再移入槽中
+template <typename T, typename Hash, typename KeyEqual, bool IsMap>
+template <typename... Args>
+tinystl::pair<typename flat_hash_table<T, Hash, KeyEqual, IsMap>::iterator,
+              bool>
+flat_hash_table<T, Hash, KeyEqual, IsMap>::emplace_unique(Args &&...args) {
+  value_type tmp(std::forward<Args>(args)...);
+  return emplace_key(key_of(tmp), std::move(tmp));
+}
+
+// 若 i 前后两组中的空槽能保证没有探测序列越过 i（i 所在的连续非空段
+// 短于一组），直接置空；否则留下墓碑
+template <typename T, typename Hash, typename KeyEqual, bool IsMap>
+void flat_hash_table<T, Hash, KeyEqual, IsMap>::erase_at(size_type i) {
+  tinystl::destory(slots_ + i);
+  --size_;
+  size_type before = (i - width) & capacity_;
+  std::uint32_t empty_after = flat_hash_group(ctrl_ + i).match_empty();
+  std::uint32_t empty_before = flat_hash_group(ctrl_ + before).match_empty();
+  bool never_full = empty_before != 0 && empty_after != 0 &&
+                    flat_hash_ctz(empty_after) + flat_hash_clz16(empty_before) <
+                        width;
+  set_ctrl(i, never_full ? flat_hash_empty : flat_hash_deleted);
+  growth_left_ += never_full ? 1 : 0;
+}
+
+// 新表建好后才释放旧表；元素移动可能抛出异常时改为拷贝，
+// 因此中途失败时旧表保持原样
+template <typename T, typename Hash, typename KeyEqual, bool IsMap>
+void flat_hash_table<T, Hash, KeyEqual, IsMap>::resize(size_type new_capacity) {
+  size_type bytes = ctrl_bytes(new_capacity);
+  flat_hash_ctrl *new_ctrl =
+      data_allocator::allocate(bytes + new_capacity * sizeof(value_type));
+  std::memset(new_ctrl, flat_hash_empty, new_capacity + width);
+  new_ctrl[new_capacity] = flat_hash_sentinel;
+
+  flat_hash_ctrl *old_ctrl = ctrl_;
+  value_type *old_slots = slots_;
+  size_type old_capacity = capacity_;
+  ctrl_ = new_ctrl;
+  slots_ = reinterpret_cast<value_type *>(new_ctrl + bytes);
+  capacity_ = new_capacity;
+  size_type i = 0;
+  try {
+    for (; i < old_capacity; ++i) {
+      if (old_ctrl[i] >= 0) {
+        size_type hash = hash_of(key_of(old_slots[i]));
+        size_type j = find_first_non_full(hash);
+        tinystl::construct(slots_ + j, std::move_if_noexcept(old_slots[i]));
+        set_ctrl(j, h2(hash));
+      }
+    }
+  } catch (...) {
+    destroy_all();
+    data_allocator::deallocate(new_ctrl);
+    ctrl_ = old_ctrl;
+    slots_ = old_slots;
+    capacity_ = old_capacity;
+    throw;
+  }
+  for (i = 0; i < old_capacity; ++i) {
+    if (old_ctrl[i] >= 0) {
+      tinystl::destory(old_slots + i);
+    }
+  }
+  if (old_capacity != 0) {
+    data_allocator::deallocate(old_ctrl);
+  }
+  growth_left_ = growth_of(capacity_) - size_;
+}
+
+template <typename T, typename Hash, typename KeyEqual, bool IsMap>
+void flat_hash_table<T, Hash, KeyEqual, IsMap>::destroy_all() {
+  for (size_type i = 0; i < capacity_; ++i) {
+    if (ctrl_[i] >= 0) {
+      tinystl::destory(slots_ + i);
+    }
+  }
+}
+// 保留容量，只把控制字节全部置空
+template <typename T, typename Hash, typename KeyEqual, bool IsMap>
+void flat_hash_table<T, Hash, KeyEqual, IsMap>::clear() {
+  if (capacity_ == 0) {
+    return;
+  }
+  destroy_all();
+  std::memset(ctrl_, flat_hash_empty, capacity_ + width);
+  ctrl_[capacity_] = flat_hash_sentinel;
+  size_ = 0;
+  growth_left_ = growth_of(capacity_);
+}
+template <typename T, typename Hash, typename KeyEqual, bool IsMap>
+void flat_hash_table<T, Hash, KeyEqual, IsMap>::rehash(size_type n) {
+  if (n == 0 && size_ == 0) {
+    release();
+    reset_empty();
+    return;
+  }
+  size_type cap = normalize_capacity(n);
+  size_type need = capacity_for(size_);
+  resize(cap > need ? cap : need);
+}
+
+// 容量相同，逐槽拷贝到同一位置，无需重新计算哈希
+template <typename T, typename Hash, typename KeyEqual, bool IsMap>
+flat_hash_table<T, Hash, KeyEqual, IsMap>::flat_hash_table(
+    const flat_hash_table &t)
+    : ctrl_(flat_hash_empty_group()), slots_(nullptr), capacity_(0),
+      size_(0), growth_left_(0), hash_(t.hash_), equal_(t.equal_) {
+  if (t.capacity_ == 0) {
+    return;
+  }
+  size_type bytes = ctrl_bytes(t.capacity_);
+  flat_hash_ctrl *ctrl =
+      data_allocator::allocate(bytes + t.capacity_ * sizeof(value_type));
+  value_type *slots = reinterpret_cast<value_type *>(ctrl + bytes);
+  size_type i = 0;
+  try {
+    for (; i < t.capacity_; ++i) {
+      if (t.ctrl_[i] >= 0) {
+        tinystl::construct(slots + i, t.slots_[i]);
+      }
+    }
+  } catch (...) {
+    while (i-- != 0) {
+      if (t.ctrl_[i] >= 0) {
+        tinystl::destory(slots + i);
+      }
+    }
+    data_allocator::deallocate(ctrl);
+    throw;
+  }
+  std::memcpy(ctrl, t.ctrl_, t.capacity_ + width);
+  ctrl_ = ctrl;
+  slots_ = slots;
+  capacity_ = t.capacity_;
+  size_ = t.size_;
+  growth_left_ = t.growth_left_;
+}
+} // namespace tinystl
+
+#endif
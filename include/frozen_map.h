@@ -0,0 +1,106 @@
+#ifndef MYTINYSTL_FROZEN_MAP_H_
+#define MYTINYSTL_FROZEN_MAP_H_
+
+// 只读的定长映射，元素在构造时给定，之后不能增删改。
+// 底层为 frozen_table 的编译期完美哈希：查找为 O(1)，只算一次哈希、
+// 比较一次键。键和值都是字面类型时可以声明为 constexpr 常量，
+// 例如
+//   constexpr auto ops = tinystl::make_frozen_map<std::string_view, int>(
+//       {{"add", 1}, {"sub", 2}, {"mul", 3}});
+// 整张表在编译期生成，程序启动时没有任何初始化开销。
+// 遍历顺序与构造时给出的顺序相同；键重复时构造失败（编译期求值时报错）。
+
+#include "exceptdef.h"
+#include "frozen_table.h"
+#include "functional.h"
+#include "util.h"
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace tinystl {
+template <typename Key, typename T, std::size_t N,
+          typename Hash = tinystl::frozen_hash<Key>,
+          typename KeyEqual = tinystl::equal_to<Key>>
+class frozen_map {
+  static_assert(N > 0, "frozen_map needs at least one element");
+
+public:
+  typedef Key key_type;
+  typedef T mapped_type;
+  typedef tinystl::pair<const Key, T> value_type;
+  typedef Hash hasher;
+  typedef KeyEqual key_equal;
+  typedef const value_type *pointer;
+  typedef const value_type *const_pointer;
+  typedef const value_type &reference;
+  typedef const value_type &const_reference;
+  typedef const value_type *iterator;
+  typedef const value_type *const_iterator;
+  typedef std::size_t size_type;
+  typedef std::ptrdiff_t difference_type;
+
+private:
+  value_type items_[N];
+  frozen_table<N> table_;
+  hasher hash_;
+  key_equal equal_;
+
+public:
+  constexpr explicit frozen_map(const tinystl::pair<Key, T> (&items)[N],
+                                const hasher &hash = hasher(),
+                                const key_equal &equal = key_equal())
+      : frozen_map(items, hash, equal, std::make_index_sequence<N>()) {}
+
+  constexpr const_iterator begin() const noexcept { return items_; }
+  constexpr const_iterator end() const noexcept { return items_ + N; }
+  constexpr const_iterator cbegin() const noexcept { return begin(); }
+  constexpr const_iterator cend() const noexcept { return end(); }
+
+  constexpr bool empty() const noexcept { return false; }
+  constexpr size_type size() const noexcept { return N; }
+  constexpr size_type max_size() const noexcept { return N; }
+
+  constexpr const_iterator find(const key_type &key) const {
+    const size_type i = table_.find(hash_(key));
+    return i != N && equal_(items_[i].first, key) ? items_ + i : end();
+  }
+  constexpr size_type count(const key_type &key) const {
+    return find(key) != end() ? 1 : 0;
+  }
+  constexpr bool contains(const key_type &key) const {
+    return find(key) != end();
+  }
+  constexpr const mapped_type &at(const key_type &key) const {
+    const_iterator it = find(key);
+    THROW_OUT_OF_RANGE_IF(it == end(),
+                          "frozen_map<Key, T> no such element exists");
+    return it->second;
+  }
+
+  constexpr hasher hash_function() const { return hash_; }
+  constexpr key_equal key_eq() const { return equal_; }
+
+private:
+  template <std::size_t... I>
+  constexpr frozen_map(const tinystl::pair<Key, T> (&items)[N],
+                       const hasher &hash, const key_equal &equal,
+                       std::index_sequence<I...>)
+      : items_{value_type(items[I].first, items[I].second)...}, table_(),
+        hash_(hash), equal_(equal) {
+    std::uint64_t h[N] = {};
+    for (size_type i = 0; i < N; ++i) {
+      h[i] = hash_(items_[i].first);
+    }
+    table_.build(h);
+  }
+};
+
+template <typename Key, typename T, std::size_t N>
+constexpr frozen_map<Key, T, N>
+make_frozen_map(const tinystl::pair<Key, T> (&items)[N]) {
+  return frozen_map<Key, T, N>(items);
+}
+} // namespace tinystl
+
+#endif
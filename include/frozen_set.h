@@ -0,0 +1,91 @@
+#ifndef MYTINYSTL_FROZEN_SET_H_
+#define MYTINYSTL_FROZEN_SET_H_
+
+// 只读的定长集合，与 frozen_map 相同，底层为 frozen_table 的编译期完美哈希，
+// 例如
+//   constexpr auto keywords = tinystl::make_frozen_set<std::string_view>(
+//       {"if", "else", "while"});
+// 遍历顺序与构造时给出的顺序相同；元素重复时构造失败。
+
+#include "frozen_table.h"
+#include "functional.h"
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace tinystl {
+template <typename Key, std::size_t N,
+          typename Hash = tinystl::frozen_hash<Key>,
+          typename KeyEqual = tinystl::equal_to<Key>>
+class frozen_set {
+  static_assert(N > 0, "frozen_set needs at least one element");
+
+public:
+  typedef Key key_type;
+  typedef Key value_type;
+  typedef Hash hasher;
+  typedef KeyEqual key_equal;
+  typedef const value_type *pointer;
+  typedef const value_type *const_pointer;
+  typedef const value_type &reference;
+  typedef const value_type &const_reference;
+  typedef const value_type *iterator;
+  typedef const value_type *const_iterator;
+  typedef std::size_t size_type;
+  typedef std::ptrdiff_t difference_type;
+
+private:
+  value_type items_[N];
+  frozen_table<N> table_;
+  hasher hash_;
+  key_equal equal_;
+
+public:
+  constexpr explicit frozen_set(const Key (&items)[N],
+                                const hasher &hash = hasher(),
+                                const key_equal &equal = key_equal())
+      : frozen_set(items, hash, equal, std::make_index_sequence<N>()) {}
+
+  constexpr const_iterator begin() const noexcept { return items_; }
+  constexpr const_iterator end() const noexcept { return items_ + N; }
+  constexpr const_iterator cbegin() const noexcept { return begin(); }
+  constexpr const_iterator cend() const noexcept { return end(); }
+
+  constexpr bool empty() const noexcept { return false; }
+  constexpr size_type size() const noexcept { return N; }
+  constexpr size_type max_size() const noexcept { return N; }
+
+  constexpr const_iterator find(const key_type &key) const {
+    const size_type i = table_.find(hash_(key));
+    return i != N && equal_(items_[i], key) ? items_ + i : end();
+  }
+  constexpr size_type count(const key_type &key) const {
+    return find(key) != end() ? 1 : 0;
+  }
+  constexpr bool contains(const key_type &key) const {
+    return find(key) != end();
+  }
+
+  constexpr hasher hash_function() const { return hash_; }
+  constexpr key_equal key_eq() const { return equal_; }
+
+private:
+  template <std::size_t... I>
+  constexpr frozen_set(const Key (&items)[N], const hasher &hash,
+                       const key_equal &equal, std::index_sequence<I...>)
+      : items_{items[I]...}, table_(), hash_(hash), equal_(equal) {
+    std::uint64_t h[N] = {};
+    for (size_type i = 0; i < N; ++i) {
+      h[i] = hash_(items_[i]);
+    }
+    table_.build(h);
+  }
+};
+
+template <typename Key, std::size_t N>
+constexpr frozen_set<Key, N> make_frozen_set(const Key (&items)[N]) {
+  return frozen_set<Key, N>(items);
+}
+} // namespace tinystl
+
+#endif
@@ -0,0 +1,221 @@
+#ifndef MYTINYSTL_FROZEN_TABLE_H_
+#define MYTINYSTL_FROZEN_TABLE_H_
+
+// 编译期完美哈希（hash and displace），frozen_map 与 frozen_set 的底层实现。
+// N 个键按哈希值分到 N 个桶，桶按大小从大到小依次处理：为每个桶找一个
+// 位移 d，使桶内每个键的 frozen_hash_slot(h, d) 都落在尚未占用的槽上。
+// 槽数为不小于 N 的 2 的幂，槽中存放元素下标。
+// 查找时只算一次键的哈希，由桶的位移得到唯一的槽，再比较一次键，没有探测。
+// 构造全部可在 constexpr 中完成，常量对象不需要运行期初始化。
+// 哈希须为 constexpr 且只依赖键的值：frozen_hash 支持整数、枚举与
+// basic_string_view；结果与 tinystl::hash 不同，也不应持久化。
+
+#include "exceptdef.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#if __cplusplus >= 201703L
+#include <string_view>
+#endif
+
+namespace tinystl {
+constexpr std::uint64_t frozen_hash_mix(std::uint64_t x) {
+  x ^= x >> 32;
+  x *= 0xD6E8FEB86659FD93ull;
+  x ^= x >> 32;
+  x *= 0xD6E8FEB86659FD93ull;
+  x ^= x >> 32;
+  return x;
+}
+
+template <typename T, typename = void> struct frozen_hash;
+
+template <typename T>
+struct frozen_hash<
+    T, typename std::enable_if<std::is_integral<T>::value ||
+                               std::is_enum<T>::value>::type> {
+  constexpr std::uint64_t operator()(T v) const {
+    return frozen_hash_mix(static_cast<std::uint64_t>(v) ^
+                           0x9E3779B97F4A7C15ull);
+  }
+};
+
+#if __cplusplus >= 201703L
+// 把 p 起的 n 个（至多 8 / sizeof(CharT) 个）字符按小端拼成 64 位整数。
+// 运行期且为单字节字符时改用重叠的整字读取，结果相同
+template <typename CharT>
+constexpr std::uint64_t frozen_hash_word(const CharT *p, std::size_t n) {
+  typedef typename std::make_unsigned<CharT>::type uchar;
+#if defined(__has_builtin) && defined(__BYTE_ORDER__)
+#if __has_builtin(__builtin_is_constant_evaluated) &&                        \
+    __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  if (sizeof(CharT) == 1 && !__builtin_is_constant_evaluated()) {
+    const unsigned char *b = reinterpret_cast<const unsigned char *>(p);
+    if (n == 8) {
+      std::uint64_t w = 0;
+      std::memcpy(&w, b, 8);
+      return w;
+    }
+    if (n >= 4) {
+      std::uint32_t lo = 0;
+      std::uint32_t hi = 0;
+      std::memcpy(&lo, b, 4);
+      std::memcpy(&hi, b + n - 4, 4);
+      return lo | static_cast<std::uint64_t>(hi) << (8 * (n - 4));
+    }
+    if (n == 0) {
+      return 0;
+    }
+    return static_cast<std::uint64_t>(b[0]) |
+           static_cast<std::uint64_t>(b[n >> 1]) << (8 * (n >> 1)) |
+           static_cast<std::uint64_t>(b[n - 1]) << (8 * (n - 1));
+  }
+#endif
+#endif
+  std::uint64_t w = 0;
+  for (std::size_t j = 0; j < n; ++j) {
+    w |= static_cast<std::uint64_t>(static_cast<uchar>(p[j]))
+         << (8 * sizeof(CharT) * j);
+  }
+  return w;
+}
+
+// 每 8 个字节的字符拼成一个 64 位整数（末尾不足的也拼成一个）再混合，
+// 每组只需一次乘法；选桶用高位，选槽还会再乘一次，不再做最终混合
+template <typename CharT, typename Traits>
+struct frozen_hash<std::basic_string_view<CharT, Traits>> {
+  static constexpr std::size_t group = 8 / sizeof(CharT);
+
+  constexpr std::uint64_t
+  operator()(std::basic_string_view<CharT, Traits> s) const {
+    std::uint64_t h = 0x9E3779B97F4A7C15ull ^ s.size();
+    for (std::size_t i = 0; i < s.size(); i += group) {
+      const std::size_t n = s.size() - i < group ? s.size() - i : group;
+      h = (h ^ frozen_hash_word(s.data() + i, n)) * 0xD6E8FEB86659FD93ull;
+      h ^= h >> 29;
+    }
+    return h;
+  }
+};
+#endif
+
+// 哈希值为 h 的键在位移 d 下的槽号：h 已充分混合，一次乘法后取高位即可
+constexpr std::size_t frozen_hash_slot(std::uint64_t h, std::uint32_t d,
+                                       std::size_t mask) {
+  return static_cast<std::size_t>(
+             ((h ^ (d * 0x9E3779B97F4A7C15ull)) * 0xD6E8FEB86659FD93ull) >>
+             32) &
+         mask;
+}
+
+constexpr std::size_t frozen_table_slots(std::size_t n) {
+  std::size_t s = 1;
+  while (s < n) {
+    s *= 2;
+  }
+  return s;
+}
+
+template <std::size_t N> class frozen_table {
+public:
+  static constexpr std::size_t bucket_count = N == 0 ? 1 : N;
+  static constexpr std::size_t slot_count = frozen_table_slots(N);
+  // 下标类型按 N 取最小的，空槽存 N
+  typedef typename std::conditional<
+      (N < 0xFF), std::uint8_t,
+      typename std::conditional<(N < 0xFFFF), std::uint16_t,
+                                std::uint32_t>::type>::type index_type;
+
+private:
+  // 尝试位移的上限；超过说明有重复的键或哈希值完全相同的键
+  static constexpr std::uint32_t max_seed = 1u << 20;
+
+  std::uint32_t seed_[bucket_count];
+  index_type index_[slot_count];
+
+public:
+  constexpr frozen_table() : seed_{}, index_{} {}
+
+  // h 为 N 个键的哈希值，按元素下标排列
+  constexpr void build(const std::uint64_t *h);
+
+  // 返回可能等于该键的元素下标，没有时返回 N
+  constexpr std::size_t find(std::uint64_t h) const {
+    return index_[frozen_hash_slot(h, seed_[bucket_of(h)], slot_count - 1)];
+  }
+
+private:
+  static constexpr std::size_t bucket_of(std::uint64_t h) {
+    return static_cast<std::size_t>(((h >> 32) * bucket_count) >> 32);
+  }
+};
+
+template <std::size_t N>
+constexpr void frozen_table<N>::build(const std::uint64_t *h) {
+  static_assert(N < 0xFFFFFFFFu, "too many elements for frozen_table");
+  for (std::size_t s = 0; s < slot_count; ++s) {
+    index_[s] = static_cast<index_type>(N);
+  }
+  // 按桶计数排序：桶 b 的元素下标为 members[start[b], start[b + 1])
+  std::size_t start[bucket_count + 1] = {};
+  std::size_t members[bucket_count] = {};
+  for (std::size_t i = 0; i < N; ++i) {
+    ++start[bucket_of(h[i]) + 1];
+  }
+  std::size_t largest = 0;
+  for (std::size_t b = 0; b < bucket_count; ++b) {
+    if (start[b + 1] > largest) {
+      largest = start[b + 1];
+    }
+    start[b + 1] += start[b];
+  }
+  std::size_t fill[bucket_count] = {};
+  for (std::size_t i = 0; i < N; ++i) {
+    const std::size_t b = bucket_of(h[i]);
+    members[start[b] + fill[b]++] = i;
+  }
+
+  // 大桶约束最多，先放
+  for (std::size_t size = largest; size != 0; --size) {
+    for (std::size_t b = 0; b < bucket_count; ++b) {
+      if (start[b + 1] - start[b] != size) {
+        continue;
+      }
+      const std::size_t *m = members + start[b];
+      for (std::size_t i = 0; i < size; ++i) {
+        for (std::size_t j = i + 1; j < size; ++j) {
+          THROW_INVALID_ARGUMENT_IF(
+              h[m[i]] == h[m[j]],
+              "frozen_table: duplicate keys or identical hashes");
+        }
+      }
+      for (std::uint32_t d = 0;; ++d) {
+        THROW_INVALID_ARGUMENT_IF(d == max_seed,
+                                  "frozen_table: no perfect hash found");
+        std::size_t placed = 0;
+        for (; placed < size; ++placed) {
+          const std::size_t s = frozen_hash_slot(h[m[placed]], d,
+                                                 slot_count - 1);
+          if (index_[s] != N) {
+            break;
+          }
+          index_[s] = static_cast<index_type>(m[placed]);
+        }
+        if (placed == size) {
+          seed_[b] = d;
+          break;
+        }
+        // 撤销本次尝试已占用的槽
+        while (placed-- != 0) {
+          index_[frozen_hash_slot(h[m[placed]], d, slot_count - 1)] =
+              static_cast<index_type>(N);
+        }
+      }
+    }
+  }
+}
+} // namespace tinystl
+
+#endif
@@ -1,6 +1,8 @@
 #ifndef MYTINYSTL_FUNCTIONAL_H_
 #define MYTINYSTL_FUNCTIONAL_H_
 
+#include <utility>
+
 namespace tinystl {
 
 template <typename Arg1, typename ReturnArg> struct unarg_function {
@@ -41,8 +43,21 @@ template <class T> struct modulus : public binary_function<T, T, T> {
 };
 
 // 函数对象：等于
-template <class T> struct equal_to : public binary_function<T, T, bool> {
-  bool operator()(const T &x, const T &y) const { return x == y; }
+template <class T = void>
+struct equal_to : public binary_function<T, T, bool> {
+  constexpr bool operator()(const T &x, const T &y) const { return x == y; }
+};
+
+// 透明版本：两个参数可以是不同类型，原样转发给 ==；
+// is_transparent 告知容器可以用非 key_type 的参数直接查找
+template <> struct equal_to<void> {
+  typedef int is_transparent;
+
+  template <class T, class U>
+  constexpr auto operator()(T &&x, U &&y) const
+      -> decltype(std::forward<T>(x) == std::forward<U>(y)) {
+    return std::forward<T>(x) == std::forward<U>(y);
+  }
 };
 
 // 函数对象：不等于
@@ -56,10 +71,22 @@ template <class T> struct greater : public binary_function<T, T, bool> {
 };
 
 // 函数对象：小于
-template <typename T> struct less : binary_function<T, T, bool> {
+template <typename T = void> struct less : binary_function<T, T, bool> {
   bool operator()(const T &x, const T &y) const { return x < y; }
 };
 
+// 透明版本，用法同 equal_to<>；例如 map<string, V, less<>> 可用
+// const char* 或 string_view 查找而不构造临时 string
+template <> struct less<void> {
+  typedef int is_transparent;
+
+  template <class T, class U>
+  auto operator()(T &&x, U &&y) const
+      -> decltype(std::forward<T>(x) < std::forward<U>(y)) {
+    return std::forward<T>(x) < std::forward<U>(y);
+  }
+};
+
 // 函数对象：逻辑与
 template <class T> struct logical_and : public binary_function<T, T, bool> {
   bool operator()(const T &x, const T &y) const { return x && y; }
@@ -0,0 +1,382 @@
+#ifndef MYTINYSTL_HASH_H_
+#define MYTINYSTL_HASH_H_
+
+// 哈希函数库，库中各哈希容器的默认哈希。
+// hash_bytes：短串（至多 256 字节）用 wyhash 式的 64x64->128 乘法折叠，
+// 长串用 xxh3 式的 8 路 32x32->64 乘加累积，每 1KB 打散一次，
+// 有 AVX2 / SSE2 时按向量处理，各路径结果相同。
+// hash_mix：整数的强混合，单次 128 位乘法，输出的每一位都依赖输入的每一位；
+// hash_combine：按顺序合并多个哈希值。
+// tinystl::hash<T> 对整数、枚举、指针、浮点数、字符串、pair 与 tuple
+// 直接给出混合良好的结果，并以 is_avalanching 标明，容器据此省去再混合；
+// 其他类型回退到 std::hash 再混合一次。
+// 结果只在进程内有意义，不同平台、不同版本之间不保证相同。
+
+#include "type_traits.h"
+#include "util.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if __cplusplus >= 201703L
+#include <string_view>
+#endif
+
+namespace tinystl {
+// 由 splitmix64 生成的常数：前 4 个用于短串与整数混合，
+// 长串的各路累加器、逐条带滑动的密钥与打散密钥依次取用其余部分
+inline const std::uint64_t *hash_secret() {
+  static const std::uint64_t secret[32] = {
+      0xE220A8397B1DCDAFull, 0x6E789E6AA1B965F4ull, 0x06C45D188009454Full,
+      0xF88BB8A8724C81ECull, 0x1B39896A51A8749Bull, 0x53CB9F0C747EA2EAull,
+      0x2C829ABE1F4532E1ull, 0xC584133AC916AB3Cull, 0x3EE5789041C98AC3ull,
+      0xF3B8488C368CB0A6ull, 0x657EECDD3CB13D09ull, 0xC2D326E0055BDEF6ull,
+      0x8621A03FE0BBDB7Bull, 0x8E1F7555983AA92Full, 0xB54E0F1600CC4D19ull,
+      0x84BB3F97971D80ABull, 0x7D29825C75521255ull, 0xC3CF17102B7F7F86ull,
+      0x3466E9A083914F64ull, 0xD81A8D2B5A4485ACull, 0xDB01602B100B9ED7ull,
+      0xA9038A921825F10Dull, 0xEDF5F1D90DCA2F6Aull, 0x54496AD67BD2634Cull,
+      0xDD7C01D4F5407269ull, 0x935E82F1DB4C4F7Bull, 0x69B82EBC92233300ull,
+      0x40D29EB57DE1D510ull, 0xA2F09DABB45C6316ull, 0xEE521D7A0F4D3872ull,
+      0xF16952EE72F3454Full, 0x377D35DEA8E40225ull};
+  return secret;
+}
+
+// 64x64->128 乘法，返回高低两半的异或
+inline std::uint64_t hash_mum(std::uint64_t a, std::uint64_t b) {
+#if defined(__SIZEOF_INT128__)
+  unsigned __int128 r = static_cast<unsigned __int128>(a) * b;
+  return static_cast<std::uint64_t>(r) ^ static_cast<std::uint64_t>(r >> 64);
+#else
+  std::uint64_t ha = a >> 32, la = a & 0xFFFFFFFFull;
+  std::uint64_t hb = b >> 32, lb = b & 0xFFFFFFFFull;
+  std::uint64_t hh = ha * hb, hl = ha * lb, lh = la * hb, ll = la * lb;
+  std::uint64_t mid = (ll >> 32) + (hl & 0xFFFFFFFFull) + (lh & 0xFFFFFFFFull);
+  std::uint64_t lo = (mid << 32) | (ll & 0xFFFFFFFFull);
+  std::uint64_t hi = hh + (hl >> 32) + (lh >> 32) + (mid >> 32);
+  return lo ^ hi;
+#endif
+}
+
+inline std::uint64_t hash_mix(std::uint64_t x) {
+  const std::uint64_t *s = hash_secret();
+  return hash_mum(x ^ s[0], s[1]);
+}
+
+// 有序合并：hash_combine(a, b) 与 hash_combine(b, a) 一般不同
+inline std::size_t hash_combine(std::size_t seed, std::size_t h) {
+  const std::uint64_t *s = hash_secret();
+  return static_cast<std::size_t>(
+      hash_mum(static_cast<std::uint64_t>(seed) ^ s[2],
+               static_cast<std::uint64_t>(h) ^ s[3]));
+}
+
+inline std::uint64_t hash_read64(const unsigned char *p) {
+  std::uint64_t v;
+  std::memcpy(&v, p, 8);
+  return v;
+}
+inline std::uint64_t hash_read32(const unsigned char *p) {
+  std::uint32_t v;
+  std::memcpy(&v, p, 4);
+  return v;
+}
+
+// 长串的 8 路累加器，每条带 64 字节：
+// acc[i] += lo32(d ^ k) * hi32(d ^ k)，acc[i ^ 1] += d
+struct hash_accumulator {
+  static constexpr std::size_t stripe = 64;
+  static constexpr std::size_t stripes_per_block = 16;
+
+  std::uint64_t acc[8];
+
+  void accumulate(const unsigned char *p, const std::uint64_t *key) {
+#if defined(__AVX2__)
+    for (int i = 0; i < 2; ++i) {
+      __m256i a = _mm256_loadu_si256(reinterpret_cast<__m256i *>(acc) + i);
+      __m256i d = _mm256_loadu_si256(
+          reinterpret_cast<const __m256i *>(p) + i);
+      __m256i k = _mm256_xor_si256(
+          d, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(key) + i));
+      __m256i prod = _mm256_mul_epu32(k, _mm256_srli_epi64(k, 32));
+      a = _mm256_add_epi64(a, _mm256_shuffle_epi32(d, 0x4E));
+      a = _mm256_add_epi64(a, prod);
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(acc) + i, a);
+    }
+#elif defined(__SSE2__)
+    for (int i = 0; i < 4; ++i) {
+      __m128i a = _mm_loadu_si128(reinterpret_cast<__m128i *>(acc) + i);
+      __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p) + i);
+      __m128i k = _mm_xor_si128(
+          d, _mm_loadu_si128(reinterpret_cast<const __m128i *>(key) + i));
+      __m128i prod = _mm_mul_epu32(k, _mm_srli_epi64(k, 32));
+      a = _mm_add_epi64(a, _mm_shuffle_epi32(d, 0x4E));
+      a = _mm_add_epi64(a, prod);
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(acc) + i, a);
+    }
+#else
+    for (int i = 0; i < 8; ++i) {
+      std::uint64_t d = hash_read64(p + 8 * i);
+      std::uint64_t k = d ^ key[i];
+      acc[i ^ 1] += d;
+      acc[i] += (k & 0xFFFFFFFFull) * (k >> 32);
+    }
+#endif
+  }
+
+  // 把高位折回低位，使之后的 32 位乘法也能用上高位
+  void scramble(const std::uint64_t *key) {
+    for (int i = 0; i < 8; ++i) {
+      std::uint64_t a = acc[i];
+      a ^= a >> 47;
+      a ^= key[i];
+      acc[i] = a * 0x9E3779B1ull;
+    }
+  }
+};
+
+inline std::uint64_t hash_bytes_long(const unsigned char *p, std::size_t len,
+                                     std::uint64_t seed) {
+  const std::uint64_t *s = hash_secret();
+  hash_accumulator h;
+  for (int i = 0; i < 8; ++i) {
+    h.acc[i] = s[4 + i];
+  }
+  const std::size_t block =
+      hash_accumulator::stripe * hash_accumulator::stripes_per_block;
+  std::size_t blocks = (len - 1) / block;
+  for (std::size_t b = 0; b < blocks; ++b, p += block) {
+    for (std::size_t i = 0; i < hash_accumulator::stripes_per_block; ++i) {
+      h.accumulate(p + i * hash_accumulator::stripe, s + 4 + i);
+    }
+    h.scramble(s + 24);
+  }
+  // 剩余的整条带，再加上末尾 64 字节（可与前面重叠）
+  std::size_t rest = len - blocks * block;
+  std::size_t stripes = (rest - 1) / hash_accumulator::stripe;
+  for (std::size_t i = 0; i < stripes; ++i) {
+    h.accumulate(p + i * hash_accumulator::stripe, s + 4 + i);
+  }
+  h.accumulate(p + rest - hash_accumulator::stripe, s + 23);
+
+  std::uint64_t r = static_cast<std::uint64_t>(len) * s[0];
+  for (int i = 0; i < 4; ++i) {
+    r += hash_mum(h.acc[2 * i] ^ s[24 + 2 * i],
+                  h.acc[2 * i + 1] ^ s[25 + 2 * i]);
+  }
+  return hash_mum(r ^ seed ^ s[2], s[3]);
+}
+
+// 任意字节串的哈希
+inline std::uint64_t hash_bytes(const void *data, std::size_t len,
+                                std::uint64_t seed = 0) {
+  const unsigned char *p = static_cast<const unsigned char *>(data);
+  const std::uint64_t *s = hash_secret();
+  if (len > 256) {
+    return hash_bytes_long(p, len, seed);
+  }
+  seed ^= hash_mum(seed ^ s[0], s[1]);
+  std::uint64_t a;
+  std::uint64_t b;
+  if (len <= 16) {
+    if (len >= 4) {
+      // 两段 4 字节在 len < 8 时重叠，len >= 8 时恰好覆盖首尾各 8 字节
+      std::size_t mid = (len >> 3) << 2;
+      a = hash_read32(p) << 32 | hash_read32(p + mid);
+      b = hash_read32(p + len - 4) << 32 | hash_read32(p + len - 4 - mid);
+    } else if (len > 0) {
+      a = static_cast<std::uint64_t>(p[0]) << 16 |
+          static_cast<std::uint64_t>(p[len >> 1]) << 8 | p[len - 1];
+      b = 0;
+    } else {
+      a = b = 0;
+    }
+  } else {
+    std::size_t i = len;
+    if (i > 48) {
+      std::uint64_t see1 = seed;
+      std::uint64_t see2 = seed;
+      do {
+        seed = hash_mum(hash_read64(p) ^ s[1], hash_read64(p + 8) ^ seed);
+        see1 = hash_mum(hash_read64(p + 16) ^ s[2], hash_read64(p + 24) ^ see1);
+        see2 = hash_mum(hash_read64(p + 32) ^ s[3], hash_read64(p + 40) ^ see2);
+        p += 48;
+        i -= 48;
+      } while (i > 48);
+      seed ^= see1 ^ see2;
+    }
+    while (i > 16) {
+      seed = hash_mum(hash_read64(p) ^ s[1], hash_read64(p + 8) ^ seed);
+      i -= 16;
+      p += 16;
+    }
+    a = hash_read64(p + i - 16);
+    b = hash_read64(p + i - 8);
+  }
+  return hash_mum(s[1] ^ len, hash_mum(a ^ s[1], b ^ seed));
+}
+
+template <typename T> struct hash;
+
+// 哈希函数声明了 is_avalanching 时，结果已充分混合，容器不必再混合
+template <typename H, typename = void>
+struct hash_is_avalanching : std::false_type {};
+template <typename H>
+struct hash_is_avalanching<
+    H, typename std::conditional<true, void,
+                                 typename H::is_avalanching>::type>
+    : std::true_type {};
+
+// 其他类型：std::hash 的结果再混合一次
+template <typename T> struct hash {
+  typedef void is_avalanching;
+
+  std::size_t operator()(const T &v) const {
+    return static_cast<std::size_t>(hash_mix(std::hash<T>()(v)));
+  }
+};
+
+// 整数与枚举
+template <typename T> struct hash_integral {
+  typedef void is_avalanching;
+
+  std::size_t operator()(T v) const noexcept {
+    return static_cast<std::size_t>(hash_mix(static_cast<std::uint64_t>(v)));
+  }
+};
+
+#define TINYSTL_HASH_INTEGRAL(T)                                               \
+  template <> struct hash<T> : public hash_integral<T> {};
+TINYSTL_HASH_INTEGRAL(bool)
+TINYSTL_HASH_INTEGRAL(char)
+TINYSTL_HASH_INTEGRAL(signed char)
+TINYSTL_HASH_INTEGRAL(unsigned char)
+TINYSTL_HASH_INTEGRAL(wchar_t)
+TINYSTL_HASH_INTEGRAL(char16_t)
+TINYSTL_HASH_INTEGRAL(char32_t)
+TINYSTL_HASH_INTEGRAL(short)
+TINYSTL_HASH_INTEGRAL(unsigned short)
+TINYSTL_HASH_INTEGRAL(int)
+TINYSTL_HASH_INTEGRAL(unsigned int)
+TINYSTL_HASH_INTEGRAL(long)
+TINYSTL_HASH_INTEGRAL(unsigned long)
+TINYSTL_HASH_INTEGRAL(long long)
+TINYSTL_HASH_INTEGRAL(unsigned long long)
+#undef TINYSTL_HASH_INTEGRAL
+
+template <typename T> struct hash<T *> {
+  typedef void is_avalanching;
+
+  std::size_t operator()(T *p) const noexcept {
+    return static_cast<std::size_t>(
+        hash_mix(reinterpret_cast<std::uintptr_t>(p)));
+  }
+};
+
+// +0.0 与 -0.0 相等，哈希值也须相同
+template <typename T> struct hash_floating {
+  typedef void is_avalanching;
+
+  std::size_t operator()(T v) const noexcept {
+    if (v == T(0)) {
+      v = T(0);
+    }
+    return static_cast<std::size_t>(hash_bytes(&v, sizeof(v)));
+  }
+};
+template <> struct hash<float> : public hash_floating<float> {};
+template <> struct hash<double> : public hash_floating<double> {};
+template <> struct hash<long double> {
+  typedef void is_avalanching;
+
+  // long double 的填充字节未定义，退回 std::hash
+  std::size_t operator()(long double v) const noexcept {
+    return static_cast<std::size_t>(hash_mix(std::hash<long double>()(v)));
+  }
+};
+
+// 字符串：可直接用 string_view 或 C 字符串查找
+template <typename CharT, typename Traits, typename Alloc>
+struct hash<std::basic_string<CharT, Traits, Alloc>> {
+  typedef void is_avalanching;
+  typedef void is_transparent;
+
+  std::size_t operator()(const std::basic_string<CharT, Traits, Alloc> &s) const
+      noexcept {
+    return static_cast<std::size_t>(
+        hash_bytes(s.data(), s.size() * sizeof(CharT)));
+  }
+#if __cplusplus >= 201703L
+  std::size_t
+  operator()(std::basic_string_view<CharT, Traits> s) const noexcept {
+    return static_cast<std::size_t>(
+        hash_bytes(s.data(), s.size() * sizeof(CharT)));
+  }
+#endif
+  std::size_t operator()(const CharT *s) const noexcept {
+    return static_cast<std::size_t>(
+        hash_bytes(s, Traits::length(s) * sizeof(CharT)));
+  }
+};
+#if __cplusplus >= 201703L
+template <typename CharT, typename Traits>
+struct hash<std::basic_string_view<CharT, Traits>> {
+  typedef void is_avalanching;
+
+  std::size_t
+  operator()(std::basic_string_view<CharT, Traits> s) const noexcept {
+    return static_cast<std::size_t>(
+        hash_bytes(s.data(), s.size() * sizeof(CharT)));
+  }
+};
+#endif
+
+// pair（tinystl::pair 与 std::pair）与 tuple：逐个元素按顺序合并
+template <typename T1, typename T2> struct hash<tinystl::pair<T1, T2>> {
+  typedef void is_avalanching;
+
+  std::size_t operator()(const tinystl::pair<T1, T2> &p) const {
+    return hash_combine(hash<typename std::remove_cv<T1>::type>()(p.first),
+                        hash<typename std::remove_cv<T2>::type>()(p.second));
+  }
+};
+template <typename T1, typename T2> struct hash<std::pair<T1, T2>> {
+  typedef void is_avalanching;
+
+  std::size_t operator()(const std::pair<T1, T2> &p) const {
+    return hash_combine(hash<typename std::remove_cv<T1>::type>()(p.first),
+                        hash<typename std::remove_cv<T2>::type>()(p.second));
+  }
+};
+template <typename... Ts> struct hash<std::tuple<Ts...>> {
+  typedef void is_avalanching;
+
+  std::size_t operator()(const std::tuple<Ts...> &t) const {
+    return combine(t, std::index_sequence_for<Ts...>());
+  }
+
+private:
+  template <std::size_t... I>
+  static std::size_t combine(const std::tuple<Ts...> &t,
+                             std::index_sequence<I...>) {
+    std::size_t seed = sizeof...(Ts);
+    // 用数组初始化按顺序展开
+    int expand[] = {0, (seed = hash_combine(
+                            seed, hash<typename std::remove_cv<Ts>::type>()(
+                                      std::get<I>(t))),
+                        0)...};
+    (void)expand;
+    return seed;
+  }
+};
+} // namespace tinystl
+
+#endif
@@ -0,0 +1,813 @@
+#ifndef MYTINYSTL_HASHTABLE_H_
+#define MYTINYSTL_HASHTABLE_H_
+
+// 拉链法哈希表，unordered_map/set 等的底层实现。
+// 全部节点串成一条单链表，同一个桶的节点在链表中连续；桶中存放的是
+// 该桶第一个节点的前驱（第一个桶的前驱是表头 before_begin_），
+// 因此 begin() 为 O(1)，删除节点时只需在本桶内找前驱。
+// 节点中缓存哈希值，重建时不再调用哈希函数，也不会因其抛出异常而失败。
+// 桶数为 2 的幂，桶号取哈希值乘以 2^64 / 黄金比例后的高位（Fibonacci
+// hashing），对 std::hash 这类整数恒等映射也能分散开。
+// 节点来自容器独占的 node_pool；插入与重建都不移动节点，
+// 迭代器只在重建时失效，引用和指针始终有效，直到元素被删除。
+
+#include "allocator.h"
+#include "construct.h"
+#include "exceptdef.h"
+#include "functional.h"
+#include "iterator.h"
+#include "node_pool.h"
+#include "rb_tree.h"
+#include "type_traits.h"
+#include "util.h"
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <utility>
+
+namespace tinystl {
+struct hashtable_node_base {
+  hashtable_node_base *next;
+};
+
+template <typename T> struct hashtable_node : public hashtable_node_base {
+  std::size_t hash;
+  T value;
+};
+
+// shift 为 63 - log2(桶数)；先右移 shift 再右移 1，桶数为 1 时也不会移位溢出
+inline std::size_t hashtable_bucket_index(std::size_t hash, unsigned shift) {
+  std::uint64_t h = static_cast<std::uint64_t>(hash) * 0x9E3779B97F4A7C15ull;
+  return static_cast<std::size_t>(h >> shift >> 1);
+}
+
+template <typename T> struct hashtable_iterator;
+template <typename T> struct hashtable_const_iterator;
+
+template <typename T>
+struct hashtable_iterator : public tinystl::iterator<forward_iterator_tag, T> {
+  typedef T value_type;
+  typedef T &reference;
+  typedef T *pointer;
+  typedef hashtable_node_base *base_ptr;
+  typedef hashtable_node<T> *node_ptr;
+  typedef hashtable_iterator<T> self;
+
+  base_ptr node;
+
+  hashtable_iterator() : node(nullptr) {}
+  explicit hashtable_iterator(base_ptr p) : node(p) {}
+
+  reference operator*() const { return static_cast<node_ptr>(node)->value; }
+  pointer operator->() const { return std::addressof(operator*()); }
+
+  self &operator++() {
+    node = node->next;
+    return *this;
+  }
+  self operator++(int) {
+    self tmp = *this;
+    node = node->next;
+    return tmp;
+  }
+
+  bool operator==(const self &rhs) const { return node == rhs.node; }
+  bool operator!=(const self &rhs) const { return node != rhs.node; }
+};
+
+template <typename T>
+struct hashtable_const_iterator
+    : public tinystl::iterator<forward_iterator_tag, T> {
+  typedef T value_type;
+  typedef const T &reference;
+  typedef const T *pointer;
+  typedef hashtable_node_base *base_ptr;
+  typedef hashtable_node<T> *node_ptr;
+  typedef hashtable_const_iterator<T> self;
+
+  base_ptr node;
+
+  hashtable_const_iterator() : node(nullptr) {}
+  explicit hashtable_const_iterator(base_ptr p) : node(p) {}
+  hashtable_const_iterator(const hashtable_iterator<T> &it) : node(it.node) {}
+
+  reference operator*() const { return static_cast<node_ptr>(node)->value; }
+  pointer operator->() const { return std::addressof(operator*()); }
+
+  self &operator++() {
+    node = node->next;
+    return *this;
+  }
+  self operator++(int) {
+    self tmp = *this;
+    node = node->next;
+    return tmp;
+  }
+
+  bool operator==(const self &rhs) const { return node == rhs.node; }
+  bool operator!=(const self &rhs) const { return node != rhs.node; }
+};
+
+// 桶内迭代器：走到属于其他桶的节点即视为结束
+template <typename T>
+struct hashtable_local_iterator
+    : public tinystl::iterator<forward_iterator_tag, T> {
+  typedef T value_type;
+  typedef T &reference;
+  typedef T *pointer;
+  typedef hashtable_node_base *base_ptr;
+  typedef hashtable_node<T> *node_ptr;
+  typedef hashtable_local_iterator<T> self;
+
+  base_ptr node;
+  std::size_t bucket;
+  unsigned shift;
+
+  hashtable_local_iterator() : node(nullptr), bucket(0), shift(0) {}
+  hashtable_local_iterator(base_ptr p, std::size_t b, unsigned s)
+      : node(p), bucket(b), shift(s) {}
+
+  reference operator*() const { return static_cast<node_ptr>(node)->value; }
+  pointer operator->() const { return std::addressof(operator*()); }
+
+  self &operator++() {
+    node = node->next;
+    if (node != nullptr &&
+        hashtable_bucket_index(static_cast<node_ptr>(node)->hash, shift) !=
+            bucket) {
+      node = nullptr;
+    }
+    return *this;
+  }
+  self operator++(int) {
+    self tmp = *this;
+    ++*this;
+    return tmp;
+  }
+
+  bool operator==(const self &rhs) const { return node == rhs.node; }
+  bool operator!=(const self &rhs) const { return node != rhs.node; }
+};
+
+template <typename T>
+struct hashtable_const_local_iterator
+    : public tinystl::iterator<forward_iterator_tag, T> {
+  typedef T value_type;
+  typedef const T &reference;
+  typedef const T *pointer;
+  typedef hashtable_node_base *base_ptr;
+  typedef hashtable_node<T> *node_ptr;
+  typedef hashtable_const_local_iterator<T> self;
+
+  hashtable_local_iterator<T> it;
+
+  hashtable_const_local_iterator() {}
+  hashtable_const_local_iterator(const hashtable_local_iterator<T> &i)
+      : it(i) {}
+
+  reference operator*() const { return *it; }
+  pointer operator->() const { return std::addressof(*it); }
+
+  self &operator++() {
+    ++it;
+    return *this;
+  }
+  self operator++(int) {
+    self tmp = *this;
+    ++it;
+    return tmp;
+  }
+
+  bool operator==(const self &rhs) const { return it == rhs.it; }
+  bool operator!=(const self &rhs) const { return it != rhs.it; }
+};
+
+template <typename T, typename Hash, typename KeyEqual,
+          bool IsMap = tinystl::is_pair<T>::value>
+class hashtable {
+public:
+  typedef rb_tree_value_traits<T, IsMap> value_traits;
+  typedef typename value_traits::key_type key_type;
+  typedef typename value_traits::mapped_type mapped_type;
+  typedef typename value_traits::value_type value_type;
+  typedef value_type *pointer;
+  typedef const value_type *const_pointer;
+  typedef value_type &reference;
+  typedef const value_type &const_reference;
+  typedef std::size_t size_type;
+  typedef std::ptrdiff_t difference_type;
+  typedef Hash hasher;
+  typedef KeyEqual key_equal;
+
+  typedef hashtable_iterator<value_type> iterator;
+  typedef hashtable_const_iterator<value_type> const_iterator;
+  typedef hashtable_local_iterator<value_type> local_iterator;
+  typedef hashtable_const_local_iterator<value_type> const_local_iterator;
+
+private:
+  typedef hashtable_node_base *base_ptr;
+  typedef hashtable_node<value_type> *node_ptr;
+  typedef tinystl::allocator<base_ptr> bucket_allocator;
+
+  base_ptr *buckets_;
+  size_type bucket_count_;
+  unsigned shift_; // 63 - log2(bucket_count_)
+  hashtable_node_base before_begin_;
+  base_ptr single_bucket_; // 桶数为 1 时不另行分配
+  size_type size_;
+  float max_load_factor_;
+  size_type next_resize_; // 元素数超过它时扩容
+  tinystl::node_pool<hashtable_node<value_type>> pool_;
+  hasher hash_;
+  key_equal equal_;
+
+public:
+  hashtable() : hashtable(0) {}
+  explicit hashtable(size_type bucket_count, const hasher &hash = hasher(),
+                     const key_equal &equal = key_equal())
+      : buckets_(&single_bucket_), bucket_count_(1), shift_(63),
+        single_bucket_(nullptr), size_(0), max_load_factor_(1.0f),
+        next_resize_(1), hash_(hash), equal_(equal) {
+    before_begin_.next = nullptr;
+    if (bucket_count > 1) {
+      rehash_to(bucket_count_for(bucket_count));
+    }
+  }
+  hashtable(const hashtable &t);
+  hashtable(hashtable &&t) noexcept : hashtable(0, t.hash_, t.equal_) {
+    swap(t);
+  }
+
+  hashtable &operator=(const hashtable &t) {
+    if (this != &t) {
+      hashtable tmp(t);
+      swap(tmp);
+    }
+    return *this;
+  }
+  hashtable &operator=(hashtable &&t) noexcept {
+    if (this != &t) {
+      clear();
+      swap(t);
+    }
+    return *this;
+  }
+
+  ~hashtable() {
+    clear();
+    release_buckets();
+  }
+
+  iterator begin() noexcept { return iterator(before_begin_.next); }
+  const_iterator begin() const noexcept {
+    return const_iterator(before_begin_.next);
+  }
+  iterator end() noexcept { return iterator(nullptr); }
+  const_iterator end() const noexcept { return const_iterator(nullptr); }
+
+  bool empty() const noexcept { return size_ == 0; }
+  size_type size() const noexcept { return size_; }
+  size_type max_size() const noexcept {
+    return static_cast<size_type>(-1) / sizeof(hashtable_node<value_type>);
+  }
+
+  // 键值唯一：键 k 不存在时才以 args 构造元素，k 仅用于查找
+  template <typename K, typename... Args>
+  tinystl::pair<iterator, bool> emplace_key(const K &k, Args &&...args);
+  // 仅用于映射：键不存在时才以 args 构造映射值，否则 args 不被移动
+  template <typename KArg, typename... Args>
+  tinystl::pair<iterator, bool> try_emplace(KArg &&key, Args &&...args) {
+    size_type hash = hash_(key);
+    base_ptr prev = find_before(bucket_index(hash), key, hash);
+    if (prev != nullptr) {
+      return tinystl::pair<iterator, bool>(iterator(prev->next), false);
+    }
+    node_ptr p = create_node(std::forward<KArg>(key),
+                             mapped_type(std::forward<Args>(args)...));
+    return tinystl::pair<iterator, bool>(insert_unique_node(p, hash), true);
+  }
+  // 无法从参数直接得到键时先构造节点，键已存在再销毁
+  template <typename... Args>
+  tinystl::pair<iterator, bool> emplace_unique(Args &&...args);
+  // 键可重复：新元素插在与其等价的元素之前，等价元素始终相邻
+  template <typename... Args> iterator emplace_equal(Args &&...args);
+
+  iterator erase(const_iterator pos);
+  iterator erase(const_iterator first, const_iterator last) {
+    while (first != last) {
+      first = erase(first);
+    }
+    return iterator(last.node);
+  }
+  template <typename K> size_type erase_key(const K &k);
+  void clear() noexcept;
+
+  template <typename K> iterator find(const K &k) {
+    size_type hash = hash_(k);
+    base_ptr prev = find_before(bucket_index(hash), k, hash);
+    return prev == nullptr ? end() : iterator(prev->next);
+  }
+  template <typename K> const_iterator find(const K &k) const {
+    return const_cast<hashtable *>(this)->find(k);
+  }
+  template <typename K> size_type count(const K &k) const {
+    tinystl::pair<const_iterator, const_iterator> r = equal_range(k);
+    size_type n = 0;
+    for (; r.first != r.second; ++r.first) {
+      ++n;
+    }
+    return n;
+  }
+  template <typename K> bool contains(const K &k) const {
+    return find(k) != end();
+  }
+  template <typename K>
+  tinystl::pair<iterator, iterator> equal_range(const K &k);
+  template <typename K>
+  tinystl::pair<const_iterator, const_iterator> equal_range(const K &k) const {
+    tinystl::pair<iterator, iterator> r =
+        const_cast<hashtable *>(this)->equal_range(k);
+    return tinystl::pair<const_iterator, const_iterator>(r.first, r.second);
+  }
+
+  // 桶接口
+  size_type bucket_count() const noexcept { return bucket_count_; }
+  size_type max_bucket_count() const noexcept {
+    return static_cast<size_type>(-1) / sizeof(base_ptr);
+  }
+  size_type bucket_size(size_type n) const {
+    size_type count = 0;
+    for (const_local_iterator it = begin(n); it != end(n); ++it) {
+      ++count;
+    }
+    return count;
+  }
+  template <typename K> size_type bucket(const K &k) const {
+    return bucket_index(hash_(k));
+  }
+  local_iterator begin(size_type n) noexcept {
+    MY_DEBUG(n < bucket_count_);
+    return local_iterator(buckets_[n] == nullptr ? nullptr : buckets_[n]->next,
+                          n, shift_);
+  }
+  const_local_iterator begin(size_type n) const noexcept {
+    return const_cast<hashtable *>(this)->begin(n);
+  }
+  local_iterator end(size_type n) noexcept {
+    return local_iterator(nullptr, n, shift_);
+  }
+  const_local_iterator end(size_type n) const noexcept {
+    return const_cast<hashtable *>(this)->end(n);
+  }
+
+  float load_factor() const noexcept {
+    return static_cast<float>(size_) / static_cast<float>(bucket_count_);
+  }
+  float max_load_factor() const noexcept { return max_load_factor_; }
+  // 只调整扩容阈值，下次插入时若已超出才重建
+  void max_load_factor(float ml) {
+    MY_DEBUG(ml > 0);
+    max_load_factor_ = ml;
+    next_resize_ = resize_threshold(bucket_count_);
+  }
+  // 桶数至少为 n，且不低于容纳现有元素所需
+  void rehash(size_type n) {
+    size_type need = bucket_count_for(buckets_for_size(size_));
+    size_type count = bucket_count_for(n);
+    rehash_to(count > need ? count : need);
+  }
+  // 之后插入到共 n 个元素前都不会重建
+  void reserve(size_type n) { rehash(buckets_for_size(n)); }
+
+  hasher hash_function() const { return hash_; }
+  key_equal key_eq() const { return equal_; }
+
+  void swap(hashtable &t) noexcept;
+
+  // 等价元素的各段须互为排列，段内次序可以不同
+  friend bool operator==(const hashtable &lhs, const hashtable &rhs) {
+    if (lhs.size_ != rhs.size_) {
+      return false;
+    }
+    for (const_iterator it = lhs.begin(); it != lhs.end();) {
+      const key_type &k = key_of(*it);
+      const_iterator run_end = it;
+      size_type n = 0;
+      for (; run_end != lhs.end() && lhs.equal_(key_of(*run_end), k);
+           ++run_end) {
+        ++n;
+      }
+      tinystl::pair<const_iterator, const_iterator> r = rhs.equal_range(k);
+      for (const_iterator j = r.first; j != r.second; ++j) {
+        if (n-- == 0) {
+          return false;
+        }
+      }
+      if (n != 0 || !is_permutation(it, run_end, r.first)) {
+        return false;
+      }
+      it = run_end;
+    }
+    return true;
+  }
+
+private:
+  static const key_type &key_of(const value_type &v) {
+    return value_traits::get_key(v);
+  }
+  static node_ptr as_node(base_ptr p) { return static_cast<node_ptr>(p); }
+  size_type bucket_index(size_type hash) const {
+    return hashtable_bucket_index(hash, shift_);
+  }
+  size_type bucket_of(base_ptr p) const {
+    return bucket_index(as_node(p)->hash);
+  }
+  // 不小于 n 的 2 的幂
+  static size_type bucket_count_for(size_type n) {
+    size_type count = 1;
+    while (count < n) {
+      count *= 2;
+    }
+    return count;
+  }
+  size_type buckets_for_size(size_type n) const {
+    return static_cast<size_type>(
+        std::ceil(static_cast<double>(n) / max_load_factor_));
+  }
+  size_type resize_threshold(size_type count) const {
+    return static_cast<size_type>(static_cast<double>(count) *
+                                  max_load_factor_);
+  }
+
+  template <typename... Args> node_ptr create_node(Args &&...args);
+  void destory_node(node_ptr p) noexcept {
+    tinystl::destory(std::addressof(p->value));
+    pool_.deallocate(p);
+  }
+
+  // 桶 b 中与 k 等价的第一个节点的前驱，没有时返回 nullptr
+  template <typename K>
+  base_ptr find_before(size_type b, const K &k, size_type hash) const;
+  iterator insert_unique_node(node_ptr p, size_type hash);
+  void link_bucket_begin(size_type b, base_ptr p);
+  // 再插入一个元素前确保不超过负载因子，可能抛出异常
+  void reserve_one() {
+    if (size_ + 1 > next_resize_) {
+      size_type need = bucket_count_for(buckets_for_size(size_ + 1));
+      rehash_to(need > bucket_count_ * 2 ? need : bucket_count_ * 2);
+    }
+  }
+  void rehash_to(size_type count);
+  // 第一个节点所在的桶以表头为前驱，表头随对象而变
+  void fix_before_begin() noexcept {
+    if (before_begin_.next != nullptr) {
+      buckets_[bucket_of(before_begin_.next)] = &before_begin_;
+    }
+  }
+  void release_buckets() noexcept {
+    if (buckets_ != &single_bucket_) {
+      bucket_allocator::deallocate(buckets_);
+    }
+  }
+
+  template <typename I1, typename I2>
+  static bool is_permutation(I1 first, I1 last, I2 first2);
+};
+
+template <typename T, typename Hash, typename KeyEqual, bool IsMap>
+template <typename... Args>
+typename hashtable<T, Hash, KeyEqual, IsMap>::node_ptr
+hashtable<T, Hash, KeyEqual, IsMap>::create_node(Args &&...args) {
+  node_ptr p = pool_.allocate();
+  try {
+    tinystl::construct(std::addressof(p->value), std::forward<Args>(args)...);
+  } catch (...) {
+    pool_.deallocate(p);
+    throw;
+  }
+  p->next = nullptr;
+  return p;
+}
+
+template <typename T, typename Hash, typename KeyEqual, bool IsMap>
+template <typename K>
+typename hashtable<T, Hash, KeyEqual, IsMap>::base_ptr
+hashtable<T, Hash, KeyEqual, IsMap>::find_before(size_type b, const K &k,
+                                                 size_type hash) const {
+  base_ptr prev = buckets_[b];
+  if (prev == nullptr) {
+    return nullptr;
+  }
+  for (base_ptr p = prev->next; p != nullptr; prev = p, p = p->next) {
+    node_ptr n = as_node(p);
+    if (n->hash == hash && equal_(key_of(n->value), k)) {
+      return prev;
+    }
+    if (p->next != nullptr && bucket_of(p->next) != b) {
+      break;
+    }
+  }
+  return nullptr;
+}
+
+// 插到桶 b 的开头；b 原本为空时插到整条链表的开头，
+// 原来的第一个节点的桶改以 p 为前驱
+template <typename T, typename Hash, typename KeyEqual, bool IsMap>
+void hashtable<T, Hash, KeyEqual, IsMap>::link_bucket_begin(size_type b,
+                                                            base_ptr p) {
+  if (buckets_[b] != nullptr) {
+    p->next = buckets_[b]->next;
+    buckets_[b]->next = p;
+  } else {
+    p->next = before_begin_.next;
+    before_begin_.next = p;
+    if (p->next != nullptr) {
+      buckets_[bucket_of(p->next)] = p;
+    }
+    buckets_[b] = &before_begin_;
+  }
+}
+
+// 已确认键不存在；扩容失败时销毁节点，表保持原样
+template <typename T, typename Hash, typename KeyEqual, bool IsMap>
+typename hashtable<T, Hash, KeyEqual, IsMap>::iterator
+hashtable<T, Hash, KeyEqual, IsMap>::insert_unique_node(node_ptr p,
+                                                        size_type hash) {
+  try {
+    reserve_one();
+  } catch (...) {
+    destory_node(p);
+    throw;
+  }
+  p->hash = hash;
+  link_bucket_begin(bucket_index(hash), p);
+  ++size_;
+  return iterator(p);
+}
+
+template <typename T, typename Hash, typename KeyEqual, bool IsMap>
+template <typename K, typename... Args>
+tinystl::pair<typename hashtable<T, Hash, KeyEqual, IsMap>::iterator, bool>
+hashtable<T, Hash, KeyEqual, IsMap>::emplace_key(const K &k, Args &&...args) {
+  size_type hash = hash_(k);
+  base_ptr prev = find_before(bucket_index(hash), k, hash);
+  if (prev != nullptr) {
+    return tinystl::pair<iterator, bool>(iterator(prev->next), false);
+  }
+  node_ptr p = create_node(std::forward<Args>(args)...);
+  return tinystl::pair<iterator, bool>(insert_unique_node(p, hash), true);
+}
+
+template <typename T, typename Hash, typename KeyEqual, bool IsMap>
+template <typename... Args>
+tinystl::pair<typename hashtable<T, Hash, KeyEqual, IsMap>::iterator, bool>
+hashtable<T, Hash, KeyEqual, IsMap>::emplace_unique(Args &&...args) {
+  node_ptr p = create_node(std::forward<Args>(args)...);
+  size_type hash;
+  base_ptr prev;
+  try {
+    hash = hash_(key_of(p->value));
+    prev = find_before(bucket_index(hash), key_of(p->value), hash);
+  } catch (...) {
+    destory_node(p);
+    throw;
+  }
+  if (prev != nullptr) {
+    destory_node(p);
+    return tinystl::pair<iterator, bool>(iterator(prev->next), false);
+  }
+  return tinystl::pair<iterator, bool>(insert_unique_node(p, hash), true);
+}
+
+template <typename T, typename Hash, typename KeyEqual, bool IsMap>
+template <typename... Args>
+typename hashtable<T, Hash, KeyEqual, IsMap>::iterator
+hashtable<T, Hash, KeyEqual, IsMap>::emplace_equal(Args &&...args) {
+  node_ptr p = create_node(std::forward<Args>(args)...);
+  size_type hash;
+  try {
+    hash = hash_(key_of(p->value));
+    reserve_one();
+  } catch (...) {
+    destory_node(p);
+    throw;
+  }
+  p->hash = hash;
+  size_type b = bucket_index(hash);
+  base_ptr prev = find_before(b, key_of(p->value), hash);
+  if (prev != nullptr) {
+    p->next = prev->next;
+    prev->next = p;
+  } else {
+    link_bucket_begin(b, p);
+  }
+  ++size_;
+  return iterator(p);
+}
+
+// 若删除的是桶中第一个节点，本桶可能变空，下一个桶的前驱也随之改变
+template <typename T, typename Hash, typename KeyEqual, bool IsMap>
+typename hashtable<T, Hash, KeyEqual, IsMap>::iterator
+hashtable<T, Hash, KeyEqual, IsMap>::erase(const_iterator pos) {
+  base_ptr n = pos.node;
+  size_type b = bucket_of(n);
+  base_ptr prev = buckets_[b];
+  while (prev->next != n) {
+    prev = prev->next;
+  }
+  base_ptr next = n->next;
+  size_type next_b = next == nullptr ? b : bucket_of(next);
+  if (prev == buckets_[b]) {
+    if (next == nullptr || next_b != b) {
+      if (next != nullptr) {
+        buckets_[next_b] = prev;
+      }
+      buckets_[b] = nullptr;
+    }
+  } else if (next != nullptr && next_b != b) {
+    buckets_[next_b] = prev;
+  }
+  prev->next = next;
+  destory_node(as_node(n));
+  --size_;
+  return iterator(next);
+}
+
+// 先定出整段等价元素再删除，k 可以引用其中的元素
+template <typename T, typename Hash, typename KeyEqual, bool IsMap>
+template <typename K>
+typename hashtable<T, Hash, KeyEqual, IsMap>::size_type
+hashtable<T, Hash, KeyEqual, IsMap>::erase_key(const K &k) {
+  tinystl::pair<iterator, iterator> r = equal_range(k);
+  size_type n = 0;
+  for (const_iterator it = r.first; it != r.second; ++it) {
+    ++n;
+  }
+  erase(r.first, r.second);
+  return n;
+}
+
+template <typename T, typename Hash, typename KeyEqual, bool IsMap>
+template <typename K>
+tinystl::pair<typename hashtable<T, Hash, KeyEqual, IsMap>::iterator,
+              typename hashtable<T, Hash, KeyEqual, IsMap>::iterator>
+hashtable<T, Hash, KeyEqual, IsMap>::equal_range(const K &k) {
+  size_type hash = hash_(k);
+  base_ptr prev = find_before(bucket_index(hash), k, hash);
+  if (prev == nullptr) {
+    return tinystl::pair<iterator, iterator>(end(), end());
+  }
+  base_ptr last = prev->next->next;
+  while (last != nullptr && as_node(last)->hash == hash &&
+         equal_(key_of(as_node(last)->value), k)) {
+    last = last->next;
+  }
+  return tinystl::pair<iterator, iterator>(iterator(prev->next),
+                                           iterator(last));
+}
+
+// 节点内存随池一并归还
+template <typename T, typename Hash, typename KeyEqual, bool IsMap>
+void hashtable<T, Hash, KeyEqual, IsMap>::clear() noexcept {
+  for (base_ptr p = before_begin_.next; p != nullptr;) {
+    base_ptr next = p->next;
+    tinystl::destory(std::addressof(as_node(p)->value));
+    p = next;
+  }
+  pool_.release();
+  for (size_type i = 0; i < bucket_count_; ++i) {
+    buckets_[i] = nullptr;
+  }
+  before_begin_.next = nullptr;
+  size_ = 0;
+}
+
+// 按原链表顺序把节点逐个挂到新桶上；与上一个节点落在同一桶时紧跟其后，
+// 从而保持等价元素的相对次序。只有分配新桶数组可能抛出异常
+template <typename T, typename Hash, typename KeyEqual, bool IsMap>
+void hashtable<T, Hash, KeyEqual, IsMap>::rehash_to(size_type count) {
+  if (count == bucket_count_) {
+    next_resize_ = resize_threshold(count);
+    return;
+  }
+  unsigned shift = 63;
+  for (size_type c = count; c > 1; c /= 2) {
+    --shift;
+  }
+  base_ptr *buckets = &single_bucket_;
+  if (count > 1) {
+    buckets = bucket_allocator::allocate(count);
+  }
+  for (size_type i = 0; i < count; ++i) {
+    buckets[i] = nullptr;
+  }
+
+  base_ptr p = before_begin_.next;
+  before_begin_.next = nullptr;
+  base_ptr last = nullptr;
+  size_type last_b = 0;
+  while (p != nullptr) {
+    base_ptr next = p->next;
+    size_type b = hashtable_bucket_index(as_node(p)->hash, shift);
+    if (last != nullptr && last_b == b) {
+      p->next = last->next;
+      last->next = p;
+      if (p->next != nullptr) {
+        size_type nb = hashtable_bucket_index(as_node(p->next)->hash, shift);
+        if (nb != b) {
+          buckets[nb] = p;
+        }
+      }
+    } else if (buckets[b] == nullptr) {
+      p->next = before_begin_.next;
+      before_begin_.next = p;
+      if (p->next != nullptr) {
+        buckets[hashtable_bucket_index(as_node(p->next)->hash, shift)] = p;
+      }
+      buckets[b] = &before_begin_;
+    } else {
+      p->next = buckets[b]->next;
+      buckets[b]->next = p;
+    }
+    last = p;
+    last_b = b;
+    p = next;
+  }
+
+  release_buckets();
+  buckets_ = buckets;
+  bucket_count_ = count;
+  shift_ = shift;
+  next_resize_ = resize_threshold(count);
+}
+
+// 桶数相同，按原顺序依次接到链表尾部，每个桶的节点自然连续；
+// 委托构造已完成，中途抛出异常时由析构函数回收已复制的节点
+template <typename T, typename Hash, typename KeyEqual, bool IsMap>
+hashtable<T, Hash, KeyEqual, IsMap>::hashtable(const hashtable &t)
+    : hashtable(0, t.hash_, t.equal_) {
+  max_load_factor_ = t.max_load_factor_;
+  rehash_to(t.bucket_count_);
+  base_ptr tail = &before_begin_;
+  for (base_ptr q = t.before_begin_.next; q != nullptr; q = q->next) {
+    node_ptr p = create_node(as_node(q)->value);
+    p->hash = as_node(q)->hash;
+    size_type b = bucket_index(p->hash);
+    if (buckets_[b] == nullptr) {
+      buckets_[b] = tail;
+    }
+    tail->next = p;
+    tail = p;
+    ++size_;
+  }
+}
+
+// 桶数为 1 时桶放在对象内部，交换后要指回各自的 single_bucket_
+template <typename T, typename Hash, typename KeyEqual, bool IsMap>
+void hashtable<T, Hash, KeyEqual, IsMap>::swap(hashtable &t) noexcept {
+  bool single = buckets_ == &single_bucket_;
+  bool t_single = t.buckets_ == &t.single_bucket_;
+  std::swap(buckets_, t.buckets_);
+  std::swap(bucket_count_, t.bucket_count_);
+  std::swap(shift_, t.shift_);
+  std::swap(before_begin_.next, t.before_begin_.next);
+  std::swap(single_bucket_, t.single_bucket_);
+  std::swap(size_, t.size_);
+  std::swap(max_load_factor_, t.max_load_factor_);
+  std::swap(next_resize_, t.next_resize_);
+  pool_.swap(t.pool_);
+  std::swap(hash_, t.hash_);
+  std::swap(equal_, t.equal_);
+  if (t_single) {
+    buckets_ = &single_bucket_;
+  }
+  if (single) {
+    t.buckets_ = &t.single_bucket_;
+  }
+  fix_before_begin();
+  t.fix_before_begin();
+}
+
+template <typename T, typename Hash, typename KeyEqual, bool IsMap>
+template <typename I1, typename I2>
+bool hashtable<T, Hash, KeyEqual, IsMap>::is_permutation(I1 first, I1 last,
+                                                         I2 first2) {
+  for (I1 it = first; it != last; ++it) {
+    size_type n1 = 0;
+    size_type n2 = 0;
+    I2 last2 = first2;
+    for (I1 j = first; j != last; ++j, ++last2) {
+      n1 += *j == *it ? 1 : 0;
+      n2 += *last2 == *it ? 1 : 0;
+    }
+    if (n1 != n2) {
+      return false;
+    }
+  }
+  return true;
+}
+} // namespace tinystl
+
+#endif
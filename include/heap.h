@@ -1,181 +1,166 @@
 #ifndef MYTINYSTL_HEAP_H_
 #define MYTINYSTL_HEAP_H_
 
+// 堆算法，均为大顶堆（compare(a, b) 为真表示 a 排在 b 之下）。
+// 模板参数 Arity 为每个节点的子节点数，默认 2 即二叉堆，与以前的调用相同；
+// 节点 i 的父节点为 (i - 1) / Arity，子节点为 Arity * i + 1 起的 Arity 个。
+// Arity 为 4 或 8 时树高减为 1/2 或 1/3，同一节点的子节点相邻存放，
+// 多在同一条缓存行内：上浮（push_heap）与建堆明显更快；下沉（pop_heap）
+// 每层要在 Arity 个子节点中选最大的，层数少了但每层比较多了，
+// 4 与二叉基本持平，8 通常更慢。
+// 同一个序列上的各操作必须使用相同的 Arity。
+
+#include "functional.h"
 #include "iterator.h"
+#include <cstddef>
 #include <iostream>
+#include <utility>
 
 namespace tinystl {
-template <typename RandomAccessIterator, typename Distance, typename T>
-void push_heap_aux(RandomAccessIterator first, Distance hole_index,
-                   Distance top_index, T value) {
-  auto parent = (hole_index - 1) / 2;
-  while (hole_index > top_index && *(first + parent) < value) {
-    *(first + hole_index) = *(first + parent);
-    hole_index = parent;
-    parent = (hole_index - 1) / 2;
-  }
-  *(first + hole_index) = value;
-}
-
-template <typename RandomAccessIterator, typename Distance>
-void push_heap_d(RandomAccessIterator first, RandomAccessIterator last,
-                 Distance *) {
-  push_heap_aux(first, static_cast<Distance>(last - first - 1),
-                static_cast<Distance>(0), *(last - 1));
-}
-
-template <typename RandomAccessIterator>
-void push_heap(RandomAccessIterator first, RandomAccessIterator last) {
-  push_heap_d(first, last, tinystl::distance_type(first));
-}
-
-template <typename RandomAccessIterator, typename Distance, typename T,
-          typename Compare>
+template <std::size_t Arity, typename RandomAccessIterator, typename Distance,
+          typename T, typename Compare>
 void push_heap_aux(RandomAccessIterator first, Distance hole_index,
                    Distance top_index, T value, Compare compare) {
-  auto parent = (hole_index - 1) / 2;
+  const Distance arity = static_cast<Distance>(Arity);
+  Distance parent = (hole_index - 1) / arity;
   while (hole_index > top_index && compare(*(first + parent), value)) {
-    *(first + hole_index) = *(first + parent);
+    *(first + hole_index) = std::move(*(first + parent));
     hole_index = parent;
-    parent = (hole_index - 1) / 2;
+    parent = (hole_index - 1) / arity;
   }
-  *(first + hole_index) = value;
+  *(first + hole_index) = std::move(value);
 }
 
-template <typename RandomAccessIterator, typename Distance, typename Compare>
+template <std::size_t Arity, typename RandomAccessIterator, typename Distance,
+          typename Compare>
 void push_heap_d(RandomAccessIterator first, RandomAccessIterator last,
                  Distance *, Compare compare) {
-  push_heap_aux(first, static_cast<Distance>(last - first - 1),
-                static_cast<Distance>(0), *(last - 1), compare);
+  push_heap_aux<Arity>(first, static_cast<Distance>(last - first - 1),
+                       static_cast<Distance>(0), std::move(*(last - 1)),
+                       compare);
 }
 
-template <typename RandomAccessIterator, typename Compare>
+template <std::size_t Arity = 2, typename RandomAccessIterator,
+          typename Compare>
 void push_heap(RandomAccessIterator first, RandomAccessIterator last,
                Compare compare) {
-  push_heap_d(first, last, tinystl::distance_type(first), compare);
+  static_assert(Arity >= 2, "heap arity must be at least 2");
+  push_heap_d<Arity>(first, last, tinystl::distance_type(first), compare);
 }
 
-template <typename RandomAccessIterator, typename T, typename Distance>
-void adjust_heap(RandomAccessIterator first, Distance hole_index, Distance len,
-                 T value) {
-  auto top_index = hole_index;
-  auto rchild = 2 * (hole_index + 1);
-  while (rchild < len) {
-    if (*(first + rchild - 1) > *(first + rchild)) {
-      --rchild;
-    }
-    *(first + hole_index) = *(first + rchild);
-    hole_index = rchild;
-    rchild = 2 * (hole_index + 1);
-  }
-  if (rchild == len) {
-    *(first + hole_index) = *(first + rchild - 1);
-    hole_index = rchild - 1;
-  }
-  push_heap_aux(first, hole_index, top_index, value);
-}
-
-template <typename RandomAccessIterator, typename T, typename Distance>
-void pop_heap_aux(RandomAccessIterator first, RandomAccessIterator last,
-                  RandomAccessIterator result, T value, Distance *) {
-  *result = *first;
-  adjust_heap(first, static_cast<Distance>(0), last - first, value);
+template <std::size_t Arity = 2, typename RandomAccessIterator>
+void push_heap(RandomAccessIterator first, RandomAccessIterator last) {
+  tinystl::push_heap<Arity>(first, last, tinystl::less<>());
 }
 
-template <typename RandomAccessIterator>
-void pop_heap(RandomAccessIterator first, RandomAccessIterator last) {
-  pop_heap_aux(first, last - 1, last - 1, *(last - 1),
-               tinystl::distance_type(first));
+// [child, end) 中最大的一个的下标，end - child 不超过 Arity
+template <typename RandomAccessIterator, typename Distance, typename Compare>
+Distance heap_max_child(RandomAccessIterator first, Distance child,
+                        Distance end, Compare compare) {
+  Distance best = child;
+  for (++child; child < end; ++child) {
+    // 写成条件表达式，整数等简单类型可以编译为条件传送，避免分支预测失败
+    best = compare(*(first + best), *(first + child)) ? child : best;
+  }
+  return best;
 }
 
-template <typename RandomAccessIterator, typename T, typename Distance,
-          typename Compare>
+// 先把空位沿较大的子节点一路下沉到叶子，再把 value 从那里上浮：
+// 被调整的值通常来自堆底，上浮很少超过一两层，比逐层与 value 比较要省
+template <std::size_t Arity, typename RandomAccessIterator, typename T,
+          typename Distance, typename Compare>
 void adjust_heap(RandomAccessIterator first, Distance hole_index, Distance len,
                  T value, Compare compare) {
-  auto rchild = 2 * (hole_index + 1);
-  while (rchild < len) {
-    if (compare(*(first + rchild), *(first + rchild - 1))) {
-      --rchild;
-    }
-    *(first + hole_index) = *(first + rchild);
-    hole_index = rchild;
-    rchild = 2 * (hole_index + 1);
+  const Distance arity = static_cast<Distance>(Arity);
+  const Distance top_index = hole_index;
+  Distance child = arity * hole_index + 1;
+  // 子节点齐全时 Arity 为常量，比较可以完全展开
+  while (child <= len - arity) {
+    child = tinystl::heap_max_child(first, child, child + arity, compare);
+    *(first + hole_index) = std::move(*(first + child));
+    hole_index = child;
+    child = arity * hole_index + 1;
   }
-  if (rchild == len) {
-    *(first + hole_index) = *(first + rchild - 1);
-    hole_index = rchild - 1;
+  if (child < len) {
+    child = tinystl::heap_max_child(first, child, len, compare);
+    *(first + hole_index) = std::move(*(first + child));
+    hole_index = child;
   }
-  push_heap_aux(first, hole_index, hole_index, value);
+  push_heap_aux<Arity>(first, hole_index, top_index, std::move(value),
+                       compare);
 }
 
-template <typename RandomAccessIterator, typename T, typename Distance,
-          typename Compare>
+template <std::size_t Arity, typename RandomAccessIterator, typename T,
+          typename Distance, typename Compare>
 void pop_heap_aux(RandomAccessIterator first, RandomAccessIterator last,
                   RandomAccessIterator result, T value, Distance *,
                   Compare compare) {
-  *result = *first;
-  adjust_heap(first, static_cast<Distance>(0), last - first, value, compare);
+  *result = std::move(*first);
+  adjust_heap<Arity>(first, static_cast<Distance>(0),
+                     static_cast<Distance>(last - first), std::move(value),
+                     compare);
 }
 
-template <typename RandomAccessIterator, typename Compare>
+template <std::size_t Arity = 2, typename RandomAccessIterator,
+          typename Compare>
 void pop_heap(RandomAccessIterator first, RandomAccessIterator last,
               Compare compare) {
-  pop_heap_aux(first, last - 1, last - 1, *(last - 1),
-               tinystl::distance_type(first), compare);
+  static_assert(Arity >= 2, "heap arity must be at least 2");
+  if (last - first < 2) {
+    return;
+  }
+  pop_heap_aux<Arity>(first, last - 1, last - 1, std::move(*(last - 1)),
+                      tinystl::distance_type(first), compare);
 }
 
-template <typename RandomAccessIterator>
-void sort_heap(RandomAccessIterator first, RandomAccessIterator last) {
-  while (last - first > 1) {
-    pop_heap(first, last--);
-  }
+template <std::size_t Arity = 2, typename RandomAccessIterator>
+void pop_heap(RandomAccessIterator first, RandomAccessIterator last) {
+  tinystl::pop_heap<Arity>(first, last, tinystl::less<>());
 }
-template <typename RandomAccessIterator, typename Compare>
+
+template <std::size_t Arity = 2, typename RandomAccessIterator,
+          typename Compare>
 void sort_heap(RandomAccessIterator first, RandomAccessIterator last,
                Compare compare) {
   while (last - first > 1) {
-    pop_heap(first, last--, compare);
+    tinystl::pop_heap<Arity>(first, last--, compare);
   }
 }
 
-template <typename RandomAccessIterator, typename Distance>
-void make_heap_aux(RandomAccessIterator first, RandomAccessIterator last,
-                   Distance *) {
-  Distance len = last - first;
-  if (len < 2) {
-    return;
-  }
-  auto hole_index = (len - 2) / 2;
-  while (hole_index >= 0) {
-    adjust_heap(first, hole_index, len, *(first + hole_index));
-    --hole_index;
-  }
-}
-
-template <typename RandomAccessIterator>
-void make_heap(RandomAccessIterator first, RandomAccessIterator last) {
-  make_heap_aux(first, last, distance_type(first));
+template <std::size_t Arity = 2, typename RandomAccessIterator>
+void sort_heap(RandomAccessIterator first, RandomAccessIterator last) {
+  tinystl::sort_heap<Arity>(first, last, tinystl::less<>());
 }
 
-template <typename RandomAccessIterator, typename Distance, typename Compare>
+template <std::size_t Arity, typename RandomAccessIterator, typename Distance,
+          typename Compare>
 void make_heap_aux(RandomAccessIterator first, RandomAccessIterator last,
                    Distance *, Compare compare) {
   Distance len = last - first;
   if (len < 2) {
     return;
   }
-  auto hole_index = (len - 2) / 2;
+  // 最后一个有子节点的节点
+  Distance hole_index = (len - 2) / static_cast<Distance>(Arity);
   while (hole_index >= 0) {
-    adjust_heap(first, hole_index, len, *(first + hole_index), compare);
+    adjust_heap<Arity>(first, hole_index, len, std::move(*(first + hole_index)),
+                       compare);
     --hole_index;
   }
 }
 
-template <typename RandomAccessIterator, typename Compare>
+template <std::size_t Arity = 2, typename RandomAccessIterator,
+          typename Compare>
 void make_heap(RandomAccessIterator first, RandomAccessIterator last,
                Compare compare) {
-  make_heap_aux(first, last, distance_type(first), compare);
+  static_assert(Arity >= 2, "heap arity must be at least 2");
+  make_heap_aux<Arity>(first, last, tinystl::distance_type(first), compare);
+}
+
+template <std::size_t Arity = 2, typename RandomAccessIterator>
+void make_heap(RandomAccessIterator first, RandomAccessIterator last) {
+  tinystl::make_heap<Arity>(first, last, tinystl::less<>());
 }
 } // namespace tinystl
 
-#endif
\ No newline at end of file
+#endif
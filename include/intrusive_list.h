@@ -0,0 +1,220 @@
+#ifndef MYTINYSTL_INTRUSIVE_LIST_H_
+#define MYTINYSTL_INTRUSIVE_LIST_H_
+
+// 侵入式双向链表：元素类型 T 以 list_node_base<Tag> 作为基类（钩子），
+// 链表只负责链接与摘除钩子，从不分配内存、也不拷贝或析构元素，
+// 元素的生命周期由使用者（如对象池）管理。
+// 一个对象继承多个不同 Tag 的钩子即可同时位于多个链表中，例如：
+//   struct order : list_node_base<by_time>, list_node_base<by_price> {...};
+//   intrusive_list<order, by_time> l1; intrusive_list<order, by_price> l2;
+
+#include "exceptdef.h"
+#include "iterator.h"
+#include "list.h"
+#include <cstddef>
+#include <type_traits>
+
+namespace tinystl {
+template <typename T, typename Tag>
+struct intrusive_list_iterator
+    : public tinystl::iterator<tinystl::bidirectional_iterator_tag, T> {
+public:
+  typedef list_node_base<Tag> *base_ptr;
+  typedef T value_type;
+  typedef T &reference;
+  typedef T *pointer;
+  typedef intrusive_list_iterator<T, Tag> self;
+
+  base_ptr node_;
+
+  intrusive_list_iterator() : node_(nullptr) {}
+  intrusive_list_iterator(base_ptr t) : node_(t) {}
+  template <typename U,
+            typename std::enable_if<std::is_same<const U, T>::value,
+                                    int>::type = 0>
+  intrusive_list_iterator(const intrusive_list_iterator<U, Tag> &t)
+      : node_(t.node_) {}
+
+  reference operator*() const { return static_cast<reference>(*node_); }
+  pointer operator->() const { return &*(*this); }
+
+  self &operator++() {
+    MY_DEBUG(node_ != nullptr);
+    node_ = node_->next;
+    return *this;
+  }
+  self operator++(int) {
+    self tmp = *this;
+    node_ = node_->next;
+    return tmp;
+  }
+  self &operator--() {
+    MY_DEBUG(node_ != nullptr);
+    node_ = node_->pre;
+    return *this;
+  }
+  self operator--(int) {
+    self tmp = *this;
+    node_ = node_->pre;
+    return tmp;
+  }
+
+  bool operator==(const self &t) const { return node_ == t.node_; }
+  bool operator!=(const self &t) const { return node_ != t.node_; }
+};
+
+template <typename T, typename Tag = T> class intrusive_list {
+public:
+  typedef list_node_base<Tag> hook_type;
+  typedef hook_type *base_ptr;
+
+  typedef T value_type;
+  typedef T *pointer;
+  typedef T &reference;
+  typedef const T &const_reference;
+  typedef std::ptrdiff_t difference_type;
+  typedef std::size_t size_type;
+
+  typedef intrusive_list_iterator<T, Tag> iterator;
+  typedef intrusive_list_iterator<const T, Tag> const_iterator;
+
+  static_assert(std::is_base_of<hook_type, T>::value,
+                "T must derive from list_node_base<Tag>");
+
+private:
+  hook_type header_;
+  size_type size_;
+
+protected:
+  static base_ptr hook_of(reference t) { return static_cast<base_ptr>(&t); }
+  static void unlink_one(base_ptr node) {
+    list_unlink(node, node);
+    node->un_link();
+  }
+  void take_all(intrusive_list &l);
+
+public:
+  intrusive_list() : size_(0) { header_.un_link(); }
+  intrusive_list(const intrusive_list &) = delete;
+  intrusive_list(intrusive_list &&l) noexcept : size_(0) {
+    header_.un_link();
+    take_all(l);
+  }
+  intrusive_list &operator=(const intrusive_list &) = delete;
+  intrusive_list &operator=(intrusive_list &&l) noexcept {
+    if (this != &l) {
+      clear();
+      take_all(l);
+    }
+    return *this;
+  }
+  ~intrusive_list() { clear(); }
+
+  iterator begin() noexcept { return header_.next; }
+  iterator end() noexcept { return &header_; }
+  const_iterator begin() const noexcept {
+    return const_cast<base_ptr>(header_.next);
+  }
+  const_iterator end() const noexcept {
+    return const_cast<base_ptr>(&header_);
+  }
+
+  bool empty() const noexcept { return header_.next == &header_; }
+  size_type size() const noexcept { return size_; }
+
+  reference front() {
+    MY_DEBUG(!empty());
+    return *begin();
+  }
+  reference back() {
+    MY_DEBUG(!empty());
+    return *iterator(header_.pre);
+  }
+
+  static iterator iterator_to(reference t) { return hook_of(t); }
+  static const_iterator iterator_to(const_reference t) {
+    return hook_of(const_cast<reference>(t));
+  }
+
+  iterator insert(const_iterator pos, reference t) {
+    base_ptr node = hook_of(t);
+    list_link_before(pos.node_, node, node);
+    ++size_;
+    return node;
+  }
+  void push_front(reference t) { insert(begin(), t); }
+  void push_back(reference t) { insert(end(), t); }
+
+  // erase 只摘除钩子，不析构元素
+  iterator erase(const_iterator pos) {
+    MY_DEBUG(pos != end());
+    base_ptr next = pos.node_->next;
+    unlink_one(pos.node_);
+    --size_;
+    return next;
+  }
+  iterator erase(const_iterator first, const_iterator last) {
+    while (first != last) {
+      first = erase(first);
+    }
+    return last.node_;
+  }
+  void remove(reference t) { erase(iterator_to(t)); }
+  void pop_front() { erase(begin()); }
+  void pop_back() { erase(header_.pre); }
+
+  void clear() noexcept;
+
+  void splice(const_iterator pos, intrusive_list &l);
+  void splice(const_iterator pos, intrusive_list &l, const_iterator it);
+};
+
+template <typename T, typename Tag>
+void intrusive_list<T, Tag>::take_all(intrusive_list &l) {
+  if (!l.empty()) {
+    base_ptr first = l.header_.next;
+    base_ptr last = l.header_.pre;
+    list_unlink(first, last);
+    list_link_before(&header_, first, last);
+    size_ += l.size_;
+    l.size_ = 0;
+  }
+}
+template <typename T, typename Tag>
+void intrusive_list<T, Tag>::clear() noexcept {
+  base_ptr cur = header_.next;
+  while (cur != &header_) {
+    base_ptr next = cur->next;
+    cur->un_link();
+    cur = next;
+  }
+  header_.un_link();
+  size_ = 0;
+}
+template <typename T, typename Tag>
+void intrusive_list<T, Tag>::splice(const_iterator pos, intrusive_list &l) {
+  if (this == &l || l.empty()) {
+    return;
+  }
+  base_ptr first = l.header_.next;
+  base_ptr last = l.header_.pre;
+  list_unlink(first, last);
+  list_link_before(pos.node_, first, last);
+  size_ += l.size_;
+  l.size_ = 0;
+}
+template <typename T, typename Tag>
+void intrusive_list<T, Tag>::splice(const_iterator pos, intrusive_list &l,
+                                    const_iterator it) {
+  base_ptr node = it.node_;
+  if (node == pos.node_ || node->next == pos.node_) {
+    return;
+  }
+  list_unlink(node, node);
+  list_link_before(pos.node_, node, node);
+  ++size_;
+  --l.size_;
+}
+} // namespace tinystl
+
+#endif
@@ -0,0 +1,275 @@
+#ifndef MYTINYSTL_INTRUSIVE_RB_TREE_H_
+#define MYTINYSTL_INTRUSIVE_RB_TREE_H_
+
+// 侵入式红黑树：元素类型 T 以 rb_tree_node_base<Tag> 作为基类（钩子），
+// 插入与删除直接复用 rb_tree.h 中的 rb_tree_insert_at /
+// rb_tree_erase_rebalance，从不分配内存、也不拷贝或析构元素。
+// Compare 直接比较两个 T；不同 Tag 的钩子可让同一对象同时位于多棵树中。
+
+#include "exceptdef.h"
+#include "functional.h"
+#include "iterator.h"
+#include "rb_tree.h"
+#include "util.h"
+#include <cstddef>
+#include <type_traits>
+
+namespace tinystl {
+template <typename T, typename Tag>
+struct intrusive_rb_tree_iterator : public rb_tree_iterator_base<Tag> {
+  typedef rb_tree_node_base<Tag> *base_ptr;
+  typedef T value_type;
+  typedef T &reference;
+  typedef T *pointer;
+  typedef intrusive_rb_tree_iterator<T, Tag> self;
+
+  using rb_tree_iterator_base<Tag>::node;
+
+  intrusive_rb_tree_iterator() {}
+  intrusive_rb_tree_iterator(base_ptr ptr) { node = ptr; }
+  template <typename U,
+            typename std::enable_if<std::is_same<const U, T>::value,
+                                    int>::type = 0>
+  intrusive_rb_tree_iterator(const intrusive_rb_tree_iterator<U, Tag> &t) {
+    node = t.node;
+  }
+
+  self &operator++() {
+    this->inc();
+    return *this;
+  }
+  self operator++(int) {
+    self tmp = *this;
+    this->inc();
+    return tmp;
+  }
+  self &operator--() {
+    this->dec();
+    return *this;
+  }
+  self operator--(int) {
+    self tmp = *this;
+    this->dec();
+    return tmp;
+  }
+  reference operator*() const { return static_cast<reference>(*node); }
+  pointer operator->() const { return &*(*this); }
+};
+
+template <typename T, typename Compare = tinystl::less<T>, typename Tag = T>
+class intrusive_rb_tree {
+public:
+  typedef rb_tree_node_base<Tag> hook_type;
+  typedef hook_type *base_ptr;
+
+  typedef T value_type;
+  typedef T *pointer;
+  typedef T &reference;
+  typedef const T &const_reference;
+  typedef std::size_t size_type;
+  typedef std::ptrdiff_t difference_type;
+  typedef Compare key_compare;
+
+  typedef intrusive_rb_tree_iterator<T, Tag> iterator;
+  typedef intrusive_rb_tree_iterator<const T, Tag> const_iterator;
+
+  static_assert(std::is_base_of<hook_type, T>::value,
+                "T must derive from rb_tree_node_base<Tag>");
+
+private:
+  hook_type header_;
+  size_type node_count_;
+  key_compare key_comp_;
+
+protected:
+  base_ptr header() const { return const_cast<base_ptr>(&header_); }
+  base_ptr &root() { return header_.parent; }
+  static base_ptr hook_of(reference t) { return static_cast<base_ptr>(&t); }
+  static const_reference value(base_ptr p) {
+    return static_cast<const_reference>(*p);
+  }
+  void tree_init() {
+    header_.color = rb_tree_red; // 用于区分 header 与根节点，见 dec()
+    header_.parent = nullptr;
+    header_.left = &header_;
+    header_.right = &header_;
+    node_count_ = 0;
+  }
+  void take_all(intrusive_rb_tree &t);
+  static void reset_hooks(base_ptr);
+
+public:
+  intrusive_rb_tree() { tree_init(); }
+  explicit intrusive_rb_tree(const key_compare &comp) : key_comp_(comp) {
+    tree_init();
+  }
+  intrusive_rb_tree(const intrusive_rb_tree &) = delete;
+  intrusive_rb_tree(intrusive_rb_tree &&t) noexcept : key_comp_(t.key_comp_) {
+    tree_init();
+    take_all(t);
+  }
+  intrusive_rb_tree &operator=(const intrusive_rb_tree &) = delete;
+  intrusive_rb_tree &operator=(intrusive_rb_tree &&t) noexcept {
+    if (this != &t) {
+      clear();
+      key_comp_ = t.key_comp_;
+      take_all(t);
+    }
+    return *this;
+  }
+  ~intrusive_rb_tree() { clear(); }
+
+  iterator begin() noexcept { return header_.left; }
+  iterator end() noexcept { return &header_; }
+  const_iterator begin() const noexcept { return header_.left; }
+  const_iterator end() const noexcept { return header(); }
+
+  bool empty() const noexcept { return node_count_ == 0; }
+  size_type size() const noexcept { return node_count_; }
+  key_compare key_comp() const { return key_comp_; }
+
+  static iterator iterator_to(reference t) { return hook_of(t); }
+  static const_iterator iterator_to(const_reference t) {
+    return hook_of(const_cast<reference>(t));
+  }
+
+  // 插入只链接钩子并重新平衡
+  tinystl::pair<iterator, bool> insert_unique(reference t);
+  iterator insert_equal(reference t);
+
+  // 删除只摘除钩子，不析构元素
+  iterator erase(const_iterator pos);
+  iterator erase(const_iterator first, const_iterator last) {
+    while (first != last) {
+      first = erase(first);
+    }
+    return last.node;
+  }
+  void remove(reference t) { erase(iterator_to(t)); }
+  void clear() noexcept;
+
+  iterator lower_bound(const_reference k);
+  iterator upper_bound(const_reference k);
+  iterator find(const_reference k) {
+    iterator j = lower_bound(k);
+    return (j == end() || key_comp_(k, *j)) ? end() : j;
+  }
+  tinystl::pair<iterator, iterator> equal_range(const_reference k) {
+    return tinystl::pair<iterator, iterator>(lower_bound(k), upper_bound(k));
+  }
+  size_type count(const_reference k) {
+    return tinystl::distance(lower_bound(k), upper_bound(k));
+  }
+};
+
+template <typename T, typename Compare, typename Tag>
+void intrusive_rb_tree<T, Compare, Tag>::take_all(intrusive_rb_tree &t) {
+  if (t.node_count_ != 0) {
+    header_.parent = t.header_.parent;
+    header_.left = t.header_.left;
+    header_.right = t.header_.right;
+    header_.parent->parent = &header_;
+    node_count_ = t.node_count_;
+    t.tree_init();
+  }
+}
+template <typename T, typename Compare, typename Tag>
+void intrusive_rb_tree<T, Compare, Tag>::reset_hooks(base_ptr x) {
+  while (x != nullptr) {
+    reset_hooks(x->right);
+    base_ptr y = x->left;
+    x->parent = x->left = x->right = nullptr;
+    x = y;
+  }
+}
+template <typename T, typename Compare, typename Tag>
+void intrusive_rb_tree<T, Compare, Tag>::clear() noexcept {
+  reset_hooks(root());
+  tree_init();
+}
+template <typename T, typename Compare, typename Tag>
+tinystl::pair<typename intrusive_rb_tree<T, Compare, Tag>::iterator, bool>
+intrusive_rb_tree<T, Compare, Tag>::insert_unique(reference t) {
+  base_ptr y = header();
+  base_ptr x = root();
+  bool add_left = true;
+  while (x != nullptr) {
+    y = x;
+    add_left = key_comp_(t, value(x));
+    x = add_left ? x->left : x->right;
+  }
+  iterator j(y);
+  if (add_left) {
+    if (j == begin()) {
+      rb_tree_insert_at(header(), y, hook_of(t), true);
+      ++node_count_;
+      return tinystl::pair<iterator, bool>(hook_of(t), true);
+    }
+    --j;
+  }
+  if (key_comp_(*j, t)) {
+    rb_tree_insert_at(header(), y, hook_of(t), add_left);
+    ++node_count_;
+    return tinystl::pair<iterator, bool>(hook_of(t), true);
+  }
+  return tinystl::pair<iterator, bool>(j, false);
+}
+template <typename T, typename Compare, typename Tag>
+typename intrusive_rb_tree<T, Compare, Tag>::iterator
+intrusive_rb_tree<T, Compare, Tag>::insert_equal(reference t) {
+  base_ptr y = header();
+  base_ptr x = root();
+  bool add_left = true;
+  while (x != nullptr) {
+    y = x;
+    add_left = key_comp_(t, value(x));
+    x = add_left ? x->left : x->right;
+  }
+  rb_tree_insert_at(header(), y, hook_of(t), add_left);
+  ++node_count_;
+  return hook_of(t);
+}
+template <typename T, typename Compare, typename Tag>
+typename intrusive_rb_tree<T, Compare, Tag>::iterator
+intrusive_rb_tree<T, Compare, Tag>::erase(const_iterator pos) {
+  MY_DEBUG(pos != end());
+  iterator next(pos.node);
+  ++next;
+  base_ptr node = rb_tree_erase_rebalance(pos.node, header());
+  node->parent = node->left = node->right = nullptr;
+  --node_count_;
+  return next;
+}
+template <typename T, typename Compare, typename Tag>
+typename intrusive_rb_tree<T, Compare, Tag>::iterator
+intrusive_rb_tree<T, Compare, Tag>::lower_bound(const_reference k) {
+  base_ptr y = header();
+  base_ptr x = root();
+  while (x != nullptr) {
+    if (!key_comp_(value(x), k)) {
+      y = x;
+      x = x->left;
+    } else {
+      x = x->right;
+    }
+  }
+  return y;
+}
+template <typename T, typename Compare, typename Tag>
+typename intrusive_rb_tree<T, Compare, Tag>::iterator
+intrusive_rb_tree<T, Compare, Tag>::upper_bound(const_reference k) {
+  base_ptr y = header();
+  base_ptr x = root();
+  while (x != nullptr) {
+    if (key_comp_(k, value(x))) {
+      y = x;
+      x = x->left;
+    } else {
+      x = x->right;
+    }
+  }
+  return y;
+}
+} // namespace tinystl
+
+#endif
@@ -122,13 +122,17 @@ public:
   reverse_iterator(const reverse_iterator &riter) : current(riter.current) {}
 
 public:
-  reference operator*() { return *(current - 1); }
-  pointer operator->() { return &*(current - 1); }
+  // 只用 --，双向迭代器（list、rb_tree）也可使用
+  reference operator*() const {
+    iterator tmp = current;
+    return *--tmp;
+  }
+  pointer operator->() const { return &*(*this); }
   reverse_iterator &operator++() {
     --current;
     return *this;
   }
-  reverse_iterator &operator++(int) {
+  reverse_iterator operator++(int) {
     reverse_iterator tmp = *this;
     --current;
     return tmp;
@@ -137,7 +141,7 @@ public:
     ++current;
     return *this;
   }
-  reverse_iterator &operator--(int) {
+  reverse_iterator operator--(int) {
     reverse_iterator tmp = *this;
     ++current;
     return tmp;
@@ -2,13 +2,27 @@
 #define MYTINYSTL_LIST_H
 #include "allocator.h"
 #include "exceptdef.h"
+#include "functional.h"
 #include "iterator.h"
+#include "node_handle.h"
 #include <cstddef>
+#include <cstdint>
+#include <new>
 #include <initializer_list>
 #include <type_traits>
 #include <utility>
 
 namespace tinystl {
+
+// 批量插入的节点数不少于该值时，节点从同一块连续内存中切分
+#ifndef LIST_SLAB_MIN_NODES_
+#define LIST_SLAB_MIN_NODES_ 16
+#endif
+// 每个内存块中节点区域的最大字节数；一个存活的节点至多使一块内存无法释放
+#ifndef LIST_SLAB_BYTES_
+#define LIST_SLAB_BYTES_ 65536
+#endif
+
 template <typename T> struct list_node_base;
 template <typename T> struct list_node;
 
@@ -45,6 +59,84 @@ public:
   node_ptr self() { return static_cast<node_ptr>(&(this)); }
 };
 
+// 批量构造节点时分配的内存块的头部，位于块内最后一个节点之后。
+// 块从按 window 字节对齐的位置起划分为若干窗口，每个窗口开头存放指向
+// list_slab 的指针，节点地址向下对齐到窗口即可找到所属的块。
+// live 为仍在使用的节点数，归零时整块释放，block 为实际分配的起始地址
+struct list_slab {
+  std::size_t live;
+  void *block;
+};
+
+// 节点是否取自内存块由标记 slab 说明，它占用 list_node 尾部的填充字节，
+// 不增加节点大小；单独分配的节点同样写入该标记。
+// list_node 尾部没有填充的类型（如 8 字节的 T）不使用内存块
+template <typename T> struct list_slab_node : public list_node<T> {
+  bool slab;
+};
+
+// 窗口内的节点从偏移 offset 起紧密排列，比逐个分配的节点更省内存，
+// 遍历时也更连续
+template <typename T> struct list_slab_traits {
+  static constexpr std::size_t window = 4096;
+  static constexpr std::size_t align = alignof(list_node<T>);
+  static constexpr std::size_t offset =
+      (sizeof(list_slab *) + align - 1) / align * align;
+  static constexpr std::size_t stride = sizeof(list_node<T>);
+  static constexpr std::size_t per_window =
+      offset + stride <= window ? (window - offset) / stride : 0;
+  static constexpr std::size_t capacity =
+      LIST_SLAB_BYTES_ / window * per_window;
+  static constexpr bool usable =
+      sizeof(list_slab_node<T>) == sizeof(list_node<T>) && align <= window &&
+      per_window >= 2 && capacity >= 2;
+
+  static bool in_slab(list_node<T> *p) {
+    return usable && static_cast<list_slab_node<T> *>(p)->slab;
+  }
+  static void set_slab(list_node<T> *p, bool slab) {
+    if (usable) {
+      static_cast<list_slab_node<T> *>(p)->slab = slab;
+    }
+  }
+  static unsigned char *window_of(const void *p) {
+    return reinterpret_cast<unsigned char *>(
+        reinterpret_cast<std::uintptr_t>(p) & ~std::uintptr_t(window - 1));
+  }
+  static list_slab *slab_of(const void *p) {
+    return *reinterpret_cast<list_slab **>(window_of(p));
+  }
+  // n 个节点占用的字节数，不含 list_slab
+  static std::size_t bytes_for(std::size_t n) {
+    const std::size_t rest = n % per_window;
+    return n / per_window * window + (rest != 0 ? offset + rest * stride : 0);
+  }
+  // 块内的下一个节点，当前窗口放不下时跳到下一个窗口
+  static list_node<T> *next_slot(list_node<T> *p) {
+    unsigned char *q = reinterpret_cast<unsigned char *>(p) + stride;
+    unsigned char *w = window_of(p);
+    if (q + stride > w + window) {
+      q = w + window + offset;
+    }
+    return reinterpret_cast<list_node<T> *>(q);
+  }
+};
+
+// 把 [first, last] 这段节点链接到 pos 之前
+template <typename Baseptr>
+void list_link_before(Baseptr pos, Baseptr first, Baseptr last) {
+  first->pre = pos->pre;
+  pos->pre->next = first;
+  last->next = pos;
+  pos->pre = last;
+}
+
+// 把 [first, last] 这段节点从所在链表中摘下，节点自身的指针保持不变
+template <typename Baseptr> void list_unlink(Baseptr first, Baseptr last) {
+  first->pre->next = last->next;
+  last->next->pre = first->pre;
+}
+
 template <typename T>
 struct list_iterator
     : public tinystl::iterator<tinystl::bidirectional_iterator_tag, T> {
@@ -62,7 +154,7 @@ public:
   list_iterator();
   list_iterator(base_ptr t) : node_(t) {}
   list_iterator(node_ptr t) : node_(t->as_base()) {}
-  list_iterator(const list_iterator &t) : node_(t.node_){};
+  list_iterator(const list_iterator &t) = default;
 
   reference operator*() const { return node_->as_node()->value; }
   pointer operator->() const { return &*(*this); }
@@ -110,7 +202,7 @@ public:
   list_const_iterator(base_ptr t) : node_(t) {}
   list_const_iterator(node_ptr t) : node_(t->as_base()) {}
   list_const_iterator(const list_iterator<T> &t) : node_(t.node_){};
-  list_const_iterator(const list_const_iterator &t) : node_(t.node_){};
+  list_const_iterator(const list_const_iterator &t) = default;
 
   reference operator*() const { return node_->as_node()->value; }
   pointer operator->() const { return &*(*this); }
@@ -145,6 +237,8 @@ public:
   typedef tinystl::allocator<T> data_allocator;
   typedef tinystl::allocator<list_node_base<T>> base_allocator;
   typedef tinystl::allocator<list_node<T>> node_allocator;
+  typedef tinystl::allocator<unsigned char> byte_allocator;
+  typedef list_slab_traits<T> slab_traits;
 
   typedef list_node_base<T> *base_ptr;
   typedef list_node<T> *node_ptr;
@@ -163,14 +257,30 @@ public:
   typedef tinystl::reverse_iterator<iterator> reverse_iterator;
   typedef tinystl::reverse_iterator<const_iterator> const_reverse_iterator;
 
+  typedef value_node_handle<list> node_type;
+
 private:
+  friend node_handle_base<list>;
+
   base_ptr node_;
   size_type size_;
 
 protected:
   template <typename... Args> node_ptr create_node(Args... args);
   void clear();
-  void destory_node(node_ptr);
+  static void destory_node(node_ptr);
+  static node_ptr allocate_slab(size_type n);
+  static void release_slab_node(node_ptr);
+  template <typename Getter>
+  void create_chain(size_type n, Getter get, base_ptr &head, base_ptr &tail);
+  template <typename InputIterator>
+  size_type create_range_chain(InputIterator first, InputIterator last,
+                               base_ptr &head, base_ptr &tail,
+                               input_iterator_tag);
+  template <typename ForwardIterator>
+  size_type create_range_chain(ForwardIterator first, ForwardIterator last,
+                               base_ptr &head, base_ptr &tail,
+                               forward_iterator_tag);
   void link_at_end(base_ptr, base_ptr);
   void link_at_front(base_ptr, base_ptr);
   void link_at_pos(const_iterator &, base_ptr, base_ptr);
@@ -185,6 +295,9 @@ protected:
   iterator range_insert(const_iterator &pos, InputIterator first,
                         InputIterator last);
   void unlink_nodes(base_ptr, base_ptr);
+  template <typename Compare>
+  static void merge_chain(base_ptr &, base_ptr, Compare &);
+  static base_ptr relink_chain(base_ptr, base_ptr);
 
 public:
   list() { fill_init(0, value_type()); }
@@ -194,6 +307,13 @@ public:
   }
   explicit list(size_type n) { fill_init(n, value_type()); }
   list(size_type n, const value_type &t) { fill_init(n, t); }
+  template <
+      typename InputIterator,
+      typename std::enable_if<
+          tinystl::has_input_iterator_cat<InputIterator>::value, int>::type = 0>
+  list(InputIterator first, InputIterator last) {
+    range_init(first, last);
+  }
   list(const list &l) { range_init(l.begin(), l.end()); }
   list(std::initializer_list<value_type> l) { range_init(l.begin(), l.end()); }
   list(list &&l) noexcept : node_(l.node_), size_(l.size_) {
@@ -270,9 +390,49 @@ public:
           tinystl::has_input_iterator_cat<InputIterator>::value, int>::type = 0>
   iterator insert(const_iterator &pos, InputIterator first,
                   InputIterator last) {
-    MY_DEBUG(first <= last);
     return range_insert(pos, first, last);
   }
+
+  // 节点句柄：摘下与插回都只改链接，不分配也不拷贝元素，
+  // 可在不同 list 之间转移单个节点
+  node_type extract(const_iterator pos) {
+    MY_DEBUG(pos != end());
+    base_ptr node = pos.node_;
+    unlink_nodes(node, node);
+    --size_;
+    return node_type(node->as_node());
+  }
+  iterator insert(const_iterator pos, node_type &&nh) {
+    if (nh.empty()) {
+      return iterator(pos.node_);
+    }
+    base_ptr node = nh.release();
+    link_at_pos(pos, node, node);
+    ++size_;
+    return iterator(node);
+  }
+
+  // splice / merge / sort 只重新链接节点，不分配也不拷贝元素
+
+  void splice(const_iterator pos, list &l);
+  void splice(const_iterator pos, list &l, const_iterator it);
+  void splice(const_iterator pos, list &l, const_iterator first,
+              const_iterator last);
+
+  void merge(list &l) { merge(l, tinystl::less<value_type>()); }
+  template <typename Compare> void merge(list &l, Compare comp);
+
+  void sort() { sort(tinystl::less<value_type>()); }
+  template <typename Compare> void sort(Compare comp);
+
+  void unique() { unique(tinystl::equal_to<value_type>()); }
+  template <typename BinaryPredicate> void unique(BinaryPredicate pred);
+
+  void reverse() noexcept;
+  void swap(list &l) noexcept {
+    std::swap(node_, l.node_);
+    std::swap(size_, l.size_);
+  }
 };
 template <typename T>
 template <typename... Args>
@@ -282,15 +442,142 @@ typename list<T>::node_ptr list<T>::create_node(Args... args) {
     tinystl::construct(&(p->value), std::forward<Args>(args)...);
     p->next = nullptr;
     p->pre = nullptr;
+    slab_traits::set_slab(p, false);
   } catch (...) {
-    destory_node(p);
+    node_allocator::deallocate(p);
     throw;
   }
   return p;
 }
 template <typename T> void list<T>::destory_node(node_ptr p) {
   tinystl::destory(&(p->value));
-  node_allocator::deallocate(p);
+  if (slab_traits::in_slab(p)) {
+    release_slab_node(p);
+  } else {
+    node_allocator::deallocate(p);
+  }
+}
+// 分配可容纳 n 个节点的内存块（n 不超过 capacity），返回首个（未构造值的）节点；
+// 多分配不到一个窗口的字节用于对齐
+template <typename T>
+typename list<T>::node_ptr list<T>::allocate_slab(size_type n) {
+  constexpr size_type window = slab_traits::window;
+  const size_type used = slab_traits::bytes_for(n);
+  const size_type head =
+      (used + alignof(list_slab) - 1) / alignof(list_slab) * alignof(list_slab);
+  unsigned char *raw =
+      byte_allocator::allocate(head + sizeof(list_slab) + window - 1);
+  unsigned char *base = raw + (-reinterpret_cast<std::uintptr_t>(raw) &
+                               std::uintptr_t(window - 1));
+  list_slab *slab = ::new (static_cast<void *>(base + head)) list_slab;
+  slab->live = n;
+  slab->block = raw;
+  for (size_type w = 0; w < used; w += window) {
+    ::new (static_cast<void *>(base + w)) list_slab *(slab);
+  }
+  return reinterpret_cast<node_ptr>(base + slab_traits::offset);
+}
+// 节点所属内存块的最后一个节点归还时释放整块内存；
+// 节点经 splice 或节点句柄转移到其他链表后依然有效
+template <typename T> void list<T>::release_slab_node(node_ptr p) {
+  list_slab *slab = slab_traits::slab_of(p);
+  if (--slab->live == 0) {
+    byte_allocator::deallocate(static_cast<unsigned char *>(slab->block));
+  }
+}
+// 创建 n 个节点并串成 [head, tail]，值依次取自 get()；
+// n 较大时节点依次取自若干内存块，既省去逐个分配，遍历时也更连续
+template <typename T>
+template <typename Getter>
+void list<T>::create_chain(size_type n, Getter get, base_ptr &head,
+                           base_ptr &tail) {
+  head = tail = nullptr;
+  if (n == 0) {
+    return;
+  }
+  const bool use_slab = slab_traits::usable && n >= LIST_SLAB_MIN_NODES_;
+  node_ptr slot = nullptr; // 当前内存块中下一个未使用的节点
+  size_type slots = 0;     // 当前内存块中未使用的节点数
+  size_type built = 0;
+  try {
+    for (; built < n; ++built) {
+      node_ptr node;
+      if (use_slab) {
+        if (slots == 0) {
+          slots = n - built < slab_traits::capacity ? n - built
+                                                    : slab_traits::capacity;
+          slot = allocate_slab(slots);
+        }
+        node = slot;
+        tinystl::construct(&(node->value), get());
+        slab_traits::set_slab(node, true);
+        slot = slab_traits::next_slot(slot);
+        --slots;
+      } else {
+        node = create_node(get());
+      }
+      if (head == nullptr) {
+        head = node;
+      } else {
+        tail->next = node;
+        node->pre = tail;
+      }
+      tail = node;
+    }
+  } catch (...) {
+    for (; slots > 0; --slots, slot = slab_traits::next_slot(slot)) {
+      release_slab_node(slot);
+    }
+    while (built-- > 0) {
+      base_ptr next = head->next;
+      destory_node(head->as_node());
+      head = next;
+    }
+    throw;
+  }
+}
+// 单趟的输入迭代器只能读一遍，逐个创建节点
+template <typename T>
+template <typename InputIterator>
+typename list<T>::size_type
+list<T>::create_range_chain(InputIterator first, InputIterator last,
+                            base_ptr &head, base_ptr &tail,
+                            input_iterator_tag) {
+  head = tail = nullptr;
+  size_type n = 0;
+  try {
+    for (; first != last; ++first, ++n) {
+      node_ptr node = create_node(*first);
+      if (head == nullptr) {
+        head = node;
+      } else {
+        tail->next = node;
+        node->pre = tail;
+      }
+      tail = node;
+    }
+  } catch (...) {
+    while (head != nullptr) {
+      base_ptr next = head->next;
+      destory_node(head->as_node());
+      head = next;
+    }
+    throw;
+  }
+  return n;
+}
+// 前向迭代器可先计数，再一次性创建全部节点
+template <typename T>
+template <typename ForwardIterator>
+typename list<T>::size_type
+list<T>::create_range_chain(ForwardIterator first, ForwardIterator last,
+                            base_ptr &head, base_ptr &tail,
+                            forward_iterator_tag) {
+  const size_type n = tinystl::distance(first, last);
+  THROW_OUT_OF_RANGE_IF(n > max_size() - size_, "out of maxsize");
+  create_chain(
+      n, [&first]() -> decltype(*first) { return *first++; }, head, tail);
+  return n;
 }
 template <typename T> void list<T>::link_at_end(base_ptr first, base_ptr last) {
   node_->pre->next = first;
@@ -320,17 +607,18 @@ template <typename T>
 void list<T>::fill_init(size_type n, const value_type &t) {
   node_ = base_allocator::allocate(1);
   node_->un_link();
-  size_ = n;
+  size_ = 0;
   try {
-    for (; n > 0; --n) {
-      base_ptr node = create_node(t);
-      link_at_end(node, node);
+    base_ptr head, tail;
+    create_chain(
+        n, [&t]() -> const value_type & { return t; }, head, tail);
+    if (n > 0) {
+      link_at_end(head, tail);
+      size_ = n;
     }
   } catch (...) {
-    clear();
     base_allocator::deallocate(node_);
     node_ = nullptr;
-    size_ = 0;
     throw;
   }
 }
@@ -338,19 +626,21 @@ void list<T>::fill_init(size_type n, const value_type &t) {
 template <typename T>
 template <typename InputIterator>
 void list<T>::range_init(InputIterator first, InputIterator last) {
-  size_ = tinystl::distance(first, last);
   node_ = base_allocator::allocate(1);
   node_->un_link();
+  size_ = 0;
   try {
-    while (first++ != last) {
-      base_ptr node = create_node(*first);
-      link_at_end(node, node);
+    base_ptr head, tail;
+    const size_type n = create_range_chain(first, last, head, tail,
+                                           tinystl::iterator_category(first));
+    if (n > 0) {
+      link_at_end(head, tail);
+      size_ = n;
     }
   } catch (...) {
-    clear();
     base_allocator::deallocate(node_);
     node_ = nullptr;
-    size_ = 0;
+    throw;
   }
 }
 template <typename T>
@@ -358,40 +648,19 @@ template <typename InputIterator>
 typename list<T>::iterator list<T>::range_insert(const_iterator &pos,
                                                  InputIterator first,
                                                  InputIterator last) {
-  size_type n = tinystl::distance(first, last);
-  THROW_OUT_OF_RANGE_IF(n + size_ > max_size(), "out of maxsize");
-  if (n > 0) {
-    base_ptr head = create_node(*first);
-    base_ptr tail = head;
-    try {
-      while (++first != last) {
-        base_ptr node = create_node(*first);
-        tail->next = node;
-        node->pre = tail;
-        tail = node;
-      }
-    } catch (...) {
-      base_ptr cur = head;
-      while (cur != tail) {
-        cur = cur->next;
-        destory_node(head->as_node());
-        head = cur;
-      }
-      destory_node(tail->as_node());
-      throw;
-    }
-    link_at_pos(pos, head, tail);
-    size_ += n;
+  base_ptr head, tail;
+  const size_type n = create_range_chain(first, last, head, tail,
+                                         tinystl::iterator_category(first));
+  if (n == 0) {
+    return iterator(pos.node_);
   }
-  return iterator(pos.node_);
+  link_at_pos(pos, head, tail);
+  size_ += n;
+  return iterator(head);
 }
 template <typename T>
 void list<T>::link_at_pos(const_iterator &pos, base_ptr first, base_ptr last) {
-  base_ptr &node = pos.node_;
-  first->pre = node->pre;
-  node->pre->next = first;
-  last->next = node;
-  node->pre = last;
+  list_link_before(pos.node_, first, last);
 }
 template <typename T>
 template <typename InputIterator>
@@ -410,50 +679,237 @@ void list<T>::range_assign(InputIterator first, InputIterator last) {
 template <typename T>
 typename list<T>::iterator
 list<T>::fill_insert(const_iterator &pos, size_type n, const value_type &t) {
-  if (n > 0) {
-    base_ptr head = create_node(t);
-    base_ptr tail = head;
-    --n;
-    try {
-      for (; n > 0; --n) {
-        base_ptr node = create_node(t);
-        tail->next = node;
-        node->pre = tail;
-        tail = node;
-      }
-    } catch (...) {
-      base_ptr cur = head;
-      while (cur != tail) {
-        cur = cur->next;
-        destory_node(head->as_node());
-        head = cur;
-      }
-      destory_node(tail->as_node());
-      throw;
-    }
-    link_at_pos(pos, head, tail);
-    size_ += n;
+  if (n == 0) {
     return iterator(pos.node_);
   }
+  base_ptr head, tail;
+  create_chain(
+      n, [&t]() -> const value_type & { return t; }, head, tail);
+  link_at_pos(pos, head, tail);
+  size_ += n;
+  return iterator(head);
 }
 template <typename T>
 void list<T>::unlink_nodes(base_ptr first, base_ptr last) {
-  first->pre->next = last->next;
-  last->next->pre = first->pre;
+  list_unlink(first, last);
 }
 template <typename T>
 typename list<T>::iterator list<T>::erase(const_iterator &first,
                                           const_iterator &last) {
   if (first != last) {
+    // 摘下后 last 的 pre 已指向区间之前的节点，只能沿 next 逐个销毁
     unlink_nodes(first.node_, last.node_->pre);
     while (first != last) {
+      base_ptr node = first.node_;
       ++first;
-      destory_node(first.node_->pre->as_node());
+      destory_node(node->as_node());
       --size_;
     }
   }
   return iterator(last.node_);
 }
+template <typename T>
+void list<T>::splice(const_iterator pos, list &l) {
+  if (l.empty() || this == &l) {
+    return;
+  }
+  base_ptr first = l.node_->next;
+  base_ptr last = l.node_->pre;
+  l.unlink_nodes(first, last);
+  link_at_pos(pos, first, last);
+  size_ += l.size_;
+  l.size_ = 0;
+}
+template <typename T>
+void list<T>::splice(const_iterator pos, list &l, const_iterator it) {
+  base_ptr node = it.node_;
+  if (node == pos.node_ || node->next == pos.node_) {
+    return;
+  }
+  l.unlink_nodes(node, node);
+  link_at_pos(pos, node, node);
+  ++size_;
+  --l.size_;
+}
+// 跨链表时需要 O(n) 统计节点个数以维护 size_，同一链表内为 O(1)
+template <typename T>
+void list<T>::splice(const_iterator pos, list &l, const_iterator first,
+                     const_iterator last) {
+  if (first == last) {
+    return;
+  }
+  if (this != &l) {
+    const size_type n = tinystl::distance(first, last);
+    size_ += n;
+    l.size_ -= n;
+  }
+  base_ptr head = first.node_;
+  base_ptr tail = last.node_->pre;
+  l.unlink_nodes(head, tail);
+  link_at_pos(pos, head, tail);
+}
+template <typename T>
+template <typename Compare>
+void list<T>::merge(list &l, Compare comp) {
+  if (this == &l) {
+    return;
+  }
+  const_iterator f1 = begin();
+  const_iterator l1 = end();
+  const_iterator f2 = l.begin();
+  const_iterator l2 = l.end();
+  while (f1 != l1 && f2 != l2) {
+    if (comp(*f2, *f1)) {
+      // 一次搬移 l 中所有小于 *f1 的连续节点
+      const_iterator next = f2;
+      ++next;
+      size_type n = 1;
+      while (next != l2 && comp(*next, *f1)) {
+        ++next;
+        ++n;
+      }
+      base_ptr head = f2.node_;
+      base_ptr tail = next.node_->pre;
+      l.unlink_nodes(head, tail);
+      link_at_pos(f1, head, tail);
+      // 随节点一起搬移计数，comp 抛出异常时两边的 size_ 仍与链接一致
+      size_ += n;
+      l.size_ -= n;
+      f2 = next;
+    }
+    ++f1;
+  }
+  if (f2 != l2) {
+    base_ptr head = f2.node_;
+    base_ptr tail = l2.node_->pre;
+    l.unlink_nodes(head, tail);
+    link_at_end(head, tail);
+  }
+  size_ += l.size_;
+  l.size_ = 0;
+}
+// 归并以 nullptr 结尾的有序链 a 与 b，结果存回 a；
+// comp 抛出异常时 a 为包含全部节点的一条（无序）链，再继续抛出
+template <typename T>
+template <typename Compare>
+void list<T>::merge_chain(base_ptr &a, base_ptr b, Compare &comp) {
+  list_node_base<T> head;
+  base_ptr tail = &head;
+  base_ptr x = a;
+  try {
+    while (x != nullptr && b != nullptr) {
+      // 相等时取 x，保证稳定
+      if (comp(b->as_node()->value, x->as_node()->value)) {
+        tail->next = b;
+        b = b->next;
+      } else {
+        tail->next = x;
+        x = x->next;
+      }
+      tail = tail->next;
+    }
+  } catch (...) {
+    tail->next = x;
+    while (tail->next != nullptr) {
+      tail = tail->next;
+    }
+    tail->next = b;
+    a = head.next;
+    throw;
+  }
+  tail->next = x != nullptr ? x : b;
+  a = head.next;
+}
+// 把以 nullptr 结尾的链 chain 接在 pre 之后并回填 pre 指针，返回新的末尾
+template <typename T>
+typename list<T>::base_ptr list<T>::relink_chain(base_ptr pre,
+                                                 base_ptr chain) {
+  for (; chain != nullptr; pre = chain, chain = chain->next) {
+    pre->next = chain;
+    chain->pre = pre;
+  }
+  return pre;
+}
+// 自底向上归并：把节点断开成以 nullptr 结尾的单链表，
+// bins[i] 存放长度为 2^i 的有序段，最后统一回填 pre 指针。
+// comp 抛出异常时把所有段接回链表（顺序未定）后继续抛出，不丢失节点
+template <typename T>
+template <typename Compare>
+void list<T>::sort(Compare comp) {
+  if (size_ < 2) {
+    return;
+  }
+  base_ptr bins[64] = {};
+  size_type fill = 0;
+  base_ptr cur = node_->next;
+  base_ptr carry = nullptr;
+  base_ptr result = nullptr;
+  node_->pre->next = nullptr;
+  try {
+    while (cur != nullptr) {
+      carry = cur;
+      cur = cur->next;
+      carry->next = nullptr;
+      size_type i = 0;
+      for (; i < fill && bins[i] != nullptr; ++i) {
+        base_ptr b = carry;
+        carry = nullptr;
+        merge_chain(bins[i], b, comp);
+        carry = bins[i];
+        bins[i] = nullptr;
+      }
+      bins[i] = carry;
+      carry = nullptr;
+      if (i == fill) {
+        ++fill;
+      }
+    }
+    for (size_type i = 0; i < fill; ++i) {
+      base_ptr b = result;
+      result = nullptr;
+      merge_chain(bins[i], b, comp);
+      result = bins[i];
+      bins[i] = nullptr;
+    }
+  } catch (...) {
+    base_ptr pre = relink_chain(node_, cur);
+    pre = relink_chain(pre, carry);
+    pre = relink_chain(pre, result);
+    for (size_type i = 0; i < fill; ++i) {
+      pre = relink_chain(pre, bins[i]);
+    }
+    pre->next = node_;
+    node_->pre = pre;
+    throw;
+  }
+  base_ptr pre = relink_chain(node_, result);
+  pre->next = node_;
+  node_->pre = pre;
+}
+template <typename T>
+template <typename BinaryPredicate>
+void list<T>::unique(BinaryPredicate pred) {
+  base_ptr cur = node_->next;
+  if (cur == node_) {
+    return;
+  }
+  for (base_ptr next = cur->next; next != node_; next = cur->next) {
+    if (pred(cur->as_node()->value, next->as_node()->value)) {
+      unlink_nodes(next, next);
+      destory_node(next->as_node());
+      --size_;
+    } else {
+      cur = next;
+    }
+  }
+}
+template <typename T> void list<T>::reverse() noexcept {
+  base_ptr cur = node_;
+  do {
+    std::swap(cur->pre, cur->next);
+    cur = cur->pre;
+  } while (cur != node_);
+}
 } // namespace tinystl
 
 #endif
@@ -0,0 +1,550 @@
+#ifndef MYTINYSTL_LRU_CACHE_H_
+#define MYTINYSTL_LRU_CACHE_H_
+
+// 分片的定容缓存，按 CLOCK 算法近似 LRU 淘汰。
+// 键按哈希值的高位分到各分片，每个分片一把读写锁、一张拉链法的桶表，
+// 以及用 list_node_base 串成的环形双向链表和一根时钟指针。
+// 命中时只在读锁下置位条目的访问标记，不移动节点，同一分片可以同时
+// 有多个线程命中；插入持有写锁，容量不足时转动时钟指针：
+// 访问标记为 1 的条目清零后跳过，为 0 的条目被淘汰。
+// 新条目插在时钟指针之前，要等指针转过一整圈才可能被淘汰。
+// 容量按权重计，默认每个条目权重为 1，即按条目数；换成返回字节数的
+// weigher 即按字节数。总容量平均分给各分片，单个条目的权重超过
+// 分片容量时不会被缓存。
+// 每个条目只分配一个节点，节点同时挂在桶链和时钟环上。
+// 读操作返回值的拷贝，或在读锁内把元素交给回调。
+
+#include "allocator.h"
+#include "construct.h"
+#include "exceptdef.h"
+#include "functional.h"
+#include "hash.h"
+#include "list.h"
+#include "util.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+namespace tinystl {
+// 每个条目的权重都是 1，容量即条目数
+struct lru_cache_entry_weight {
+  template <typename K, typename V>
+  std::size_t operator()(const K &, const V &) const noexcept {
+    return 1;
+  }
+};
+
+struct lru_cache_stats {
+  std::uint64_t hits;
+  std::uint64_t misses;
+  std::uint64_t insertions;
+  std::uint64_t evictions; // 只计容量不足时的淘汰，不含 erase 与 clear
+};
+
+template <typename Key, typename T, typename Hash = tinystl::hash<Key>,
+          typename KeyEqual = tinystl::equal_to<Key>,
+          typename Weigher = lru_cache_entry_weight>
+class lru_cache {
+public:
+  typedef Key key_type;
+  typedef T mapped_type;
+  typedef tinystl::pair<const Key, T> value_type;
+  typedef Hash hasher;
+  typedef KeyEqual key_equal;
+  typedef Weigher weigher;
+  typedef std::size_t size_type;
+
+private:
+  typedef list_node_base<value_type> link_type;
+  typedef link_type *base_ptr;
+
+  struct node : public link_type {
+    node *hnext; // 同一个桶中的下一个节点
+    std::uint64_t hash;
+    size_type weight;
+    std::atomic<bool> referenced; // 时钟指针上次经过后是否被访问过
+    value_type value;
+
+    template <typename... Args>
+    explicit node(std::uint64_t h, Args &&...args)
+        : hnext(nullptr), hash(h), weight(0), referenced(false),
+          value(std::forward<Args>(args)...) {}
+  };
+  typedef tinystl::allocator<node> node_allocator;
+  typedef tinystl::allocator<node *> bucket_allocator;
+
+  static constexpr size_type min_buckets = 8;
+  // 自动确定分片数时，每个分片至少分到的容量
+  static constexpr size_type min_shard_capacity = 64;
+
+  // 各分片独占缓存行，避免不同分片的锁互相干扰
+  struct alignas(64) shard {
+    mutable std::shared_mutex lock;
+    node **buckets;
+    size_type mask; // 桶数减一
+    size_type count;
+    size_type weight; // 已缓存条目的权重之和
+    size_type capacity;
+    link_type ring; // 时钟环的哨兵
+    base_ptr hand;  // 下一个要检查的位置，可能是哨兵
+    std::atomic<std::uint64_t> hits;
+    std::atomic<std::uint64_t> misses;
+    std::atomic<std::uint64_t> insertions;
+    std::atomic<std::uint64_t> evictions;
+  };
+
+  shard *shards_;
+  size_type shard_count_;
+  unsigned shard_shift_; // 63 - log2(shard_count_)
+  size_type capacity_;
+  hasher hash_;
+  key_equal equal_;
+  weigher weigh_;
+
+public:
+  // capacity 为总权重；shard_count 取不小于它的 2 的幂，为 0 时取硬件线程数
+  // 的 4 倍，但保证每个分片至少分到 min_shard_capacity
+  explicit lru_cache(size_type capacity, size_type shard_count = 0,
+                     const weigher &weigh = weigher(),
+                     const hasher &hash = hasher(),
+                     const key_equal &equal = key_equal());
+  lru_cache(const lru_cache &) = delete;
+  lru_cache &operator=(const lru_cache &) = delete;
+  // 析构与其他操作不能并发
+  ~lru_cache();
+
+  // 仅作提示，并发修改时结果可能立即过期
+  size_type size() const noexcept;
+  size_type weight() const noexcept;
+  bool empty() const noexcept { return size() == 0; }
+  size_type capacity() const noexcept { return capacity_; }
+  size_type shard_count() const noexcept { return shard_count_; }
+  hasher hash_function() const { return hash_; }
+  key_equal key_eq() const { return equal_; }
+
+  // 以下读操作持有所在分片的读锁，命中时置位访问标记并计入统计
+  // 找到时把值拷贝到 out
+  bool find(const key_type &k, mapped_type &out);
+  // 找到时在读锁内调用 f(const value_type &)
+  template <typename F> bool visit(const key_type &k, F &&f);
+  // 只判断是否存在，不影响淘汰顺序和统计
+  bool contains(const key_type &k) const;
+
+  // 以下写操作持有所在分片的写锁
+  // 键不存在时以 args 构造映射值插入，返回是否插入
+  template <typename... Args>
+  bool try_emplace(const key_type &k, Args &&...args);
+  // 键存在时替换映射值，返回是否插入了新条目；
+  // 新值超过分片容量时删除该键
+  template <typename M> bool insert_or_assign(const key_type &k, M &&obj);
+  bool erase(const key_type &k);
+  // 逐个分片清空，可与其他操作并发
+  void clear();
+
+  lru_cache_stats stats() const noexcept;
+  void reset_stats() noexcept;
+
+private:
+  std::uint64_t hash_of(const key_type &k) const {
+    return mix(hash_(k), hash_is_avalanching<hasher>());
+  }
+  static std::uint64_t mix(std::uint64_t h, std::true_type) { return h; }
+  static std::uint64_t mix(std::uint64_t h, std::false_type) {
+    return hash_mix(h);
+  }
+  // 高位选分片，低位选桶
+  shard &shard_of(std::uint64_t h) const {
+    return shards_[h >> shard_shift_ >> 1];
+  }
+
+  node *lookup(const shard &s, const key_type &k, std::uint64_t h) const;
+  template <typename... Args> node *create_node(Args &&...args);
+  static void destory_node(node *p) {
+    tinystl::destory(p);
+    node_allocator::deallocate(p);
+  }
+
+  bool admit(shard &s, node *p);
+  void make_room(shard &s, size_type w);
+  void link_ring(shard &s, node *p) {
+    list_link_before(s.hand, static_cast<base_ptr>(p),
+                     static_cast<base_ptr>(p));
+  }
+  void unlink_ring(shard &s, node *p) {
+    if (s.hand == p) {
+      s.hand = p->next;
+    }
+    list_unlink(static_cast<base_ptr>(p), static_cast<base_ptr>(p));
+  }
+  void unlink_bucket(shard &s, node *p);
+  void remove(shard &s, node *p);
+  void grow(shard &s);
+  void clear_shard(shard &s);
+};
+
+template <typename Key, typename T, typename Hash, typename KeyEqual,
+          typename Weigher>
+lru_cache<Key, T, Hash, KeyEqual, Weigher>::lru_cache(size_type capacity,
+                                                      size_type shard_count,
+                                                      const weigher &weigh,
+                                                      const hasher &hash,
+                                                      const key_equal &equal)
+    : shards_(nullptr), shard_count_(1), shard_shift_(63),
+      capacity_(capacity), hash_(hash), equal_(equal), weigh_(weigh) {
+  if (shard_count == 0) {
+    shard_count =
+        4 * static_cast<size_type>(std::thread::hardware_concurrency());
+    while (shard_count > 1 && capacity / shard_count < min_shard_capacity) {
+      shard_count /= 2;
+    }
+  }
+  while (shard_count_ < shard_count) {
+    shard_count_ *= 2;
+    --shard_shift_;
+  }
+  shards_ = new shard[shard_count_];
+  size_type i = 0;
+  try {
+    for (; i < shard_count_; ++i) {
+      shard &s = shards_[i];
+      s.buckets = bucket_allocator::allocate(min_buckets);
+      std::memset(static_cast<void *>(s.buckets), 0,
+                  min_buckets * sizeof(node *));
+      s.mask = min_buckets - 1;
+      s.count = 0;
+      s.weight = 0;
+      // 容量不能整除时，前面的分片各多分 1
+      s.capacity = capacity / shard_count_ + (i < capacity % shard_count_);
+      s.ring.un_link();
+      s.hand = &s.ring;
+      s.hits.store(0, std::memory_order_relaxed);
+      s.misses.store(0, std::memory_order_relaxed);
+      s.insertions.store(0, std::memory_order_relaxed);
+      s.evictions.store(0, std::memory_order_relaxed);
+    }
+  } catch (...) {
+    while (i-- != 0) {
+      bucket_allocator::deallocate(shards_[i].buckets);
+    }
+    delete[] shards_;
+    throw;
+  }
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual,
+          typename Weigher>
+lru_cache<Key, T, Hash, KeyEqual, Weigher>::~lru_cache() {
+  for (size_type i = 0; i < shard_count_; ++i) {
+    clear_shard(shards_[i]);
+    bucket_allocator::deallocate(shards_[i].buckets);
+  }
+  delete[] shards_;
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual,
+          typename Weigher>
+typename lru_cache<Key, T, Hash, KeyEqual, Weigher>::size_type
+lru_cache<Key, T, Hash, KeyEqual, Weigher>::size() const noexcept {
+  size_type n = 0;
+  for (size_type i = 0; i < shard_count_; ++i) {
+    std::shared_lock<std::shared_mutex> lock(shards_[i].lock);
+    n += shards_[i].count;
+  }
+  return n;
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual,
+          typename Weigher>
+typename lru_cache<Key, T, Hash, KeyEqual, Weigher>::size_type
+lru_cache<Key, T, Hash, KeyEqual, Weigher>::weight() const noexcept {
+  size_type n = 0;
+  for (size_type i = 0; i < shard_count_; ++i) {
+    std::shared_lock<std::shared_mutex> lock(shards_[i].lock);
+    n += shards_[i].weight;
+  }
+  return n;
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual,
+          typename Weigher>
+bool lru_cache<Key, T, Hash, KeyEqual, Weigher>::find(const key_type &k,
+                                                      mapped_type &out) {
+  return visit(k, [&out](const value_type &v) { out = v.second; });
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual,
+          typename Weigher>
+template <typename F>
+bool lru_cache<Key, T, Hash, KeyEqual, Weigher>::visit(const key_type &k,
+                                                       F &&f) {
+  std::uint64_t h = hash_of(k);
+  shard &s = shard_of(h);
+  std::shared_lock<std::shared_mutex> lock(s.lock);
+  node *p = lookup(s, k, h);
+  if (p == nullptr) {
+    s.misses.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  // 已置位时不再写，热点条目所在的缓存行保持共享
+  if (!p->referenced.load(std::memory_order_relaxed)) {
+    p->referenced.store(true, std::memory_order_relaxed);
+  }
+  s.hits.fetch_add(1, std::memory_order_relaxed);
+  f(static_cast<const value_type &>(p->value));
+  return true;
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual,
+          typename Weigher>
+bool lru_cache<Key, T, Hash, KeyEqual, Weigher>::contains(
+    const key_type &k) const {
+  std::uint64_t h = hash_of(k);
+  const shard &s = shard_of(h);
+  std::shared_lock<std::shared_mutex> lock(s.lock);
+  return lookup(s, k, h) != nullptr;
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual,
+          typename Weigher>
+template <typename... Args>
+bool lru_cache<Key, T, Hash, KeyEqual, Weigher>::try_emplace(
+    const key_type &k, Args &&...args) {
+  std::uint64_t h = hash_of(k);
+  shard &s = shard_of(h);
+  std::unique_lock<std::shared_mutex> lock(s.lock);
+  if (lookup(s, k, h) != nullptr) {
+    return false;
+  }
+  return admit(s, create_node(h, k,
+                              mapped_type(std::forward<Args>(args)...)));
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual,
+          typename Weigher>
+template <typename M>
+bool lru_cache<Key, T, Hash, KeyEqual, Weigher>::insert_or_assign(
+    const key_type &k, M &&obj) {
+  std::uint64_t h = hash_of(k);
+  shard &s = shard_of(h);
+  std::unique_lock<std::shared_mutex> lock(s.lock);
+  node *p = lookup(s, k, h);
+  if (p == nullptr) {
+    return admit(s, create_node(h, k, std::forward<M>(obj)));
+  }
+  p->value.second = std::forward<M>(obj);
+  const size_type w = weigh_(p->value.first, p->value.second);
+  // 先从环上摘下，腾出空间时不会淘汰它自己
+  unlink_ring(s, p);
+  s.weight -= p->weight;
+  if (w > s.capacity) {
+    unlink_bucket(s, p);
+    --s.count;
+    destory_node(p);
+    return false;
+  }
+  make_room(s, w);
+  p->weight = w;
+  p->referenced.store(true, std::memory_order_relaxed);
+  link_ring(s, p);
+  s.weight += w;
+  return false;
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual,
+          typename Weigher>
+bool lru_cache<Key, T, Hash, KeyEqual, Weigher>::erase(const key_type &k) {
+  std::uint64_t h = hash_of(k);
+  shard &s = shard_of(h);
+  std::unique_lock<std::shared_mutex> lock(s.lock);
+  node *p = lookup(s, k, h);
+  if (p == nullptr) {
+    return false;
+  }
+  remove(s, p);
+  return true;
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual,
+          typename Weigher>
+void lru_cache<Key, T, Hash, KeyEqual, Weigher>::clear() {
+  for (size_type i = 0; i < shard_count_; ++i) {
+    std::unique_lock<std::shared_mutex> lock(shards_[i].lock);
+    clear_shard(shards_[i]);
+  }
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual,
+          typename Weigher>
+lru_cache_stats
+lru_cache<Key, T, Hash, KeyEqual, Weigher>::stats() const noexcept {
+  lru_cache_stats r = {0, 0, 0, 0};
+  for (size_type i = 0; i < shard_count_; ++i) {
+    const shard &s = shards_[i];
+    r.hits += s.hits.load(std::memory_order_relaxed);
+    r.misses += s.misses.load(std::memory_order_relaxed);
+    r.insertions += s.insertions.load(std::memory_order_relaxed);
+    r.evictions += s.evictions.load(std::memory_order_relaxed);
+  }
+  return r;
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual,
+          typename Weigher>
+void lru_cache<Key, T, Hash, KeyEqual, Weigher>::reset_stats() noexcept {
+  for (size_type i = 0; i < shard_count_; ++i) {
+    shard &s = shards_[i];
+    s.hits.store(0, std::memory_order_relaxed);
+    s.misses.store(0, std::memory_order_relaxed);
+    s.insertions.store(0, std::memory_order_relaxed);
+    s.evictions.store(0, std::memory_order_relaxed);
+  }
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual,
+          typename Weigher>
+typename lru_cache<Key, T, Hash, KeyEqual, Weigher>::node *
+lru_cache<Key, T, Hash, KeyEqual, Weigher>::lookup(const shard &s,
+                                                   const key_type &k,
+                                                   std::uint64_t h) const {
+  for (node *p = s.buckets[h & s.mask]; p != nullptr; p = p->hnext) {
+    if (p->hash == h && equal_(p->value.first, k)) {
+      return p;
+    }
+  }
+  return nullptr;
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual,
+          typename Weigher>
+template <typename... Args>
+typename lru_cache<Key, T, Hash, KeyEqual, Weigher>::node *
+lru_cache<Key, T, Hash, KeyEqual, Weigher>::create_node(Args &&...args) {
+  node *p = node_allocator::allocate(1);
+  try {
+    tinystl::construct(p, std::forward<Args>(args)...);
+  } catch (...) {
+    node_allocator::deallocate(p);
+    throw;
+  }
+  return p;
+}
+
+// 接收一个新节点：权重超过分片容量时丢弃，否则腾出空间后挂到桶链和时钟环上
+template <typename Key, typename T, typename Hash, typename KeyEqual,
+          typename Weigher>
+bool lru_cache<Key, T, Hash, KeyEqual, Weigher>::admit(shard &s, node *p) {
+  size_type w;
+  try {
+    w = weigh_(p->value.first, p->value.second);
+    if (w <= s.capacity && s.count > s.mask) {
+      grow(s);
+    }
+  } catch (...) {
+    destory_node(p);
+    throw;
+  }
+  if (w > s.capacity) {
+    destory_node(p);
+    return false;
+  }
+  make_room(s, w);
+  p->weight = w;
+  node *&head = s.buckets[p->hash & s.mask];
+  p->hnext = head;
+  head = p;
+  link_ring(s, p);
+  ++s.count;
+  s.weight += w;
+  s.insertions.fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
+// 转动时钟指针直到能再放下权重 w，调用前应保证 w 不超过分片容量
+template <typename Key, typename T, typename Hash, typename KeyEqual,
+          typename Weigher>
+void lru_cache<Key, T, Hash, KeyEqual, Weigher>::make_room(shard &s,
+                                                           size_type w) {
+  while (s.weight + w > s.capacity) {
+    base_ptr cur = s.hand;
+    s.hand = cur->next;
+    if (cur == &s.ring) {
+      continue;
+    }
+    node *p = static_cast<node *>(cur);
+    if (p->referenced.load(std::memory_order_relaxed)) {
+      p->referenced.store(false, std::memory_order_relaxed);
+      continue;
+    }
+    remove(s, p);
+    s.evictions.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual,
+          typename Weigher>
+void lru_cache<Key, T, Hash, KeyEqual, Weigher>::unlink_bucket(shard &s,
+                                                               node *p) {
+  node **link = &s.buckets[p->hash & s.mask];
+  while (*link != p) {
+    link = &(*link)->hnext;
+  }
+  *link = p->hnext;
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual,
+          typename Weigher>
+void lru_cache<Key, T, Hash, KeyEqual, Weigher>::remove(shard &s, node *p) {
+  unlink_ring(s, p);
+  unlink_bucket(s, p);
+  --s.count;
+  s.weight -= p->weight;
+  destory_node(p);
+}
+
+// 桶数翻倍，节点按缓存的哈希值重新分桶
+template <typename Key, typename T, typename Hash, typename KeyEqual,
+          typename Weigher>
+void lru_cache<Key, T, Hash, KeyEqual, Weigher>::grow(shard &s) {
+  const size_type n = (s.mask + 1) * 2;
+  node **buckets = bucket_allocator::allocate(n);
+  std::memset(static_cast<void *>(buckets), 0, n * sizeof(node *));
+  for (size_type i = 0; i <= s.mask; ++i) {
+    node *p = s.buckets[i];
+    while (p != nullptr) {
+      node *next = p->hnext;
+      node *&head = buckets[p->hash & (n - 1)];
+      p->hnext = head;
+      head = p;
+      p = next;
+    }
+  }
+  bucket_allocator::deallocate(s.buckets);
+  s.buckets = buckets;
+  s.mask = n - 1;
+}
+
+template <typename Key, typename T, typename Hash, typename KeyEqual,
+          typename Weigher>
+void lru_cache<Key, T, Hash, KeyEqual, Weigher>::clear_shard(shard &s) {
+  base_ptr cur = s.ring.next;
+  while (cur != &s.ring) {
+    base_ptr next = cur->next;
+    destory_node(static_cast<node *>(cur));
+    cur = next;
+  }
+  s.ring.un_link();
+  s.hand = &s.ring;
+  std::memset(static_cast<void *>(s.buckets), 0,
+              (s.mask + 1) * sizeof(node *));
+  s.count = 0;
+  s.weight = 0;
+}
+} // namespace tinystl
+
+#endif
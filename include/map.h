@@ -0,0 +1,550 @@
+#ifndef MYTINYSTL_MAP_H_
+#define MYTINYSTL_MAP_H_
+
+#include "exceptdef.h"
+#include "functional.h"
+#include "rb_tree.h"
+#include "util.h"
+#include <initializer_list>
+#include <type_traits>
+#include <utility>
+
+namespace tinystl {
+template <typename Key, typename T, typename Compare, typename NodePolicy>
+class multimap;
+
+// 键值唯一
+template <typename Key, typename T, typename Compare = tinystl::less<Key>,
+          typename NodePolicy = rb_tree_plain_node>
+class map {
+public:
+  typedef Key key_type;
+  typedef T mapped_type;
+  typedef tinystl::pair<const Key, T> value_type;
+  typedef Compare key_compare;
+
+  class value_compare : public binary_function<value_type, value_type, bool> {
+    friend class map<Key, T, Compare, NodePolicy>;
+
+  private:
+    Compare comp;
+    value_compare(Compare c) : comp(c) {}
+
+  public:
+    bool operator()(const value_type &lhs, const value_type &rhs) const {
+      return comp(lhs.first, rhs.first);
+    }
+  };
+
+private:
+  typedef tinystl::rb_tree<value_type, key_compare, true, NodePolicy>
+      base_type;
+  base_type tree_;
+
+  friend class multimap<Key, T, Compare, NodePolicy>;
+
+public:
+  typedef typename base_type::node_type node_type;
+  typedef typename base_type::insert_return_type insert_return_type;
+  typedef typename base_type::pointer pointer;
+  typedef typename base_type::const_pointer const_pointer;
+  typedef typename base_type::reference reference;
+  typedef typename base_type::const_reference const_reference;
+  typedef typename base_type::iterator iterator;
+  typedef typename base_type::const_iterator const_iterator;
+  typedef typename base_type::reverse_iterator reverse_iterator;
+  typedef typename base_type::const_reverse_iterator const_reverse_iterator;
+  typedef typename base_type::size_type size_type;
+  typedef typename base_type::difference_type difference_type;
+
+  map() = default;
+  explicit map(const key_compare &comp) : tree_(comp) {}
+  template <typename InputIterator,
+            typename std::enable_if<
+                tinystl::has_input_iterator_cat<InputIterator>::value,
+                int>::type = 0>
+  map(InputIterator first, InputIterator last) {
+    tree_.insert_unique(first, last);
+  }
+  map(std::initializer_list<value_type> l) {
+    tree_.insert_unique(l.begin(), l.end());
+  }
+  // [first, last) 须已按键有序，O(n) 建树
+  template <typename InputIterator,
+            typename std::enable_if<
+                tinystl::has_input_iterator_cat<InputIterator>::value,
+                int>::type = 0>
+  map(sorted_unique_t, InputIterator first, InputIterator last,
+      const key_compare &comp = key_compare())
+      : tree_(sorted_unique, first, last, comp) {}
+  map(const map &m) : tree_(m.tree_) {}
+  map(map &&m) : tree_(std::move(m.tree_)) {}
+
+  map &operator=(const map &m) {
+    tree_ = m.tree_;
+    return *this;
+  }
+  map &operator=(map &&m) noexcept {
+    tree_ = std::move(m.tree_);
+    return *this;
+  }
+  map &operator=(std::initializer_list<value_type> l) {
+    tree_.clear();
+    tree_.insert_unique(l.begin(), l.end());
+    return *this;
+  }
+
+  key_compare key_comp() const { return tree_.key_comp(); }
+  value_compare value_comp() const { return value_compare(tree_.key_comp()); }
+
+  iterator begin() noexcept { return tree_.begin(); }
+  const_iterator begin() const noexcept { return tree_.begin(); }
+  iterator end() noexcept { return tree_.end(); }
+  const_iterator end() const noexcept { return tree_.end(); }
+  reverse_iterator rbegin() noexcept { return tree_.rbegin(); }
+  const_reverse_iterator rbegin() const noexcept { return tree_.rbegin(); }
+  reverse_iterator rend() noexcept { return tree_.rend(); }
+  const_reverse_iterator rend() const noexcept { return tree_.rend(); }
+  const_iterator cbegin() const noexcept { return begin(); }
+  const_iterator cend() const noexcept { return end(); }
+
+  bool empty() const noexcept { return tree_.empty(); }
+  size_type size() const noexcept { return tree_.size(); }
+  size_type max_size() const noexcept { return tree_.max_size(); }
+
+  mapped_type &at(const key_type &key) {
+    iterator it = lower_bound(key);
+    THROW_OUT_OF_RANGE_IF(it == end() || key_comp()(key, it->first),
+                          "map<Key, T> no such element exists");
+    return it->second;
+  }
+  const mapped_type &at(const key_type &key) const {
+    const_iterator it = lower_bound(key);
+    THROW_OUT_OF_RANGE_IF(it == end() || key_comp()(key, it->first),
+                          "map<Key, T> no such element exists");
+    return it->second;
+  }
+  mapped_type &operator[](const key_type &key) {
+    iterator it = lower_bound(key);
+    if (it == end() || key_comp()(key, it->first)) {
+      it = tree_.emplace_hint_unique(it, key, T{});
+    }
+    return it->second;
+  }
+  mapped_type &operator[](key_type &&key) {
+    iterator it = lower_bound(key);
+    if (it == end() || key_comp()(key, it->first)) {
+      it = tree_.emplace_hint_unique(it, std::move(key), T{});
+    }
+    return it->second;
+  }
+
+  template <typename... Args>
+  tinystl::pair<iterator, bool> emplace(Args &&...args) {
+    return tree_.emplace_unique(std::forward<Args>(args)...);
+  }
+  template <typename... Args>
+  iterator emplace_hint(const_iterator hint, Args &&...args) {
+    return tree_.emplace_hint_unique(hint, std::forward<Args>(args)...);
+  }
+
+  tinystl::pair<iterator, bool> insert(const value_type &value) {
+    return tree_.insert_unique(value);
+  }
+  tinystl::pair<iterator, bool> insert(value_type &&value) {
+    return tree_.insert_unique(std::move(value));
+  }
+  iterator insert(const_iterator hint, const value_type &value) {
+    return tree_.insert_unique(hint, value);
+  }
+  iterator insert(const_iterator hint, value_type &&value) {
+    return tree_.insert_unique(hint, std::move(value));
+  }
+  template <typename InputIterator,
+            typename std::enable_if<
+                tinystl::has_input_iterator_cat<InputIterator>::value,
+                int>::type = 0>
+  void insert(InputIterator first, InputIterator last) {
+    tree_.insert_unique(first, last);
+  }
+  void insert(std::initializer_list<value_type> l) {
+    tree_.insert_unique(l.begin(), l.end());
+  }
+
+  node_type extract(const_iterator pos) { return tree_.extract(pos); }
+  node_type extract(const key_type &key) { return tree_.extract(key); }
+  insert_return_type insert(node_type &&nh) {
+    return tree_.insert_unique(std::move(nh));
+  }
+  iterator insert(const_iterator hint, node_type &&nh) {
+    return tree_.insert_unique(hint, std::move(nh));
+  }
+  void merge(map &other) { tree_.merge_unique(other.tree_); }
+  void merge(map &&other) { tree_.merge_unique(other.tree_); }
+  void merge(multimap<Key, T, Compare, NodePolicy> &other) {
+    tree_.merge_unique(other.tree_);
+  }
+  void merge(multimap<Key, T, Compare, NodePolicy> &&other) {
+    tree_.merge_unique(other.tree_);
+  }
+  // 基于 join 的集合运算，只改链接；other 的节点被并入或释放，之后为空
+  void union_with(map &other) { tree_.union_unique(other.tree_); }
+  void intersect_with(map &other) { tree_.intersection_unique(other.tree_); }
+  void subtract(map &other) { tree_.difference_unique(other.tree_); }
+  // 本容器的键都不大于 other 的键时把 other 接在后面，O(log n)
+  void join(map &other) { tree_.join(other.tree_); }
+  // 本容器保留键小于 key 的元素，其余移入 right
+  void split(const key_type &key, map &right) { tree_.split(key, right.tree_); }
+
+  iterator erase(const_iterator pos) { return tree_.erase(pos); }
+  iterator erase(const_iterator first, const_iterator last) {
+    return tree_.erase(first, last);
+  }
+  size_type erase(const key_type &key) { return tree_.erase_unique(key); }
+  void clear() { tree_.clear(); }
+
+  iterator find(const key_type &key) { return tree_.find(key); }
+  const_iterator find(const key_type &key) const { return tree_.find(key); }
+  size_type count(const key_type &key) const { return tree_.count_unique(key); }
+  iterator lower_bound(const key_type &key) { return tree_.lower_bound(key); }
+  const_iterator lower_bound(const key_type &key) const {
+    return tree_.lower_bound(key);
+  }
+  iterator upper_bound(const key_type &key) { return tree_.upper_bound(key); }
+  const_iterator upper_bound(const key_type &key) const {
+    return tree_.upper_bound(key);
+  }
+  tinystl::pair<iterator, iterator> equal_range(const key_type &key) {
+    return tree_.equal_range_unique(key);
+  }
+  tinystl::pair<const_iterator, const_iterator>
+  equal_range(const key_type &key) const {
+    return tree_.equal_range_unique(key);
+  }
+
+  // 比较器透明（如 less<>）时的异构查找，不构造临时键
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  iterator find(const K &key) {
+    return tree_.find(key);
+  }
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  const_iterator find(const K &key) const {
+    return tree_.find(key);
+  }
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  size_type count(const K &key) const {
+    return tree_.count_unique(key);
+  }
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  iterator lower_bound(const K &key) {
+    return tree_.lower_bound(key);
+  }
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  const_iterator lower_bound(const K &key) const {
+    return tree_.lower_bound(key);
+  }
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  iterator upper_bound(const K &key) {
+    return tree_.upper_bound(key);
+  }
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  const_iterator upper_bound(const K &key) const {
+    return tree_.upper_bound(key);
+  }
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  tinystl::pair<iterator, iterator> equal_range(const K &key) {
+    return tree_.equal_range_unique(key);
+  }
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  tinystl::pair<const_iterator, const_iterator>
+  equal_range(const K &key) const {
+    return tree_.equal_range_unique(key);
+  }
+
+  // 以下需 NodePolicy 为 rb_tree_order_statistics，均为 O(log n)
+  size_type rank(const key_type &key) const { return tree_.rank(key); }
+  iterator select(size_type n) { return tree_.select(n); }
+  const_iterator select(size_type n) const { return tree_.select(n); }
+  size_type index_of(const_iterator it) const { return tree_.index_of(it); }
+
+  void swap(map &m) noexcept { tree_.swap(m.tree_); }
+
+  friend bool operator==(const map &lhs, const map &rhs) {
+    return lhs.tree_ == rhs.tree_;
+  }
+  friend bool operator<(const map &lhs, const map &rhs) {
+    return lhs.tree_ < rhs.tree_;
+  }
+};
+
+template <typename Key, typename T, typename Compare, typename NodePolicy>
+bool operator!=(const map<Key, T, Compare, NodePolicy> &lhs,
+                const map<Key, T, Compare, NodePolicy> &rhs) {
+  return !(lhs == rhs);
+}
+template <typename Key, typename T, typename Compare, typename NodePolicy>
+void swap(map<Key, T, Compare, NodePolicy> &lhs,
+          map<Key, T, Compare, NodePolicy> &rhs) noexcept {
+  lhs.swap(rhs);
+}
+
+// 键值允许重复
+template <typename Key, typename T, typename Compare = tinystl::less<Key>,
+          typename NodePolicy = rb_tree_plain_node>
+class multimap {
+public:
+  typedef Key key_type;
+  typedef T mapped_type;
+  typedef tinystl::pair<const Key, T> value_type;
+  typedef Compare key_compare;
+
+  class value_compare : public binary_function<value_type, value_type, bool> {
+    friend class multimap<Key, T, Compare, NodePolicy>;
+
+  private:
+    Compare comp;
+    value_compare(Compare c) : comp(c) {}
+
+  public:
+    bool operator()(const value_type &lhs, const value_type &rhs) const {
+      return comp(lhs.first, rhs.first);
+    }
+  };
+
+private:
+  typedef tinystl::rb_tree<value_type, key_compare, true, NodePolicy>
+      base_type;
+  base_type tree_;
+
+  friend class map<Key, T, Compare, NodePolicy>;
+
+public:
+  typedef typename base_type::node_type node_type;
+  typedef typename base_type::pointer pointer;
+  typedef typename base_type::const_pointer const_pointer;
+  typedef typename base_type::reference reference;
+  typedef typename base_type::const_reference const_reference;
+  typedef typename base_type::iterator iterator;
+  typedef typename base_type::const_iterator const_iterator;
+  typedef typename base_type::reverse_iterator reverse_iterator;
+  typedef typename base_type::const_reverse_iterator const_reverse_iterator;
+  typedef typename base_type::size_type size_type;
+  typedef typename base_type::difference_type difference_type;
+
+  multimap() = default;
+  explicit multimap(const key_compare &comp) : tree_(comp) {}
+  template <typename InputIterator,
+            typename std::enable_if<
+                tinystl::has_input_iterator_cat<InputIterator>::value,
+                int>::type = 0>
+  multimap(InputIterator first, InputIterator last) {
+    tree_.insert_equal(first, last);
+  }
+  multimap(std::initializer_list<value_type> l) {
+    tree_.insert_equal(l.begin(), l.end());
+  }
+  // [first, last) 须已按键有序，O(n) 建树
+  template <typename InputIterator,
+            typename std::enable_if<
+                tinystl::has_input_iterator_cat<InputIterator>::value,
+                int>::type = 0>
+  multimap(sorted_equal_t, InputIterator first, InputIterator last,
+           const key_compare &comp = key_compare())
+      : tree_(sorted_equal, first, last, comp) {}
+  multimap(const multimap &m) : tree_(m.tree_) {}
+  multimap(multimap &&m) : tree_(std::move(m.tree_)) {}
+
+  multimap &operator=(const multimap &m) {
+    tree_ = m.tree_;
+    return *this;
+  }
+  multimap &operator=(multimap &&m) noexcept {
+    tree_ = std::move(m.tree_);
+    return *this;
+  }
+  multimap &operator=(std::initializer_list<value_type> l) {
+    tree_.clear();
+    tree_.insert_equal(l.begin(), l.end());
+    return *this;
+  }
+
+  key_compare key_comp() const { return tree_.key_comp(); }
+  value_compare value_comp() const { return value_compare(tree_.key_comp()); }
+
+  iterator begin() noexcept { return tree_.begin(); }
+  const_iterator begin() const noexcept { return tree_.begin(); }
+  iterator end() noexcept { return tree_.end(); }
+  const_iterator end() const noexcept { return tree_.end(); }
+  reverse_iterator rbegin() noexcept { return tree_.rbegin(); }
+  const_reverse_iterator rbegin() const noexcept { return tree_.rbegin(); }
+  reverse_iterator rend() noexcept { return tree_.rend(); }
+  const_reverse_iterator rend() const noexcept { return tree_.rend(); }
+  const_iterator cbegin() const noexcept { return begin(); }
+  const_iterator cend() const noexcept { return end(); }
+
+  bool empty() const noexcept { return tree_.empty(); }
+  size_type size() const noexcept { return tree_.size(); }
+  size_type max_size() const noexcept { return tree_.max_size(); }
+
+  template <typename... Args> iterator emplace(Args &&...args) {
+    return tree_.emplace_equal(std::forward<Args>(args)...);
+  }
+  template <typename... Args>
+  iterator emplace_hint(const_iterator hint, Args &&...args) {
+    return tree_.emplace_hint_equal(hint, std::forward<Args>(args)...);
+  }
+
+  iterator insert(const value_type &value) { return tree_.insert_equal(value); }
+  iterator insert(value_type &&value) {
+    return tree_.insert_equal(std::move(value));
+  }
+  iterator insert(const_iterator hint, const value_type &value) {
+    return tree_.insert_equal(hint, value);
+  }
+  iterator insert(const_iterator hint, value_type &&value) {
+    return tree_.insert_equal(hint, std::move(value));
+  }
+  template <typename InputIterator,
+            typename std::enable_if<
+                tinystl::has_input_iterator_cat<InputIterator>::value,
+                int>::type = 0>
+  void insert(InputIterator first, InputIterator last) {
+    tree_.insert_equal(first, last);
+  }
+  void insert(std::initializer_list<value_type> l) {
+    tree_.insert_equal(l.begin(), l.end());
+  }
+
+  node_type extract(const_iterator pos) { return tree_.extract(pos); }
+  node_type extract(const key_type &key) { return tree_.extract(key); }
+  iterator insert(node_type &&nh) { return tree_.insert_equal(std::move(nh)); }
+  iterator insert(const_iterator hint, node_type &&nh) {
+    return tree_.insert_equal(hint, std::move(nh));
+  }
+  void merge(multimap &other) { tree_.merge_equal(other.tree_); }
+  void merge(multimap &&other) { tree_.merge_equal(other.tree_); }
+  void merge(map<Key, T, Compare, NodePolicy> &other) {
+    tree_.merge_equal(other.tree_);
+  }
+  void merge(map<Key, T, Compare, NodePolicy> &&other) {
+    tree_.merge_equal(other.tree_);
+  }
+  // 本容器的键都不大于 other 的键时把 other 接在后面，O(log n)
+  void join(multimap &other) { tree_.join(other.tree_); }
+  // 本容器保留键小于 key 的元素，其余移入 right
+  void split(const key_type &key, multimap &right) {
+    tree_.split(key, right.tree_);
+  }
+
+  iterator erase(const_iterator pos) { return tree_.erase(pos); }
+  iterator erase(const_iterator first, const_iterator last) {
+    return tree_.erase(first, last);
+  }
+  size_type erase(const key_type &key) { return tree_.erase_multi(key); }
+  void clear() { tree_.clear(); }
+
+  iterator find(const key_type &key) { return tree_.find(key); }
+  const_iterator find(const key_type &key) const { return tree_.find(key); }
+  size_type count(const key_type &key) const { return tree_.count_multi(key); }
+  iterator lower_bound(const key_type &key) { return tree_.lower_bound(key); }
+  const_iterator lower_bound(const key_type &key) const {
+    return tree_.lower_bound(key);
+  }
+  iterator upper_bound(const key_type &key) { return tree_.upper_bound(key); }
+  const_iterator upper_bound(const key_type &key) const {
+    return tree_.upper_bound(key);
+  }
+  tinystl::pair<iterator, iterator> equal_range(const key_type &key) {
+    return tree_.equal_range_multi(key);
+  }
+  tinystl::pair<const_iterator, const_iterator>
+  equal_range(const key_type &key) const {
+    return tree_.equal_range_multi(key);
+  }
+
+  // 比较器透明（如 less<>）时的异构查找，不构造临时键
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  iterator find(const K &key) {
+    return tree_.find(key);
+  }
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  const_iterator find(const K &key) const {
+    return tree_.find(key);
+  }
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  size_type count(const K &key) const {
+    return tree_.count_multi(key);
+  }
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  iterator lower_bound(const K &key) {
+    return tree_.lower_bound(key);
+  }
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  const_iterator lower_bound(const K &key) const {
+    return tree_.lower_bound(key);
+  }
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  iterator upper_bound(const K &key) {
+    return tree_.upper_bound(key);
+  }
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  const_iterator upper_bound(const K &key) const {
+    return tree_.upper_bound(key);
+  }
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  tinystl::pair<iterator, iterator> equal_range(const K &key) {
+    return tree_.equal_range_multi(key);
+  }
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  tinystl::pair<const_iterator, const_iterator>
+  equal_range(const K &key) const {
+    return tree_.equal_range_multi(key);
+  }
+
+  // 以下需 NodePolicy 为 rb_tree_order_statistics，均为 O(log n)
+  size_type rank(const key_type &key) const { return tree_.rank(key); }
+  iterator select(size_type n) { return tree_.select(n); }
+  const_iterator select(size_type n) const { return tree_.select(n); }
+  size_type index_of(const_iterator it) const { return tree_.index_of(it); }
+
+  void swap(multimap &m) noexcept { tree_.swap(m.tree_); }
+
+  friend bool operator==(const multimap &lhs, const multimap &rhs) {
+    return lhs.tree_ == rhs.tree_;
+  }
+  friend bool operator<(const multimap &lhs, const multimap &rhs) {
+    return lhs.tree_ < rhs.tree_;
+  }
+};
+
+template <typename Key, typename T, typename Compare, typename NodePolicy>
+bool operator!=(const multimap<Key, T, Compare, NodePolicy> &lhs,
+                const multimap<Key, T, Compare, NodePolicy> &rhs) {
+  return !(lhs == rhs);
+}
+template <typename Key, typename T, typename Compare, typename NodePolicy>
+void swap(multimap<Key, T, Compare, NodePolicy> &lhs,
+          multimap<Key, T, Compare, NodePolicy> &rhs) noexcept {
+  lhs.swap(rhs);
+}
+} // namespace tinystl
+
+#endif
@@ -0,0 +1,124 @@
+#ifndef MYTINYSTL_NODE_HANDLE_H_
+#define MYTINYSTL_NODE_HANDLE_H_
+
+// 节点句柄：持有一个从容器中摘下（extract）的节点，元素与节点内存原样保留，
+// 插回同类容器时只重新链接，不分配也不拷贝元素；句柄析构时销毁仍持有的节点。
+// Container 需提供 node_ptr、value_type 与静态的 destory_node(node_ptr)。
+
+#include "exceptdef.h"
+#include <type_traits>
+#include <utility>
+
+namespace tinystl {
+template <typename Container> class node_handle_base {
+  friend Container;
+
+public:
+  typedef typename Container::value_type value_type;
+
+protected:
+  typedef typename Container::node_ptr node_ptr;
+
+  node_ptr node_;
+
+  explicit node_handle_base(node_ptr p) noexcept : node_(p) {}
+  node_ptr release() noexcept {
+    node_ptr p = node_;
+    node_ = nullptr;
+    return p;
+  }
+  node_ptr get() const noexcept { return node_; }
+
+public:
+  node_handle_base() noexcept : node_(nullptr) {}
+  node_handle_base(const node_handle_base &) = delete;
+  node_handle_base(node_handle_base &&nh) noexcept : node_(nh.release()) {}
+
+  node_handle_base &operator=(const node_handle_base &) = delete;
+  node_handle_base &operator=(node_handle_base &&nh) noexcept {
+    if (this != &nh) {
+      reset();
+      node_ = nh.release();
+    }
+    return *this;
+  }
+
+  ~node_handle_base() { reset(); }
+
+  bool empty() const noexcept { return node_ == nullptr; }
+  explicit operator bool() const noexcept { return node_ != nullptr; }
+
+  void swap(node_handle_base &nh) noexcept { std::swap(node_, nh.node_); }
+
+private:
+  void reset() noexcept {
+    if (node_ != nullptr) {
+      Container::destory_node(node_);
+      node_ = nullptr;
+    }
+  }
+};
+
+// 元素即键的容器（set、multiset、list）使用
+template <typename Container>
+class value_node_handle : public node_handle_base<Container> {
+  friend Container;
+  typedef node_handle_base<Container> base;
+
+  explicit value_node_handle(typename base::node_ptr p) noexcept : base(p) {}
+
+public:
+  typedef typename base::value_type value_type;
+
+  value_node_handle() noexcept = default;
+  value_node_handle(value_node_handle &&) noexcept = default;
+  value_node_handle &operator=(value_node_handle &&) noexcept = default;
+
+  value_type &value() const {
+    MY_DEBUG(!this->empty());
+    return this->get()->value;
+  }
+};
+
+// map、multimap 使用；key() 可修改键，以便换键后插回
+template <typename Container>
+class map_node_handle : public node_handle_base<Container> {
+  friend Container;
+  typedef node_handle_base<Container> base;
+
+  explicit map_node_handle(typename base::node_ptr p) noexcept : base(p) {}
+
+public:
+  typedef typename Container::key_type key_type;
+  typedef typename Container::mapped_type mapped_type;
+
+  map_node_handle() noexcept = default;
+  map_node_handle(map_node_handle &&) noexcept = default;
+  map_node_handle &operator=(map_node_handle &&) noexcept = default;
+
+  key_type &key() const {
+    MY_DEBUG(!this->empty());
+    return const_cast<key_type &>(this->get()->value.first);
+  }
+  mapped_type &mapped() const {
+    MY_DEBUG(!this->empty());
+    return this->get()->value.second;
+  }
+};
+
+template <typename Container>
+void swap(node_handle_base<Container> &lhs,
+          node_handle_base<Container> &rhs) noexcept {
+  lhs.swap(rhs);
+}
+
+// 以节点句柄插入键值唯一的容器时的返回值；
+// 插入失败时句柄原样归还给调用者
+template <typename Iterator, typename NodeType> struct node_insert_return {
+  Iterator position;
+  bool inserted;
+  NodeType node;
+};
+} // namespace tinystl
+
+#endif
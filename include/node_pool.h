@@ -0,0 +1,102 @@
+#ifndef MYTINYSTL_NODE_POOL_H_
+#define MYTINYSTL_NODE_POOL_H_
+
+// 定长节点池：按块向 tinystl::allocator 申请内存，块大小从 8 个节点起
+// 倍增到 1024 个；释放的节点挂进空闲链表，下次分配优先复用。
+// 节点内存只在 release() 或池析构时整体归还，池本身不构造也不析构对象。
+// 池不是线程安全的，由持有它的容器独占。
+
+#include "allocator.h"
+#include <cstddef>
+#include <utility>
+
+namespace tinystl {
+template <typename T> class node_pool {
+public:
+  typedef std::size_t size_type;
+
+private:
+  // 空闲时复用节点内存存放链表指针
+  union slot {
+    slot *next;
+    alignas(T) unsigned char storage[sizeof(T)];
+  };
+  typedef tinystl::allocator<slot> slot_allocator;
+
+  static constexpr size_type min_chunk = 8;
+  static constexpr size_type max_chunk = 1024;
+
+  slot *free_;
+  slot *chunks_;     // 每块的第一个槽用来串起所有块
+  slot *bump_;       // 最新一块中尚未分配过的部分 [bump_, bump_end_)
+  slot *bump_end_;
+  size_type next_chunk_;
+
+public:
+  node_pool() noexcept
+      : free_(nullptr), chunks_(nullptr), bump_(nullptr), bump_end_(nullptr),
+        next_chunk_(min_chunk) {}
+  node_pool(const node_pool &) = delete;
+  node_pool(node_pool &&p) noexcept : node_pool() { swap(p); }
+  node_pool &operator=(const node_pool &) = delete;
+  node_pool &operator=(node_pool &&p) noexcept {
+    if (this != &p) {
+      release();
+      swap(p);
+    }
+    return *this;
+  }
+  ~node_pool() { release(); }
+
+  T *allocate() {
+    if (free_ != nullptr) {
+      slot *s = free_;
+      free_ = s->next;
+      return reinterpret_cast<T *>(s);
+    }
+    if (bump_ == bump_end_) {
+      grow();
+    }
+    return reinterpret_cast<T *>(bump_++);
+  }
+  void deallocate(T *p) noexcept {
+    slot *s = reinterpret_cast<slot *>(p);
+    s->next = free_;
+    free_ = s;
+  }
+
+  // 归还所有块，调用前须已销毁池中的全部对象
+  void release() noexcept {
+    while (chunks_ != nullptr) {
+      slot *next = chunks_->next;
+      slot_allocator::deallocate(chunks_);
+      chunks_ = next;
+    }
+    free_ = nullptr;
+    bump_ = bump_end_ = nullptr;
+    next_chunk_ = min_chunk;
+  }
+
+  void swap(node_pool &p) noexcept {
+    std::swap(free_, p.free_);
+    std::swap(chunks_, p.chunks_);
+    std::swap(bump_, p.bump_);
+    std::swap(bump_end_, p.bump_end_);
+    std::swap(next_chunk_, p.next_chunk_);
+  }
+
+private:
+  void grow() {
+    slot *c = slot_allocator::allocate(next_chunk_ + 1);
+    c->next = chunks_;
+    chunks_ = c;
+    bump_ = c + 1;
+    bump_end_ = c + 1 + next_chunk_;
+    if (next_chunk_ < max_chunk) {
+      next_chunk_ *= 2;
+    }
+  }
+};
+} // namespace tinystl
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef MYTINYSTL_PARALLEL_H_
+#define MYTINYSTL_PARALLEL_H_
+
+// 分治算法用的简单 fork-join：递归的前几层把两个子问题分给两个线程，
+// 更深的层次串行执行，同时存在的线程数因此受递归层数约束。
+
+#include <cstddef>
+#include <future>
+#include <system_error>
+#include <thread>
+
+namespace tinystl {
+// 问题规模为 n 时允许并行的递归层数：约产生两倍于硬件线程数的叶子任务，
+// 以便负载不均时仍能占满各核；n 小于 grain 或只有单核时为 0
+inline unsigned parallel_depth(std::size_t n, std::size_t grain) {
+  unsigned threads = std::thread::hardware_concurrency();
+  if (n < grain || threads <= 1) {
+    return 0;
+  }
+  unsigned depth = 0;
+  while ((1u << depth) < 2 * threads) {
+    ++depth;
+  }
+  return depth;
+}
+
+// f 在新线程上、g 在当前线程上执行，两者都结束后返回；
+// f 抛出的异常在此重新抛出，无法创建线程时退化为依次执行
+template <typename F, typename G> void parallel_invoke(F &&f, G &&g) {
+  std::future<void> task;
+  try {
+    task = std::async(std::launch::async, [&f] { f(); });
+  } catch (const std::system_error &) {
+    f();
+    g();
+    return;
+  }
+  try {
+    g();
+  } catch (...) {
+    task.wait();
+    throw;
+  }
+  task.get();
+}
+} // namespace tinystl
+
+#endif
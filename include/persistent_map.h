@@ -0,0 +1,718 @@
+#ifndef MYTINYSTL_PERSISTENT_MAP_H_
+#define MYTINYSTL_PERSISTENT_MAP_H_
+
+// 持久化有序映射：红黑树的各个版本共享节点，节点带原子引用计数。
+// 插入与删除只复制根到目标位置的路径（O(log n) 个节点），其余子树共享，
+// 因此取快照（拷贝 persistent_map）为 O(1)；释放快照时只会真正析构
+// 该版本独有的节点。
+// 插入、删除采用 Okasaki / Kahrs 的函数式红黑树算法。所有内部函数都
+// 消耗参数中子树的所有权：引用计数为 1 的节点直接原地修改，否则先复制。
+// 因此同一套代码既实现了路径复制，也实现了 transient_map 的原地批量修改。
+// 不同版本可以分别被不同线程读取和释放；同一个对象的并发修改需外部同步。
+// 路径复制会拷贝元素，元素类型的拷贝构造不应抛出异常。
+
+#include "allocator.h"
+#include "construct.h"
+#include "exceptdef.h"
+#include "functional.h"
+#include "iterator.h"
+#include "rb_tree.h"
+#include "util.h"
+#include <atomic>
+#include <cstddef>
+#include <initializer_list>
+#include <utility>
+
+namespace tinystl {
+template <typename T> struct persistent_rb_node {
+  std::atomic<std::size_t> refs;
+  persistent_rb_node *left;
+  persistent_rb_node *right;
+  rb_tree_color_type color;
+  T value;
+};
+
+template <typename Key, typename T, typename Compare> class transient_map;
+
+// persistent_map 与 transient_map 共用的树操作
+template <typename Key, typename T, typename Compare>
+class persistent_map_base {
+public:
+  typedef Key key_type;
+  typedef T mapped_type;
+  typedef tinystl::pair<const Key, T> value_type;
+  typedef Compare key_compare;
+  typedef std::size_t size_type;
+  typedef std::ptrdiff_t difference_type;
+  typedef const value_type &const_reference;
+  typedef const value_type *const_pointer;
+
+protected:
+  typedef persistent_rb_node<value_type> node;
+  typedef node *node_ptr;
+  typedef tinystl::allocator<node> node_allocator;
+
+  // 红黑树高度不超过 2 * log2(n + 1)，元素个数小于 2^32 时足够
+  static constexpr int max_height = 64;
+
+public:
+  // 中序遍历的前向迭代器，用栈记录尚未访问的祖先
+  class const_iterator
+      : public tinystl::iterator<forward_iterator_tag, value_type> {
+    friend class persistent_map_base;
+
+    node_ptr stack_[max_height];
+    int depth_;
+
+    void push_left(node_ptr p) {
+      for (; p != nullptr; p = p->left) {
+        MY_DEBUG(depth_ < max_height);
+        stack_[depth_++] = p;
+      }
+    }
+
+  public:
+    typedef const value_type &reference;
+    typedef const value_type *pointer;
+
+    const_iterator() : depth_(0) {}
+    const_iterator(const const_iterator &it) : depth_(it.depth_) {
+      for (int i = 0; i < depth_; ++i) {
+        stack_[i] = it.stack_[i];
+      }
+    }
+    const_iterator &operator=(const const_iterator &it) {
+      depth_ = it.depth_;
+      for (int i = 0; i < depth_; ++i) {
+        stack_[i] = it.stack_[i];
+      }
+      return *this;
+    }
+
+    reference operator*() const { return stack_[depth_ - 1]->value; }
+    pointer operator->() const { return &stack_[depth_ - 1]->value; }
+    const_iterator &operator++() {
+      node_ptr p = stack_[--depth_];
+      push_left(p->right);
+      return *this;
+    }
+    const_iterator operator++(int) {
+      const_iterator tmp = *this;
+      ++*this;
+      return tmp;
+    }
+    bool operator==(const const_iterator &it) const {
+      return depth_ == it.depth_ &&
+             (depth_ == 0 || stack_[depth_ - 1] == it.stack_[depth_ - 1]);
+    }
+    bool operator!=(const const_iterator &it) const { return !(*this == it); }
+  };
+  typedef const_iterator iterator;
+
+protected:
+  node_ptr root_;
+  size_type size_;
+  key_compare key_comp_;
+
+  persistent_map_base(node_ptr root, size_type n, const key_compare &comp)
+      : root_(root), size_(n), key_comp_(comp) {}
+  ~persistent_map_base() { release(root_); }
+
+  static const key_type &key_of(node_ptr p) { return p->value.first; }
+  static bool is_red(node_ptr p) {
+    return p != nullptr && p->color == rb_tree_red;
+  }
+  static bool is_black(node_ptr p) {
+    return p != nullptr && p->color == rb_tree_black;
+  }
+
+  template <typename... Args> static node_ptr create_node(Args &&...args);
+  static void destory_node(node_ptr p);
+  static node_ptr retain(node_ptr p) {
+    if (p != nullptr) {
+      p->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+    return p;
+  }
+  static void release(node_ptr p);
+  // 取得 p 的独占版本：独占时原样返回，否则复制节点并释放 p
+  static node_ptr take(node_ptr p);
+  // 把 u 设为颜色 c、左右子树 l、r 的节点（u 须独占）
+  static node_ptr make(node_ptr u, rb_tree_color_type c, node_ptr l,
+                       node_ptr r) {
+    u->color = c;
+    u->left = l;
+    u->right = r;
+    return u;
+  }
+  static node_ptr make_black(node_ptr p) {
+    if (is_red(p)) {
+      p = take(p);
+      p->color = rb_tree_black;
+    }
+    return p;
+  }
+
+  static node_ptr balance(node_ptr a, node_ptr u, node_ptr b);
+  static node_ptr balance_left(node_ptr l, node_ptr u, node_ptr r);
+  static node_ptr balance_right(node_ptr l, node_ptr u, node_ptr r);
+  static node_ptr sub1(node_ptr p) {
+    MY_DEBUG(is_black(p));
+    p = take(p);
+    p->color = rb_tree_red;
+    return p;
+  }
+  static node_ptr append(node_ptr a, node_ptr b);
+
+  node_ptr find_node(const key_type &k) const;
+  // 以下均消耗 t 的所有权并返回新树
+  node_ptr insert_at(node_ptr t, node_ptr z);
+  template <typename M>
+  node_ptr assign_at(node_ptr t, const key_type &k, M &&obj);
+  node_ptr erase_at(node_ptr t, const key_type &k);
+
+  // 键不存在时插入 z，否则销毁 z；返回是否插入
+  bool insert_root(node_ptr z);
+  template <typename M> bool insert_or_assign_root(const key_type &k, M &&obj);
+  bool erase_root(const key_type &k);
+
+public:
+  key_compare key_comp() const { return key_comp_; }
+  bool empty() const noexcept { return size_ == 0; }
+  size_type size() const noexcept { return size_; }
+
+  const_iterator begin() const {
+    const_iterator it;
+    it.push_left(root_);
+    return it;
+  }
+  const_iterator end() const { return const_iterator(); }
+  const_iterator cbegin() const { return begin(); }
+  const_iterator cend() const { return end(); }
+
+  const_iterator find(const key_type &k) const;
+  const_iterator lower_bound(const key_type &k) const;
+  size_type count(const key_type &k) const {
+    return find_node(k) != nullptr ? 1 : 0;
+  }
+  bool contains(const key_type &k) const { return find_node(k) != nullptr; }
+  const mapped_type &at(const key_type &k) const {
+    node_ptr p = find_node(k);
+    THROW_OUT_OF_RANGE_IF(p == nullptr,
+                          "persistent_map<Key, T> no such element exists");
+    return p->value.second;
+  }
+};
+
+// 不可变映射：修改操作返回新版本，原对象不变
+template <typename Key, typename T, typename Compare = tinystl::less<Key>>
+class persistent_map : public persistent_map_base<Key, T, Compare> {
+  typedef persistent_map_base<Key, T, Compare> base;
+  friend class transient_map<Key, T, Compare>;
+
+  using typename base::node_ptr;
+  using base::root_;
+  using base::size_;
+  using base::key_comp_;
+
+  persistent_map(node_ptr root, std::size_t n, const Compare &comp)
+      : base(root, n, comp) {}
+
+  template <typename K, typename V, typename C>
+  friend bool operator==(const persistent_map<K, V, C> &lhs,
+                         const persistent_map<K, V, C> &rhs);
+
+public:
+  using typename base::key_type;
+  using typename base::mapped_type;
+  using typename base::value_type;
+  using typename base::key_compare;
+  using typename base::size_type;
+  typedef transient_map<Key, T, Compare> transient_type;
+
+  persistent_map() : base(nullptr, 0, key_compare()) {}
+  explicit persistent_map(const key_compare &comp) : base(nullptr, 0, comp) {}
+  persistent_map(std::initializer_list<value_type> l);
+  // O(1)：与 m 共享整棵树
+  persistent_map(const persistent_map &m)
+      : base(base::retain(m.root_), m.size_, m.key_comp_) {}
+  persistent_map(persistent_map &&m) noexcept
+      : base(m.root_, m.size_, m.key_comp_) {
+    m.root_ = nullptr;
+    m.size_ = 0;
+  }
+  persistent_map &operator=(const persistent_map &m) {
+    node_ptr old = root_;
+    root_ = base::retain(m.root_);
+    size_ = m.size_;
+    key_comp_ = m.key_comp_;
+    base::release(old);
+    return *this;
+  }
+  persistent_map &operator=(persistent_map &&m) noexcept {
+    if (this != &m) {
+      base::release(root_);
+      root_ = m.root_;
+      size_ = m.size_;
+      key_comp_ = m.key_comp_;
+      m.root_ = nullptr;
+      m.size_ = 0;
+    }
+    return *this;
+  }
+
+  // 以下均为 O(log n)，返回的新版本与 *this 共享未改动的子树；
+  // 键已存在（insert）或不存在（erase）时直接返回 *this 的拷贝
+  persistent_map insert(const value_type &value) const {
+    persistent_map m(*this);
+    m.insert_root(base::create_node(value));
+    return m;
+  }
+  template <typename M>
+  persistent_map insert_or_assign(const key_type &k, M &&obj) const {
+    persistent_map m(*this);
+    m.insert_or_assign_root(k, std::forward<M>(obj));
+    return m;
+  }
+  persistent_map erase(const key_type &k) const {
+    persistent_map m(*this);
+    m.erase_root(k);
+    return m;
+  }
+
+  // O(1)：返回共享本版本的可变副本，用于批量修改
+  transient_type transient() const { return transient_type(*this); }
+
+  void swap(persistent_map &m) noexcept {
+    std::swap(root_, m.root_);
+    std::swap(size_, m.size_);
+    std::swap(key_comp_, m.key_comp_);
+  }
+};
+
+// 可变副本：修改直接作用于自身，独占的节点原地修改、不再复制，
+// 因此批量修改的总代价接近普通红黑树；persistent() 之后继续修改
+// 不会影响已取出的版本
+template <typename Key, typename T, typename Compare = tinystl::less<Key>>
+class transient_map : public persistent_map_base<Key, T, Compare> {
+  typedef persistent_map_base<Key, T, Compare> base;
+  friend class persistent_map<Key, T, Compare>;
+
+  using typename base::node_ptr;
+  using base::root_;
+  using base::size_;
+  using base::key_comp_;
+
+  explicit transient_map(const persistent_map<Key, T, Compare> &m)
+      : base(base::retain(m.root_), m.size_, m.key_comp_) {}
+
+public:
+  using typename base::key_type;
+  using typename base::mapped_type;
+  using typename base::value_type;
+  using typename base::key_compare;
+  using typename base::size_type;
+
+  transient_map() : base(nullptr, 0, key_compare()) {}
+  transient_map(const transient_map &) = delete;
+  transient_map &operator=(const transient_map &) = delete;
+  transient_map(transient_map &&m) noexcept
+      : base(m.root_, m.size_, m.key_comp_) {
+    m.root_ = nullptr;
+    m.size_ = 0;
+  }
+
+  // 键已存在时不插入，返回 false
+  bool insert(const value_type &value) {
+    return this->insert_root(base::create_node(value));
+  }
+  bool insert(value_type &&value) {
+    return this->insert_root(base::create_node(std::move(value)));
+  }
+  template <typename... Args> bool emplace(Args &&...args) {
+    return this->insert_root(base::create_node(std::forward<Args>(args)...));
+  }
+  // 返回是否新插入
+  template <typename M> bool insert_or_assign(const key_type &k, M &&obj) {
+    return this->insert_or_assign_root(k, std::forward<M>(obj));
+  }
+  size_type erase(const key_type &k) { return this->erase_root(k) ? 1 : 0; }
+  void clear() {
+    base::release(root_);
+    root_ = nullptr;
+    size_ = 0;
+  }
+
+  // O(1)：取出当前内容的不可变版本
+  persistent_map<Key, T, Compare> persistent() const {
+    return persistent_map<Key, T, Compare>(base::retain(root_), size_,
+                                           key_comp_);
+  }
+};
+
+template <typename Key, typename T, typename Compare>
+template <typename... Args>
+typename persistent_map_base<Key, T, Compare>::node_ptr
+persistent_map_base<Key, T, Compare>::create_node(Args &&...args) {
+  node_ptr p = node_allocator::allocate(1);
+  try {
+    tinystl::construct(std::addressof(p->value), std::forward<Args>(args)...);
+  } catch (...) {
+    node_allocator::deallocate(p);
+    throw;
+  }
+  ::new (static_cast<void *>(&p->refs)) std::atomic<std::size_t>(1);
+  p->left = nullptr;
+  p->right = nullptr;
+  p->color = rb_tree_red;
+  return p;
+}
+
+template <typename Key, typename T, typename Compare>
+void persistent_map_base<Key, T, Compare>::destory_node(node_ptr p) {
+  tinystl::destory(std::addressof(p->value));
+  node_allocator::deallocate(p);
+}
+
+template <typename Key, typename T, typename Compare>
+void persistent_map_base<Key, T, Compare>::release(node_ptr p) {
+  // 只有引用计数降到 0 的节点才会继续释放子树，共享部分在此止步
+  while (p != nullptr && p->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    release(p->left);
+    node_ptr r = p->right;
+    destory_node(p);
+    p = r;
+  }
+}
+
+template <typename Key, typename T, typename Compare>
+typename persistent_map_base<Key, T, Compare>::node_ptr
+persistent_map_base<Key, T, Compare>::take(node_ptr p) {
+  if (p->refs.load(std::memory_order_acquire) == 1) {
+    return p;
+  }
+  node_ptr q = create_node(p->value);
+  q->color = p->color;
+  q->left = retain(p->left);
+  q->right = retain(p->right);
+  release(p);
+  return q;
+}
+
+// Kahrs 的 balance：a、b 为子树，u 提供根的值；消除一侧的连续红节点，
+// 两侧都为红时整体提升一层红色
+template <typename Key, typename T, typename Compare>
+typename persistent_map_base<Key, T, Compare>::node_ptr
+persistent_map_base<Key, T, Compare>::balance(node_ptr a, node_ptr u,
+                                              node_ptr b) {
+  if (is_red(a) && is_red(b)) {
+    a = take(a);
+    b = take(b);
+    a->color = rb_tree_black;
+    b->color = rb_tree_black;
+    return make(u, rb_tree_red, a, b);
+  }
+  if (is_red(a) && is_red(a->left)) {
+    node_ptr x = take(a);
+    node_ptr l = take(x->left);
+    l->color = rb_tree_black;
+    make(u, rb_tree_black, x->right, b);
+    return make(x, rb_tree_red, l, u);
+  }
+  if (is_red(a) && is_red(a->right)) {
+    node_ptr x = take(a);
+    node_ptr y = take(x->right);
+    make(u, rb_tree_black, y->right, b);
+    make(x, rb_tree_black, x->left, y->left);
+    return make(y, rb_tree_red, x, u);
+  }
+  if (is_red(b) && is_red(b->right)) {
+    node_ptr z = take(b);
+    node_ptr r = take(z->right);
+    r->color = rb_tree_black;
+    make(u, rb_tree_black, a, z->left);
+    return make(z, rb_tree_red, u, r);
+  }
+  if (is_red(b) && is_red(b->left)) {
+    node_ptr z = take(b);
+    node_ptr y = take(z->left);
+    make(u, rb_tree_black, a, y->left);
+    make(z, rb_tree_black, y->right, z->right);
+    return make(y, rb_tree_red, u, z);
+  }
+  return make(u, rb_tree_black, a, b);
+}
+
+// 左子树 l 的黑高比右子树 r 少一时重新平衡
+template <typename Key, typename T, typename Compare>
+typename persistent_map_base<Key, T, Compare>::node_ptr
+persistent_map_base<Key, T, Compare>::balance_left(node_ptr l, node_ptr u,
+                                                   node_ptr r) {
+  if (is_red(l)) {
+    l = take(l);
+    l->color = rb_tree_black;
+    return make(u, rb_tree_red, l, r);
+  }
+  if (is_black(r)) {
+    return balance(l, u, sub1(r));
+  }
+  MY_DEBUG(is_red(r) && is_black(r->left));
+  node_ptr z = take(r);
+  node_ptr y = take(z->left);
+  node_ptr c = z->right;
+  make(u, rb_tree_black, l, y->left);
+  node_ptr right = balance(y->right, z, sub1(c));
+  return make(y, rb_tree_red, u, right);
+}
+
+// 右子树 r 的黑高比左子树 l 少一时重新平衡
+template <typename Key, typename T, typename Compare>
+typename persistent_map_base<Key, T, Compare>::node_ptr
+persistent_map_base<Key, T, Compare>::balance_right(node_ptr l, node_ptr u,
+                                                    node_ptr r) {
+  if (is_red(r)) {
+    r = take(r);
+    r->color = rb_tree_black;
+    return make(u, rb_tree_red, l, r);
+  }
+  if (is_black(l)) {
+    return balance(sub1(l), u, r);
+  }
+  MY_DEBUG(is_red(l) && is_black(l->right));
+  node_ptr x = take(l);
+  node_ptr y = take(x->right);
+  node_ptr a = x->left;
+  node_ptr left = balance(sub1(a), x, y->left);
+  make(u, rb_tree_black, y->right, r);
+  return make(y, rb_tree_red, left, u);
+}
+
+// 拼接黑高相同的两棵树 a < b，用于删除节点后合并其左右子树
+template <typename Key, typename T, typename Compare>
+typename persistent_map_base<Key, T, Compare>::node_ptr
+persistent_map_base<Key, T, Compare>::append(node_ptr a, node_ptr b) {
+  if (a == nullptr) {
+    return b;
+  }
+  if (b == nullptr) {
+    return a;
+  }
+  if (is_red(a) && is_red(b)) {
+    node_ptr x = take(a);
+    node_ptr y = take(b);
+    node_ptr m = append(x->right, y->left);
+    if (is_red(m)) {
+      m = take(m);
+      make(x, rb_tree_red, x->left, m->left);
+      make(y, rb_tree_red, m->right, y->right);
+      return make(m, rb_tree_red, x, y);
+    }
+    make(y, rb_tree_red, m, y->right);
+    return make(x, rb_tree_red, x->left, y);
+  }
+  if (is_black(a) && is_black(b)) {
+    node_ptr x = take(a);
+    node_ptr y = take(b);
+    node_ptr m = append(x->right, y->left);
+    if (is_red(m)) {
+      m = take(m);
+      make(x, rb_tree_black, x->left, m->left);
+      make(y, rb_tree_black, m->right, y->right);
+      return make(m, rb_tree_red, x, y);
+    }
+    make(y, rb_tree_black, m, y->right);
+    return balance_left(x->left, x, y);
+  }
+  if (is_red(b)) {
+    node_ptr y = take(b);
+    y->left = append(a, y->left);
+    return y;
+  }
+  node_ptr x = take(a);
+  x->right = append(x->right, b);
+  return x;
+}
+
+template <typename Key, typename T, typename Compare>
+typename persistent_map_base<Key, T, Compare>::node_ptr
+persistent_map_base<Key, T, Compare>::find_node(const key_type &k) const {
+  node_ptr p = root_;
+  while (p != nullptr) {
+    if (key_comp_(k, key_of(p))) {
+      p = p->left;
+    } else if (key_comp_(key_of(p), k)) {
+      p = p->right;
+    } else {
+      return p;
+    }
+  }
+  return nullptr;
+}
+
+template <typename Key, typename T, typename Compare>
+typename persistent_map_base<Key, T, Compare>::node_ptr
+persistent_map_base<Key, T, Compare>::insert_at(node_ptr t, node_ptr z) {
+  if (t == nullptr) {
+    return z;
+  }
+  node_ptr u = take(t);
+  if (key_comp_(key_of(z), key_of(u))) {
+    node_ptr l = insert_at(u->left, z);
+    if (u->color == rb_tree_black) {
+      return balance(l, u, u->right);
+    }
+    u->left = l;
+  } else {
+    node_ptr r = insert_at(u->right, z);
+    if (u->color == rb_tree_black) {
+      return balance(u->left, u, r);
+    }
+    u->right = r;
+  }
+  return u;
+}
+
+template <typename Key, typename T, typename Compare>
+template <typename M>
+typename persistent_map_base<Key, T, Compare>::node_ptr
+persistent_map_base<Key, T, Compare>::assign_at(node_ptr t, const key_type &k,
+                                                M &&obj) {
+  if (key_comp_(k, key_of(t))) {
+    t = take(t);
+    t->left = assign_at(t->left, k, std::forward<M>(obj));
+  } else if (key_comp_(key_of(t), k)) {
+    t = take(t);
+    t->right = assign_at(t->right, k, std::forward<M>(obj));
+  } else if (t->refs.load(std::memory_order_acquire) == 1) {
+    t->value.second = std::forward<M>(obj);
+  } else {
+    // 共享的目标节点直接以新值复制，避免先拷贝旧值
+    node_ptr q = create_node(key_of(t), std::forward<M>(obj));
+    make(q, t->color, retain(t->left), retain(t->right));
+    release(t);
+    t = q;
+  }
+  return t;
+}
+
+template <typename Key, typename T, typename Compare>
+typename persistent_map_base<Key, T, Compare>::node_ptr
+persistent_map_base<Key, T, Compare>::erase_at(node_ptr t, const key_type &k) {
+  node_ptr u = take(t);
+  if (key_comp_(k, key_of(u))) {
+    if (is_black(u->left)) {
+      return balance_left(erase_at(u->left, k), u, u->right);
+    }
+    return make(u, rb_tree_red, erase_at(u->left, k), u->right);
+  }
+  if (key_comp_(key_of(u), k)) {
+    if (is_black(u->right)) {
+      return balance_right(u->left, u, erase_at(u->right, k));
+    }
+    return make(u, rb_tree_red, u->left, erase_at(u->right, k));
+  }
+  node_ptr m = append(u->left, u->right);
+  destory_node(u);
+  return m;
+}
+
+template <typename Key, typename T, typename Compare>
+bool persistent_map_base<Key, T, Compare>::insert_root(node_ptr z) {
+  if (find_node(key_of(z)) != nullptr) {
+    destory_node(z);
+    return false;
+  }
+  root_ = make_black(insert_at(root_, z));
+  ++size_;
+  return true;
+}
+
+template <typename Key, typename T, typename Compare>
+template <typename M>
+bool persistent_map_base<Key, T, Compare>::insert_or_assign_root(
+    const key_type &k, M &&obj) {
+  if (find_node(k) != nullptr) {
+    root_ = assign_at(root_, k, std::forward<M>(obj));
+    return false;
+  }
+  root_ = make_black(insert_at(root_, create_node(k, std::forward<M>(obj))));
+  ++size_;
+  return true;
+}
+
+template <typename Key, typename T, typename Compare>
+bool persistent_map_base<Key, T, Compare>::erase_root(const key_type &k) {
+  // 删除算法要求键存在，否则会破坏黑高
+  if (find_node(k) == nullptr) {
+    return false;
+  }
+  root_ = make_black(erase_at(root_, k));
+  --size_;
+  return true;
+}
+
+template <typename Key, typename T, typename Compare>
+typename persistent_map_base<Key, T, Compare>::const_iterator
+persistent_map_base<Key, T, Compare>::find(const key_type &k) const {
+  const_iterator it = lower_bound(k);
+  if (it != end() && key_comp_(k, it->first)) {
+    return end();
+  }
+  return it;
+}
+
+template <typename Key, typename T, typename Compare>
+typename persistent_map_base<Key, T, Compare>::const_iterator
+persistent_map_base<Key, T, Compare>::lower_bound(const key_type &k) const {
+  // 栈中保留下降路径上所有不小于 k 的节点，栈顶即为结果
+  const_iterator it;
+  node_ptr p = root_;
+  while (p != nullptr) {
+    if (key_comp_(key_of(p), k)) {
+      p = p->right;
+    } else {
+      it.stack_[it.depth_++] = p;
+      p = p->left;
+    }
+  }
+  return it;
+}
+
+template <typename Key, typename T, typename Compare>
+persistent_map<Key, T, Compare>::persistent_map(
+    std::initializer_list<value_type> l)
+    : base(nullptr, 0, key_compare()) {
+  for (const value_type &v : l) {
+    this->insert_root(base::create_node(v));
+  }
+}
+
+template <typename Key, typename T, typename Compare>
+bool operator==(const persistent_map<Key, T, Compare> &lhs,
+                const persistent_map<Key, T, Compare> &rhs) {
+  if (lhs.size() != rhs.size()) {
+    return false;
+  }
+  if (lhs.root_ == rhs.root_) {
+    return true; // 同一版本的快照
+  }
+  for (auto i = lhs.begin(), j = rhs.begin(); i != lhs.end(); ++i, ++j) {
+    if (!(*i == *j)) {
+      return false;
+    }
+  }
+  return true;
+}
+template <typename Key, typename T, typename Compare>
+bool operator!=(const persistent_map<Key, T, Compare> &lhs,
+                const persistent_map<Key, T, Compare> &rhs) {
+  return !(lhs == rhs);
+}
+template <typename Key, typename T, typename Compare>
+void swap(persistent_map<Key, T, Compare> &lhs,
+          persistent_map<Key, T, Compare> &rhs) noexcept {
+  lhs.swap(rhs);
+}
+} // namespace tinystl
+
+#endif
@@ -4,9 +4,12 @@
 #include "functional.h"
 #include "heap.h"
 #include "vector.h"
+#include <cstddef>
 namespace tinystl {
+// Arity 为底层堆每个节点的子节点数，见 heap.h；push 多于 pop 时可用 4
 template <typename T, typename Container = tinystl::vector<T>,
-          typename Compare = tinystl::less<typename Container::value_type>>
+          typename Compare = tinystl::less<typename Container::value_type>,
+          std::size_t Arity = 2>
 class priority_queue {
   typedef Container container_type;
   typedef Compare compare_type;
@@ -27,47 +30,47 @@ public:
   priority_queue() = default;
   priority_queue(const compare_type &compare) : compare_(compare) {}
   explicit priority_queue(size_type n) : c_(n) {
-    tinystl::make_heap(c_.begin(), c_.end(), compare_);
+    tinystl::make_heap<Arity>(c_.begin(), c_.end(), compare_);
   }
   priority_queue(size_type n, const value_type &t) : c_(n, t) {
-    tinystl::make_heap(c_.begin(), c_.end(), compare_);
+    tinystl::make_heap<Arity>(c_.begin(), c_.end(), compare_);
   }
   template <typename InputIterator>
   priority_queue(InputIterator first, InputIterator last) : c_(first, last) {
-    tinystl::make_heap(c_.begin(), c_.end(), compare_);
+    tinystl::make_heap<Arity>(c_.begin(), c_.end(), compare_);
   }
   priority_queue(std::initializer_list<value_type> l) : c_(l.begin(), l.end()) {
-    tinystl::make_heap(c_.begin(), c_.end(), compare_);
+    tinystl::make_heap<Arity>(c_.begin(), c_.end(), compare_);
   }
   priority_queue(const container_type &c) : c_(c) {
-    tinystl::make_heap(c_.begin(), c_.end(), compare_);
+    tinystl::make_heap<Arity>(c_.begin(), c_.end(), compare_);
   }
   priority_queue(container_type &&c) : c_(std::move(c)) {
-    tinystl::make_heap(c_.begin(), c_.end(), compare_);
+    tinystl::make_heap<Arity>(c_.begin(), c_.end(), compare_);
   }
   priority_queue(const priority_queue &p) : c_(p.c_), compare_(p.compare_) {
-    tinystl::make_heap(c_.begin(), c_.end(), compare_);
+    tinystl::make_heap<Arity>(c_.begin(), c_.end(), compare_);
   }
   priority_queue(priority_queue &&p)
       : c_(std::move(p.c_)), compare_(p.compare_) {
-    tinystl::make_heap(c_.begin(), c_.end(), compare_);
+    tinystl::make_heap<Arity>(c_.begin(), c_.end(), compare_);
   }
 
   priority_queue &operator=(const priority_queue &p) {
     c_ = p.c_;
     compare_ = p.compare_;
-    tinystl::make_heap(c_.begin(), c_.end(), compare_);
+    tinystl::make_heap<Arity>(c_.begin(), c_.end(), compare_);
     return *this;
   }
   priority_queue &operator=(priority_queue &&p) {
     c_ = std::move(p.c_);
     compare_ = p.compare_;
-    tinystl::make_heap(c_.begin(), c_.end(), compare_);
+    tinystl::make_heap<Arity>(c_.begin(), c_.end(), compare_);
     return *this;
   }
   priority_queue &operator=(std::initializer_list<value_type> l) {
     c_ = l;
-    tinystl::make_heap(c_.begin(), c_.end(), compare_);
+    tinystl::make_heap<Arity>(c_.begin(), c_.end(), compare_);
     return *this;
   }
 
@@ -80,18 +83,18 @@ public:
 
   template <typename... Args> void emplace(Args... args) {
     c_.emplace_back(std::forward<Args>(args)...);
-    tinystl::push_heap(c_.begin(), c_.end(), compare_);
+    tinystl::push_heap<Arity>(c_.begin(), c_.end(), compare_);
   }
   void push(const value_type &t) {
     c_.push_back(t);
-    tinystl::push_heap(c_.begin(), c_.end(), compare_);
+    tinystl::push_heap<Arity>(c_.begin(), c_.end(), compare_);
   }
   void push(value_type &&t) {
     c_.push_back(std::move(t));
-    tinystl::push_heap(c_.begin(), c_.end(), compare_);
+    tinystl::push_heap<Arity>(c_.begin(), c_.end(), compare_);
   }
   void pop() {
-    tinystl::pop_heap(c_.begin(), c_.end(), compare_);
+    tinystl::pop_heap<Arity>(c_.begin(), c_.end(), compare_);
     c_.pop_back();
   }
   void clear() {
@@ -2,9 +2,18 @@
 #define MYTINYSTL_RB_TREE_H_
 
 #include "allocator.h"
+#include "construct.h"
+#include "exceptdef.h"
 #include "iterator.h"
+#include "node_handle.h"
+#include "parallel.h"
 #include "type_traits.h"
+#include "util.h"
+#include <cstddef>
+#include <cstdint>
+#include <exception>
 #include <type_traits>
+#include <utility>
 
 // static constexpr rb_tree_color_type re_tree_red = false;
 
@@ -14,32 +23,59 @@ typedef bool rb_tree_color_type;
 static constexpr rb_tree_color_type rb_tree_red = false;
 static constexpr rb_tree_color_type rb_tree_black = true;
 
-template <typename T> struct rb_tree_node_base;
-template <typename T> struct rb_tree_node;
-template <typename T> struct rb_tree_iterator;
-template <typename T> struct rb_tree_const_iterator;
+// 节点策略：默认节点只有三个指针和颜色；
+// rb_tree_order_statistics 额外记录子树大小，以支持 O(log n) 的
+// rank / select / 迭代器距离，未选用的树不付出任何代价；
+// rb_tree_compact_node 把颜色存进 parent 指针的最低位，省去颜色字段
+// 及其对齐填充（64 位下基类由 32 字节降为 24 字节）
+struct rb_tree_plain_node {};
+struct rb_tree_order_statistics {};
+struct rb_tree_compact_node {};
+
+template <typename T, typename NodePolicy = rb_tree_plain_node>
+struct rb_tree_node_base;
+template <typename T, typename NodePolicy = rb_tree_plain_node>
+struct rb_tree_node;
+template <typename T, typename NodePolicy = rb_tree_plain_node>
+struct rb_tree_iterator;
+template <typename T, typename NodePolicy = rb_tree_plain_node>
+struct rb_tree_const_iterator;
 
 template <typename T, bool> struct rb_tree_node_traits_imp {
   typedef T value_type;
   typedef T key_type;
   typedef T mapped_type;
+
+  static const key_type &get_key(const value_type &value) { return value; }
 };
 
 template <typename T> struct rb_tree_node_traits_imp<T, true> {
   typedef T value_type;
   typedef typename std::remove_cv<typename T::first_type>::type key_type;
   typedef typename T::second_type mapped_type;
+
+  static const key_type &get_key(const value_type &value) {
+    return value.first;
+  }
 };
 
-template <typename T> struct rb_tree_value_traits {
-  static constexpr bool is_map = tinystl::is_pair<T>::value;
+// IsMap 默认由 T 是否为 pair 推导；set<pair<...>> 需显式传 false，
+// 否则会只按 first 比较
+template <typename T, bool IsMap = tinystl::is_pair<T>::value>
+struct rb_tree_value_traits {
+  static constexpr bool is_map = IsMap;
   typedef rb_tree_node_traits_imp<T, is_map> value_traits;
   typedef typename value_traits::value_type value_type;
   typedef typename value_traits::key_type key_type;
   typedef typename value_traits::mapped_type mapped_type;
+
+  static const key_type &get_key(const value_type &value) {
+    return value_traits::get_key(value);
+  }
 };
 
-template <class T> struct rb_tree_traits {
+template <typename T, typename NodePolicy = rb_tree_plain_node>
+struct rb_tree_traits {
   typedef rb_tree_color_type color_type;
 
   typedef rb_tree_value_traits<T> value_traits;
@@ -51,28 +87,96 @@ template <class T> struct rb_tree_traits {
   typedef const value_type *const_pointer;
   typedef const value_type &const_reference;
 
-  typedef rb_tree_node_base<T> *base_ptr;
-  typedef rb_tree_node<T> *node_ptr;
+  typedef rb_tree_node_base<T, NodePolicy> *base_ptr;
+  typedef rb_tree_node<T, NodePolicy> *node_ptr;
 };
 
-template <typename T> struct rb_tree_node_base {
+template <typename T, typename NodePolicy> struct rb_tree_node_base {
   typedef rb_tree_color_type color_type;
-  typedef rb_tree_node_base<T> *base_ptr;
-  typedef rb_tree_node<T> *node_ptr;
+  typedef rb_tree_node_base<T, NodePolicy> *base_ptr;
+  typedef rb_tree_node<T, NodePolicy> *node_ptr;
+
+  static constexpr bool has_size = false;
 
   base_ptr parent;
   base_ptr left;
   base_ptr right;
   color_type color;
 
+  void init() {
+    parent = nullptr;
+    color = rb_tree_red;
+  }
+  base_ptr get_parent() const { return parent; }
+  void set_parent(base_ptr p) { parent = p; }
+  color_type get_color() const { return color; }
+  void set_color(color_type c) { color = c; }
+
   base_ptr get_base_ptr() { return &*this; }
   node_ptr get_node_ptr() { return static_cast<node_ptr>(&*this); }
   node_ptr &get_node_ref() { return static_cast<node_ptr &>(&*this); }
 };
 
-template <typename T> struct rb_tree_node : public rb_tree_node_base<T> {
-  typedef rb_tree_node_base<T> *base_ptr;
-  typedef rb_tree_node<T> *node_ptr;
+template <typename T>
+struct rb_tree_node_base<T, rb_tree_order_statistics> {
+  typedef rb_tree_color_type color_type;
+  typedef rb_tree_node_base<T, rb_tree_order_statistics> *base_ptr;
+  typedef rb_tree_node<T, rb_tree_order_statistics> *node_ptr;
+
+  static constexpr bool has_size = true;
+
+  base_ptr parent;
+  base_ptr left;
+  base_ptr right;
+  color_type color;
+  std::size_t size; // 以该节点为根的子树的节点数
+
+  void init() {
+    parent = nullptr;
+    color = rb_tree_red;
+  }
+  base_ptr get_parent() const { return parent; }
+  void set_parent(base_ptr p) { parent = p; }
+  color_type get_color() const { return color; }
+  void set_color(color_type c) { color = c; }
+
+  base_ptr get_base_ptr() { return &*this; }
+  node_ptr get_node_ptr() { return static_cast<node_ptr>(&*this); }
+};
+
+template <typename T> struct rb_tree_node_base<T, rb_tree_compact_node> {
+  typedef rb_tree_color_type color_type;
+  typedef rb_tree_node_base<T, rb_tree_compact_node> *base_ptr;
+  typedef rb_tree_node<T, rb_tree_compact_node> *node_ptr;
+
+  static constexpr bool has_size = false;
+
+  std::uintptr_t parent_color; // parent 指针，最低位为颜色
+  base_ptr left;
+  base_ptr right;
+
+  // set_parent 与 set_color 都保留另一半，新节点须先整体写入
+  void init() { parent_color = std::uintptr_t(rb_tree_red); }
+
+  base_ptr get_parent() const {
+    return reinterpret_cast<base_ptr>(parent_color & ~std::uintptr_t(1));
+  }
+  void set_parent(base_ptr p) {
+    parent_color = reinterpret_cast<std::uintptr_t>(p) | (parent_color & 1);
+  }
+  color_type get_color() const { return (parent_color & 1) != 0; }
+  void set_color(color_type c) {
+    parent_color = (parent_color & ~std::uintptr_t(1)) | std::uintptr_t(c);
+  }
+
+  base_ptr get_base_ptr() { return &*this; }
+  node_ptr get_node_ptr() { return static_cast<node_ptr>(&*this); }
+};
+
+template <typename T, typename NodePolicy>
+struct rb_tree_node : public rb_tree_node_base<T, NodePolicy> {
+  typedef rb_tree_node_base<T, NodePolicy> *base_ptr;
+  typedef rb_tree_node<T, NodePolicy> *node_ptr;
 
   T value;
 
@@ -80,22 +184,22 @@ template <typename T> struct rb_tree_node : public rb_tree_node_base<T> {
   node_ptr get_node_ptr() { return &*this; }
 };
 
-template <typename T>
+template <typename T, typename NodePolicy = rb_tree_plain_node>
 struct rb_tree_iterator_base
     : tinystl::iterator<bidirectional_iterator_tag, T> {
-  typedef rb_tree_node_base<T> *base_ptr;
+  typedef rb_tree_node_base<T, NodePolicy> *base_ptr;
 
   base_ptr node;
 
   rb_tree_iterator_base() : node(nullptr) {}
   void inc() {
     if (node->right != nullptr) {
-      node = rb_tree_min(node->left);
+      node = rb_tree_min(node->right);
     } else {
-      auto p = node->parent;
+      auto p = rb_tree_parent(node);
       while (p->right == node) {
         node = p;
-        p = p->parent;
+        p = rb_tree_parent(p);
       }
       if (node->right != p) {
         node = p; // 应对根节点无右节点执行inc的情况
@@ -103,94 +207,118 @@ struct rb_tree_iterator_base
     }
   }
   void dec() {
-    if (node->parent->parent == node && rb_tree_is_red(node)) {
-      node = node->right;
+    if (rb_tree_parent(rb_tree_parent(node)) == node && rb_tree_is_red(node)) {
+      node = node->right; // end() 的前驱是最右节点
     } else if (node->left != nullptr) {
       node = rb_tree_max(node->left);
     } else {
-      auto p = node->parent;
+      auto p = rb_tree_parent(node);
       while (p->left == node) {
         node = p;
-        p = p->parent;
+        p = rb_tree_parent(p);
       }
       node = p;
     }
   }
 
-  bool operator==(const rb_tree_iterator_base<T> &t) { return node == t.node; }
-  bool operator!=(const rb_tree_iterator_base<T> &t) { return node != t.node; }
+  bool operator==(const rb_tree_iterator_base<T, NodePolicy> &t) const {
+    return node == t.node;
+  }
+  bool operator!=(const rb_tree_iterator_base<T, NodePolicy> &t) const {
+    return node != t.node;
+  }
 };
 
-template <typename T>
-struct rb_tree_iterator : public rb_tree_iterator_base<T> {
-  typedef rb_tree_node_base<T> *base_ptr;
-  typedef rb_tree_node<T> *node_ptr;
-  typedef rb_tree_iterator<T> self;
-  typedef rb_tree_traits<T> tree_traits;
+template <typename T, typename NodePolicy>
+struct rb_tree_iterator : public rb_tree_iterator_base<T, NodePolicy> {
+  typedef rb_tree_node_base<T, NodePolicy> *base_ptr;
+  typedef rb_tree_node<T, NodePolicy> *node_ptr;
+  typedef rb_tree_iterator<T, NodePolicy> self;
+  typedef rb_tree_traits<T, NodePolicy> tree_traits;
   typedef typename tree_traits::value_type value_type;
   typedef typename tree_traits::reference reference;
   typedef typename tree_traits::pointer pointer;
 
-  using rb_tree_iterator_base<T>::node;
+  using rb_tree_iterator_base<T, NodePolicy>::node;
 
   rb_tree_iterator() {}
   rb_tree_iterator(base_ptr ptr) { node = ptr; }
   rb_tree_iterator(node_ptr ptr) { node = ptr->get_base_ptr(); }
   rb_tree_iterator(const rb_tree_iterator &t) { node = t.node; }
-  rb_tree_iterator(const rb_tree_const_iterator<T> &t) { node = t.node; }
+  rb_tree_iterator(const rb_tree_const_iterator<T, NodePolicy> &t) {
+    node = t.node;
+  }
 
+  self &operator=(const rb_tree_iterator &t) {
+    node = t.node;
+    return *this;
+  }
   self &operator++() {
-    node->inc();
+    this->inc();
     return *this;
   }
-  self &operator++(int) {
-    auto tmp = *this;
-    node->inc();
+  self operator++(int) {
+    self tmp = *this;
+    this->inc();
     return tmp;
   }
   self &operator--() {
-    node->dec();
+    this->dec();
     return *this;
   }
-  self &operator--(int) {
-    auto tmp = *this;
-    node->dec();
-    return tmp();
+  self operator--(int) {
+    self tmp = *this;
+    this->dec();
+    return tmp;
   }
   reference operator*() const { return node->get_node_ptr()->value; }
   pointer operator->() const { return &*(*this); }
 };
 
-template <typename T> struct rb_tree_const_iterator : rb_tree_iterator_base<T> {
-  typedef rb_tree_node_base<T> *base_ptr;
-  typedef rb_tree_node<T> *node_ptr;
-  typedef rb_tree_const_iterator<T> self;
-  typedef rb_tree_traits<T> tree_traits;
+template <typename T, typename NodePolicy>
+struct rb_tree_const_iterator : rb_tree_iterator_base<T, NodePolicy> {
+  typedef rb_tree_node_base<T, NodePolicy> *base_ptr;
+  typedef rb_tree_node<T, NodePolicy> *node_ptr;
+  typedef rb_tree_const_iterator<T, NodePolicy> self;
+  typedef rb_tree_traits<T, NodePolicy> tree_traits;
+  typedef typename tree_traits::value_type value_type;
+  typedef typename tree_traits::const_reference reference;
+  typedef typename tree_traits::const_pointer pointer;
   typedef typename tree_traits::const_reference const_reference;
   typedef typename tree_traits::const_pointer const_pointer;
 
-  using rb_tree_iterator_base<T>::node;
+  using rb_tree_iterator_base<T, NodePolicy>::node;
+  rb_tree_const_iterator() {}
   rb_tree_const_iterator(base_ptr ptr) { node = ptr; }
   rb_tree_const_iterator(node_ptr ptr) { node = ptr->get_base_ptr(); }
-  rb_tree_const_iterator(const rb_tree_iterator<T> &t) { node = t.node; }
-  rb_tree_const_iterator(const rb_tree_const_iterator<T> &t) { node = t.node; }
+  rb_tree_const_iterator(const rb_tree_iterator<T, NodePolicy> &t) {
+    node = t.node;
+  }
+  rb_tree_const_iterator(const rb_tree_const_iterator<T, NodePolicy> &t) {
+    node = t.node;
+  }
+
+  self &operator=(const rb_tree_const_iterator &t) {
+    node = t.node;
+    return *this;
+  }
   self &operator++() {
-    node->inc();
+    this->inc();
     return *this;
   }
-  self &operator++(int) {
-    auto tmp = *this;
-    node->inc();
+  self operator++(int) {
+    self tmp = *this;
+    this->inc();
     return tmp;
   }
   self &operator--() {
-    node->dec();
+    this->dec();
     return *this;
   }
-  self &operator--(int) {
-    auto tmp = *this;
-    node->dec();
-    return tmp();
+  self operator--(int) {
+    self tmp = *this;
+    this->dec();
+    return tmp;
   }
   const_reference operator*() const { return node->get_node_ptr()->value; }
   const_pointer operator->() const { return &*(*this); }
@@ -208,93 +336,169 @@ template <typename Nodeptr> Nodeptr rb_tree_min(Nodeptr ptr) {
   }
   return ptr;
 }
+// 所有对 parent 与颜色的访问都经由以下函数，节点布局由 NodePolicy 决定
+// 新分配的节点：parent 为空，红色
+template <typename Nodeptr> void rb_tree_init_node(Nodeptr ptr) {
+  ptr->init();
+}
+template <typename Nodeptr> Nodeptr rb_tree_parent(Nodeptr ptr) {
+  return ptr->get_parent();
+}
+template <typename Nodeptr, typename Baseptr>
+void rb_tree_set_parent(Nodeptr ptr, Baseptr p) {
+  ptr->set_parent(p);
+}
+template <typename Nodeptr> rb_tree_color_type rb_tree_color(Nodeptr ptr) {
+  return ptr->get_color();
+}
+template <typename Nodeptr>
+void rb_tree_set_color(Nodeptr ptr, rb_tree_color_type c) {
+  ptr->set_color(c);
+}
 template <typename Nodeptr> bool rb_tree_is_red(Nodeptr ptr) {
-  return ptr->color == rb_tree_red;
+  return rb_tree_color(ptr) == rb_tree_red;
 }
 template <typename Nodeptr> void rb_tree_set_black(Nodeptr ptr) {
-  ptr->color = rb_tree_black;
+  rb_tree_set_color(ptr, rb_tree_black);
 }
 template <typename Nodeptr> void rb_tree_set_red(Nodeptr ptr) {
-  ptr->color = rb_tree_red;
+  rb_tree_set_color(ptr, rb_tree_red);
 }
 template <typename Nodeptr> bool rb_tree_is_lchild(Nodeptr ptr) {
-  return ptr->parent->left == ptr;
+  return rb_tree_parent(ptr)->left == ptr;
+}
+// 子树大小的维护：只有带 size 的节点（rb_tree_order_statistics）才会真正
+// 读写，其余节点上这些函数在编译期即为空操作
+template <typename Nodeptr>
+struct rb_tree_has_size
+    : public std::integral_constant<
+          bool, std::remove_pointer<Nodeptr>::type::has_size> {};
+
+template <typename Nodeptr> std::size_t rb_tree_size(Nodeptr ptr) {
+  return ptr == nullptr ? 0 : ptr->size;
+}
+template <typename Nodeptr>
+void rb_tree_update_size(Nodeptr ptr, std::true_type) {
+  ptr->size = 1 + rb_tree_size(ptr->left) + rb_tree_size(ptr->right);
+}
+template <typename Nodeptr>
+void rb_tree_update_size(Nodeptr, std::false_type) {}
+template <typename Nodeptr> void rb_tree_update_size(Nodeptr ptr) {
+  rb_tree_update_size(ptr, rb_tree_has_size<Nodeptr>());
+}
+template <typename Nodeptr>
+void rb_tree_copy_size(Nodeptr dst, Nodeptr src, std::true_type) {
+  dst->size = src->size;
+}
+template <typename Nodeptr>
+void rb_tree_copy_size(Nodeptr, Nodeptr, std::false_type) {}
+template <typename Nodeptr> void rb_tree_copy_size(Nodeptr dst, Nodeptr src) {
+  rb_tree_copy_size(dst, src, rb_tree_has_size<Nodeptr>());
 }
+template <typename Nodeptr>
+void rb_tree_set_size(Nodeptr ptr, std::size_t n, std::true_type) {
+  ptr->size = n;
+}
+template <typename Nodeptr>
+void rb_tree_set_size(Nodeptr, std::size_t, std::false_type) {}
+template <typename Nodeptr> void rb_tree_set_size(Nodeptr ptr, std::size_t n) {
+  rb_tree_set_size(ptr, n, rb_tree_has_size<Nodeptr>());
+}
+// ptr 的所有祖先（直到 root）的 size 加上 delta
+template <typename Nodeptr>
+void rb_tree_adjust_ancestors(Nodeptr ptr, Nodeptr root, int delta,
+                              std::true_type) {
+  while (ptr != root) {
+    ptr = rb_tree_parent(ptr);
+    ptr->size += delta;
+  }
+}
+template <typename Nodeptr>
+void rb_tree_adjust_ancestors(Nodeptr, Nodeptr, int, std::false_type) {}
+template <typename Nodeptr>
+void rb_tree_adjust_ancestors(Nodeptr ptr, Nodeptr root, int delta) {
+  rb_tree_adjust_ancestors(ptr, root, delta, rb_tree_has_size<Nodeptr>());
+}
+
 template <typename Nodeptr>
 void rb_tree_left_rotate(Nodeptr ptr, Nodeptr &root) {
   auto y = ptr->right;
   ptr->right = y->left;
   if (y->left != nullptr) {
-    y->left->parent = ptr;
+    rb_tree_set_parent(y->left, ptr);
   }
-  y->parent = ptr->parent;
+  rb_tree_set_parent(y, rb_tree_parent(ptr));
   if (ptr == root) {
     root = y;
   } else if (rb_tree_is_lchild(ptr)) {
-    y->parent->left = y;
+    rb_tree_parent(y)->left = y;
   } else {
-    y->parent->right = y;
+    rb_tree_parent(y)->right = y;
   }
   y->left = ptr;
-  ptr->parent = y;
+  rb_tree_set_parent(ptr, y);
+  rb_tree_copy_size(y, ptr);
+  rb_tree_update_size(ptr);
 }
 template <typename Nodeptr>
 void rb_tree_right_rotate(Nodeptr ptr, Nodeptr &root) {
   auto y = ptr->left;
-  ptr->right = y->left;
-  if (y->left != nullptr) {
-    y->left->parent = ptr;
+  ptr->left = y->right;
+  if (y->right != nullptr) {
+    rb_tree_set_parent(y->right, ptr);
   }
-  y->parent = ptr->parent;
+  rb_tree_set_parent(y, rb_tree_parent(ptr));
   if (ptr == root) {
-    root == y;
+    root = y;
   } else if (rb_tree_is_lchild(ptr)) {
-    y->parent->left = y;
+    rb_tree_parent(y)->left = y;
   } else {
-    y->parent->right = y;
+    rb_tree_parent(y)->right = y;
   }
   y->right = ptr;
-  ptr->parent = y;
+  rb_tree_set_parent(ptr, y);
+  rb_tree_copy_size(y, ptr);
+  rb_tree_update_size(ptr);
 }
 
 template <typename Nodeptr>
 void rb_tree_insert_rebalance(Nodeptr ptr, Nodeptr &root) {
   rb_tree_set_red(ptr);
-  while (ptr != root && rb_tree_is_red(ptr->parent)) {
-    if (rb_tree_is_lchild(ptr->parent)) {
+  while (ptr != root && rb_tree_is_red(rb_tree_parent(ptr))) {
+    if (rb_tree_is_lchild(rb_tree_parent(ptr))) {
       // 父节点是祖父节点的左节点
-      auto uncle = ptr->parent->parent->right;
+      auto uncle = rb_tree_parent(rb_tree_parent(ptr))->right;
       if (uncle != nullptr && rb_tree_is_red(uncle)) {
-        rb_tree_set_black(ptr->parent);
+        rb_tree_set_black(rb_tree_parent(ptr));
         rb_tree_set_black(uncle);
-        ptr = ptr->parent->parent;
+        ptr = rb_tree_parent(rb_tree_parent(ptr));
         rb_tree_set_red(ptr);
       } else {
-        if (rb_tree_is_lchild(ptr)) {
-          ptr = ptr->parent;
+        if (!rb_tree_is_lchild(ptr)) {
+          ptr = rb_tree_parent(ptr);
           rb_tree_left_rotate(ptr, root);
         }
-        rb_tree_set_black(ptr->parent);
-        rb_tree_set_red(ptr->parent->parent);
-        rb_tree_right_rotate(ptr->parent->parent);
+        rb_tree_set_black(rb_tree_parent(ptr));
+        rb_tree_set_red(rb_tree_parent(rb_tree_parent(ptr)));
+        rb_tree_right_rotate(rb_tree_parent(rb_tree_parent(ptr)), root);
         break;
       }
     } else {
       // 父节点是祖父节点的右节点
-      auto uncle = ptr->parent->parent->left;
+      auto uncle = rb_tree_parent(rb_tree_parent(ptr))->left;
       if (uncle != nullptr && rb_tree_is_red(uncle)) {
-        rb_tree_set_black(ptr->parent);
+        rb_tree_set_black(rb_tree_parent(ptr));
         rb_tree_set_black(uncle);
-        ptr = ptr->parent->parent;
+        ptr = rb_tree_parent(rb_tree_parent(ptr));
         rb_tree_set_red(ptr);
       } else {
-        if (!rb_tree_is_lchild(ptr)) {
-          ptr = ptr->parent;
+        if (rb_tree_is_lchild(ptr)) {
+          ptr = rb_tree_parent(ptr);
           rb_tree_right_rotate(ptr, root);
         }
-        rb_tree_set_black(ptr->parent);
-        rb_tree_set_red(ptr->parent->parent);
-        rb_tree_left_rotate(ptr->parent->parent);
+        rb_tree_set_black(rb_tree_parent(ptr));
+        rb_tree_set_red(rb_tree_parent(rb_tree_parent(ptr)));
+        rb_tree_left_rotate(rb_tree_parent(rb_tree_parent(ptr)), root);
         break;
       }
     }
@@ -302,62 +506,101 @@ void rb_tree_insert_rebalance(Nodeptr ptr, Nodeptr &root) {
   rb_tree_set_black(root);
 }
 
+// 把 node 挂到 parent 的左/右侧（parent 为 header 时作为根），维护
+// header 中的 leftmost/rightmost，然后重新平衡
+template <typename Nodeptr>
+void rb_tree_insert_at(Nodeptr header, Nodeptr parent, Nodeptr node,
+                       bool add_left) {
+  rb_tree_set_parent(node, parent);
+  node->left = nullptr;
+  node->right = nullptr;
+  if (parent == header) {
+    rb_tree_set_parent(header, node);
+    header->left = node;
+    header->right = node;
+  } else if (add_left) {
+    parent->left = node;
+    if (header->left == parent) {
+      header->left = node;
+    }
+  } else {
+    parent->right = node;
+    if (header->right == parent) {
+      header->right = node;
+    }
+  }
+  rb_tree_set_size(node, 1);
+  auto root = rb_tree_parent(header);
+  rb_tree_adjust_ancestors(node, root, 1);
+  rb_tree_insert_rebalance(node, root);
+  rb_tree_set_parent(header, root);
+}
+
 template <class NodePtr> NodePtr rb_tree_next(NodePtr node) noexcept {
   if (node->right != nullptr)
     return rb_tree_min(node->right);
   while (!rb_tree_is_lchild(node))
-    node = node->parent;
-  return node->parent;
+    node = rb_tree_parent(node);
+  return rb_tree_parent(node);
 }
 
+// 从 header 所在的树中摘除 ptr 并重新平衡，返回被摘除的节点（即 ptr）
 template <typename Nodeptr>
-Nodeptr rb_tree_erase_rebalance(Nodeptr ptr, Nodeptr &root, Nodeptr &leftmost,
-                                Nodeptr &rightmost) {
+Nodeptr rb_tree_erase_rebalance(Nodeptr ptr, Nodeptr header) {
+  Nodeptr root = rb_tree_parent(header);
+  Nodeptr &leftmost = header->left;
+  Nodeptr &rightmost = header->right;
+  // y 为实际从树中摘除位置上的节点，x 为顶替 y 的子节点
   auto y =
-      (ptr->left != nullptr || ptr->right != nullptr) ? ptr : rb_tree_next(ptr);
+      (ptr->left == nullptr || ptr->right == nullptr) ? ptr : rb_tree_next(ptr);
   auto x = (y->left != nullptr) ? y->left : y->right;
   Nodeptr xp = nullptr;
+  rb_tree_adjust_ancestors(y, root, -1);
   if (y != ptr) {
+    // ptr 有两个子节点：用后继 y 顶替 ptr，x 顶替 y
     y->left = ptr->left;
-    ptr->left->parent = y;
+    rb_tree_set_parent(ptr->left, y);
     if (ptr->right == y) {
       xp = y;
     } else {
-      xp = y->parent;
-      y->parent->left = x;
+      xp = rb_tree_parent(y);
+      rb_tree_parent(y)->left = x;
       if (x != nullptr) {
-        x->parent = y->parent;
+        rb_tree_set_parent(x, rb_tree_parent(y));
       }
       y->right = ptr->right;
-      ptr->right->parent = y;
+      rb_tree_set_parent(ptr->right, y);
     }
 
-    y->parent = ptr->parent;
     if (ptr == root) {
       root = y;
     } else {
       if (rb_tree_is_lchild(ptr)) {
-        ptr->parent->left = y;
+        rb_tree_parent(ptr)->left = y;
       } else {
-        ptr->parent->right = y;
+        rb_tree_parent(ptr)->right = y;
       }
     }
-    std::swap(y->color, ptr->color);
+    rb_tree_set_parent(y, rb_tree_parent(ptr));
+    auto color = rb_tree_color(y);
+    rb_tree_set_color(y, rb_tree_color(ptr));
+    rb_tree_set_color(ptr, color);
+    rb_tree_copy_size(y, ptr);
     y = ptr;
   } else {
-    xp = y->parent;
+    xp = rb_tree_parent(y);
+    if (x != nullptr) {
+      rb_tree_set_parent(x, rb_tree_parent(y));
+    }
     if (y == root) {
       root = x;
     } else {
       if (rb_tree_is_lchild(y)) {
-        y->parent->left = x;
+        rb_tree_parent(y)->left = x;
       } else {
-        y->parent->right = x;
+        rb_tree_parent(y)->right = x;
       }
     }
-    if (x != nullptr) {
-      x->parent = y->parent;
-    }
 
     if (leftmost == y) {
       leftmost = x == nullptr ? xp : rb_tree_min(x);
@@ -381,7 +624,7 @@ Nodeptr rb_tree_erase_rebalance(Nodeptr ptr, Nodeptr &root, Nodeptr &leftmost,
             (bro->right == nullptr || !rb_tree_is_red(bro->right))) {
           rb_tree_set_red(bro);
           x = xp;
-          xp = xp->parent;
+          xp = rb_tree_parent(xp);
         } else {
           if ((bro->right == nullptr || !rb_tree_is_red(bro->right))) {
             rb_tree_set_red(bro);
@@ -391,10 +634,10 @@ Nodeptr rb_tree_erase_rebalance(Nodeptr ptr, Nodeptr &root, Nodeptr &leftmost,
             rb_tree_right_rotate(bro, root);
             bro = xp->right;
           }
-          bro->color = xp->color;
+          rb_tree_set_color(bro, rb_tree_color(xp));
           rb_tree_set_black(xp);
           if (bro->right != nullptr) {
-            rb_tree_set_balck(bro->right);
+            rb_tree_set_black(bro->right);
           }
           rb_tree_left_rotate(xp, root);
           break;
@@ -412,7 +655,7 @@ Nodeptr rb_tree_erase_rebalance(Nodeptr ptr, Nodeptr &root, Nodeptr &leftmost,
             (bro->right == nullptr || !rb_tree_is_red(bro->right))) { // case 2
           rb_tree_set_red(bro);
           x = xp;
-          xp = xp->parent;
+          xp = rb_tree_parent(xp);
         } else {
           if (bro->left == nullptr || !rb_tree_is_red(bro->left)) { // case 3
             if (bro->right != nullptr)
@@ -422,7 +665,7 @@ Nodeptr rb_tree_erase_rebalance(Nodeptr ptr, Nodeptr &root, Nodeptr &leftmost,
             bro = xp->left;
           }
           // 转为 case 4
-          bro->color = xp->color;
+          rb_tree_set_color(bro, rb_tree_color(xp));
           rb_tree_set_black(xp);
           if (bro->left != nullptr)
             rb_tree_set_black(bro->left);
@@ -430,190 +673,1723 @@ Nodeptr rb_tree_erase_rebalance(Nodeptr ptr, Nodeptr &root, Nodeptr &leftmost,
           break;
         }
       }
-      if (x != nullptr) {
-        rb_tree_set_black(x);
-      }
     }
-    return y;
+    if (x != nullptr) {
+      rb_tree_set_black(x);
+    }
   }
+  rb_tree_set_parent(header, root);
+  return y;
 }
 
-template <typename T, typename Compare> class rb_tree {
+
+// 标记输入区间已按键有序，用于 O(n) 批量建树；
+// sorted_unique 会丢弃相邻的等值元素
+struct sorted_equal_t {};
+struct sorted_unique_t {};
+static constexpr sorted_equal_t sorted_equal{};
+static constexpr sorted_unique_t sorted_unique{};
+
+template <typename T, typename Compare,
+          bool IsMap = tinystl::is_pair<T>::value,
+          typename NodePolicy = rb_tree_plain_node>
+class rb_tree {
 public:
-  typedef rb_tree_node<T> node_type;
-  typedef rb_tree_node_base<T> base_type;
-  typedef node_type *node_ptr;
+  typedef rb_tree_value_traits<T, IsMap> value_traits;
+  typedef rb_tree_node<T, NodePolicy> tree_node;
+  typedef rb_tree_node_base<T, NodePolicy> base_type;
+  typedef tree_node *node_ptr;
   typedef base_type *base_ptr;
 
   typedef tinystl::allocator<T> data_allocator;
-  typedef tinystl::allocator<node_type> node_allocator;
+  typedef tinystl::allocator<tree_node> node_allocator;
   typedef tinystl::allocator<base_type> base_allocator;
 
-  typedef typename data_allocator::size_type size_type;
-  typedef typename data_allocator::value_type value_type;
-  typedef typename data_allocator::pointer pointer;
-  typedef typename data_allocator::const_pointer const_pointer;
-  typedef typename data_allocator::reference reference;
-  typedef typename data_allocator::const_reference const_reference;
+  typedef typename value_traits::key_type key_type;
+  typedef typename value_traits::mapped_type mapped_type;
+  typedef typename value_traits::value_type value_type;
+  typedef value_type *pointer;
+  typedef const value_type *const_pointer;
+  typedef value_type &reference;
+  typedef const value_type &const_reference;
+  typedef std::size_t size_type;
+  typedef std::ptrdiff_t difference_type;
+
+  typedef rb_tree_iterator<T, NodePolicy> iterator;
+  typedef rb_tree_const_iterator<T, NodePolicy> const_iterator;
+  typedef tinystl::reverse_iterator<iterator> reverse_iterator;
+  typedef tinystl::reverse_iterator<const_iterator> const_reverse_iterator;
 
   typedef Compare key_compare;
 
+  typedef typename std::conditional<IsMap, map_node_handle<rb_tree>,
+                                    value_node_handle<rb_tree>>::type
+      node_type;
+  typedef node_insert_return<iterator, node_type> insert_return_type;
+
 private:
+  friend node_handle_base<rb_tree>;
+
   base_ptr header_;
   size_type node_count_;
   key_compare key_comp_;
 
 public:
-  base_ptr &root() const { return header_->parent; }
+  base_ptr root() const { return rb_tree_parent(header_); }
+  void set_root(base_ptr p) const { rb_tree_set_parent(header_, p); }
   base_ptr &leftmost() const { return header_->left; }
   base_ptr &rightmost() const { return header_->right; }
 
 protected:
-  template <typename... Args> node_ptr create_node(Args... args);
-  void destory_node(node_ptr);
+  static const key_type &key_of(base_ptr p) {
+    return value_traits::get_key(p->get_node_ptr()->value);
+  }
+
+  template <typename... Args> node_ptr create_node(Args &&...args);
+  static void destory_node(node_ptr);
+  // 红黑树的高度不超过 2 log2(n + 1)，复制与销毁的显式栈按此定长
+  static constexpr size_type max_height = 2 * 8 * sizeof(size_type);
   base_ptr copy_from(base_ptr, base_ptr);
+  base_ptr copy_tree(base_ptr, base_ptr, unsigned depth);
   node_ptr clone_node(base_ptr);
   void erase_since(base_ptr);
+  void destroy_tree(base_ptr, unsigned depth);
   void rb_tree_init();
-  void clear() {
-    if (node_count_ != 0) {
-      erase_since(root());
+
+  // 插入位置以 (x, p) 表示：p 为新节点的父节点，x 非空表示强制挂在左侧；
+  // 对 unique 版本，p 为空时 x 为已存在的等值节点
+  typedef tinystl::pair<base_ptr, base_ptr> insert_pos;
+  insert_pos get_insert_unique_pos(const key_type &k);
+  insert_pos get_insert_equal_pos(const key_type &k);
+  insert_pos get_insert_hint_unique_pos(const_iterator hint,
+                                        const key_type &k);
+  insert_pos get_insert_hint_equal_pos(const_iterator hint, const key_type &k);
+  iterator insert_node_at(base_ptr x, base_ptr p, node_ptr z);
+  template <typename V>
+  tinystl::pair<iterator, bool> insert_value_unique(V &&value);
+  template <typename V>
+  iterator insert_hint_value_unique(const_iterator hint, V &&value);
+
+  // K 为 key_type，或比较器透明时任何能与键比较的类型
+  template <typename K> base_ptr lower_bound_node(const K &k) const;
+  template <typename K> base_ptr upper_bound_node(const K &k) const;
+  template <typename K> base_ptr find_node(const K &k) const {
+    base_ptr j = lower_bound_node(k);
+    return (j == header_ || key_comp_(k, key_of(j))) ? header_ : j;
+  }
+  template <typename K>
+  tinystl::pair<const_iterator, const_iterator>
+  equal_range_unique_node(const K &k) const {
+    const_iterator it = find_node(k);
+    const_iterator next = it;
+    return tinystl::pair<const_iterator, const_iterator>(
+        it, it == end() ? it : ++next);
+  }
+  template <typename K>
+  tinystl::pair<const_iterator, const_iterator>
+  equal_range_multi_node(const K &k) const {
+    return tinystl::pair<const_iterator, const_iterator>(lower_bound_node(k),
+                                                         upper_bound_node(k));
+  }
+  template <typename K> size_type count_multi_node(const K &k) const {
+    auto p = equal_range_multi_node(k);
+    return static_cast<size_type>(tinystl::distance(p.first, p.second));
+  }
+
+  template <typename InputIterator>
+  void build_sorted(InputIterator first, InputIterator last, bool unique) {
+    build_sorted_dispatch(first, last, unique,
+                          tinystl::iterator_category(first));
+  }
+  template <typename InputIterator>
+  void build_sorted_dispatch(InputIterator first, InputIterator last,
+                             bool unique, input_iterator_tag);
+  template <typename ForwardIterator>
+  void build_sorted_dispatch(ForwardIterator first, ForwardIterator last,
+                             bool unique, forward_iterator_tag);
+  template <typename ForwardIterator>
+  base_ptr build_balanced(ForwardIterator &first, ForwardIterator last,
+                          size_type n, size_type depth, size_type red_depth,
+                          bool unique, base_ptr parent);
+  static size_type balanced_red_depth(size_type n) {
+    size_type depth = 0;
+    while ((n >> (depth + 1)) != 0) {
+      ++depth;
+    }
+    return depth;
+  }
+  static base_ptr link_balanced(base_ptr &head, size_type n, size_type depth,
+                                size_type red_depth, base_ptr parent);
+
+  // 基于 join 的集合运算在摘下的子树上进行：子树以根和黑高表示，根的
+  // parent 为空且可以是红色；黑高计入根自身，空树为 0
+  struct subtree {
+    base_ptr root;
+    size_type bh;
+  };
+  // 两棵树合计达到这个规模时，集合运算才把递归分给多个线程
+  static constexpr size_type parallel_grain = 1 << 16;
+
+  static size_type black_height(base_ptr p) {
+    size_type h = 0;
+    for (; p != nullptr; p = p->left) {
+      h += rb_tree_is_red(p) ? 0 : 1;
     }
-    leftmost() = header_;
-    rightmost() = header_;
-    root() = nullptr;
-    node_count_ = 0;
+    return h;
   }
+  subtree detach_root();
+  void attach_root(subtree t, size_type n);
+  static void expose(subtree t, subtree &l, subtree &r);
+  static subtree join_at(subtree l, base_ptr m, subtree r);
+  static subtree join_right(subtree l, base_ptr m, subtree r);
+  static subtree join_left(subtree l, base_ptr m, subtree r);
+  static subtree join2(subtree l, subtree r);
+  static subtree split_last(subtree t, base_ptr &last);
+  subtree split_at(subtree t, const key_type &k, base_ptr *mid,
+                   subtree &right) const;
+  subtree union_at(subtree a, subtree b, unsigned depth, size_type &dup);
+  subtree intersect_at(subtree a, subtree b, unsigned depth,
+                       size_type &matched);
+  subtree difference_at(subtree a, subtree b, unsigned depth,
+                        size_type &matched);
+  void count_split(rb_tree &right, size_type n, std::true_type);
+  void count_split(rb_tree &right, size_type n, std::false_type);
 
 public:
-  rb_tree() { rb_tree_init(); }
+  rb_tree() : header_(nullptr), node_count_(0), key_comp_() {
+    rb_tree_init();
+  }
+  explicit rb_tree(const key_compare &comp)
+      : header_(nullptr), node_count_(0), key_comp_(comp) {
+    rb_tree_init();
+  }
+  // [first, last) 须已按键有序：先按键序逐个分配节点，再 O(n) 链接成
+  // 完全平衡的树，无需比较和旋转
+  template <typename InputIterator,
+            typename std::enable_if<
+                tinystl::has_input_iterator_cat<InputIterator>::value,
+                int>::type = 0>
+  rb_tree(sorted_equal_t, InputIterator first, InputIterator last,
+          const key_compare &comp = key_compare())
+      : header_(nullptr), node_count_(0), key_comp_(comp) {
+    rb_tree_init();
+    try {
+      build_sorted(first, last, false);
+    } catch (...) {
+      base_allocator::deallocate(header_);
+      throw;
+    }
+  }
+  template <typename InputIterator,
+            typename std::enable_if<
+                tinystl::has_input_iterator_cat<InputIterator>::value,
+                int>::type = 0>
+  rb_tree(sorted_unique_t, InputIterator first, InputIterator last,
+          const key_compare &comp = key_compare())
+      : header_(nullptr), node_count_(0), key_comp_(comp) {
+    rb_tree_init();
+    try {
+      build_sorted(first, last, true);
+    } catch (...) {
+      base_allocator::deallocate(header_);
+      throw;
+    }
+  }
   rb_tree(const rb_tree &);
-  rb_tree(rb_tree &&) noexcept;
+  rb_tree(rb_tree &&);
 
   rb_tree &operator=(const rb_tree &t);
   rb_tree &operator=(rb_tree &&t) noexcept;
 
   ~rb_tree();
+
+  template <typename InputIterator,
+            typename std::enable_if<
+                tinystl::has_input_iterator_cat<InputIterator>::value,
+                int>::type = 0>
+  void assign(sorted_equal_t, InputIterator first, InputIterator last) {
+    clear();
+    build_sorted(first, last, false);
+  }
+  template <typename InputIterator,
+            typename std::enable_if<
+                tinystl::has_input_iterator_cat<InputIterator>::value,
+                int>::type = 0>
+  void assign(sorted_unique_t, InputIterator first, InputIterator last) {
+    clear();
+    build_sorted(first, last, true);
+  }
+
+  iterator begin() noexcept { return leftmost(); }
+  const_iterator begin() const noexcept { return leftmost(); }
+  iterator end() noexcept { return header_; }
+  const_iterator end() const noexcept { return header_; }
+  reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+  const_reverse_iterator rbegin() const noexcept {
+    return const_reverse_iterator(end());
+  }
+  reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+  const_reverse_iterator rend() const noexcept {
+    return const_reverse_iterator(begin());
+  }
+  const_iterator cbegin() const noexcept { return begin(); }
+  const_iterator cend() const noexcept { return end(); }
+
+  bool empty() const noexcept { return node_count_ == 0; }
+  size_type size() const noexcept { return node_count_; }
+  size_type max_size() const noexcept {
+    return static_cast<size_type>(-1) / sizeof(tree_node);
+  }
+  key_compare key_comp() const { return key_comp_; }
+
+  template <typename... Args>
+  tinystl::pair<iterator, bool> emplace_unique(Args &&...args);
+  template <typename... Args> iterator emplace_equal(Args &&...args);
+  template <typename... Args>
+  iterator emplace_hint_unique(const_iterator hint, Args &&...args);
+  template <typename... Args>
+  iterator emplace_hint_equal(const_iterator hint, Args &&...args);
+
+  // 已存在等值元素时不分配节点
+  tinystl::pair<iterator, bool> insert_unique(const value_type &value) {
+    return insert_value_unique(value);
+  }
+  tinystl::pair<iterator, bool> insert_unique(value_type &&value) {
+    return insert_value_unique(std::move(value));
+  }
+  iterator insert_equal(const value_type &value) {
+    return emplace_equal(value);
+  }
+  iterator insert_equal(value_type &&value) {
+    return emplace_equal(std::move(value));
+  }
+  // hint 正确（紧邻插入位置之后）时为均摊 O(1)，
+  // 因此以 end() 为 hint 插入有序序列是线性的
+  iterator insert_unique(const_iterator hint, const value_type &value) {
+    return insert_hint_value_unique(hint, value);
+  }
+  iterator insert_unique(const_iterator hint, value_type &&value) {
+    return insert_hint_value_unique(hint, std::move(value));
+  }
+  iterator insert_equal(const_iterator hint, const value_type &value) {
+    return emplace_hint_equal(hint, value);
+  }
+  iterator insert_equal(const_iterator hint, value_type &&value) {
+    return emplace_hint_equal(hint, std::move(value));
+  }
+  template <typename InputIterator,
+            typename std::enable_if<
+                tinystl::has_input_iterator_cat<InputIterator>::value,
+                int>::type = 0>
+  void insert_unique(InputIterator first, InputIterator last) {
+    for (; first != last; ++first) {
+      insert_unique(end(), *first);
+    }
+  }
+  template <typename InputIterator,
+            typename std::enable_if<
+                tinystl::has_input_iterator_cat<InputIterator>::value,
+                int>::type = 0>
+  void insert_equal(InputIterator first, InputIterator last) {
+    for (; first != last; ++first) {
+      insert_equal(end(), *first);
+    }
+  }
+
+  // 节点句柄：摘下与插回都只改链接，不分配也不拷贝元素
+  node_type extract(const_iterator pos);
+  node_type extract(const key_type &k) {
+    iterator it = find(k);
+    return it == end() ? node_type() : extract(it);
+  }
+  insert_return_type insert_unique(node_type &&nh);
+  iterator insert_unique(const_iterator hint, node_type &&nh);
+  iterator insert_equal(node_type &&nh);
+  iterator insert_equal(const_iterator hint, node_type &&nh);
+  // 把 t 中的节点逐个摘下挂到本树；unique 版本保留 t 中键已存在的节点
+  void merge_unique(rb_tree &t);
+  void merge_equal(rb_tree &t);
+
+  // 基于 join 的集合运算，只改链接、不分配节点。设两树大小为 m <= n，
+  // 并、交、差为 O(m log(n/m + 1))，规模较大时递归在多个线程上并行。
+  // 结果留在本树（键相同时保留本树的元素），t 的节点被并入或释放，
+  // t 变为空；两树须使用等价的比较器，且比较器不得抛出异常。
+  // 以下三者只适用于键唯一的树
+  void union_unique(rb_tree &t);
+  void intersection_unique(rb_tree &t);
+  void difference_unique(rb_tree &t);
+  // 本树的键都不大于 t 的键时把 t 接在本树之后，O(log n)
+  void join(rb_tree &t);
+  // 本树保留键小于 k 的元素，其余移入 right（right 原有元素被清除）。
+  // 拆分本身为 O(log n)；节点不带子树大小时还需 O(min) 清点较小的一侧
+  void split(const key_type &k, rb_tree &right);
+
+  iterator erase(const_iterator pos);
+  iterator erase(const_iterator first, const_iterator last);
+  size_type erase_unique(const key_type &k);
+  size_type erase_multi(const key_type &k);
+  void clear();
+
+  iterator find(const key_type &k) { return find_node(k); }
+  const_iterator find(const key_type &k) const { return find_node(k); }
+  size_type count_unique(const key_type &k) const {
+    return find_node(k) == header_ ? 0 : 1;
+  }
+  size_type count_multi(const key_type &k) const {
+    return count_multi_node(k);
+  }
+  iterator lower_bound(const key_type &k) { return lower_bound_node(k); }
+  const_iterator lower_bound(const key_type &k) const {
+    return lower_bound_node(k);
+  }
+  iterator upper_bound(const key_type &k) { return upper_bound_node(k); }
+  const_iterator upper_bound(const key_type &k) const {
+    return upper_bound_node(k);
+  }
+  tinystl::pair<iterator, iterator> equal_range_unique(const key_type &k) {
+    return equal_range_unique_node(k);
+  }
+  tinystl::pair<const_iterator, const_iterator>
+  equal_range_unique(const key_type &k) const {
+    return equal_range_unique_node(k);
+  }
+  tinystl::pair<iterator, iterator> equal_range_multi(const key_type &k) {
+    return equal_range_multi_node(k);
+  }
+  tinystl::pair<const_iterator, const_iterator>
+  equal_range_multi(const key_type &k) const {
+    return equal_range_multi_node(k);
+  }
+
+  // 比较器声明了 is_transparent（如 less<>）时，查找可直接使用任何能与键
+  // 比较的类型，例如用 const char* 查 string 键，不构造临时的 key_type
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  iterator find(const K &k) {
+    return find_node(k);
+  }
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  const_iterator find(const K &k) const {
+    return find_node(k);
+  }
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  size_type count_unique(const K &k) const {
+    return find_node(k) == header_ ? 0 : 1;
+  }
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  size_type count_multi(const K &k) const {
+    return count_multi_node(k);
+  }
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  iterator lower_bound(const K &k) {
+    return lower_bound_node(k);
+  }
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  const_iterator lower_bound(const K &k) const {
+    return lower_bound_node(k);
+  }
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  iterator upper_bound(const K &k) {
+    return upper_bound_node(k);
+  }
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  const_iterator upper_bound(const K &k) const {
+    return upper_bound_node(k);
+  }
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  tinystl::pair<iterator, iterator> equal_range_unique(const K &k) {
+    return equal_range_unique_node(k);
+  }
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  tinystl::pair<const_iterator, const_iterator>
+  equal_range_unique(const K &k) const {
+    return equal_range_unique_node(k);
+  }
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  tinystl::pair<iterator, iterator> equal_range_multi(const K &k) {
+    return equal_range_multi_node(k);
+  }
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  tinystl::pair<const_iterator, const_iterator>
+  equal_range_multi(const K &k) const {
+    return equal_range_multi_node(k);
+  }
+
+  // 以下仅适用于 NodePolicy 为 rb_tree_order_statistics 的树，均为 O(log n)
+  // 键小于 k 的元素个数，即 lower_bound(k) 的下标
+  size_type rank(const key_type &k) const;
+  // 第 n 小（从 0 起）的元素，n >= size() 时返回 end()
+  iterator select(size_type n);
+  const_iterator select(size_type n) const;
+  // 迭代器在中序中的下标，end() 为 size()
+  size_type index_of(const_iterator it) const;
+  difference_type distance(const_iterator first, const_iterator last) const {
+    return static_cast<difference_type>(index_of(last)) -
+           static_cast<difference_type>(index_of(first));
+  }
+
+  void swap(rb_tree &t) noexcept {
+    std::swap(header_, t.header_);
+    std::swap(node_count_, t.node_count_);
+    std::swap(key_comp_, t.key_comp_);
+  }
 };
-template <typename T, typename Compare>
+
+template <typename T, typename Compare, bool IsMap, typename NodePolicy>
 template <typename... Args>
-typename rb_tree<T, Compare>::node_ptr
-rb_tree<T, Compare>::create_node(Args... args) {
+typename rb_tree<T, Compare, IsMap, NodePolicy>::node_ptr
+rb_tree<T, Compare, IsMap, NodePolicy>::create_node(Args &&...args) {
   auto tmp = node_allocator::allocate(1);
   try {
     tinystl::construct(std::addressof(tmp->value), std::forward<Args>(args)...);
     tmp->left = nullptr;
     tmp->right = nullptr;
-    tmp->parent = nullptr;
+    rb_tree_init_node(tmp);
   } catch (...) {
-    tinystl::destory(std::addressof(tmp->value));
     node_allocator::deallocate(tmp);
     throw;
   }
   return tmp;
 }
-template <typename T, typename Compare>
-void rb_tree<T, Compare>::destory_node(node_ptr p) {
+template <typename T, typename Compare, bool IsMap, typename NodePolicy>
+void rb_tree<T, Compare, IsMap, NodePolicy>::destory_node(node_ptr p) {
   tinystl::destory(std::addressof(p->value));
   node_allocator::deallocate(p);
 }
-template <typename T, typename Compare>
-typename rb_tree<T, Compare>::base_ptr
-rb_tree<T, Compare>::copy_from(base_ptr x, base_ptr p) {
-  auto top = clone_node(x);
-  top->parent = p;
+// 按中序逐个克隆，副本的节点大致按键序相邻分配，之后顺序遍历副本时
+// 对缓存更友好；用显式栈代替递归。栈中是源树中尚未访问的左链，
+// 每项记下：若它是右孩子，应挂到哪个已克隆的节点（rparent）下；
+// 其左子树复制完成后的副本根（left）
+template <typename T, typename Compare, bool IsMap, typename NodePolicy>
+typename rb_tree<T, Compare, IsMap, NodePolicy>::base_ptr
+rb_tree<T, Compare, IsMap, NodePolicy>::copy_from(base_ptr x, base_ptr p) {
+  struct frame {
+    base_ptr src;
+    base_ptr rparent;
+    base_ptr left;
+  };
+  frame stack[max_height];
+  size_type top = 0;
+  base_ptr top_copy = nullptr;
+  base_ptr rparent = nullptr;
   try {
-    if (x->right != nullptr) {
-      top->right = copy_from(x->right, top);
-    }
-    p = top;
-    x = x->left;
-    while (x != nullptr) {
-      auto y = clone_node(x);
-      y->parent = p;
-      p->left = y;
-      if (x->right != nullptr) {
-        y->right = copy_from(x->right, y);
+    while (true) {
+      for (; x != nullptr; x = x->left) {
+        stack[top++] = frame{x, rparent, nullptr};
+        rparent = nullptr;
       }
-      p = y;
-      x = x->left;
+      if (top == 0) {
+        break;
+      }
+      // 克隆成功后才出栈，抛出异常时 cur.left 仍在栈中
+      const frame &cur = stack[top - 1];
+      base_ptr y = clone_node(cur.src);
+      --top;
+      y->left = cur.left;
+      if (cur.left != nullptr) {
+        rb_tree_set_parent(cur.left, y);
+      }
+      if (cur.rparent != nullptr) {
+        cur.rparent->right = y;
+        rb_tree_set_parent(y, cur.rparent);
+      } else if (top != 0) {
+        stack[top - 1].left = y; // cur.src 是栈中下一项的左孩子
+      } else {
+        top_copy = y;
+      }
+      x = cur.src->right;
+      rparent = y;
     }
   } catch (...) {
-    erase_since(top);
+    // 已克隆的节点都挂在 top_copy 或某一项的 left 之下
+    erase_since(top_copy);
+    for (size_type i = 0; i < top; ++i) {
+      erase_since(stack[i].left);
+    }
     throw;
   }
+  rb_tree_set_parent(top_copy, p);
+  return top_copy;
+}
+// 前 depth 层把左右子树交给两个线程复制，之后按 copy_from 串行复制
+template <typename T, typename Compare, bool IsMap, typename NodePolicy>
+typename rb_tree<T, Compare, IsMap, NodePolicy>::base_ptr
+rb_tree<T, Compare, IsMap, NodePolicy>::copy_tree(base_ptr x, base_ptr p,
+                                                  unsigned depth) {
+  if (depth == 0) {
+    return copy_from(x, p);
+  }
+  base_ptr l = nullptr;
+  base_ptr r = nullptr;
+  std::exception_ptr le, re;
+  tinystl::parallel_invoke(
+      [&] {
+        try {
+          if (x->left != nullptr) {
+            l = copy_tree(x->left, nullptr, depth - 1);
+          }
+        } catch (...) {
+          le = std::current_exception();
+        }
+      },
+      [&] {
+        try {
+          if (x->right != nullptr) {
+            r = copy_tree(x->right, nullptr, depth - 1);
+          }
+        } catch (...) {
+          re = std::current_exception();
+        }
+      });
+  base_ptr top = nullptr;
+  if (le == nullptr && re == nullptr) {
+    try {
+      top = clone_node(x);
+    } catch (...) {
+      le = std::current_exception();
+    }
+  }
+  if (top == nullptr) {
+    erase_since(l);
+    erase_since(r);
+    std::rethrow_exception(le != nullptr ? le : re);
+  }
+  top->left = l;
+  top->right = r;
+  if (l != nullptr) {
+    rb_tree_set_parent(l, top);
+  }
+  if (r != nullptr) {
+    rb_tree_set_parent(r, top);
+  }
+  rb_tree_set_parent(top, p);
   return top;
 }
 
-template <typename T, typename Compare>
-typename rb_tree<T, Compare>::node_ptr
-rb_tree<T, Compare>::clone_node(base_ptr p) {
+template <typename T, typename Compare, bool IsMap, typename NodePolicy>
+typename rb_tree<T, Compare, IsMap, NodePolicy>::node_ptr
+rb_tree<T, Compare, IsMap, NodePolicy>::clone_node(base_ptr p) {
   auto tmp = create_node(p->get_node_ptr()->value);
-  tmp->color = p->color;
+  rb_tree_set_color(tmp, rb_tree_color(p));
+  rb_tree_copy_size<base_ptr>(tmp, p);
   return tmp;
 }
 
-template <typename T, typename Compare>
-void rb_tree<T, Compare>::erase_since(base_ptr x) {
-  while (x != nullptr) {
-    erase_since(x->right);
-    auto y = x->left;
-    destory_node(x->get_node_ptr());
-    x = y;
+// 按中序销毁，与 copy_from 的分配顺序一致；显式栈中是尚未访问的左链
+template <typename T, typename Compare, bool IsMap, typename NodePolicy>
+void rb_tree<T, Compare, IsMap, NodePolicy>::erase_since(base_ptr x) {
+  base_ptr stack[max_height];
+  size_type top = 0;
+  while (true) {
+    for (; x != nullptr; x = x->left) {
+      stack[top++] = x;
+    }
+    if (top == 0) {
+      break;
+    }
+    base_ptr y = stack[--top];
+    x = y->right;
+    destory_node(y->get_node_ptr());
+  }
+}
+template <typename T, typename Compare, bool IsMap, typename NodePolicy>
+void rb_tree<T, Compare, IsMap, NodePolicy>::destroy_tree(base_ptr x,
+                                                          unsigned depth) {
+  if (depth == 0 || x == nullptr) {
+    erase_since(x);
+    return;
   }
+  base_ptr l = x->left;
+  base_ptr r = x->right;
+  destory_node(x->get_node_ptr());
+  tinystl::parallel_invoke([&] { destroy_tree(l, depth - 1); },
+                           [&] { destroy_tree(r, depth - 1); });
 }
 
-template <typename T, typename Compare>
-void rb_tree<T, Compare>::rb_tree_init() {
+template <typename T, typename Compare, bool IsMap, typename NodePolicy>
+void rb_tree<T, Compare, IsMap, NodePolicy>::rb_tree_init() {
   header_ = base_allocator::allocate(1);
-  root() = nullptr;
+  // header 为红色，用于区分 header 与根节点，见 dec()
+  rb_tree_init_node(header_);
   leftmost() = header_;
   rightmost() = header_;
   node_count_ = 0;
 }
-template <typename T, typename Compare>
-rb_tree<T, Compare>::rb_tree(const rb_tree &t) {
+template <typename T, typename Compare, bool IsMap, typename NodePolicy>
+rb_tree<T, Compare, IsMap, NodePolicy>::rb_tree(
+    const rb_tree &t) : header_(nullptr), node_count_(0),
+    key_comp_(t.key_comp_) {
   rb_tree_init();
   if (t.node_count_ != 0) {
-    header_->parent = copy_from(t.root(), header_);
+    try {
+      set_root(copy_tree(
+          t.root(), header_,
+          tinystl::parallel_depth(t.node_count_, parallel_grain)));
+    } catch (...) {
+      base_allocator::deallocate(header_);
+      throw;
+    }
     leftmost() = rb_tree_min(root());
     rightmost() = rb_tree_max(root());
     node_count_ = t.node_count_;
   }
-  key_comp_ = t.key_comp_;
 }
-template <typename T, typename Compare>
-rb_tree<T, Compare>::rb_tree(rb_tree &&t) noexcept
-    : header_(std::move(t.header_)) {
-  node_count_ = t.node_count_;
-  key_comp_ = t.key_comp_;
-  t.node_count_ = 0;
+// 源对象留下一棵新分配的空树，移动后仍可正常使用
+template <typename T, typename Compare, bool IsMap, typename NodePolicy>
+rb_tree<T, Compare, IsMap, NodePolicy>::rb_tree(
+    rb_tree &&t) : header_(nullptr), node_count_(0), key_comp_(t.key_comp_) {
+  rb_tree_init();
+  swap(t);
 }
-template <typename T, typename Compare> rb_tree<T, Compare>::~rb_tree() {
+template <typename T, typename Compare, bool IsMap, typename NodePolicy>
+rb_tree<T, Compare, IsMap, NodePolicy>::~rb_tree() {
   clear();
   base_allocator::deallocate(header_);
 }
-template <typename T, typename Compare>
-rb_tree<T, Compare> &rb_tree<T, Compare>::operator=(const rb_tree &t) {
-  clear();
-  if (t.node_count_ != 0) {
-    header_->parent = copy_from(t.root(), header_);
-    leftmost() = rb_tree_min(root());
-    rightmost() = rb_tree_max(root());
-    node_count_ = t.node_count_;
+template <typename T, typename Compare, bool IsMap, typename NodePolicy>
+rb_tree<T, Compare, IsMap, NodePolicy> &
+rb_tree<T, Compare, IsMap, NodePolicy>::operator=(const rb_tree &t) {
+  if (this != &t) {
+    clear();
+    if (t.node_count_ != 0) {
+      set_root(copy_tree(
+          t.root(), header_,
+          tinystl::parallel_depth(t.node_count_, parallel_grain)));
+      leftmost() = rb_tree_min(root());
+      rightmost() = rb_tree_max(root());
+      node_count_ = t.node_count_;
+    }
+    key_comp_ = t.key_comp_;
   }
-  key_comp_ = t.key_comp_;
   return *this;
 }
-template <typename T, typename Compare>
-rb_tree<T, Compare> &rb_tree<T, Compare>::operator=(rb_tree &&t) noexcept {
-  clear();
-  header_ = std::move(t.header_);
-  node_count_ = t.node_count_;
-  t.node_count_ = 0;
-  key_comp_ = t.key_comp_;
+template <typename T, typename Compare, bool IsMap, typename NodePolicy>
+rb_tree<T, Compare, IsMap, NodePolicy> &
+rb_tree<T, Compare, IsMap, NodePolicy>::operator=(rb_tree &&t) noexcept {
+  if (this != &t) {
+    clear();
+    swap(t);
+  }
   return *this;
 }
+
+template <typename T, typename Compare, bool IsMap, typename NodePolicy>
+typename rb_tree<T, Compare, IsMap, NodePolicy>::insert_pos
+rb_tree<T, Compare, IsMap, NodePolicy>::get_insert_unique_pos(
+    const key_type &k) {
+  base_ptr x = root();
+  base_ptr y = header_;
+  bool comp = true;
+  while (x != nullptr) {
+    y = x;
+    comp = key_comp_(k, key_of(x));
+    x = comp ? x->left : x->right;
+  }
+  iterator j(y);
+  if (comp) {
+    if (j == begin()) {
+      return insert_pos(nullptr, y);
+    }
+    --j;
+  }
+  if (key_comp_(key_of(j.node), k)) {
+    return insert_pos(nullptr, y);
+  }
+  return insert_pos(j.node, nullptr);
+}
+template <typename T, typename Compare, bool IsMap, typename NodePolicy>
+typename rb_tree<T, Compare, IsMap, NodePolicy>::insert_pos
+rb_tree<T, Compare, IsMap, NodePolicy>::get_insert_equal_pos(
+    const key_type &k) {
+  base_ptr x = root();
+  base_ptr y = header_;
+  while (x != nullptr) {
+    y = x;
+    x = key_comp_(k, key_of(x)) ? x->left : x->right;
+  }
+  return insert_pos(nullptr, y);
+}
+// hint 与插入位置相邻时只需与其前驱/后继比较，否则退化为从根查找
+template <typename T, typename Compare, bool IsMap, typename NodePolicy>
+typename rb_tree<T, Compare, IsMap, NodePolicy>::insert_pos
+rb_tree<T, Compare, IsMap, NodePolicy>::get_insert_hint_unique_pos(
+    const_iterator hint, const key_type &k) {
+  base_ptr pos = hint.node;
+  if (pos == header_) {
+    if (node_count_ > 0 && key_comp_(key_of(rightmost()), k)) {
+      return insert_pos(nullptr, rightmost());
+    }
+    return get_insert_unique_pos(k);
+  }
+  if (key_comp_(k, key_of(pos))) {
+    if (pos == leftmost()) {
+      return insert_pos(pos, pos);
+    }
+    const_iterator before(pos);
+    --before;
+    if (key_comp_(key_of(before.node), k)) {
+      if (before.node->right == nullptr) {
+        return insert_pos(nullptr, before.node);
+      }
+      return insert_pos(pos, pos);
+    }
+    return get_insert_unique_pos(k);
+  }
+  if (key_comp_(key_of(pos), k)) {
+    if (pos == rightmost()) {
+      return insert_pos(nullptr, pos);
+    }
+    const_iterator after(pos);
+    ++after;
+    if (key_comp_(k, key_of(after.node))) {
+      if (pos->right == nullptr) {
+        return insert_pos(nullptr, pos);
+      }
+      return insert_pos(after.node, after.node);
+    }
+    return get_insert_unique_pos(k);
+  }
+  return insert_pos(pos, nullptr);
+}
+template <typename T, typename Compare, bool IsMap, typename NodePolicy>
+typename rb_tree<T, Compare, IsMap, NodePolicy>::insert_pos
+rb_tree<T, Compare, IsMap, NodePolicy>::get_insert_hint_equal_pos(
+    const_iterator hint, const key_type &k) {
+  base_ptr pos = hint.node;
+  if (pos == header_) {
+    if (node_count_ > 0 && !key_comp_(k, key_of(rightmost()))) {
+      return insert_pos(nullptr, rightmost());
+    }
+    return get_insert_equal_pos(k);
+  }
+  if (!key_comp_(key_of(pos), k)) {
+    if (pos == leftmost()) {
+      return insert_pos(pos, pos);
+    }
+    const_iterator before(pos);
+    --before;
+    if (!key_comp_(k, key_of(before.node))) {
+      if (before.node->right == nullptr) {
+        return insert_pos(nullptr, before.node);
+      }
+      return insert_pos(pos, pos);
+    }
+    return get_insert_equal_pos(k);
+  }
+  if (pos == rightmost()) {
+    return insert_pos(nullptr, pos);
+  }
+  const_iterator after(pos);
+  ++after;
+  if (!key_comp_(key_of(after.node), k)) {
+    if (pos->right == nullptr) {
+      return insert_pos(nullptr, pos);
+    }
+    return insert_pos(after.node, after.node);
+  }
+  return get_insert_equal_pos(k);
+}
+template <typename T, typename Compare, bool IsMap, typename NodePolicy>
+typename rb_tree<T, Compare, IsMap, NodePolicy>::iterator
+rb_tree<T, Compare, IsMap, NodePolicy>::insert_node_at(
+    base_ptr x, base_ptr p, node_ptr z) {
+  bool add_left =
+      x != nullptr || p == header_ || key_comp_(key_of(z), key_of(p));
+  rb_tree_insert_at(header_, p, z->get_base_ptr(), add_left);
+  ++node_count_;
+  return iterator(z);
+}
+
+template <typename T, typename Compare, bool IsMap, typename NodePolicy>
+template <typename... Args>
+tinystl::pair<typename rb_tree<T, Compare, IsMap, NodePolicy>::iterator, bool>
+rb_tree<T, Compare, IsMap, NodePolicy>::emplace_unique(Args &&...args) {
+  node_ptr z = create_node(std::forward<Args>(args)...);
+  insert_pos pos = get_insert_unique_pos(key_of(z));
+  if (pos.second == nullptr) {
+    destory_node(z);
+    return tinystl::pair<iterator, bool>(iterator(pos.first), false);
+  }
+  return tinystl::pair<iterator, bool>(insert_node_at(pos.first, pos.second, z),
+                                       true);
+}
+template <typename T, typename Compare, bool IsMap, typename NodePolicy>
+template <typename... Args>
+typename rb_tree<T, Compare, IsMap, NodePolicy>::iterator
+rb_tree<T, Compare, IsMap, NodePolicy>::emplace_equal(Args &&...args) {
+  node_ptr z = create_node(std::forward<Args>(args)...);
+  insert_pos pos = get_insert_equal_pos(key_of(z));
+  return insert_node_at(pos.first, pos.second, z);
+}
+template <typename T, typename Compare, bool IsMap, typename NodePolicy>
+template <typename... Args>
+typename rb_tree<T, Compare, IsMap, NodePolicy>::iterator
+rb_tree<T, Compare, IsMap, NodePolicy>::emplace_hint_unique(
+    const_iterator hint, Args &&...args) {
+  node_ptr z = create_node(std::forward<Args>(args)...);
+  insert_pos pos = get_insert_hint_unique_pos(hint, key_of(z));
+  if (pos.second == nullptr) {
+    destory_node(z);
+    return iterator(pos.first);
+  }
+  return insert_node_at(pos.first, pos.second, z);
+}
+template <typename T, typename Compare, bool IsMap, typename NodePolicy>
+template <typename... Args>
+typename rb_tree<T, Compare, IsMap, NodePolicy>::iterator
+rb_tree<T, Compare, IsMap, NodePolicy>::emplace_hint_equal(
+    const_iterator hint, Args &&...args) {
+  node_ptr z = create_node(std::forward<Args>(args)...);
+  insert_pos pos = get_insert_hint_equal_pos(hint, key_of(z));
+  return insert_node_at(pos.first, pos.second, z);
+}
+template <typename T, typename Compare, bool IsMap, typename NodePolicy>
+template <typename V>
+tinystl::pair<typename rb_tree<T, Compare, IsMap, NodePolicy>::iterator, bool>
+rb_tree<T, Compare, IsMap, NodePolicy>::insert_value_unique(V &&value) {
+  insert_pos pos = get_insert_unique_pos(value_traits::get_key(value));
+  if (pos.second == nullptr) {
+    return tinystl::pair<iterator, bool>(iterator(pos.first), false);
+  }
+  node_ptr z = create_node(std::forward<V>(value));
+  return tinystl::pair<iterator, bool>(insert_node_at(pos.first, pos.second, z),
+                                       true);
+}
+template <typename T, typename Compare, bool IsMap, typename NodePolicy>
+template <typename V>
+typename rb_tree<T, Compare, IsMap, NodePolicy>::iterator
+rb_tree<T, Compare, IsMap, NodePolicy>::insert_hint_value_unique(
+    const_iterator hint, V &&value) {
+  insert_pos pos =
+      get_insert_hint_unique_pos(hint, value_traits::get_key(value));
+  if (pos.second == nullptr) {
+    return iterator(pos.first);
+  }
+  node_ptr z = create_node(std::forward<V>(value));
+  return insert_node_at(pos.first, pos.second, z);
+}
+
+template <typename T, typename Compare, bool IsMap, typename NodePolicy>
+typename rb_tree<T, Compare, IsMap, NodePolicy>::node_type
+rb_tree<T, Compare, IsMap, NodePolicy>::extract(const_iterator pos) {
+  MY_DEBUG(pos != end());
+  base_ptr y = rb_tree_erase_rebalance(pos.node, header_);
+  --node_count_;
+  rb_tree_set_parent(y, nullptr);
+  y->left = y->right = nullptr;
+  return node_type(y->get_node_ptr());
+}
+template <typename T, typename Compare, bool IsMap, typename NodePolicy>
+typename rb_tree<T, Compare, IsMap, NodePolicy>::insert_return_type
+rb_tree<T, Compare, IsMap, NodePolicy>::insert_unique(node_type &&nh) {
+  if (nh.empty()) {
+    return insert_return_type{end(), false, node_type()};
+  }
+  insert_pos pos = get_insert_unique_pos(key_of(nh.get()));
+  if (pos.second == nullptr) {
+    return insert_return_type{iterator(pos.first), false, std::move(nh)};
+  }
+  return insert_return_type{insert_node_at(pos.first, pos.second, nh.release()),
+                            true, node_type()};
+}
+template <typename T, typename Compare, bool IsMap, typename NodePolicy>
+typename rb_tree<T, Compare, IsMap, NodePolicy>::iterator
+rb_tree<T, Compare, IsMap, NodePolicy>::insert_unique(
+    const_iterator hint, node_type &&nh) {
+  if (nh.empty()) {
+    return end();
+  }
+  insert_pos pos = get_insert_hint_unique_pos(hint, key_of(nh.get()));
+  if (pos.second == nullptr) {
+    return iterator(pos.first);
+  }
+  return insert_node_at(pos.first, pos.second, nh.release());
+}
+template <typename T, typename Compare, bool IsMap, typename NodePolicy>
+typename rb_tree<T, Compare, IsMap, NodePolicy>::iterator
+rb_tree<T, Compare, IsMap, NodePolicy>::insert_equal(node_type &&nh) {
+  if (nh.empty()) {
+    return end();
+  }
+  insert_pos pos = get_insert_equal_pos(key_of(nh.get()));
+  return insert_node_at(pos.first, pos.second, nh.release());
+}
+template <typename T, typename Compare, bool IsMap, typename NodePolicy>
+typename rb_tree<T, Compare, IsMap, NodePolicy>::iterator
+rb_tree<T, Compare, IsMap, NodePolicy>::insert_equal(
+    const_iterator hint, node_type &&nh) {
+  if (nh.empty()) {
+    return end();
+  }
+  insert_pos pos = get_insert_hint_equal_pos(hint, key_of(nh.get()));
+  return insert_node_at(pos.first, pos.second, nh.release());
+}
+// t 按升序遍历，上一个落点的后继通常就是下一个落点，故以它为 hint
+template <typename T, typename Compare, bool IsMap, typename NodePolicy>
+void rb_tree<T, Compare, IsMap, NodePolicy>::merge_unique(rb_tree &t) {
+  if (this == &t) {
+    return;
+  }
+  const_iterator hint = end();
+  for (base_ptr p = t.leftmost(); p != t.header_;) {
+    base_ptr next = (++const_iterator(p)).node;
+    insert_pos pos = get_insert_hint_unique_pos(hint, key_of(p));
+    if (pos.second != nullptr) {
+      rb_tree_erase_rebalance(p, t.header_);
+      --t.node_count_;
+      hint = insert_node_at(pos.first, pos.second, p->get_node_ptr());
+    } else {
+      hint = pos.first;
+    }
+    ++hint;
+    p = next;
+  }
+}
+template <typename T, typename Compare, bool IsMap, typename NodePolicy>
+void rb_tree<T, Compare, IsMap, NodePolicy>::merge_equal(rb_tree &t) {
+  if (this == &t) {
+    return;
+  }
+  for (base_ptr p = t.leftmost(); p != t.header_;) {
+    base_ptr next = (++const_iterator(p)).node;
+    insert_pos pos = get_insert_equal_pos(key_of(p));
+    rb_tree_erase_rebalance(p, t.header_);
+    --t.node_count_;
+    insert_node_at(pos.first, pos.second, p->get_node_ptr());
+    p = next;
+  }
+}
+
+template <typename T, typename Compare, bool IsMap, typename NodePolicy>
+typename rb_tree<T, Compare, IsMap, NodePolicy>::subtree
+rb_tree<T, Compare, IsMap, NodePolicy>::detach_root() {
+  subtree t = {root(), 0};
+  if (t.root != nullptr) {
+    rb_tree_set_parent(t.root, nullptr);
+    t.bh = black_height(t.root);
+  }
+  set_root(nullptr);
+  leftmost() = header_;
+  rightmost() = header_;
+  node_count_ = 0;
+  return t;
+}
+template <typename T, typename Compare, bool IsMap, typename NodePolicy>
+void rb_tree<T, Compare, IsMap, NodePolicy>::attach_root(subtree t,
+                                                         size_type n) {
+  node_count_ = n;
+  if (t.root == nullptr) {
+    return;
+  }
+  rb_tree_set_black(t.root);
+  rb_tree_set_parent(t.root, header_);
+  set_root(t.root);
+  leftmost() = rb_tree_min(t.root);
+  rightmost() = rb_tree_max(t.root);
+}
+// 把非空子树 t 拆成根与左右两棵子树，根的链接留待 join 时重写
+template <typename T, typename Compare, bool IsMap, typename NodePolicy>
+void rb_tree<T, Compare, IsMap, NodePolicy>::expose(subtree t, subtree &l,
+                                                    subtree &r) {
+  size_type bh = t.bh - (rb_tree_is_red(t.root) ? 0 : 1);
+  l = subtree{t.root->left, bh};
+  r = subtree{t.root->right, bh};
+  if (l.root != nullptr) {
+    rb_tree_set_parent(l.root, nullptr);
+  }
+  if (r.root != nullptr) {
+    rb_tree_set_parent(r.root, nullptr);
+  }
+}
+// l 中的键 <= m 的键 <= r 中的键，以 m 为分隔连成一棵树，
+// 代价与两侧黑高之差成正比
+template <typename T, typename Compare, bool IsMap, typename NodePolicy>
+typename rb_tree<T, Compare, IsMap, NodePolicy>::subtree
+rb_tree<T, Compare, IsMap, NodePolicy>::join_at(subtree l, base_ptr m,
+                                                subtree r) {
+  if (l.root != nullptr && rb_tree_is_red(l.root)) {
+    rb_tree_set_black(l.root);
+    ++l.bh;
+  }
+  if (r.root != nullptr && rb_tree_is_red(r.root)) {
+    rb_tree_set_black(r.root);
+    ++r.bh;
+  }
+  if (l.bh > r.bh) {
+    return join_right(l, m, r);
+  }
+  if (l.bh < r.bh) {
+    return join_left(l, m, r);
+  }
+  m->left = l.root;
+  m->right = r.root;
+  if (l.root != nullptr) {
+    rb_tree_set_parent(l.root, m);
+  }
+  if (r.root != nullptr) {
+    rb_tree_set_parent(r.root, m);
+  }
+  rb_tree_set_parent(m, nullptr);
+  rb_tree_set_black(m);
+  rb_tree_update_size(m);
+  return subtree{m, l.bh + 1};
+}
+// l 更高：沿 l 的右脊下降到与 r 黑高相同的黑色节点 y（可能为空），
+// 以红色的 m 取代 y，y 与 r 成为 m 的左右子树，再按插入修正
+template <typename T, typename Compare, bool IsMap, typename NodePolicy>
+typename rb_tree<T, Compare, IsMap, NodePolicy>::subtree
+rb_tree<T, Compare, IsMap, NodePolicy>::join_right(subtree l, base_ptr m,
+                                                   subtree r) {
+  base_ptr p = nullptr;
+  base_ptr y = l.root;
+  size_type h = l.bh;
+  while (y != nullptr && (rb_tree_is_red(y) || h > r.bh)) {
+    h -= rb_tree_is_red(y) ? 0 : 1;
+    p = y;
+    y = y->right;
+  }
+  m->left = y;
+  m->right = r.root;
+  if (y != nullptr) {
+    rb_tree_set_parent(y, m);
+  }
+  if (r.root != nullptr) {
+    rb_tree_set_parent(r.root, m);
+  }
+  rb_tree_set_parent(m, p);
+  p->right = m;
+  rb_tree_update_size(m);
+  for (base_ptr a = p; a != nullptr; a = rb_tree_parent(a)) {
+    rb_tree_update_size(a);
+  }
+  base_ptr root = l.root;
+  rb_tree_insert_rebalance(m, root);
+  // 修正只在 m 之上旋转，r 仍是 m 的右子树，新黑高即 r 的黑高
+  // 加上 m 到根路径上的黑色节点数
+  size_type bh = r.bh;
+  for (base_ptr a = m; a != nullptr; a = rb_tree_parent(a)) {
+    bh += rb_tree_is_red(a) ? 0 : 1;
+  }
+  return subtree{root, bh};
+}
+template <typename T, typename Compare, bool IsMap, typename NodePolicy>
+typename rb_tree<T, Compare, IsMap, NodePolicy>::subtree
+rb_tree<T, Compare, IsMap, NodePolicy>::join_left(subtree l, base_ptr m,
+                                                  subtree r) {
+  base_ptr p = nullptr;
+  base_ptr y = r.root;
+  size_type h = r.bh;
+  while (y != nullptr && (rb_tree_is_red(y) || h > l.bh)) {
+    h -= rb_tree_is_red(y) ? 0 : 1;
+    p = y;
+    y = y->left;
+  }
+  m->left = l.root;
+  m->right = y;
+  if (l.root != nullptr) {
+    rb_tree_set_parent(l.root, m);
+  }
+  if (y != nullptr) {
+    rb_tree_set_parent(y, m);
+  }
+  rb_tree_set_parent(m, p);
+  p->left = m;
+  rb_tree_update_size(m);
+  for (base_ptr a = p; a != nullptr; a = rb_tree_parent(a)) {
+    rb_tree_update_size(a);
+  }
+  base_ptr root = r.root;
+  rb_tree_insert_rebalance(m, root);
+  size_type bh = l.bh;
+  for (base_ptr a = m; a != nullptr; a = rb_tree_parent(a)) {
+    bh += rb_tree_is_red(a) ? 0 : 1;
+  }
+  return subtree{root, bh};
+}
+// 没有分隔节点时，取出 l 的最大节点作分隔
+template <typename T, typename Compare, bool IsMap, typename NodePolicy>
+typename rb_tree<T, Compare, IsMap, NodePolicy>::subtree
+rb_tree<T, Compare, IsMap, NodePolicy>::join2(subtree l, subtree r) {
+  if (l.root == nullptr) {
+    return r;
+  }
+  if (r.root == nullptr) {
+    return l;
+  }
+  base_ptr m = nullptr;
+  l = split_last(l, m);
+  return join_at(l, m, r);
+}
+template <typename T, typename Compare, bool IsMap, typename NodePolicy>
+typename rb_tree<T, Compare, IsMap, NodePolicy>::subtree
+rb_tree<T, Compare, IsMap, NodePolicy>::split_last(subtree t,
+                                                   base_ptr &last) {
+  subtree l, r;
+  expose(t, l, r);
+  if (r.root == nullptr) {
+    last = t.root;
+    return l;
+  }
+  r = split_last(r, last);
+  return join_at(l, t.root, r);
+}
+// 返回键小于 k 的部分，其余放入 right；mid 非空时等于 k 的节点
+// （树中至多一个）单独摘出放入 *mid，否则归入 right
+template <typename T, typename Compare, bool IsMap, typename NodePolicy>
+typename rb_tree<T, Compare, IsMap, NodePolicy>::subtree
+rb_tree<T, Compare, IsMap, NodePolicy>::split_at(subtree t, const key_type &k,
+                                                 base_ptr *mid,
+                                                 subtree &right) const {
+  if (t.root == nullptr) {
+    right = t;
+    return t;
+  }
+  const bool less = key_comp_(key_of(t.root), k);
+  const bool greater =
+      !less && (mid == nullptr || key_comp_(k, key_of(t.root)));
+  subtree l, r;
+  expose(t, l, r);
+  if (greater) {
+    subtree left = split_at(l, k, mid, right);
+    right = join_at(right, t.root, r);
+    return left;
+  }
+  if (!less) {
+    *mid = t.root;
+    right = r;
+    return l;
+  }
+  r = split_at(r, k, mid, right);
+  return join_at(l, t.root, r);
+}
+
+template <typename T, typename Compare, bool IsMap, typename NodePolicy>
+typename rb_tree<T, Compare, IsMap, NodePolicy>::subtree
+rb_tree<T, Compare, IsMap, NodePolicy>::union_at(subtree a, subtree b,
+                                                 unsigned depth,
+                                                 size_type &dup) {
+  if (a.root == nullptr) {
+    return b;
+  }
+  if (b.root == nullptr) {
+    return a;
+  }
+  base_ptr mid = nullptr;
+  subtree bl, br, al, ar;
+  bl = split_at(b, key_of(a.root), &mid, br);
+  expose(a, al, ar);
+  subtree l, r;
+  size_type dl = 0, dr = 0;
+  if (depth > 0) {
+    tinystl::parallel_invoke(
+        [&] { l = union_at(al, bl, depth - 1, dl); },
+        [&] { r = union_at(ar, br, depth - 1, dr); });
+  } else {
+    l = union_at(al, bl, 0, dl);
+    r = union_at(ar, br, 0, dr);
+  }
+  dup += dl + dr;
+  if (mid != nullptr) {
+    destory_node(mid->get_node_ptr());
+    ++dup;
+  }
+  return join_at(l, a.root, r);
+}
+template <typename T, typename Compare, bool IsMap, typename NodePolicy>
+typename rb_tree<T, Compare, IsMap, NodePolicy>::subtree
+rb_tree<T, Compare, IsMap, NodePolicy>::intersect_at(subtree a, subtree b,
+                                                     unsigned depth,
+                                                     size_type &matched) {
+  if (a.root == nullptr || b.root == nullptr) {
+    erase_since(a.root);
+    erase_since(b.root);
+    return subtree{nullptr, 0};
+  }
+  base_ptr mid = nullptr;
+  subtree bl, br, al, ar;
+  bl = split_at(b, key_of(a.root), &mid, br);
+  expose(a, al, ar);
+  subtree l, r;
+  size_type ml = 0, mr = 0;
+  if (depth > 0) {
+    tinystl::parallel_invoke(
+        [&] { l = intersect_at(al, bl, depth - 1, ml); },
+        [&] { r = intersect_at(ar, br, depth - 1, mr); });
+  } else {
+    l = intersect_at(al, bl, 0, ml);
+    r = intersect_at(ar, br, 0, mr);
+  }
+  matched += ml + mr;
+  if (mid != nullptr) {
+    destory_node(mid->get_node_ptr());
+    ++matched;
+    return join_at(l, a.root, r);
+  }
+  destory_node(a.root->get_node_ptr());
+  return join2(l, r);
+}
+template <typename T, typename Compare, bool IsMap, typename NodePolicy>
+typename rb_tree<T, Compare, IsMap, NodePolicy>::subtree
+rb_tree<T, Compare, IsMap, NodePolicy>::difference_at(subtree a, subtree b,
+                                                      unsigned depth,
+                                                      size_type &matched) {
+  if (a.root == nullptr || b.root == nullptr) {
+    erase_since(b.root);
+    return a;
+  }
+  base_ptr mid = nullptr;
+  subtree al, ar, bl, br;
+  al = split_at(a, key_of(b.root), &mid, ar);
+  expose(b, bl, br);
+  subtree l, r;
+  size_type ml = 0, mr = 0;
+  if (depth > 0) {
+    tinystl::parallel_invoke(
+        [&] { l = difference_at(al, bl, depth - 1, ml); },
+        [&] { r = difference_at(ar, br, depth - 1, mr); });
+  } else {
+    l = difference_at(al, bl, 0, ml);
+    r = difference_at(ar, br, 0, mr);
+  }
+  matched += ml + mr;
+  destory_node(b.root->get_node_ptr());
+  if (mid != nullptr) {
+    destory_node(mid->get_node_ptr());
+    ++matched;
+  }
+  return join2(l, r);
+}
+
+template <typename T, typename Compare, bool IsMap, typename NodePolicy>
+void rb_tree<T, Compare, IsMap, NodePolicy>::union_unique(rb_tree &t) {
+  if (this == &t || t.node_count_ == 0) {
+    return;
+  }
+  size_type n = node_count_ + t.node_count_;
+  unsigned depth = tinystl::parallel_depth(n, parallel_grain);
+  subtree a = detach_root();
+  subtree b = t.detach_root();
+  size_type dup = 0;
+  subtree c = union_at(a, b, depth, dup);
+  attach_root(c, n - dup);
+}
+template <typename T, typename Compare, bool IsMap, typename NodePolicy>
+void rb_tree<T, Compare, IsMap, NodePolicy>::intersection_unique(rb_tree &t) {
+  if (this == &t) {
+    return;
+  }
+  unsigned depth =
+      tinystl::parallel_depth(node_count_ + t.node_count_, parallel_grain);
+  subtree a = detach_root();
+  subtree b = t.detach_root();
+  size_type matched = 0;
+  subtree c = intersect_at(a, b, depth, matched);
+  attach_root(c, matched);
+}
+template <typename T, typename Compare, bool IsMap, typename NodePolicy>
+void rb_tree<T, Compare, IsMap, NodePolicy>::difference_unique(rb_tree &t) {
+  if (this == &t) {
+    clear();
+    return;
+  }
+  if (t.node_count_ == 0) {
+    return;
+  }
+  size_type n = node_count_;
+  unsigned depth = tinystl::parallel_depth(n + t.node_count_, parallel_grain);
+  subtree a = detach_root();
+  subtree b = t.detach_root();
+  size_type matched = 0;
+  subtree c = difference_at(a, b, depth, matched);
+  attach_root(c, n - matched);
+}
+template <typename T, typename Compare, bool IsMap, typename NodePolicy>
+void rb_tree<T, Compare, IsMap, NodePolicy>::join(rb_tree &t) {
+  if (this == &t || t.node_count_ == 0) {
+    return;
+  }
+  MY_DEBUG(node_count_ == 0 ||
+           !key_comp_(key_of(t.leftmost()), key_of(rightmost())));
+  size_type n = node_count_ + t.node_count_;
+  subtree a = detach_root();
+  subtree b = t.detach_root();
+  attach_root(join2(a, b), n);
+}
+template <typename T, typename Compare, bool IsMap, typename NodePolicy>
+void rb_tree<T, Compare, IsMap, NodePolicy>::split(const key_type &k,
+                                                   rb_tree &right) {
+  if (this == &right) {
+    return;
+  }
+  right.clear();
+  size_type n = node_count_;
+  subtree r;
+  subtree l = split_at(detach_root(), k, nullptr, r);
+  attach_root(l, 0);
+  right.attach_root(r, 0);
+  count_split(right, n, rb_tree_has_size<base_ptr>());
+}
+template <typename T, typename Compare, bool IsMap, typename NodePolicy>
+void rb_tree<T, Compare, IsMap, NodePolicy>::count_split(rb_tree &right,
+                                                         size_type n,
+                                                         std::true_type) {
+  node_count_ = rb_tree_size(root());
+  right.node_count_ = n - node_count_;
+}
+// 从本树的开头和 right 的末尾同时向内清点，先走完的一侧即较小的一侧
+template <typename T, typename Compare, bool IsMap, typename NodePolicy>
+void rb_tree<T, Compare, IsMap, NodePolicy>::count_split(rb_tree &right,
+                                                         size_type n,
+                                                         std::false_type) {
+  const_iterator first = begin();
+  const_iterator last = right.end();
+  for (size_type k = 0;; ++k, ++first) {
+    if (first == end()) {
+      node_count_ = k;
+      break;
+    }
+    if (last == right.begin()) {
+      node_count_ = n - k;
+      break;
+    }
+    --last;
+  }
+  right.node_count_ = n - node_count_;
+}
+
+template <typename T, typename Compare, bool IsMap, typename NodePolicy>
+typename rb_tree<T, Compare, IsMap, NodePolicy>::iterator
+rb_tree<T, Compare, IsMap, NodePolicy>::erase(const_iterator pos) {
+  MY_DEBUG(pos != end());
+  iterator next(pos.node);
+  ++next;
+  base_ptr y = rb_tree_erase_rebalance(pos.node, header_);
+  destory_node(y->get_node_ptr());
+  --node_count_;
+  return next;
+}
+template <typename T, typename Compare, bool IsMap, typename NodePolicy>
+typename rb_tree<T, Compare, IsMap, NodePolicy>::iterator
+rb_tree<T, Compare, IsMap, NodePolicy>::erase(
+    const_iterator first, const_iterator last) {
+  if (first == begin() && last == end()) {
+    clear();
+    return end();
+  }
+  while (first != last) {
+    first = erase(first);
+  }
+  return iterator(last.node);
+}
+template <typename T, typename Compare, bool IsMap, typename NodePolicy>
+typename rb_tree<T, Compare, IsMap, NodePolicy>::size_type
+rb_tree<T, Compare, IsMap, NodePolicy>::erase_unique(const key_type &k) {
+  iterator it = find(k);
+  if (it == end()) {
+    return 0;
+  }
+  erase(it);
+  return 1;
+}
+template <typename T, typename Compare, bool IsMap, typename NodePolicy>
+typename rb_tree<T, Compare, IsMap, NodePolicy>::size_type
+rb_tree<T, Compare, IsMap, NodePolicy>::erase_multi(const key_type &k) {
+  auto p = equal_range_multi(k);
+  size_type n = static_cast<size_type>(tinystl::distance(p.first, p.second));
+  erase(p.first, p.second);
+  return n;
+}
+template <typename T, typename Compare, bool IsMap, typename NodePolicy>
+void rb_tree<T, Compare, IsMap, NodePolicy>::clear() {
+  if (node_count_ != 0) {
+    destroy_tree(root(), tinystl::parallel_depth(node_count_, parallel_grain));
+  }
+  leftmost() = header_;
+  rightmost() = header_;
+  set_root(nullptr);
+  node_count_ = 0;
+}
+
+template <typename T, typename Compare, bool IsMap, typename NodePolicy>
+template <typename K>
+typename rb_tree<T, Compare, IsMap, NodePolicy>::base_ptr
+rb_tree<T, Compare, IsMap, NodePolicy>::lower_bound_node(const K &k) const {
+  base_ptr y = header_;
+  base_ptr x = root();
+  while (x != nullptr) {
+    if (!key_comp_(key_of(x), k)) {
+      y = x;
+      x = x->left;
+    } else {
+      x = x->right;
+    }
+  }
+  return y;
+}
+template <typename T, typename Compare, bool IsMap, typename NodePolicy>
+template <typename K>
+typename rb_tree<T, Compare, IsMap, NodePolicy>::base_ptr
+rb_tree<T, Compare, IsMap, NodePolicy>::upper_bound_node(const K &k) const {
+  base_ptr y = header_;
+  base_ptr x = root();
+  while (x != nullptr) {
+    if (key_comp_(k, key_of(x))) {
+      y = x;
+      x = x->left;
+    } else {
+      x = x->right;
+    }
+  }
+  return y;
+}
+
+template <typename T, typename Compare, bool IsMap, typename NodePolicy>
+typename rb_tree<T, Compare, IsMap, NodePolicy>::size_type
+rb_tree<T, Compare, IsMap, NodePolicy>::rank(const key_type &k) const {
+  static_assert(base_type::has_size, "rank needs rb_tree_order_statistics");
+  size_type r = 0;
+  base_ptr x = root();
+  while (x != nullptr) {
+    if (key_comp_(key_of(x), k)) {
+      r += rb_tree_size(x->left) + 1;
+      x = x->right;
+    } else {
+      x = x->left;
+    }
+  }
+  return r;
+}
+template <typename T, typename Compare, bool IsMap, typename NodePolicy>
+typename rb_tree<T, Compare, IsMap, NodePolicy>::iterator
+rb_tree<T, Compare, IsMap, NodePolicy>::select(size_type n) {
+  return static_cast<const rb_tree &>(*this).select(n).node;
+}
+template <typename T, typename Compare, bool IsMap, typename NodePolicy>
+typename rb_tree<T, Compare, IsMap, NodePolicy>::const_iterator
+rb_tree<T, Compare, IsMap, NodePolicy>::select(size_type n) const {
+  static_assert(base_type::has_size, "select needs rb_tree_order_statistics");
+  if (n >= node_count_) {
+    return end();
+  }
+  base_ptr x = root();
+  while (true) {
+    size_type left = rb_tree_size(x->left);
+    if (n < left) {
+      x = x->left;
+    } else if (n == left) {
+      return x;
+    } else {
+      n -= left + 1;
+      x = x->right;
+    }
+  }
+}
+template <typename T, typename Compare, bool IsMap, typename NodePolicy>
+typename rb_tree<T, Compare, IsMap, NodePolicy>::size_type
+rb_tree<T, Compare, IsMap, NodePolicy>::index_of(const_iterator it) const {
+  static_assert(base_type::has_size,
+                "index_of needs rb_tree_order_statistics");
+  base_ptr x = it.node;
+  if (x == header_) {
+    return node_count_;
+  }
+  size_type i = rb_tree_size(x->left);
+  while (x != root()) {
+    if (!rb_tree_is_lchild(x)) {
+      i += rb_tree_size(rb_tree_parent(x)->left) + 1;
+    }
+    x = rb_tree_parent(x);
+  }
+  return i;
+}
+
+// 左右子树大小至多差 1 的树除最深一层外各层都是满的，
+// 最深一层染红、其余染黑即满足红黑性质，无需比较和旋转
+
+// 前向迭代器：先数出元素个数，再按中序边分配节点边建树，
+// 节点分配顺序即键序，且每个节点只访问一次
+template <typename T, typename Compare, bool IsMap, typename NodePolicy>
+template <typename ForwardIterator>
+void rb_tree<T, Compare, IsMap, NodePolicy>::build_sorted_dispatch(
+    ForwardIterator first, ForwardIterator last, bool unique,
+    forward_iterator_tag) {
+  MY_DEBUG(node_count_ == 0);
+  size_type n = 0;
+  for (ForwardIterator it = first; it != last; ++n) {
+    ForwardIterator prev = it;
+    ++it;
+    while (unique && it != last &&
+           !key_comp_(value_traits::get_key(*prev),
+                      value_traits::get_key(*it))) {
+      ++it;
+    }
+  }
+  if (n == 0) {
+    return;
+  }
+  set_root(build_balanced(first, last, n, 0, balanced_red_depth(n), unique,
+                          header_));
+  rb_tree_set_black(root());
+  leftmost() = rb_tree_min(root());
+  rightmost() = rb_tree_max(root());
+  node_count_ = n;
+}
+template <typename T, typename Compare, bool IsMap, typename NodePolicy>
+template <typename ForwardIterator>
+typename rb_tree<T, Compare, IsMap, NodePolicy>::base_ptr
+rb_tree<T, Compare, IsMap, NodePolicy>::build_balanced(
+    ForwardIterator &first, ForwardIterator last, size_type n, size_type depth,
+    size_type red_depth, bool unique, base_ptr parent) {
+  if (n == 0) {
+    return nullptr;
+  }
+  size_type left_n = (n - 1) / 2;
+  base_ptr left = build_balanced(first, last, left_n, depth + 1, red_depth,
+                                 unique, nullptr);
+  base_ptr node = nullptr;
+  try {
+    node = create_node(*first);
+  } catch (...) {
+    erase_since(left);
+    throw;
+  }
+  ForwardIterator prev = first;
+  ++first;
+  MY_DEBUG(first == last || !key_comp_(value_traits::get_key(*first),
+                                       value_traits::get_key(*prev)));
+  while (unique && first != last &&
+         !key_comp_(value_traits::get_key(*prev),
+                    value_traits::get_key(*first))) {
+    ++first;
+  }
+  rb_tree_set_parent(node, parent);
+  node->left = left;
+  if (left != nullptr) {
+    rb_tree_set_parent(left, node);
+  }
+  rb_tree_set_color(node, depth == red_depth ? rb_tree_red : rb_tree_black);
+  rb_tree_set_size(node, n);
+  try {
+    node->right = build_balanced(first, last, n - 1 - left_n, depth + 1,
+                                 red_depth, unique, node);
+  } catch (...) {
+    erase_since(node);
+    throw;
+  }
+  return node;
+}
+
+// 输入迭代器只能遍历一次：先把节点按键序串成一条以 right 相连的链，
+// 再按中序把链上的节点挂成完全平衡的树
+template <typename T, typename Compare, bool IsMap, typename NodePolicy>
+template <typename InputIterator>
+void rb_tree<T, Compare, IsMap, NodePolicy>::build_sorted_dispatch(
+    InputIterator first, InputIterator last, bool unique, input_iterator_tag) {
+  MY_DEBUG(node_count_ == 0);
+  base_ptr head = nullptr;
+  base_ptr tail = nullptr;
+  size_type n = 0;
+  try {
+    for (; first != last; ++first) {
+      base_ptr z = create_node(*first);
+      if (tail != nullptr) {
+        MY_DEBUG(!key_comp_(key_of(z), key_of(tail)));
+        if (unique && !key_comp_(key_of(tail), key_of(z))) {
+          destory_node(z->get_node_ptr());
+          continue;
+        }
+        tail->right = z;
+      } else {
+        head = z;
+      }
+      tail = z;
+      ++n;
+    }
+  } catch (...) {
+    while (head != nullptr) {
+      base_ptr next = head->right;
+      destory_node(head->get_node_ptr());
+      head = next;
+    }
+    throw;
+  }
+  if (n == 0) {
+    return;
+  }
+  leftmost() = head;
+  rightmost() = tail;
+  set_root(link_balanced(head, n, 0, balanced_red_depth(n), header_));
+  rb_tree_set_black(root());
+  node_count_ = n;
+}
+template <typename T, typename Compare, bool IsMap, typename NodePolicy>
+typename rb_tree<T, Compare, IsMap, NodePolicy>::base_ptr
+rb_tree<T, Compare, IsMap, NodePolicy>::link_balanced(
+    base_ptr &head, size_type n, size_type depth, size_type red_depth,
+    base_ptr parent) {
+  if (n == 0) {
+    return nullptr;
+  }
+  size_type left_n = (n - 1) / 2;
+  base_ptr left = link_balanced(head, left_n, depth + 1, red_depth, nullptr);
+  base_ptr node = head;
+  head = head->right;
+  rb_tree_set_parent(node, parent);
+  node->left = left;
+  if (left != nullptr) {
+    rb_tree_set_parent(left, node);
+  }
+  rb_tree_set_color(node, depth == red_depth ? rb_tree_red : rb_tree_black);
+  rb_tree_set_size(node, n);
+  node->right =
+      link_balanced(head, n - 1 - left_n, depth + 1, red_depth, node);
+  return node;
+}
+
+template <typename T, typename Compare, bool IsMap, typename NodePolicy>
+bool operator==(const rb_tree<T, Compare, IsMap, NodePolicy> &lhs,
+                const rb_tree<T, Compare, IsMap, NodePolicy> &rhs) {
+  if (lhs.size() != rhs.size()) {
+    return false;
+  }
+  for (auto i = lhs.begin(), j = rhs.begin(); i != lhs.end(); ++i, ++j) {
+    if (!(*i == *j)) {
+      return false;
+    }
+  }
+  return true;
+}
+template <typename T, typename Compare, bool IsMap, typename NodePolicy>
+bool operator!=(const rb_tree<T, Compare, IsMap, NodePolicy> &lhs,
+                const rb_tree<T, Compare, IsMap, NodePolicy> &rhs) {
+  return !(lhs == rhs);
+}
+template <typename T, typename Compare, bool IsMap, typename NodePolicy>
+bool operator<(const rb_tree<T, Compare, IsMap, NodePolicy> &lhs,
+               const rb_tree<T, Compare, IsMap, NodePolicy> &rhs) {
+  auto i = lhs.begin();
+  auto j = rhs.begin();
+  for (; i != lhs.end() && j != rhs.end(); ++i, ++j) {
+    if (*i < *j) {
+      return true;
+    }
+    if (*j < *i) {
+      return false;
+    }
+  }
+  return i == lhs.end() && j != rhs.end();
+}
 } // namespace tinystl
 
-#endif
\ No newline at end of file
+#endif
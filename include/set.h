@@ -0,0 +1,434 @@
+#ifndef MYTINYSTL_SET_H_
+#define MYTINYSTL_SET_H_
+
+#include "functional.h"
+#include "rb_tree.h"
+#include "util.h"
+#include <initializer_list>
+#include <type_traits>
+#include <utility>
+
+namespace tinystl {
+template <typename Key, typename Compare, typename NodePolicy>
+class multiset;
+
+// 键值唯一；元素即键，迭代器均为 const 迭代器
+template <typename Key, typename Compare = tinystl::less<Key>,
+          typename NodePolicy = rb_tree_plain_node>
+class set {
+public:
+  typedef Key key_type;
+  typedef Key value_type;
+  typedef Compare key_compare;
+  typedef Compare value_compare;
+
+private:
+  typedef tinystl::rb_tree<value_type, key_compare, false, NodePolicy>
+      base_type;
+  base_type tree_;
+
+  friend class multiset<Key, Compare, NodePolicy>;
+
+public:
+  typedef typename base_type::node_type node_type;
+  typedef typename base_type::const_pointer pointer;
+  typedef typename base_type::const_pointer const_pointer;
+  typedef typename base_type::const_reference reference;
+  typedef typename base_type::const_reference const_reference;
+  typedef typename base_type::const_iterator iterator;
+  typedef typename base_type::const_iterator const_iterator;
+  typedef typename base_type::const_reverse_iterator reverse_iterator;
+  typedef typename base_type::const_reverse_iterator const_reverse_iterator;
+  typedef typename base_type::size_type size_type;
+  typedef typename base_type::difference_type difference_type;
+  typedef node_insert_return<iterator, node_type> insert_return_type;
+
+  set() = default;
+  explicit set(const key_compare &comp) : tree_(comp) {}
+  template <typename InputIterator,
+            typename std::enable_if<
+                tinystl::has_input_iterator_cat<InputIterator>::value,
+                int>::type = 0>
+  set(InputIterator first, InputIterator last) {
+    tree_.insert_unique(first, last);
+  }
+  set(std::initializer_list<value_type> l) {
+    tree_.insert_unique(l.begin(), l.end());
+  }
+  // [first, last) 须已按键有序，O(n) 建树
+  template <typename InputIterator,
+            typename std::enable_if<
+                tinystl::has_input_iterator_cat<InputIterator>::value,
+                int>::type = 0>
+  set(sorted_unique_t, InputIterator first, InputIterator last,
+      const key_compare &comp = key_compare())
+      : tree_(sorted_unique, first, last, comp) {}
+  set(const set &s) : tree_(s.tree_) {}
+  set(set &&s) : tree_(std::move(s.tree_)) {}
+
+  set &operator=(const set &s) {
+    tree_ = s.tree_;
+    return *this;
+  }
+  set &operator=(set &&s) noexcept {
+    tree_ = std::move(s.tree_);
+    return *this;
+  }
+  set &operator=(std::initializer_list<value_type> l) {
+    tree_.clear();
+    tree_.insert_unique(l.begin(), l.end());
+    return *this;
+  }
+
+  key_compare key_comp() const { return tree_.key_comp(); }
+  value_compare value_comp() const { return tree_.key_comp(); }
+
+  iterator begin() const noexcept { return tree_.begin(); }
+  iterator end() const noexcept { return tree_.end(); }
+  reverse_iterator rbegin() const noexcept { return tree_.rbegin(); }
+  reverse_iterator rend() const noexcept { return tree_.rend(); }
+  const_iterator cbegin() const noexcept { return begin(); }
+  const_iterator cend() const noexcept { return end(); }
+
+  bool empty() const noexcept { return tree_.empty(); }
+  size_type size() const noexcept { return tree_.size(); }
+  size_type max_size() const noexcept { return tree_.max_size(); }
+
+  template <typename... Args>
+  tinystl::pair<iterator, bool> emplace(Args &&...args) {
+    auto p = tree_.emplace_unique(std::forward<Args>(args)...);
+    return tinystl::pair<iterator, bool>(p.first, p.second);
+  }
+  template <typename... Args>
+  iterator emplace_hint(const_iterator hint, Args &&...args) {
+    return tree_.emplace_hint_unique(hint, std::forward<Args>(args)...);
+  }
+
+  tinystl::pair<iterator, bool> insert(const value_type &value) {
+    auto p = tree_.insert_unique(value);
+    return tinystl::pair<iterator, bool>(p.first, p.second);
+  }
+  tinystl::pair<iterator, bool> insert(value_type &&value) {
+    auto p = tree_.insert_unique(std::move(value));
+    return tinystl::pair<iterator, bool>(p.first, p.second);
+  }
+  iterator insert(const_iterator hint, const value_type &value) {
+    return tree_.insert_unique(hint, value);
+  }
+  iterator insert(const_iterator hint, value_type &&value) {
+    return tree_.insert_unique(hint, std::move(value));
+  }
+  template <typename InputIterator,
+            typename std::enable_if<
+                tinystl::has_input_iterator_cat<InputIterator>::value,
+                int>::type = 0>
+  void insert(InputIterator first, InputIterator last) {
+    tree_.insert_unique(first, last);
+  }
+  void insert(std::initializer_list<value_type> l) {
+    tree_.insert_unique(l.begin(), l.end());
+  }
+
+  node_type extract(const_iterator pos) { return tree_.extract(pos); }
+  node_type extract(const key_type &key) { return tree_.extract(key); }
+  insert_return_type insert(node_type &&nh) {
+    auto r = tree_.insert_unique(std::move(nh));
+    return insert_return_type{r.position, r.inserted, std::move(r.node)};
+  }
+  iterator insert(const_iterator hint, node_type &&nh) {
+    return tree_.insert_unique(hint, std::move(nh));
+  }
+  void merge(set &other) { tree_.merge_unique(other.tree_); }
+  void merge(set &&other) { tree_.merge_unique(other.tree_); }
+  void merge(multiset<Key, Compare, NodePolicy> &other) {
+    tree_.merge_unique(other.tree_);
+  }
+  void merge(multiset<Key, Compare, NodePolicy> &&other) {
+    tree_.merge_unique(other.tree_);
+  }
+  // 基于 join 的集合运算，只改链接；other 的节点被并入或释放，之后为空
+  void union_with(set &other) { tree_.union_unique(other.tree_); }
+  void intersect_with(set &other) { tree_.intersection_unique(other.tree_); }
+  void subtract(set &other) { tree_.difference_unique(other.tree_); }
+  // 本容器的键都不大于 other 的键时把 other 接在后面，O(log n)
+  void join(set &other) { tree_.join(other.tree_); }
+  // 本容器保留键小于 key 的元素，其余移入 right
+  void split(const key_type &key, set &right) { tree_.split(key, right.tree_); }
+
+  iterator erase(const_iterator pos) { return tree_.erase(pos); }
+  iterator erase(const_iterator first, const_iterator last) {
+    return tree_.erase(first, last);
+  }
+  size_type erase(const key_type &key) { return tree_.erase_unique(key); }
+  void clear() { tree_.clear(); }
+
+  iterator find(const key_type &key) const { return tree_.find(key); }
+  size_type count(const key_type &key) const { return tree_.count_unique(key); }
+  iterator lower_bound(const key_type &key) const {
+    return tree_.lower_bound(key);
+  }
+  iterator upper_bound(const key_type &key) const {
+    return tree_.upper_bound(key);
+  }
+  tinystl::pair<iterator, iterator> equal_range(const key_type &key) const {
+    return tree_.equal_range_unique(key);
+  }
+
+  // 比较器透明（如 less<>）时的异构查找，不构造临时键
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  iterator find(const K &key) const {
+    return tree_.find(key);
+  }
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  size_type count(const K &key) const {
+    return tree_.count_unique(key);
+  }
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  iterator lower_bound(const K &key) const {
+    return tree_.lower_bound(key);
+  }
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  iterator upper_bound(const K &key) const {
+    return tree_.upper_bound(key);
+  }
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  tinystl::pair<iterator, iterator> equal_range(const K &key) const {
+    return tree_.equal_range_unique(key);
+  }
+
+  // 以下需 NodePolicy 为 rb_tree_order_statistics，均为 O(log n)
+  size_type rank(const key_type &key) const { return tree_.rank(key); }
+  iterator select(size_type n) const { return tree_.select(n); }
+  size_type index_of(const_iterator it) const { return tree_.index_of(it); }
+
+  void swap(set &s) noexcept { tree_.swap(s.tree_); }
+
+  friend bool operator==(const set &lhs, const set &rhs) {
+    return lhs.tree_ == rhs.tree_;
+  }
+  friend bool operator<(const set &lhs, const set &rhs) {
+    return lhs.tree_ < rhs.tree_;
+  }
+};
+
+template <typename Key, typename Compare, typename NodePolicy>
+bool operator!=(const set<Key, Compare, NodePolicy> &lhs,
+                const set<Key, Compare, NodePolicy> &rhs) {
+  return !(lhs == rhs);
+}
+template <typename Key, typename Compare, typename NodePolicy>
+void swap(set<Key, Compare, NodePolicy> &lhs,
+          set<Key, Compare, NodePolicy> &rhs) noexcept {
+  lhs.swap(rhs);
+}
+
+// 键值允许重复
+template <typename Key, typename Compare = tinystl::less<Key>,
+          typename NodePolicy = rb_tree_plain_node>
+class multiset {
+public:
+  typedef Key key_type;
+  typedef Key value_type;
+  typedef Compare key_compare;
+  typedef Compare value_compare;
+
+private:
+  typedef tinystl::rb_tree<value_type, key_compare, false, NodePolicy>
+      base_type;
+  base_type tree_;
+
+  friend class set<Key, Compare, NodePolicy>;
+
+public:
+  typedef typename base_type::node_type node_type;
+  typedef typename base_type::const_pointer pointer;
+  typedef typename base_type::const_pointer const_pointer;
+  typedef typename base_type::const_reference reference;
+  typedef typename base_type::const_reference const_reference;
+  typedef typename base_type::const_iterator iterator;
+  typedef typename base_type::const_iterator const_iterator;
+  typedef typename base_type::const_reverse_iterator reverse_iterator;
+  typedef typename base_type::const_reverse_iterator const_reverse_iterator;
+  typedef typename base_type::size_type size_type;
+  typedef typename base_type::difference_type difference_type;
+
+  multiset() = default;
+  explicit multiset(const key_compare &comp) : tree_(comp) {}
+  template <typename InputIterator,
+            typename std::enable_if<
+                tinystl::has_input_iterator_cat<InputIterator>::value,
+                int>::type = 0>
+  multiset(InputIterator first, InputIterator last) {
+    tree_.insert_equal(first, last);
+  }
+  multiset(std::initializer_list<value_type> l) {
+    tree_.insert_equal(l.begin(), l.end());
+  }
+  // [first, last) 须已按键有序，O(n) 建树
+  template <typename InputIterator,
+            typename std::enable_if<
+                tinystl::has_input_iterator_cat<InputIterator>::value,
+                int>::type = 0>
+  multiset(sorted_equal_t, InputIterator first, InputIterator last,
+           const key_compare &comp = key_compare())
+      : tree_(sorted_equal, first, last, comp) {}
+  multiset(const multiset &s) : tree_(s.tree_) {}
+  multiset(multiset &&s) : tree_(std::move(s.tree_)) {}
+
+  multiset &operator=(const multiset &s) {
+    tree_ = s.tree_;
+    return *this;
+  }
+  multiset &operator=(multiset &&s) noexcept {
+    tree_ = std::move(s.tree_);
+    return *this;
+  }
+  multiset &operator=(std::initializer_list<value_type> l) {
+    tree_.clear();
+    tree_.insert_equal(l.begin(), l.end());
+    return *this;
+  }
+
+  key_compare key_comp() const { return tree_.key_comp(); }
+  value_compare value_comp() const { return tree_.key_comp(); }
+
+  iterator begin() const noexcept { return tree_.begin(); }
+  iterator end() const noexcept { return tree_.end(); }
+  reverse_iterator rbegin() const noexcept { return tree_.rbegin(); }
+  reverse_iterator rend() const noexcept { return tree_.rend(); }
+  const_iterator cbegin() const noexcept { return begin(); }
+  const_iterator cend() const noexcept { return end(); }
+
+  bool empty() const noexcept { return tree_.empty(); }
+  size_type size() const noexcept { return tree_.size(); }
+  size_type max_size() const noexcept { return tree_.max_size(); }
+
+  template <typename... Args> iterator emplace(Args &&...args) {
+    return tree_.emplace_equal(std::forward<Args>(args)...);
+  }
+  template <typename... Args>
+  iterator emplace_hint(const_iterator hint, Args &&...args) {
+    return tree_.emplace_hint_equal(hint, std::forward<Args>(args)...);
+  }
+
+  iterator insert(const value_type &value) { return tree_.insert_equal(value); }
+  iterator insert(value_type &&value) {
+    return tree_.insert_equal(std::move(value));
+  }
+  iterator insert(const_iterator hint, const value_type &value) {
+    return tree_.insert_equal(hint, value);
+  }
+  iterator insert(const_iterator hint, value_type &&value) {
+    return tree_.insert_equal(hint, std::move(value));
+  }
+  template <typename InputIterator,
+            typename std::enable_if<
+                tinystl::has_input_iterator_cat<InputIterator>::value,
+                int>::type = 0>
+  void insert(InputIterator first, InputIterator last) {
+    tree_.insert_equal(first, last);
+  }
+  void insert(std::initializer_list<value_type> l) {
+    tree_.insert_equal(l.begin(), l.end());
+  }
+
+  node_type extract(const_iterator pos) { return tree_.extract(pos); }
+  node_type extract(const key_type &key) { return tree_.extract(key); }
+  iterator insert(node_type &&nh) { return tree_.insert_equal(std::move(nh)); }
+  iterator insert(const_iterator hint, node_type &&nh) {
+    return tree_.insert_equal(hint, std::move(nh));
+  }
+  void merge(multiset &other) { tree_.merge_equal(other.tree_); }
+  void merge(multiset &&other) { tree_.merge_equal(other.tree_); }
+  void merge(set<Key, Compare, NodePolicy> &other) {
+    tree_.merge_equal(other.tree_);
+  }
+  void merge(set<Key, Compare, NodePolicy> &&other) {
+    tree_.merge_equal(other.tree_);
+  }
+  // 本容器的键都不大于 other 的键时把 other 接在后面，O(log n)
+  void join(multiset &other) { tree_.join(other.tree_); }
+  // 本容器保留键小于 key 的元素，其余移入 right
+  void split(const key_type &key, multiset &right) {
+    tree_.split(key, right.tree_);
+  }
+
+  iterator erase(const_iterator pos) { return tree_.erase(pos); }
+  iterator erase(const_iterator first, const_iterator last) {
+    return tree_.erase(first, last);
+  }
+  size_type erase(const key_type &key) { return tree_.erase_multi(key); }
+  void clear() { tree_.clear(); }
+
+  iterator find(const key_type &key) const { return tree_.find(key); }
+  size_type count(const key_type &key) const { return tree_.count_multi(key); }
+  iterator lower_bound(const key_type &key) const {
+    return tree_.lower_bound(key);
+  }
+  iterator upper_bound(const key_type &key) const {
+    return tree_.upper_bound(key);
+  }
+  tinystl::pair<iterator, iterator> equal_range(const key_type &key) const {
+    return tree_.equal_range_multi(key);
+  }
+
+  // 比较器透明（如 less<>）时的异构查找，不构造临时键
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  iterator find(const K &key) const {
+    return tree_.find(key);
+  }
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  size_type count(const K &key) const {
+    return tree_.count_multi(key);
+  }
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  iterator lower_bound(const K &key) const {
+    return tree_.lower_bound(key);
+  }
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  iterator upper_bound(const K &key) const {
+    return tree_.upper_bound(key);
+  }
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  tinystl::pair<iterator, iterator> equal_range(const K &key) const {
+    return tree_.equal_range_multi(key);
+  }
+
+  // 以下需 NodePolicy 为 rb_tree_order_statistics，均为 O(log n)
+  size_type rank(const key_type &key) const { return tree_.rank(key); }
+  iterator select(size_type n) const { return tree_.select(n); }
+  size_type index_of(const_iterator it) const { return tree_.index_of(it); }
+
+  void swap(multiset &s) noexcept { tree_.swap(s.tree_); }
+
+  friend bool operator==(const multiset &lhs, const multiset &rhs) {
+    return lhs.tree_ == rhs.tree_;
+  }
+  friend bool operator<(const multiset &lhs, const multiset &rhs) {
+    return lhs.tree_ < rhs.tree_;
+  }
+};
+
+template <typename Key, typename Compare, typename NodePolicy>
+bool operator!=(const multiset<Key, Compare, NodePolicy> &lhs,
+                const multiset<Key, Compare, NodePolicy> &rhs) {
+  return !(lhs == rhs);
+}
+template <typename Key, typename Compare, typename NodePolicy>
+void swap(multiset<Key, Compare, NodePolicy> &lhs,
+          multiset<Key, Compare, NodePolicy> &rhs) noexcept {
+  lhs.swap(rhs);
+}
+} // namespace tinystl
+
+#endif
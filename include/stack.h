@@ -1,27 +1,302 @@
 #ifndef MYTINYSTL_STACK_H_
 #define MYTINYSTL_STACK_H_
 
+#include "allocator.h"
+#include "construct.h"
+#include "deque.h"
+#include "exceptdef.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <type_traits>
+#include <utility>
 
+namespace tinystl {
+template <typename T, typename Container = tinystl::deque<T>> class stack {
+public:
+  typedef Container container_type;
+  typedef typename Container::value_type value_type;
+  typedef typename Container::size_type size_type;
+  typedef typename Container::reference reference;
+  typedef typename Container::const_reference const_reference;
 
+  static_assert(std::is_same<T, value_type>::value,
+                "container_value_type is different from T");
 
+private:
+  container_type c_;
 
+public:
+  stack() = default;
+  explicit stack(const container_type &c) : c_(c) {}
+  explicit stack(container_type &&c) : c_(std::move(c)) {}
+  stack(std::initializer_list<value_type> l) : c_(l.begin(), l.end()) {}
+  stack(const stack &s) : c_(s.c_) {}
+  stack(stack &&s) : c_(std::move(s.c_)) {}
 
+  stack &operator=(const stack &s) {
+    c_ = s.c_;
+    return *this;
+  }
+  stack &operator=(stack &&s) {
+    c_ = std::move(s.c_);
+    return *this;
+  }
 
+  ~stack() = default;
 
+  bool empty() const noexcept { return c_.empty(); }
+  size_type size() const noexcept { return c_.size(); }
 
+  reference top() { return c_.back(); }
+  const_reference top() const { return c_.back(); }
 
+  template <typename... Args> void emplace(Args &&...args) {
+    c_.emplace_back(std::forward<Args>(args)...);
+  }
+  void push(const value_type &t) { c_.push_back(t); }
+  void push(value_type &&t) { c_.push_back(std::move(t)); }
+  void pop() { c_.pop_back(); }
+  void clear() {
+    while (!empty()) {
+      pop();
+    }
+  }
+  void swap(stack &s) { std::swap(c_, s.c_); }
+};
 
+// Treiber 无锁栈，用于跨线程的空闲链表、对象回收等场景。
+// 栈顶指针与 16 位版本号打包在一个 64 位字中做 CAS，每次修改版本号加一，
+// 以防 ABA；出栈的节点不归还给系统而是放入内部空闲链表（同样带版本号），
+// 因此并发 pop 读取已被他人弹出的节点的 next 也不会访问已释放内存。
+// 节点内存在析构时统一释放。要求 64 位平台且用户态地址不超过 48 位。
+template <typename T> class lockfree_stack {
+public:
+  typedef T value_type;
+  typedef std::size_t size_type;
 
+private:
+  struct node {
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+    std::atomic<node *> next;
 
+    T *value() { return reinterpret_cast<T *>(&storage); }
+  };
+  typedef tinystl::allocator<node> node_allocator;
+  typedef std::uint64_t tagged_ptr;
 
+  static_assert(sizeof(void *) == 8, "lockfree_stack needs 64-bit pointers");
+  static constexpr int ptr_bits = 48;
+  static constexpr tagged_ptr ptr_mask = (tagged_ptr(1) << ptr_bits) - 1;
 
+  std::atomic<tagged_ptr> head_;
+  std::atomic<tagged_ptr> free_;
 
+  static node *get_ptr(tagged_ptr t) {
+    return reinterpret_cast<node *>(static_cast<std::uintptr_t>(t & ptr_mask));
+  }
+  static tagged_ptr next_tag(tagged_ptr old, node *p) {
+    return ((old >> ptr_bits) + 1) << ptr_bits |
+           static_cast<tagged_ptr>(reinterpret_cast<std::uintptr_t>(p));
+  }
 
+  // 把 [first, last] 这段已串好的节点一次性压入 top
+  static void push_chain(std::atomic<tagged_ptr> &top, node *first,
+                         node *last) {
+    tagged_ptr old = top.load(std::memory_order_relaxed);
+    do {
+      last->next.store(get_ptr(old), std::memory_order_relaxed);
+    } while (!top.compare_exchange_weak(old, next_tag(old, first),
+                                        std::memory_order_release,
+                                        std::memory_order_relaxed));
+  }
+  static node *pop_node(std::atomic<tagged_ptr> &top) {
+    tagged_ptr old = top.load(std::memory_order_acquire);
+    node *p = get_ptr(old);
+    while (p != nullptr) {
+      node *next = p->next.load(std::memory_order_relaxed);
+      if (top.compare_exchange_weak(old, next_tag(old, next),
+                                    std::memory_order_acquire,
+                                    std::memory_order_acquire)) {
+        break;
+      }
+      p = get_ptr(old);
+    }
+    return p;
+  }
+  static node *take_all(std::atomic<tagged_ptr> &top) {
+    tagged_ptr old = top.load(std::memory_order_acquire);
+    while (get_ptr(old) != nullptr &&
+           !top.compare_exchange_weak(old, next_tag(old, nullptr),
+                                      std::memory_order_acquire,
+                                      std::memory_order_acquire)) {
+    }
+    return get_ptr(old);
+  }
 
+  node *get_node() {
+    node *p = pop_node(free_);
+    if (p == nullptr) {
+      p = node_allocator::allocate(1);
+      ::new (static_cast<void *>(&p->next)) std::atomic<node *>(nullptr);
+      MY_DEBUG((reinterpret_cast<std::uintptr_t>(p) & ~ptr_mask) == 0);
+    }
+    return p;
+  }
+  void put_node(node *p) { push_chain(free_, p, p); }
+  void recycle_chain(node *first);
 
+public:
+  lockfree_stack() : head_(0), free_(0) {}
+  lockfree_stack(const lockfree_stack &) = delete;
+  lockfree_stack &operator=(const lockfree_stack &) = delete;
+  ~lockfree_stack();
 
+  // 仅作提示，并发修改时结果可能立即过期
+  bool empty() const noexcept {
+    return get_ptr(head_.load(std::memory_order_acquire)) == nullptr;
+  }
 
+  template <typename... Args> void emplace(Args &&...args) {
+    node *p = get_node();
+    try {
+      tinystl::construct(p->value(), std::forward<Args>(args)...);
+    } catch (...) {
+      put_node(p);
+      throw;
+    }
+    push_chain(head_, p, p);
+  }
+  void push(const value_type &t) { emplace(t); }
+  void push(value_type &&t) { emplace(std::move(t)); }
 
+  // 栈空时返回 false
+  bool pop(value_type &out);
 
+  // 批量压栈：先在本地串好节点，再用一次 CAS 整体压入；
+  // 弹出顺序与 [first, last) 相反，和逐个 push 一致
+  template <typename InputIterator>
+  void push_list(InputIterator first, InputIterator last);
 
-#endif
\ No newline at end of file
+  // 用一次 CAS 摘下整个栈，按出栈顺序写入 out，返回元素个数
+  template <typename OutputIterator> size_type pop_all(OutputIterator out);
+};
+
+template <typename T> lockfree_stack<T>::~lockfree_stack() {
+  node *p = get_ptr(head_.load(std::memory_order_relaxed));
+  while (p != nullptr) {
+    node *next = p->next.load(std::memory_order_relaxed);
+    tinystl::destory(p->value());
+    node_allocator::deallocate(p);
+    p = next;
+  }
+  p = get_ptr(free_.load(std::memory_order_relaxed));
+  while (p != nullptr) {
+    node *next = p->next.load(std::memory_order_relaxed);
+    node_allocator::deallocate(p);
+    p = next;
+  }
+}
+
+template <typename T> void lockfree_stack<T>::recycle_chain(node *first) {
+  if (first == nullptr) {
+    return;
+  }
+  node *last = first;
+  for (node *next = last->next.load(std::memory_order_relaxed);
+       next != nullptr; next = last->next.load(std::memory_order_relaxed)) {
+    last = next;
+  }
+  push_chain(free_, first, last);
+}
+
+template <typename T> bool lockfree_stack<T>::pop(value_type &out) {
+  node *p = pop_node(head_);
+  if (p == nullptr) {
+    return false;
+  }
+  try {
+    out = std::move(*p->value());
+  } catch (...) {
+    push_chain(head_, p, p);
+    throw;
+  }
+  tinystl::destory(p->value());
+  put_node(p);
+  return true;
+}
+
+template <typename T>
+template <typename InputIterator>
+void lockfree_stack<T>::push_list(InputIterator first, InputIterator last) {
+  node *top = nullptr;
+  node *bottom = nullptr;
+  try {
+    for (; first != last; ++first) {
+      node *p = get_node();
+      try {
+        tinystl::construct(p->value(), *first);
+      } catch (...) {
+        put_node(p);
+        throw;
+      }
+      p->next.store(top, std::memory_order_relaxed);
+      if (bottom == nullptr) {
+        bottom = p;
+      }
+      top = p;
+    }
+  } catch (...) {
+    for (node *p = top; p != nullptr;
+         p = p->next.load(std::memory_order_relaxed)) {
+      tinystl::destory(p->value());
+    }
+    recycle_chain(top);
+    throw;
+  }
+  if (top != nullptr) {
+    push_chain(head_, top, bottom);
+  }
+}
+
+template <typename T>
+template <typename OutputIterator>
+typename lockfree_stack<T>::size_type
+lockfree_stack<T>::pop_all(OutputIterator out) {
+  node *first = take_all(head_);
+  node *done = nullptr; // 最后一个已写出并销毁元素的节点
+  size_type n = 0;
+  try {
+    for (node *p = first; p != nullptr;
+         p = p->next.load(std::memory_order_relaxed)) {
+      *out = std::move(*p->value());
+      tinystl::destory(p->value());
+      done = p;
+      ++n;
+      ++out;
+    }
+  } catch (...) {
+    // 已写出的节点回收；其余节点（含写出失败的那个）同 pop 一样压回栈中
+    node *rest = first;
+    if (done != nullptr) {
+      rest = done->next.load(std::memory_order_relaxed);
+      done->next.store(nullptr, std::memory_order_relaxed);
+      recycle_chain(first);
+    }
+    if (rest != nullptr) {
+      node *last = rest;
+      for (node *next = last->next.load(std::memory_order_relaxed);
+           next != nullptr; next = last->next.load(std::memory_order_relaxed)) {
+        last = next;
+      }
+      push_chain(head_, rest, last);
+    }
+    throw;
+  }
+  recycle_chain(first);
+  return n;
+}
+} // namespace tinystl
+
+#endif
@@ -0,0 +1,415 @@
+#ifndef MYTINYSTL_UNORDERED_MAP_H_
+#define MYTINYSTL_UNORDERED_MAP_H_
+
+// 底层为拉链法的 hashtable，节点来自容器独占的节点池；
+// 元素的引用和指针在删除前一直有效，迭代器只在重建时失效。
+// 不需要引用稳定时 flat_hash_map 更快
+
+#include "exceptdef.h"
+#include "functional.h"
+#include "hash.h"
+#include "hashtable.h"
+#include "util.h"
+#include <functional>
+#include <initializer_list>
+#include <type_traits>
+#include <utility>
+
+namespace tinystl {
+// 键值唯一
+template <typename Key, typename T, typename Hash = tinystl::hash<Key>,
+          typename KeyEqual = tinystl::equal_to<Key>>
+class unordered_map {
+public:
+  typedef Key key_type;
+  typedef T mapped_type;
+  typedef tinystl::pair<const Key, T> value_type;
+  typedef Hash hasher;
+  typedef KeyEqual key_equal;
+
+private:
+  typedef tinystl::hashtable<value_type, Hash, KeyEqual, true> base_type;
+  base_type ht_;
+
+public:
+  typedef typename base_type::pointer pointer;
+  typedef typename base_type::const_pointer const_pointer;
+  typedef typename base_type::reference reference;
+  typedef typename base_type::const_reference const_reference;
+  typedef typename base_type::iterator iterator;
+  typedef typename base_type::const_iterator const_iterator;
+  typedef typename base_type::local_iterator local_iterator;
+  typedef typename base_type::const_local_iterator const_local_iterator;
+  typedef typename base_type::size_type size_type;
+  typedef typename base_type::difference_type difference_type;
+
+  unordered_map() = default;
+  explicit unordered_map(size_type bucket_count,
+                         const hasher &hash = hasher(),
+                         const key_equal &equal = key_equal())
+      : ht_(bucket_count, hash, equal) {}
+  template <typename InputIterator,
+            typename std::enable_if<
+                tinystl::has_input_iterator_cat<InputIterator>::value,
+                int>::type = 0>
+  unordered_map(InputIterator first, InputIterator last) {
+    insert(first, last);
+  }
+  unordered_map(std::initializer_list<value_type> l) {
+    ht_.reserve(l.size());
+    insert(l.begin(), l.end());
+  }
+  unordered_map(const unordered_map &m) : ht_(m.ht_) {}
+  unordered_map(unordered_map &&m) noexcept : ht_(std::move(m.ht_)) {}
+
+  unordered_map &operator=(const unordered_map &m) {
+    ht_ = m.ht_;
+    return *this;
+  }
+  unordered_map &operator=(unordered_map &&m) noexcept {
+    ht_ = std::move(m.ht_);
+    return *this;
+  }
+  unordered_map &operator=(std::initializer_list<value_type> l) {
+    ht_.clear();
+    insert(l.begin(), l.end());
+    return *this;
+  }
+
+  iterator begin() noexcept { return ht_.begin(); }
+  const_iterator begin() const noexcept { return ht_.begin(); }
+  iterator end() noexcept { return ht_.end(); }
+  const_iterator end() const noexcept { return ht_.end(); }
+  const_iterator cbegin() const noexcept { return begin(); }
+  const_iterator cend() const noexcept { return end(); }
+
+  bool empty() const noexcept { return ht_.empty(); }
+  size_type size() const noexcept { return ht_.size(); }
+  size_type max_size() const noexcept { return ht_.max_size(); }
+
+  mapped_type &at(const key_type &key) {
+    iterator it = find(key);
+    THROW_OUT_OF_RANGE_IF(it == end(),
+                          "unordered_map<Key, T> no such element exists");
+    return it->second;
+  }
+  const mapped_type &at(const key_type &key) const {
+    const_iterator it = find(key);
+    THROW_OUT_OF_RANGE_IF(it == end(),
+                          "unordered_map<Key, T> no such element exists");
+    return it->second;
+  }
+  mapped_type &operator[](const key_type &key) {
+    return try_emplace(key).first->second;
+  }
+  mapped_type &operator[](key_type &&key) {
+    return try_emplace(std::move(key)).first->second;
+  }
+
+  template <typename... Args>
+  tinystl::pair<iterator, bool> emplace(Args &&...args) {
+    return ht_.emplace_unique(std::forward<Args>(args)...);
+  }
+  template <typename... Args>
+  iterator emplace_hint(const_iterator, Args &&...args) {
+    return ht_.emplace_unique(std::forward<Args>(args)...).first;
+  }
+  // 键已存在时不构造元素，args 不会被移动
+  template <typename... Args>
+  tinystl::pair<iterator, bool> try_emplace(const key_type &key,
+                                            Args &&...args) {
+    return ht_.try_emplace(key, std::forward<Args>(args)...);
+  }
+  template <typename... Args>
+  tinystl::pair<iterator, bool> try_emplace(key_type &&key, Args &&...args) {
+    return ht_.try_emplace(std::move(key), std::forward<Args>(args)...);
+  }
+  template <typename M>
+  tinystl::pair<iterator, bool> insert_or_assign(const key_type &key,
+                                                 M &&obj) {
+    auto r = ht_.emplace_key(key, key, std::forward<M>(obj));
+    if (!r.second) {
+      r.first->second = std::forward<M>(obj);
+    }
+    return r;
+  }
+
+  tinystl::pair<iterator, bool> insert(const value_type &value) {
+    return ht_.emplace_key(value.first, value);
+  }
+  tinystl::pair<iterator, bool> insert(value_type &&value) {
+    return ht_.emplace_key(value.first, std::move(value));
+  }
+  iterator insert(const_iterator, const value_type &value) {
+    return insert(value).first;
+  }
+  iterator insert(const_iterator, value_type &&value) {
+    return insert(std::move(value)).first;
+  }
+  template <typename InputIterator,
+            typename std::enable_if<
+                tinystl::has_input_iterator_cat<InputIterator>::value,
+                int>::type = 0>
+  void insert(InputIterator first, InputIterator last) {
+    for (; first != last; ++first) {
+      insert(*first);
+    }
+  }
+  void insert(std::initializer_list<value_type> l) {
+    insert(l.begin(), l.end());
+  }
+
+  iterator erase(const_iterator pos) { return ht_.erase(pos); }
+  iterator erase(const_iterator first, const_iterator last) {
+    return ht_.erase(first, last);
+  }
+  size_type erase(const key_type &key) { return ht_.erase_key(key); }
+  void clear() noexcept { ht_.clear(); }
+
+  iterator find(const key_type &key) { return ht_.find(key); }
+  const_iterator find(const key_type &key) const { return ht_.find(key); }
+  size_type count(const key_type &key) const {
+    return ht_.contains(key) ? 1 : 0;
+  }
+  bool contains(const key_type &key) const { return ht_.contains(key); }
+  tinystl::pair<iterator, iterator> equal_range(const key_type &key) {
+    return ht_.equal_range(key);
+  }
+  tinystl::pair<const_iterator, const_iterator>
+  equal_range(const key_type &key) const {
+    return ht_.equal_range(key);
+  }
+
+  // 哈希与相等比较都透明时的异构查找，不构造临时键
+  template <typename K, typename H = Hash, typename E = KeyEqual,
+            typename = typename H::is_transparent,
+            typename = typename E::is_transparent>
+  iterator find(const K &key) {
+    return ht_.find(key);
+  }
+  template <typename K, typename H = Hash, typename E = KeyEqual,
+            typename = typename H::is_transparent,
+            typename = typename E::is_transparent>
+  const_iterator find(const K &key) const {
+    return ht_.find(key);
+  }
+  template <typename K, typename H = Hash, typename E = KeyEqual,
+            typename = typename H::is_transparent,
+            typename = typename E::is_transparent>
+  size_type count(const K &key) const {
+    return ht_.contains(key) ? 1 : 0;
+  }
+  template <typename K, typename H = Hash, typename E = KeyEqual,
+            typename = typename H::is_transparent,
+            typename = typename E::is_transparent>
+  bool contains(const K &key) const {
+    return ht_.contains(key);
+  }
+
+  // 桶接口
+  local_iterator begin(size_type n) { return ht_.begin(n); }
+  const_local_iterator begin(size_type n) const { return ht_.begin(n); }
+  const_local_iterator cbegin(size_type n) const { return ht_.begin(n); }
+  local_iterator end(size_type n) { return ht_.end(n); }
+  const_local_iterator end(size_type n) const { return ht_.end(n); }
+  const_local_iterator cend(size_type n) const { return ht_.end(n); }
+  size_type bucket_count() const noexcept { return ht_.bucket_count(); }
+  size_type max_bucket_count() const noexcept {
+    return ht_.max_bucket_count();
+  }
+  size_type bucket_size(size_type n) const { return ht_.bucket_size(n); }
+  size_type bucket(const key_type &key) const { return ht_.bucket(key); }
+
+  float load_factor() const noexcept { return ht_.load_factor(); }
+  float max_load_factor() const noexcept { return ht_.max_load_factor(); }
+  void max_load_factor(float ml) { ht_.max_load_factor(ml); }
+  void rehash(size_type n) { ht_.rehash(n); }
+  void reserve(size_type n) { ht_.reserve(n); }
+
+  hasher hash_function() const { return ht_.hash_function(); }
+  key_equal key_eq() const { return ht_.key_eq(); }
+
+  void swap(unordered_map &m) noexcept { ht_.swap(m.ht_); }
+
+  friend bool operator==(const unordered_map &lhs, const unordered_map &rhs) {
+    return lhs.ht_ == rhs.ht_;
+  }
+};
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+bool operator!=(const unordered_map<Key, T, Hash, KeyEqual> &lhs,
+                const unordered_map<Key, T, Hash, KeyEqual> &rhs) {
+  return !(lhs == rhs);
+}
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+void swap(unordered_map<Key, T, Hash, KeyEqual> &lhs,
+          unordered_map<Key, T, Hash, KeyEqual> &rhs) noexcept {
+  lhs.swap(rhs);
+}
+
+// 键值可重复，等价元素相邻
+template <typename Key, typename T, typename Hash = tinystl::hash<Key>,
+          typename KeyEqual = tinystl::equal_to<Key>>
+class unordered_multimap {
+public:
+  typedef Key key_type;
+  typedef T mapped_type;
+  typedef tinystl::pair<const Key, T> value_type;
+  typedef Hash hasher;
+  typedef KeyEqual key_equal;
+
+private:
+  typedef tinystl::hashtable<value_type, Hash, KeyEqual, true> base_type;
+  base_type ht_;
+
+public:
+  typedef typename base_type::pointer pointer;
+  typedef typename base_type::const_pointer const_pointer;
+  typedef typename base_type::reference reference;
+  typedef typename base_type::const_reference const_reference;
+  typedef typename base_type::iterator iterator;
+  typedef typename base_type::const_iterator const_iterator;
+  typedef typename base_type::local_iterator local_iterator;
+  typedef typename base_type::const_local_iterator const_local_iterator;
+  typedef typename base_type::size_type size_type;
+  typedef typename base_type::difference_type difference_type;
+
+  unordered_multimap() = default;
+  explicit unordered_multimap(size_type bucket_count,
+                              const hasher &hash = hasher(),
+                              const key_equal &equal = key_equal())
+      : ht_(bucket_count, hash, equal) {}
+  template <typename InputIterator,
+            typename std::enable_if<
+                tinystl::has_input_iterator_cat<InputIterator>::value,
+                int>::type = 0>
+  unordered_multimap(InputIterator first, InputIterator last) {
+    insert(first, last);
+  }
+  unordered_multimap(std::initializer_list<value_type> l) {
+    ht_.reserve(l.size());
+    insert(l.begin(), l.end());
+  }
+  unordered_multimap(const unordered_multimap &m) : ht_(m.ht_) {}
+  unordered_multimap(unordered_multimap &&m) noexcept
+      : ht_(std::move(m.ht_)) {}
+
+  unordered_multimap &operator=(const unordered_multimap &m) {
+    ht_ = m.ht_;
+    return *this;
+  }
+  unordered_multimap &operator=(unordered_multimap &&m) noexcept {
+    ht_ = std::move(m.ht_);
+    return *this;
+  }
+  unordered_multimap &operator=(std::initializer_list<value_type> l) {
+    ht_.clear();
+    insert(l.begin(), l.end());
+    return *this;
+  }
+
+  iterator begin() noexcept { return ht_.begin(); }
+  const_iterator begin() const noexcept { return ht_.begin(); }
+  iterator end() noexcept { return ht_.end(); }
+  const_iterator end() const noexcept { return ht_.end(); }
+  const_iterator cbegin() const noexcept { return begin(); }
+  const_iterator cend() const noexcept { return end(); }
+
+  bool empty() const noexcept { return ht_.empty(); }
+  size_type size() const noexcept { return ht_.size(); }
+  size_type max_size() const noexcept { return ht_.max_size(); }
+
+  template <typename... Args> iterator emplace(Args &&...args) {
+    return ht_.emplace_equal(std::forward<Args>(args)...);
+  }
+  template <typename... Args>
+  iterator emplace_hint(const_iterator, Args &&...args) {
+    return ht_.emplace_equal(std::forward<Args>(args)...);
+  }
+
+  iterator insert(const value_type &value) { return ht_.emplace_equal(value); }
+  iterator insert(value_type &&value) {
+    return ht_.emplace_equal(std::move(value));
+  }
+  iterator insert(const_iterator, const value_type &value) {
+    return insert(value);
+  }
+  iterator insert(const_iterator, value_type &&value) {
+    return insert(std::move(value));
+  }
+  template <typename InputIterator,
+            typename std::enable_if<
+                tinystl::has_input_iterator_cat<InputIterator>::value,
+                int>::type = 0>
+  void insert(InputIterator first, InputIterator last) {
+    for (; first != last; ++first) {
+      insert(*first);
+    }
+  }
+  void insert(std::initializer_list<value_type> l) {
+    insert(l.begin(), l.end());
+  }
+
+  iterator erase(const_iterator pos) { return ht_.erase(pos); }
+  iterator erase(const_iterator first, const_iterator last) {
+    return ht_.erase(first, last);
+  }
+  size_type erase(const key_type &key) { return ht_.erase_key(key); }
+  void clear() noexcept { ht_.clear(); }
+
+  iterator find(const key_type &key) { return ht_.find(key); }
+  const_iterator find(const key_type &key) const { return ht_.find(key); }
+  size_type count(const key_type &key) const { return ht_.count(key); }
+  bool contains(const key_type &key) const { return ht_.contains(key); }
+  tinystl::pair<iterator, iterator> equal_range(const key_type &key) {
+    return ht_.equal_range(key);
+  }
+  tinystl::pair<const_iterator, const_iterator>
+  equal_range(const key_type &key) const {
+    return ht_.equal_range(key);
+  }
+
+  // 桶接口
+  local_iterator begin(size_type n) { return ht_.begin(n); }
+  const_local_iterator begin(size_type n) const { return ht_.begin(n); }
+  const_local_iterator cbegin(size_type n) const { return ht_.begin(n); }
+  local_iterator end(size_type n) { return ht_.end(n); }
+  const_local_iterator end(size_type n) const { return ht_.end(n); }
+  const_local_iterator cend(size_type n) const { return ht_.end(n); }
+  size_type bucket_count() const noexcept { return ht_.bucket_count(); }
+  size_type max_bucket_count() const noexcept {
+    return ht_.max_bucket_count();
+  }
+  size_type bucket_size(size_type n) const { return ht_.bucket_size(n); }
+  size_type bucket(const key_type &key) const { return ht_.bucket(key); }
+
+  float load_factor() const noexcept { return ht_.load_factor(); }
+  float max_load_factor() const noexcept { return ht_.max_load_factor(); }
+  void max_load_factor(float ml) { ht_.max_load_factor(ml); }
+  void rehash(size_type n) { ht_.rehash(n); }
+  void reserve(size_type n) { ht_.reserve(n); }
+
+  hasher hash_function() const { return ht_.hash_function(); }
+  key_equal key_eq() const { return ht_.key_eq(); }
+
+  void swap(unordered_multimap &m) noexcept { ht_.swap(m.ht_); }
+
+  friend bool operator==(const unordered_multimap &lhs,
+                         const unordered_multimap &rhs) {
+    return lhs.ht_ == rhs.ht_;
+  }
+};
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+bool operator!=(const unordered_multimap<Key, T, Hash, KeyEqual> &lhs,
+                const unordered_multimap<Key, T, Hash, KeyEqual> &rhs) {
+  return !(lhs == rhs);
+}
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+void swap(unordered_multimap<Key, T, Hash, KeyEqual> &lhs,
+          unordered_multimap<Key, T, Hash, KeyEqual> &rhs) noexcept {
+  lhs.swap(rhs);
+}
+} // namespace tinystl
+
+#endif
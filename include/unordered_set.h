@@ -0,0 +1,350 @@
+#ifndef MYTINYSTL_UNORDERED_SET_H_
+#define MYTINYSTL_UNORDERED_SET_H_
+
+// 底层为拉链法的 hashtable，元素不可修改，iterator 与 const_iterator 相同；
+// 元素的引用和指针在删除前一直有效，迭代器只在重建时失效
+
+#include "functional.h"
+#include "hash.h"
+#include "hashtable.h"
+#include "util.h"
+#include <functional>
+#include <initializer_list>
+#include <type_traits>
+#include <utility>
+
+namespace tinystl {
+// 键值唯一
+template <typename Key, typename Hash = tinystl::hash<Key>,
+          typename KeyEqual = tinystl::equal_to<Key>>
+class unordered_set {
+public:
+  typedef Key key_type;
+  typedef Key value_type;
+  typedef Hash hasher;
+  typedef KeyEqual key_equal;
+
+private:
+  typedef tinystl::hashtable<Key, Hash, KeyEqual, false> base_type;
+  base_type ht_;
+
+public:
+  typedef typename base_type::const_pointer pointer;
+  typedef typename base_type::const_pointer const_pointer;
+  typedef typename base_type::const_reference reference;
+  typedef typename base_type::const_reference const_reference;
+  typedef typename base_type::const_iterator iterator;
+  typedef typename base_type::const_iterator const_iterator;
+  typedef typename base_type::const_local_iterator local_iterator;
+  typedef typename base_type::const_local_iterator const_local_iterator;
+  typedef typename base_type::size_type size_type;
+  typedef typename base_type::difference_type difference_type;
+
+  unordered_set() = default;
+  explicit unordered_set(size_type bucket_count,
+                         const hasher &hash = hasher(),
+                         const key_equal &equal = key_equal())
+      : ht_(bucket_count, hash, equal) {}
+  template <typename InputIterator,
+            typename std::enable_if<
+                tinystl::has_input_iterator_cat<InputIterator>::value,
+                int>::type = 0>
+  unordered_set(InputIterator first, InputIterator last) {
+    insert(first, last);
+  }
+  unordered_set(std::initializer_list<value_type> l) {
+    ht_.reserve(l.size());
+    insert(l.begin(), l.end());
+  }
+  unordered_set(const unordered_set &s) : ht_(s.ht_) {}
+  unordered_set(unordered_set &&s) noexcept : ht_(std::move(s.ht_)) {}
+
+  unordered_set &operator=(const unordered_set &s) {
+    ht_ = s.ht_;
+    return *this;
+  }
+  unordered_set &operator=(unordered_set &&s) noexcept {
+    ht_ = std::move(s.ht_);
+    return *this;
+  }
+  unordered_set &operator=(std::initializer_list<value_type> l) {
+    ht_.clear();
+    insert(l.begin(), l.end());
+    return *this;
+  }
+
+  iterator begin() const noexcept { return ht_.begin(); }
+  iterator end() const noexcept { return ht_.end(); }
+  const_iterator cbegin() const noexcept { return begin(); }
+  const_iterator cend() const noexcept { return end(); }
+
+  bool empty() const noexcept { return ht_.empty(); }
+  size_type size() const noexcept { return ht_.size(); }
+  size_type max_size() const noexcept { return ht_.max_size(); }
+
+  template <typename... Args>
+  tinystl::pair<iterator, bool> emplace(Args &&...args) {
+    auto r = ht_.emplace_unique(std::forward<Args>(args)...);
+    return tinystl::pair<iterator, bool>(r.first, r.second);
+  }
+  template <typename... Args>
+  iterator emplace_hint(const_iterator, Args &&...args) {
+    return ht_.emplace_unique(std::forward<Args>(args)...).first;
+  }
+  tinystl::pair<iterator, bool> insert(const value_type &value) {
+    auto r = ht_.emplace_key(value, value);
+    return tinystl::pair<iterator, bool>(r.first, r.second);
+  }
+  tinystl::pair<iterator, bool> insert(value_type &&value) {
+    auto r = ht_.emplace_key(value, std::move(value));
+    return tinystl::pair<iterator, bool>(r.first, r.second);
+  }
+  iterator insert(const_iterator, const value_type &value) {
+    return insert(value).first;
+  }
+  iterator insert(const_iterator, value_type &&value) {
+    return insert(std::move(value)).first;
+  }
+  template <typename InputIterator,
+            typename std::enable_if<
+                tinystl::has_input_iterator_cat<InputIterator>::value,
+                int>::type = 0>
+  void insert(InputIterator first, InputIterator last) {
+    for (; first != last; ++first) {
+      insert(*first);
+    }
+  }
+  void insert(std::initializer_list<value_type> l) {
+    insert(l.begin(), l.end());
+  }
+
+  iterator erase(const_iterator pos) { return ht_.erase(pos); }
+  iterator erase(const_iterator first, const_iterator last) {
+    return ht_.erase(first, last);
+  }
+  size_type erase(const key_type &key) { return ht_.erase_key(key); }
+  void clear() noexcept { ht_.clear(); }
+
+  iterator find(const key_type &key) const { return ht_.find(key); }
+  size_type count(const key_type &key) const {
+    return ht_.contains(key) ? 1 : 0;
+  }
+  bool contains(const key_type &key) const { return ht_.contains(key); }
+  tinystl::pair<iterator, iterator> equal_range(const key_type &key) const {
+    return ht_.equal_range(key);
+  }
+
+  // 哈希与相等比较都透明时的异构查找，不构造临时键
+  template <typename K, typename H = Hash, typename E = KeyEqual,
+            typename = typename H::is_transparent,
+            typename = typename E::is_transparent>
+  iterator find(const K &key) const {
+    return ht_.find(key);
+  }
+  template <typename K, typename H = Hash, typename E = KeyEqual,
+            typename = typename H::is_transparent,
+            typename = typename E::is_transparent>
+  size_type count(const K &key) const {
+    return ht_.contains(key) ? 1 : 0;
+  }
+  template <typename K, typename H = Hash, typename E = KeyEqual,
+            typename = typename H::is_transparent,
+            typename = typename E::is_transparent>
+  bool contains(const K &key) const {
+    return ht_.contains(key);
+  }
+
+  // 桶接口
+  local_iterator begin(size_type n) const { return ht_.begin(n); }
+  const_local_iterator cbegin(size_type n) const { return ht_.begin(n); }
+  local_iterator end(size_type n) const { return ht_.end(n); }
+  const_local_iterator cend(size_type n) const { return ht_.end(n); }
+  size_type bucket_count() const noexcept { return ht_.bucket_count(); }
+  size_type max_bucket_count() const noexcept {
+    return ht_.max_bucket_count();
+  }
+  size_type bucket_size(size_type n) const { return ht_.bucket_size(n); }
+  size_type bucket(const key_type &key) const { return ht_.bucket(key); }
+
+  float load_factor() const noexcept { return ht_.load_factor(); }
+  float max_load_factor() const noexcept { return ht_.max_load_factor(); }
+  void max_load_factor(float ml) { ht_.max_load_factor(ml); }
+  void rehash(size_type n) { ht_.rehash(n); }
+  void reserve(size_type n) { ht_.reserve(n); }
+
+  hasher hash_function() const { return ht_.hash_function(); }
+  key_equal key_eq() const { return ht_.key_eq(); }
+
+  void swap(unordered_set &s) noexcept { ht_.swap(s.ht_); }
+
+  friend bool operator==(const unordered_set &lhs, const unordered_set &rhs) {
+    return lhs.ht_ == rhs.ht_;
+  }
+};
+
+template <typename Key, typename Hash, typename KeyEqual>
+bool operator!=(const unordered_set<Key, Hash, KeyEqual> &lhs,
+                const unordered_set<Key, Hash, KeyEqual> &rhs) {
+  return !(lhs == rhs);
+}
+template <typename Key, typename Hash, typename KeyEqual>
+void swap(unordered_set<Key, Hash, KeyEqual> &lhs,
+          unordered_set<Key, Hash, KeyEqual> &rhs) noexcept {
+  lhs.swap(rhs);
+}
+
+// 键值可重复，等价元素相邻
+template <typename Key, typename Hash = tinystl::hash<Key>,
+          typename KeyEqual = tinystl::equal_to<Key>>
+class unordered_multiset {
+public:
+  typedef Key key_type;
+  typedef Key value_type;
+  typedef Hash hasher;
+  typedef KeyEqual key_equal;
+
+private:
+  typedef tinystl::hashtable<Key, Hash, KeyEqual, false> base_type;
+  base_type ht_;
+
+public:
+  typedef typename base_type::const_pointer pointer;
+  typedef typename base_type::const_pointer const_pointer;
+  typedef typename base_type::const_reference reference;
+  typedef typename base_type::const_reference const_reference;
+  typedef typename base_type::const_iterator iterator;
+  typedef typename base_type::const_iterator const_iterator;
+  typedef typename base_type::const_local_iterator local_iterator;
+  typedef typename base_type::const_local_iterator const_local_iterator;
+  typedef typename base_type::size_type size_type;
+  typedef typename base_type::difference_type difference_type;
+
+  unordered_multiset() = default;
+  explicit unordered_multiset(size_type bucket_count,
+                              const hasher &hash = hasher(),
+                              const key_equal &equal = key_equal())
+      : ht_(bucket_count, hash, equal) {}
+  template <typename InputIterator,
+            typename std::enable_if<
+                tinystl::has_input_iterator_cat<InputIterator>::value,
+                int>::type = 0>
+  unordered_multiset(InputIterator first, InputIterator last) {
+    insert(first, last);
+  }
+  unordered_multiset(std::initializer_list<value_type> l) {
+    ht_.reserve(l.size());
+    insert(l.begin(), l.end());
+  }
+  unordered_multiset(const unordered_multiset &s) : ht_(s.ht_) {}
+  unordered_multiset(unordered_multiset &&s) noexcept
+      : ht_(std::move(s.ht_)) {}
+
+  unordered_multiset &operator=(const unordered_multiset &s) {
+    ht_ = s.ht_;
+    return *this;
+  }
+  unordered_multiset &operator=(unordered_multiset &&s) noexcept {
+    ht_ = std::move(s.ht_);
+    return *this;
+  }
+  unordered_multiset &operator=(std::initializer_list<value_type> l) {
+    ht_.clear();
+    insert(l.begin(), l.end());
+    return *this;
+  }
+
+  iterator begin() const noexcept { return ht_.begin(); }
+  iterator end() const noexcept { return ht_.end(); }
+  const_iterator cbegin() const noexcept { return begin(); }
+  const_iterator cend() const noexcept { return end(); }
+
+  bool empty() const noexcept { return ht_.empty(); }
+  size_type size() const noexcept { return ht_.size(); }
+  size_type max_size() const noexcept { return ht_.max_size(); }
+
+  template <typename... Args> iterator emplace(Args &&...args) {
+    return ht_.emplace_equal(std::forward<Args>(args)...);
+  }
+  template <typename... Args>
+  iterator emplace_hint(const_iterator, Args &&...args) {
+    return ht_.emplace_equal(std::forward<Args>(args)...);
+  }
+  iterator insert(const value_type &value) { return ht_.emplace_equal(value); }
+  iterator insert(value_type &&value) {
+    return ht_.emplace_equal(std::move(value));
+  }
+  iterator insert(const_iterator, const value_type &value) {
+    return insert(value);
+  }
+  iterator insert(const_iterator, value_type &&value) {
+    return insert(std::move(value));
+  }
+  template <typename InputIterator,
+            typename std::enable_if<
+                tinystl::has_input_iterator_cat<InputIterator>::value,
+                int>::type = 0>
+  void insert(InputIterator first, InputIterator last) {
+    for (; first != last; ++first) {
+      insert(*first);
+    }
+  }
+  void insert(std::initializer_list<value_type> l) {
+    insert(l.begin(), l.end());
+  }
+
+  iterator erase(const_iterator pos) { return ht_.erase(pos); }
+  iterator erase(const_iterator first, const_iterator last) {
+    return ht_.erase(first, last);
+  }
+  size_type erase(const key_type &key) { return ht_.erase_key(key); }
+  void clear() noexcept { ht_.clear(); }
+
+  iterator find(const key_type &key) const { return ht_.find(key); }
+  size_type count(const key_type &key) const { return ht_.count(key); }
+  bool contains(const key_type &key) const { return ht_.contains(key); }
+  tinystl::pair<iterator, iterator> equal_range(const key_type &key) const {
+    return ht_.equal_range(key);
+  }
+
+  // 桶接口
+  local_iterator begin(size_type n) const { return ht_.begin(n); }
+  const_local_iterator cbegin(size_type n) const { return ht_.begin(n); }
+  local_iterator end(size_type n) const { return ht_.end(n); }
+  const_local_iterator cend(size_type n) const { return ht_.end(n); }
+  size_type bucket_count() const noexcept { return ht_.bucket_count(); }
+  size_type max_bucket_count() const noexcept {
+    return ht_.max_bucket_count();
+  }
+  size_type bucket_size(size_type n) const { return ht_.bucket_size(n); }
+  size_type bucket(const key_type &key) const { return ht_.bucket(key); }
+
+  float load_factor() const noexcept { return ht_.load_factor(); }
+  float max_load_factor() const noexcept { return ht_.max_load_factor(); }
+  void max_load_factor(float ml) { ht_.max_load_factor(ml); }
+  void rehash(size_type n) { ht_.rehash(n); }
+  void reserve(size_type n) { ht_.reserve(n); }
+
+  hasher hash_function() const { return ht_.hash_function(); }
+  key_equal key_eq() const { return ht_.key_eq(); }
+
+  void swap(unordered_multiset &s) noexcept { ht_.swap(s.ht_); }
+
+  friend bool operator==(const unordered_multiset &lhs,
+                         const unordered_multiset &rhs) {
+    return lhs.ht_ == rhs.ht_;
+  }
+};
+
+template <typename Key, typename Hash, typename KeyEqual>
+bool operator!=(const unordered_multiset<Key, Hash, KeyEqual> &lhs,
+                const unordered_multiset<Key, Hash, KeyEqual> &rhs) {
+  return !(lhs == rhs);
+}
+template <typename Key, typename Hash, typename KeyEqual>
+void swap(unordered_multiset<Key, Hash, KeyEqual> &lhs,
+          unordered_multiset<Key, Hash, KeyEqual> &rhs) noexcept {
+  lhs.swap(rhs);
+}
+} // namespace tinystl
+
+#endif
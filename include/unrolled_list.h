@@ -0,0 +1,451 @@
+#ifndef MYTINYSTL_UNROLLED_LIST_H_
+#define MYTINYSTL_UNROLLED_LIST_H_
+
+// 展开链表：每个节点持有一段按 64 字节对齐的连续数组（最多 K 个元素），
+// 顺序遍历时一次缓存未命中可访问多个元素。节点写满时对半分裂，
+// 删除后节点过空则与后继合并，在已知位置插入/删除的代价为 O(K)。
+// 插入与删除会使同一节点（分裂/合并时还包括相邻节点）上的迭代器失效。
+
+#include "allocator.h"
+#include "construct.h"
+#include "exceptdef.h"
+#include "iterator.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace tinystl {
+
+#ifndef UNROLLED_LIST_NODE_ALIGN_
+#define UNROLLED_LIST_NODE_ALIGN_ 64
+#endif
+
+// 默认每个节点的数据区约为 512 字节（8 条缓存行）
+template <typename T> struct unrolled_list_node_capacity {
+  static constexpr std::size_t value = sizeof(T) < 64 ? 512 / sizeof(T) : 8;
+};
+
+struct unrolled_list_node_base {
+  typedef unrolled_list_node_base *base_ptr;
+
+  base_ptr pre;
+  base_ptr next;
+  std::size_t count;
+
+  void un_link() {
+    pre = this;
+    next = this;
+  }
+};
+
+template <typename T, std::size_t K>
+struct unrolled_list_node : public unrolled_list_node_base {
+  alignas(UNROLLED_LIST_NODE_ALIGN_) typename std::aligned_storage<
+      sizeof(T), alignof(T)>::type data[K];
+
+  T *elems() { return reinterpret_cast<T *>(data); }
+};
+
+template <typename T, std::size_t K, typename Ref, typename Ptr>
+struct unrolled_list_iterator
+    : public tinystl::iterator<tinystl::bidirectional_iterator_tag, T> {
+  typedef unrolled_list_iterator<T, K, T &, T *> iterator;
+  typedef unrolled_list_iterator<T, K, const T &, const T *> const_iterator;
+  typedef unrolled_list_iterator self;
+
+  typedef unrolled_list_node_base *base_ptr;
+  typedef unrolled_list_node<T, K> *node_ptr;
+  typedef std::size_t size_type;
+  typedef T value_type;
+  typedef Ref reference;
+  typedef Ptr pointer;
+
+  base_ptr node;
+  size_type index;
+
+  unrolled_list_iterator() : node(nullptr), index(0) {}
+  unrolled_list_iterator(base_ptr n, size_type i) : node(n), index(i) {}
+  // 仅供 iterator 转换为 const_iterator；写成模板使其不成为 iterator 的
+  // 拷贝构造函数，两种迭代器都保留隐式的拷贝构造与拷贝赋值
+  template <typename R = Ref,
+            typename = typename std::enable_if<
+                !std::is_same<R, T &>::value>::type>
+  unrolled_list_iterator(const iterator &t) : node(t.node), index(t.index) {}
+
+  reference operator*() const {
+    return static_cast<node_ptr>(node)->elems()[index];
+  }
+  pointer operator->() const { return &*(*this); }
+
+  self &operator++() {
+    MY_DEBUG(node != nullptr);
+    if (++index == node->count) {
+      node = node->next;
+      index = 0;
+    }
+    return *this;
+  }
+  self operator++(int) {
+    self tmp = *this;
+    ++*this;
+    return tmp;
+  }
+  self &operator--() {
+    MY_DEBUG(node != nullptr);
+    if (index == 0) {
+      node = node->pre;
+      index = node->count;
+    }
+    --index;
+    return *this;
+  }
+  self operator--(int) {
+    self tmp = *this;
+    --*this;
+    return tmp;
+  }
+
+  bool operator==(const self &t) const {
+    return node == t.node && index == t.index;
+  }
+  bool operator!=(const self &t) const { return !(*this == t); }
+};
+
+template <typename T, std::size_t K = unrolled_list_node_capacity<T>::value>
+class unrolled_list {
+  static_assert(K >= 2, "unrolled_list needs at least two slots per node");
+
+public:
+  typedef unrolled_list_node_base base_type;
+  typedef unrolled_list_node<T, K> node_type;
+  typedef base_type *base_ptr;
+  typedef node_type *node_ptr;
+
+  typedef tinystl::allocator<base_type> base_allocator;
+  typedef tinystl::allocator<unsigned char> byte_allocator;
+
+  typedef T value_type;
+  typedef T *pointer;
+  typedef T &reference;
+  typedef const T &const_reference;
+  typedef std::ptrdiff_t difference_type;
+  typedef std::size_t size_type;
+
+  typedef unrolled_list_iterator<T, K, T &, T *> iterator;
+  typedef unrolled_list_iterator<T, K, const T &, const T *> const_iterator;
+
+  static constexpr size_type node_capacity = K;
+
+private:
+  base_ptr node_;
+  size_type size_;
+
+protected:
+  static node_ptr as_node(base_ptr p) { return static_cast<node_ptr>(p); }
+  node_ptr create_node(base_ptr pos);
+  void destory_node(base_ptr);
+  void list_init();
+  void split_node(base_ptr);
+  void merge_next(base_ptr);
+  template <typename... Args>
+  iterator emplace_in_node(base_ptr, size_type, Args &&...args);
+  template <typename InputIterator>
+  void range_init(InputIterator first, InputIterator last);
+
+public:
+  unrolled_list() { list_init(); }
+  explicit unrolled_list(size_type n) {
+    list_init();
+    for (; n > 0; --n) {
+      emplace_back();
+    }
+  }
+  unrolled_list(size_type n, const value_type &t) {
+    list_init();
+    for (; n > 0; --n) {
+      emplace_back(t);
+    }
+  }
+  template <
+      typename InputIterator,
+      typename std::enable_if<
+          tinystl::has_input_iterator_cat<InputIterator>::value, int>::type = 0>
+  unrolled_list(InputIterator first, InputIterator last) {
+    range_init(first, last);
+  }
+  unrolled_list(std::initializer_list<value_type> l) {
+    range_init(l.begin(), l.end());
+  }
+  unrolled_list(const unrolled_list &l) { range_init(l.begin(), l.end()); }
+  unrolled_list(unrolled_list &&l) noexcept : node_(l.node_), size_(l.size_) {
+    l.node_ = nullptr;
+    l.size_ = 0;
+  }
+
+  unrolled_list &operator=(const unrolled_list &l) {
+    if (this != &l) {
+      unrolled_list tmp(l);
+      swap(tmp);
+    }
+    return *this;
+  }
+  unrolled_list &operator=(unrolled_list &&l) noexcept {
+    swap(l);
+    return *this;
+  }
+
+  ~unrolled_list() {
+    if (node_ != nullptr) {
+      clear();
+      base_allocator::deallocate(node_);
+    }
+  }
+
+  iterator begin() noexcept { return iterator(node_->next, 0); }
+  iterator end() noexcept { return iterator(node_, 0); }
+  const_iterator begin() const noexcept { return iterator(node_->next, 0); }
+  const_iterator end() const noexcept { return iterator(node_, 0); }
+
+  bool empty() const noexcept { return size_ == 0; }
+  size_type size() const noexcept { return size_; }
+
+  reference front() {
+    MY_DEBUG(!empty());
+    return *begin();
+  }
+  reference back() {
+    MY_DEBUG(!empty());
+    return as_node(node_->pre)->elems()[node_->pre->count - 1];
+  }
+
+  template <typename... Args>
+  iterator emplace(const_iterator pos, Args &&...args);
+  template <typename... Args> void emplace_back(Args &&...args) {
+    base_ptr tail = node_->pre;
+    if (tail == node_ || tail->count == K) {
+      tail = create_node(node_);
+    }
+    tinystl::construct(as_node(tail)->elems() + tail->count,
+                       std::forward<Args>(args)...);
+    ++tail->count;
+    ++size_;
+  }
+  template <typename... Args> void emplace_front(Args &&...args) {
+    emplace(begin(), std::forward<Args>(args)...);
+  }
+
+  iterator insert(const_iterator pos, const value_type &t) {
+    return emplace(pos, t);
+  }
+  iterator insert(const_iterator pos, value_type &&t) {
+    return emplace(pos, std::move(t));
+  }
+  void push_back(const value_type &t) { emplace_back(t); }
+  void push_back(value_type &&t) { emplace_back(std::move(t)); }
+  void push_front(const value_type &t) { emplace_front(t); }
+  void push_front(value_type &&t) { emplace_front(std::move(t)); }
+
+  iterator erase(const_iterator pos);
+  iterator erase(const_iterator first, const_iterator last);
+  void pop_front() { erase(begin()); }
+  void pop_back() { erase(iterator(node_->pre, node_->pre->count - 1)); }
+
+  void clear();
+  void swap(unrolled_list &l) noexcept {
+    std::swap(node_, l.node_);
+    std::swap(size_, l.size_);
+  }
+};
+
+template <typename T, std::size_t K> void unrolled_list<T, K>::list_init() {
+  node_ = base_allocator::allocate(1);
+  node_->un_link();
+  node_->count = 0;
+  size_ = 0;
+}
+
+// 节点数据区需要 64 字节对齐，而 allocator 只保证基本对齐，
+// 因此多分配一段空间手动对齐，并把偏移量存在对齐地址的前一个字节中
+template <typename T, std::size_t K>
+typename unrolled_list<T, K>::node_ptr
+unrolled_list<T, K>::create_node(base_ptr pos) {
+  constexpr std::size_t align = alignof(node_type);
+  static_assert(align <= 255, "node alignment must fit in one byte");
+  unsigned char *raw = byte_allocator::allocate(sizeof(node_type) + align);
+  const std::uintptr_t addr =
+      (reinterpret_cast<std::uintptr_t>(raw) + align) & ~(align - 1);
+  unsigned char *p = reinterpret_cast<unsigned char *>(addr);
+  p[-1] = static_cast<unsigned char>(p - raw);
+  node_ptr node = ::new (static_cast<void *>(p)) node_type;
+  node->count = 0;
+  node->next = pos;
+  node->pre = pos->pre;
+  pos->pre->next = node;
+  pos->pre = node;
+  return node;
+}
+
+// 只负责摘除并释放节点，调用前元素应已析构或移走
+template <typename T, std::size_t K>
+void unrolled_list<T, K>::destory_node(base_ptr p) {
+  p->pre->next = p->next;
+  p->next->pre = p->pre;
+  unsigned char *aligned = reinterpret_cast<unsigned char *>(as_node(p));
+  byte_allocator::deallocate(aligned - aligned[-1]);
+}
+
+template <typename T, std::size_t K>
+template <typename InputIterator>
+void unrolled_list<T, K>::range_init(InputIterator first, InputIterator last) {
+  list_init();
+  try {
+    for (; first != last; ++first) {
+      emplace_back(*first);
+    }
+  } catch (...) {
+    clear();
+    base_allocator::deallocate(node_);
+    node_ = nullptr;
+    throw;
+  }
+}
+
+// 把 node 的后一半元素移到其后新建的节点中
+template <typename T, std::size_t K>
+void unrolled_list<T, K>::split_node(base_ptr node) {
+  node_ptr right = create_node(node->next);
+  T *src = as_node(node)->elems();
+  T *dst = right->elems();
+  const size_type half = node->count / 2;
+  const size_type moved = node->count - half;
+  for (size_type i = 0; i < moved; ++i) {
+    tinystl::construct(dst + i, std::move(src[half + i]));
+    tinystl::destory(src + half + i);
+  }
+  right->count = moved;
+  node->count = half;
+}
+
+// 把后继节点的全部元素并入 node，并释放后继节点
+template <typename T, std::size_t K>
+void unrolled_list<T, K>::merge_next(base_ptr node) {
+  base_ptr next = node->next;
+  T *src = as_node(next)->elems();
+  T *dst = as_node(node)->elems() + node->count;
+  for (size_type i = 0; i < next->count; ++i) {
+    tinystl::construct(dst + i, std::move(src[i]));
+    tinystl::destory(src + i);
+  }
+  node->count += next->count;
+  destory_node(next);
+}
+
+template <typename T, std::size_t K>
+template <typename... Args>
+typename unrolled_list<T, K>::iterator
+unrolled_list<T, K>::emplace_in_node(base_ptr node, size_type index,
+                                     Args &&...args) {
+  T *elems = as_node(node)->elems();
+  const size_type count = node->count;
+  if (index == count) {
+    tinystl::construct(elems + count, std::forward<Args>(args)...);
+  } else {
+    value_type tmp(std::forward<Args>(args)...);
+    tinystl::construct(elems + count, std::move(elems[count - 1]));
+    std::move_backward(elems + index, elems + count - 1, elems + count);
+    elems[index] = std::move(tmp);
+  }
+  ++node->count;
+  ++size_;
+  return iterator(node, index);
+}
+
+template <typename T, std::size_t K>
+template <typename... Args>
+typename unrolled_list<T, K>::iterator
+unrolled_list<T, K>::emplace(const_iterator pos, Args &&...args) {
+  base_ptr node = pos.node;
+  size_type index = pos.index;
+  if (node == node_) {
+    // end()：优先追加到尾节点
+    node = node_->pre;
+    if (node == node_ || node->count == K) {
+      node = create_node(node_);
+    }
+    index = node->count;
+  } else if (index == 0 && node->pre != node_ && node->pre->count < K) {
+    // 插入到节点开头时，前驱节点有空位则追加到前驱末尾，避免移动
+    node = node->pre;
+    index = node->count;
+  } else if (node->count == K) {
+    split_node(node);
+    if (index > node->count) {
+      index -= node->count;
+      node = node->next;
+    }
+  }
+  return emplace_in_node(node, index, std::forward<Args>(args)...);
+}
+
+template <typename T, std::size_t K>
+typename unrolled_list<T, K>::iterator
+unrolled_list<T, K>::erase(const_iterator pos) {
+  MY_DEBUG(pos.node != node_);
+  base_ptr node = pos.node;
+  size_type index = pos.index;
+  T *elems = as_node(node)->elems();
+  std::move(elems + index + 1, elems + node->count, elems + index);
+  tinystl::destory(elems + node->count - 1);
+  --node->count;
+  --size_;
+  if (node->count == 0) {
+    base_ptr next = node->next;
+    destory_node(node);
+    return iterator(next, 0);
+  }
+  // 节点过空时与后继合并，保证平均填充率
+  base_ptr next = node->next;
+  if (next != node_ && node->count + next->count <= K * 3 / 4 &&
+      node->count < K / 4 + 1) {
+    merge_next(node);
+  }
+  if (index == node->count) {
+    return iterator(node->next, 0);
+  }
+  return iterator(node, index);
+}
+
+template <typename T, std::size_t K>
+typename unrolled_list<T, K>::iterator
+unrolled_list<T, K>::erase(const_iterator first, const_iterator last) {
+  // 被删除区间之后的元素位置会因合并而变化，按剩余个数重新定位
+  size_type n = tinystl::distance(first, last);
+  iterator cur(first.node, first.index);
+  for (; n > 0; --n) {
+    cur = erase(cur);
+  }
+  return cur;
+}
+
+template <typename T, std::size_t K> void unrolled_list<T, K>::clear() {
+  base_ptr cur = node_->next;
+  while (cur != node_) {
+    base_ptr next = cur->next;
+    tinystl::destory(as_node(cur)->elems(), as_node(cur)->elems() + cur->count);
+    destory_node(cur);
+    cur = next;
+  }
+  node_->un_link();
+  size_ = 0;
+}
+
+template <typename T, std::size_t K>
+constexpr typename unrolled_list<T, K>::size_type
+    unrolled_list<T, K>::node_capacity;
+} // namespace tinystl
+
+#endif
@@ -0,0 +1,88 @@
+#ifndef MYTINYSTL_UTIL_H_
+#define MYTINYSTL_UTIL_H_
+
+#include "type_traits.h"
+#include <type_traits>
+#include <utility>
+
+namespace tinystl {
+template <class T1, class T2> struct pair {
+  typedef T1 first_type;
+  typedef T2 second_type;
+
+  first_type first;
+  second_type second;
+
+  constexpr pair() : first(), second() {}
+  constexpr pair(const T1 &a, const T2 &b) : first(a), second(b) {}
+  template <class U1, class U2,
+            typename std::enable_if<std::is_constructible<T1, U1 &&>::value &&
+                                        std::is_constructible<T2, U2 &&>::value,
+                                    int>::type = 0>
+  constexpr pair(U1 &&a, U2 &&b)
+      : first(std::forward<U1>(a)), second(std::forward<U2>(b)) {}
+  template <class U1, class U2>
+  constexpr pair(const pair<U1, U2> &p) : first(p.first), second(p.second) {}
+  template <class U1, class U2>
+  constexpr pair(pair<U1, U2> &&p)
+      : first(std::forward<U1>(p.first)), second(std::forward<U2>(p.second)) {}
+  pair(const pair &) = default;
+  pair(pair &&) = default;
+
+  pair &operator=(const pair &p) {
+    if (this != &p) {
+      first = p.first;
+      second = p.second;
+    }
+    return *this;
+  }
+  pair &operator=(pair &&p) {
+    if (this != &p) {
+      first = std::move(p.first);
+      second = std::move(p.second);
+    }
+    return *this;
+  }
+
+  void swap(pair &p) {
+    if (this != &p) {
+      std::swap(first, p.first);
+      std::swap(second, p.second);
+    }
+  }
+};
+
+template <class T1, class T2>
+bool operator==(const pair<T1, T2> &x, const pair<T1, T2> &y) {
+  return x.first == y.first && x.second == y.second;
+}
+template <class T1, class T2>
+bool operator!=(const pair<T1, T2> &x, const pair<T1, T2> &y) {
+  return !(x == y);
+}
+template <class T1, class T2>
+bool operator<(const pair<T1, T2> &x, const pair<T1, T2> &y) {
+  return x.first < y.first || (!(y.first < x.first) && x.second < y.second);
+}
+template <class T1, class T2>
+bool operator>(const pair<T1, T2> &x, const pair<T1, T2> &y) {
+  return y < x;
+}
+template <class T1, class T2>
+bool operator<=(const pair<T1, T2> &x, const pair<T1, T2> &y) {
+  return !(y < x);
+}
+template <class T1, class T2>
+bool operator>=(const pair<T1, T2> &x, const pair<T1, T2> &y) {
+  return !(x < y);
+}
+
+template <class T1, class T2>
+pair<typename std::decay<T1>::type, typename std::decay<T2>::type>
+make_pair(T1 &&first, T2 &&second) {
+  return pair<typename std::decay<T1>::type, typename std::decay<T2>::type>(
+      std::forward<T1>(first), std::forward<T2>(second));
+}
+} // namespace tinystl
+
+#endif
@@ -110,10 +110,18 @@ public:
     MY_DEBUG(!empty());
     return *start;
   }
+  const_reference front() const {
+    MY_DEBUG(!empty());
+    return *start;
+  }
   reference back() {
     MY_DEBUG(!empty());
     return *(finish - 1);
   }
+  const_reference back() const {
+    MY_DEBUG(!empty());
+    return *(finish - 1);
+  }
   pointer data() { return start; }
 
   //修改容器
@@ -425,13 +433,14 @@ template <typename T, typename alloc>
 template <typename... Args>
 void vector<T, alloc>::emplace_back(Args &&...args) {
   if (finish == end_of_storage) {
-    const size_type new_size = std::max(static_cast<size_type>(16), 2 * size());
+    const size_type old_size = size();
+    const size_type new_size = std::max(static_cast<size_type>(16), 2 * old_size);
     iterator new_start = data_allocator::allocate(new_size);
     tinystl::uninitialized_move(start, finish, new_start);
-    tinystl::construct(new_start + size(), std::forward<Args>(args)...);
+    tinystl::construct(new_start + old_size, std::forward<Args>(args)...);
     destory_deallocate_recover();
     start = new_start;
-    finish = start + size() + 1;
+    finish = start + old_size + 1;
     end_of_storage = start + new_size;
   } else {
     tinystl::construct(finish, std::forward<Args>(args)...);
@@ -455,14 +464,15 @@ typename vector<T, alloc>::iterator vector<T, alloc>::emplace(iterator iter,
   MY_DEBUG(iter <= finish && iter >= start);
   const size_type n = iter - start;
   if (finish == end_of_storage) {
-    const size_type new_size = std::max(static_cast<size_type>(16), 2 * size());
+    const size_type old_size = size();
+    const size_type new_size = std::max(static_cast<size_type>(16), 2 * old_size);
     iterator new_start = data_allocator::allocate(new_size);
     iterator new_iter = tinystl::uninitialized_move(start, iter, new_start);
     tinystl::construct(new_iter, std::forward<Args>(args)...);
     tinystl::uninitialized_move(iter, finish, new_iter + 1);
     destory_deallocate_recover();
     start = new_start;
-    finish = start + size() + 1;
+    finish = start + old_size + 1;
     end_of_storage = start + new_size;
   } else if (iter == finish) {
     tinystl::construct(iter, std::forward<Args>(args)...);